@@ -20,12 +20,28 @@
 #include <getopt.h>
 #include <libgen.h> // basename()
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <uv.h>
 
 #include "ubloxutils.h"
 #include "ubloxconn.h"
 #include "ubloxcstr.h"
+#include "ubloxring.h"
+#include "ubloxwheel.h"
+#include "ubloxdec.h"
+#include "ubloxreg.h"
+#include "ubloxcol.h"
+#include "ubloxrtcm.h"
+#include "ubloxrnx.h"
+#include "ubloxdmx.h"
+#include "ubloxcmd.h"
+#include "ubloxtty.h"
+#include "ubloxout.h"
 
 #undef DEBUG
 #define DEBUG 1
@@ -41,7 +57,7 @@
 #endif
 
 #define nullptr NULL
-#define TRACE(fmt, ...) {time_t now = time(nullptr); struct tm timeinfo; char buf[30]; gmtime_r(&now, &timeinfo); strcpy(buf, asctime(&timeinfo)); buf[strlen(buf)-1] = 0; fprintf (stderr, "%s [%s()] " fmt " {ln:%d, fn:" __FILE__ "}\n", buf, __func__, ##__VA_ARGS__, __LINE__); }
+#define TRACE(fmt, ...) {time_t now = time(nullptr); struct tm timeinfo; char buf[30]; gmtime_r(&now, &timeinfo); asctime_r(&timeinfo, buf); buf[strlen(buf)-1] = 0; fprintf (stderr, "%s [%s()] " fmt " {ln:%d, fn:" __FILE__ "}\n", buf, __func__, ##__VA_ARGS__, __LINE__); }
 
 
 #define TD TRACE
@@ -70,24 +86,105 @@
 #endif // DEBUG
 
 
+#define UBLOX_RING_SIZE (128 * 1024) /**< the size of the receiving ring buffer, power of 2 and >= UBLOX_PKT_LENGTH_MAX */
+#define UBLOX_CLI_WINDOW 8 /**< the default number of the commands in flight */
+#define UBLOX_CLI_CMD_TIMEOUT 2000 /**< the time to wait for the responses of a command (ms) */
+#define UBLOX_CLI_CMD_RETRIES 1 /**< the times to resend a command without the responses */
+#define UBLOX_CLI_TICK 10 /**< the resolution of the timer wheel (ms) */
+#define UBLOX_FLEET_CONCURRENCY 64 /**< the default number of the devices connected at the same time */
+
+#define UBLOX_DEV_PENDING 0 /**< not connected yet */
+#define UBLOX_DEV_RUNNING 1 /**< connecting or sending the commands */
+#define UBLOX_DEV_OK      2 /**< all of the commands are finished without error */
+#define UBLOX_DEV_FAILED  3 /**< some of the commands are NAKed, timed out or not sent */
+#define UBLOX_DEV_CONNECT 4 /**< unable to connect */
+#define UBLOX_DEV_TIMEOUT 5 /**< not finished before the timeout of -t */
+#define UBLOX_DEV_CLOSED  6 /**< closed by the device before finished */
+#define UBLOX_DEV_STOPPED 7 /**< interrupted by SIGINT */
+
+/** the device of the fleet, and the result */
+typedef struct _ubloxfleet_dev_t {
+    char * host;          /**< the host, or the path of the serial port */
+    int port;             /**< the port, or the baud rate of the serial port */
+    char flg_tty;         /**< 1 if the device is a serial port */
+    int status;           /**< UBLOX_DEV_xxx */
+    int err;              /**< the libuv error (-errno) of the connection */
+    uint64_t tm_start;    /**< the time to connect (ms) */
+    uint64_t tm_connected; /**< the time connected (ms), 0 if not */
+    uint64_t tm_done;     /**< the time closed (ms) */
+
+    size_t num_cmds;
+    size_t num_ok;
+    size_t num_nak;
+    size_t num_timeout;
+    size_t num_error;
+    size_t num_retry;
+    size_t num_rtt;       /**< the number of the commands responded */
+    uint64_t rtt_sum;     /**< the sum of the round-trip time (ms) */
+    uint64_t rtt_max;     /**< the max round-trip time (ms) */
+    size_t num_pkts;      /**< the number of the packets received */
+    size_t num_bytes;     /**< the number of the bytes received */
+} ubloxfleet_dev_t;
+
+struct _ubloxfleet_t;
+
+/** the connection to a device, allocated when connecting and freed when closed */
 typedef struct _ubloxdata_client_t {
-    const char * fn_execute; /**< the file name of execute file */
+    struct _ubloxfleet_t * fleet;
+    ubloxfleet_dev_t * dev;
 
     struct sockaddr_in addr_tcp;  /**< thep socket addr for commands (TCP) */
     uv_tcp_t uvtcp;
     uv_connect_t connect;
-    // TODO: a list of remote commands load from file?
-    size_t num_requests; /**< the total number of requests sent */
-    size_t num_responds; /**< the total number of responds received */
-    time_t starttime;
-    time_t timeout;
-
-    size_t sz_data; /**< the lenght of data in the buffer */
-    uint8_t buffer[UBLOX_PKT_LENGTH_MIN + 1200]; /**< the buffer to cache the received packets */
+    int fd;            /**< the serial port, -1 for TCP */
+    uv_poll_t uvpoll;  /**< the events of the serial port */
+    int events;        /**< the events polled, UV_READABLE and UV_WRITABLE if wbuf is not empty */
+    uint8_t * wbuf;    /**< the data not written to the serial port yet */
+    size_t sz_wbuf;
+    size_t max_wbuf;
+    ublox_cmdq_t cmdq; /**< the commands load from file, and the responses */
+    ublox_tmnode_t tmn_cmd; /**< the deadline of the commands in flight */
+    ublox_tmnode_t tmn_quit; /**< the deadline of the device, -t */
+
+    ublox_ring_t ring; /**< the ring buffer of the received data */
+    uint8_t buffer[UBLOX_RING_SIZE]; /**< the buffer to cache the received packets */
+    uint8_t buf_linear[UBLOX_PKT_LENGTH_MAX]; /**< the buffer to linearize the packet at the wrap point of the ring */
+    ublox_registry_t registry; /**< the handlers of the received packets */
+    ublox_out_t out; /**< the writer of the received packets to stdout */
+    char flg_out; /**< 1 if out is set */
 } ubloxdata_client_t;
 
-ubloxdata_client_t g_ubxcli;
-uv_loop_t * loop = NULL; /**< this have to be global variable, since it needs to access in on_xxxx() when service new connections */
+/**
+ * The devices of an event loop. The devices are connected in order while the
+ * number of the connections is less than the cap; each connection runs the
+ * same commands and is closed when the commands are finished, then the next
+ * device is connected. The deadlines of all of the connections are in one
+ * timer wheel, waked up by one libuv timer.
+ * A shard is a fleet with its own loop in its own thread, it only touches its
+ * slice of the devices, so the shards share nothing but the read-only script.
+ */
+typedef struct _ubloxfleet_t {
+    uv_loop_t * loop;
+    ublox_wheel_t wheel;  /**< the deadlines of the connections */
+    uv_timer_t uvtimer_wheel; /**< wake up the loop at the next slot of the wheel */
+    uv_signal_t sigint;
+
+    ubloxfleet_dev_t * devs;
+    size_t num_devs;
+    size_t idx_next;      /**< the next device to connect */
+    size_t num_active;    /**< the number of the connections */
+    size_t max_active;    /**< the max number of the connections */
+    char flg_stop;        /**< 1 if not to connect more devices */
+
+    const ublox_cmdq_t * script; /**< the commands sent to each device */
+    size_t window;        /**< the max number of the commands in flight of a device */
+    time_t timeout;       /**< the seconds of each device, 0 - wait forever */
+    int format;           /**< the format to print the received packets, <0 not to print */
+    char flg_single;      /**< 1 if only one device is in the run, the result of each command is reported */
+
+    uv_loop_t uvloop;     /**< the loop of the shard thread */
+    int ret;              /**< the return value of uv_run() */
+} ubloxfleet_t;
 
 
 /*****************************************************************************/
@@ -110,114 +207,276 @@ alloc_buffer(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
     buf->len = suggested_size;
 }
 
+/**
+ * \brief libuv read the data directly to the free space of the ring buffer
+ */
+void
+alloc_buffer_ring(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
+{
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)(handle->data);
+    size_t sz_space = 0;
+    buf->base = (char *)ublox_ring_write_ptr(&(ped->ring), &sz_space);
+    buf->len = sz_space;
+}
+
 /*****************************************************************************/
 
 /**
  * \brief process response packet in the buffer of ubloxdata_client_t
  * \param ped: the ubxcli with buffer
- * \param stream: the libuv socket
  *
  * \return 0 on successs
  *
  * process the data in the buffer, until there's no more data can be processed in one round
  */
 int
-ubxcli_process_data (ubloxdata_client_t * ped, uv_stream_t *stream)
+ubxcli_process_data (ubloxdata_client_t * ped)
 {
-    //int flg_again = 0;
     int ret;
+    uint8_t * p_frame;
+    size_t sz_frame;
     size_t sz_processed;
     size_t sz_needed_in;
+    uint64_t now;
 
     assert (NULL != ped);
-    assert (NULL != stream);
 
     TD("tcp cli ubxcli_process_data() BEGIN\n");
-    while(1) { // while (ped->sz_data > 0) {
-        //flg_again = 0;
-        TD("tcp cli ubxcli_process_data() ped->sz_data=%" PRIuSZ "\n", ped->sz_data);
-        assert (NULL != ped->buffer);
-        assert (ped->sz_data >= 0);
-        TD("tcp cli ubxcli_process_data() call ublox_pkt_nexthdr_ubx\n");
-
-        ret = ublox_process_buffer_data(ped->buffer, ped->sz_data, &sz_processed, &sz_needed_in);
-        if (sz_processed > 0) {
-            if (ped->sz_data > sz_processed) {
-                memmove(ped->buffer, ped->buffer + sz_processed, ped->sz_data - sz_processed);
-                ped->sz_data -= sz_processed;
-            } else {
-                ped->sz_data = 0;
-            }
-        }
-        if (sz_needed_in > 0) {
+    now = uv_now(ped->fleet->loop);
+    while(1) {
+        TD("tcp cli ubxcli_process_data() ring size=%" PRIuSZ "\n", ublox_ring_size(&(ped->ring)));
+        ret = ublox_ring_peek_frame(&(ped->ring), &p_frame, &sz_frame, &sz_needed_in);
+        if (ret == 1) {
+            // need more data
             break;
+        } else if (ret != 0) {
+            // the packet was skipped (too large or checksum error)
+            continue;
         }
-        if (ret < 0) {
-            break;
-        } else if (ret == 0) {
-            //flg_again = 1;
-            if (g_ubxcli.timeout > 0) g_ubxcli.num_responds ++;
-        } else if (ret == 1) {
-            //flg_again = 1;
-            break;
-
-        } else if (ret == 2) {
-            break;
+        // the packet without handler is skipped
+        ret = ublox_registry_dispatch(&(ped->registry), p_frame, sz_frame, &sz_processed);
+        if (sz_processed < 1) {
+            sz_processed = 1;
         }
-
+        ublox_cmdq_on_packet(&(ped->cmdq), p_frame, sz_frame, now);
+        ublox_ring_consume(&(ped->ring), sz_processed);
+        ped->dev->num_pkts ++;
     }
     return 0;
 }
 
 /*****************************************************************************/
+static void ubxfleet_next(ubloxfleet_t * fleet);
+
+/* the handle of the connection, the TCP socket or the poll of the serial port */
+static uv_handle_t *
+ubxcli_handle(ubloxdata_client_t * ped)
+{
+    if (ped->dev->flg_tty) {
+        return (uv_handle_t *)&(ped->uvpoll);
+    }
+    return (uv_handle_t *)&(ped->uvtcp);
+}
+
+/* wake up at the next slot of the wheel, the loop sleeps if no deadline */
+static void
+on_wheel_timer(uv_timer_t *handle);
+
+static void
+ubxfleet_wheel_arm(ubloxfleet_t * fleet)
+{
+    uint64_t next = ublox_wheel_next(&(fleet->wheel));
+    uint64_t now = uv_now(fleet->loop);
+
+    if (uv_is_closing((uv_handle_t *)&(fleet->uvtimer_wheel))) {
+        return;
+    }
+    if (0 == next) {
+        uv_timer_stop(&(fleet->uvtimer_wheel));
+        return;
+    }
+    uv_timer_start(&(fleet->uvtimer_wheel), on_wheel_timer, (next > now)?(next - now):0, 0);
+}
+
+/* save the result of the commands to the device */
+static void
+ubxcli_save_result(ubloxdata_client_t * ped)
+{
+    ubloxfleet_dev_t * dev = ped->dev;
+    const ublox_cmd_t * cmd;
+    uint64_t rtt;
+    size_t i;
+
+    dev->num_cmds = ped->cmdq.num_cmds;
+    dev->num_ok = ped->cmdq.num_ok;
+    dev->num_nak = ped->cmdq.num_nak;
+    dev->num_timeout = ped->cmdq.num_timeout;
+    dev->num_error = ped->cmdq.num_error;
+    dev->num_retry = ped->cmdq.num_retry;
+    for (i = 0; i < ped->cmdq.num_cmds; i ++) {
+        cmd = ped->cmdq.cmds + i;
+        if ((0 == cmd->expect) || ((UBLOX_CMD_OK != cmd->status) && (UBLOX_CMD_NAK != cmd->status))) {
+            continue;
+        }
+        rtt = cmd->tm_done - cmd->tm_sent;
+        dev->num_rtt ++;
+        dev->rtt_sum += rtt;
+        if (rtt > dev->rtt_max) {
+            dev->rtt_max = rtt;
+        }
+    }
+}
 
 void
 on_tcp_cli_close(uv_handle_t* handle)
 {
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)(handle->data);
+    ubloxfleet_t * fleet = ped->fleet;
+
     TI( "tcp cli closed.\n");
+    ubxcli_save_result(ped);
+    if (fleet->flg_single && (ped->cmdq.num_cmds > 0)) {
+        ublox_cmdq_report(&(ped->cmdq), stderr);
+    }
+    ublox_cmdq_clear(&(ped->cmdq));
+    ublox_registry_clear(&(ped->registry));
+    if (ped->flg_out) {
+        ublox_out_clear(&(ped->out));
+    }
+    if (ped->fd >= 0) {
+        close(ped->fd);
+    }
+    free(ped->wbuf);
+    free(ped);
+    fleet->num_active --;
+    ubxfleet_next(fleet);
+}
+
+/**
+ * \brief close the connection and set the status of the device
+ * \param ped: the ubxcli
+ * \param status: UBLOX_DEV_xxx, the reason if the commands are not finished
+ */
+static void
+ubxcli_close(ubloxdata_client_t * ped, int status)
+{
+    ubloxfleet_dev_t * dev = ped->dev;
+    ublox_cmdq_t * q = &(ped->cmdq);
+
+    if (uv_is_closing(ubxcli_handle(ped))) {
+        return;
+    }
+    if ((dev->tm_connected > 0) && ublox_cmdq_done(q)) {
+        status = (q->num_nak + q->num_timeout + q->num_error > 0)?UBLOX_DEV_FAILED:UBLOX_DEV_OK;
+    }
+    dev->status = status;
+    dev->tm_done = uv_now(ped->fleet->loop);
+    if (UBLOX_DEV_TIMEOUT == status) {
+        TW("timeout: %d\n", (int)ped->fleet->timeout);
+    }
+    ublox_wheel_del(&(ped->fleet->wheel), &(ped->tmn_cmd));
+    ublox_wheel_del(&(ped->fleet->wheel), &(ped->tmn_quit));
+    uv_close(ubxcli_handle(ped), on_tcp_cli_close);
+}
+
+/**
+ * \brief close the connection when all of the commands are finished
+ * \param ped: the ubxcli
+ *
+ * Without the commands, the connection of a single device is closed after the first read.
+ * Without the timeout, the connection is kept to print or count the received packets until SIGINT.
+ */
+static void
+ubxcli_check_done(ubloxdata_client_t * ped)
+{
+    if (! ublox_cmdq_done(&(ped->cmdq))) {
+        return;
+    }
+    if ((ped->fleet->timeout > 0) || ((ped->cmdq.num_cmds < 1) && ped->flg_out)) {
+        TI("tcp cli all of the commands(%" PRIuSZ ") are finished!\n", ped->cmdq.num_cmds);
+        ubxcli_close(ped, UBLOX_DEV_OK);
+    }
+}
+
+/**
+ * \brief move the timer of the client to the deadline of the commands in flight
+ * \param ped: the ubxcli
+ *
+ * \return 1 if the timer is changed, 0 if not
+ */
+static int
+ubxcli_update_deadline(ubloxdata_client_t * ped)
+{
+    ublox_wheel_t * w = &(ped->fleet->wheel);
+    uint64_t deadline = ublox_cmdq_deadline(&(ped->cmdq));
+
+    if (deadline < 1) {
+        if (! ublox_tmnode_pending(&(ped->tmn_cmd))) {
+            return 0;
+        }
+        ublox_wheel_del(w, &(ped->tmn_cmd));
+        return 1;
+    }
+    if (ublox_tmnode_pending(&(ped->tmn_cmd)) && (ped->tmn_cmd.expire == deadline)) {
+        return 0;
+    }
+    ublox_wheel_add(w, &(ped->tmn_cmd), deadline);
+    return 1;
+}
+
+/* the commands of the client are timed out, resend or finish them; or the device is timed out */
+static void
+on_cli_expired(void * userdata, ublox_tmnode_t * node)
+{
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)(node->data);
+    ubloxfleet_t * fleet = (ubloxfleet_t *)userdata;
+
+    if (node == &(ped->tmn_quit)) {
+        ubxcli_close(ped, UBLOX_DEV_TIMEOUT);
+        return;
+    }
+    ublox_cmdq_check_timeout(&(ped->cmdq), uv_now(fleet->loop));
+    ubxcli_update_deadline(ped);
+    ubxcli_check_done(ped);
+}
+
+static void
+on_wheel_timer(uv_timer_t *handle)
+{
+    ubloxfleet_t * fleet = (ubloxfleet_t *)(handle->data);
+
+    ublox_wheel_advance(&(fleet->wheel), uv_now(fleet->loop), on_cli_expired, fleet);
+    ubxfleet_wheel_arm(fleet);
+}
+
+/* process the data appended to the ring, and the commands responded */
+static void
+ubxcli_on_data(ubloxdata_client_t * ped, size_t sz_read)
+{
+    if (sz_read > 0) {
+        ped->dev->num_bytes += sz_read;
+        ubxcli_process_data (ped);
+        if (ped->flg_out) {
+            ublox_out_flush(&(ped->out));
+        }
+    }
+    if (ubxcli_update_deadline(ped)) {
+        ubxfleet_wheel_arm(ped->fleet);
+    }
+    ubxcli_check_done(ped);
 }
 
 void
 on_tcp_cli_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
 {
-    if(nread > 0) {
-        // push the content to a center buffer for this TCP connection
-        // and fetch the cmd to fetch appriate length of data as a packet
-        // to process
-        size_t sz_copy;
-        size_t sz_processed;
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)(stream->data);
 
+    if(nread > 0) {
+        // the data was read to the ring buffer of this TCP connection by alloc_buffer_ring()
         TD("tcp cli read block, size=%" PRIiSZ ":\n", nread);
         hex_dump_to_fd(STDERR_FILENO, (opaque_t *)(buf->base), nread);
 
-        TD("tcp cli process data 1\n");
-        ubxcli_process_data (&g_ubxcli, stream);
-        sz_processed = 0;
-        while (sz_processed < nread) {
-            sz_copy = nread - sz_processed;
-            assert (sizeof(g_ubxcli.buffer) >= g_ubxcli.sz_data);
-            if (sz_copy + g_ubxcli.sz_data > sizeof(g_ubxcli.buffer)) {
-                sz_copy = sizeof(g_ubxcli.buffer) - g_ubxcli.sz_data;
-            }
-            TD("tcp cli push received data size=%" PRIuSZ ", processed=%" PRIuSZ "\n", sz_copy, sz_processed);
-            if (sz_copy > 0) {
-                memmove (g_ubxcli.buffer + g_ubxcli.sz_data, buf->base + sz_processed, sz_copy);
-                sz_processed += sz_copy;
-                g_ubxcli.sz_data += sz_copy;
-            } else {
-                // error? full?
-                TI( "tcp cli no more received data to be push\n");
-                break;
-            }
-            TD("tcp cli process data 2\n");
-            ubxcli_process_data (&g_ubxcli, stream);
-        }
-        if (sz_processed < nread) {
-            // we're stalled here, because the content can't be processed by the function ubxcli_process_data()
-            // error
-            TD("tcp cli data stalled\n");
-            //uv_close((uv_handle_t *)stream, on_tcp_cli_close);
-        }
+        ublox_ring_commit(&(ped->ring), nread);
     }
     if (nread == 0) {
         TI("tcp cli read zero!\n");
@@ -225,15 +484,10 @@ on_tcp_cli_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
     if (nread < 0) {
         //we got an EOF
         TI("tcp cli read EOF!\n");
-        uv_close((uv_handle_t*)stream, on_tcp_cli_close);
-    }
-
-    free(buf->base);
-    if (g_ubxcli.num_responds >= g_ubxcli.num_requests) {
-        TI("tcp cli received responses(%" PRIuSZ ") exceed requests(%" PRIuSZ ")!\n", g_ubxcli.num_responds, g_ubxcli.num_requests);
-        uv_close((uv_handle_t*)stream, on_tcp_cli_close);
-        raise(SIGINT); // send signal and handle by uv_signal_cb
+        ubxcli_close(ped, UBLOX_DEV_CLOSED);
+        return;
     }
+    ubxcli_on_data(ped, nread);
 }
 
 void
@@ -241,15 +495,16 @@ on_tcp_cli_write_end(uv_write_t* req, int status)
 {
     if (status) {
         TI( "tcp cli write error %s.\n", uv_strerror(status));
-        uv_close(req->handle, on_tcp_cli_close);
-        return;
+        if (UV_ECANCELED != status) {
+            ubxcli_close((ubloxdata_client_t *)(req->handle->data), UBLOX_DEV_CLOSED);
+        }
     } else {
         TI( "tcp cli write successfull.\n");
     }
-    write_buf_free(req);
+    write_buf_free((write_buf_t *)req);
 }
 
-void
+int
 send_buffer(uv_stream_t* stream, uint8_t *buffer1, size_t szbuf)
 {
     int r;
@@ -262,11 +517,124 @@ send_buffer(uv_stream_t* stream, uint8_t *buffer1, size_t szbuf)
     memmove (wbuf->buf.base, buffer1, szbuf);
     assert (NULL != wbuf->buf.base);
     assert (wbuf->buf.len >= szbuf);
-    r = uv_write(wbuf, stream, &(wbuf->buf), 1, on_tcp_cli_write_end);
+    r = uv_write(&(wbuf->req), stream, &(wbuf->buf), 1, on_tcp_cli_write_end);
     if (r) {
         /* error */
         TE( "tcp cli error in write() %s\n", uv_strerror(r));
+        write_buf_free(wbuf);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief the send function of the command queue
+ * \param userdata: the libuv socket
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on successs, <0 on error
+ */
+static int
+ubxcli_send_cmd(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    return send_buffer((uv_stream_t *)userdata, (uint8_t *)buffer_in, sz_in);
+}
+
+void on_tty_cli_poll(uv_poll_t *handle, int status, int events);
+
+/* write the data pending to the serial port, poll UV_WRITABLE until all of them are written */
+static int
+ubxcli_tty_flush(ubloxdata_client_t * ped)
+{
+    ssize_t ret;
+    int events;
+
+    if (ped->sz_wbuf > 0) {
+        ret = ublox_tty_write(ped->fd, ped->wbuf, ped->sz_wbuf);
+        if (ret < 0) {
+            TE("tty cli write %s error %s\n", ped->dev->host, uv_strerror((int)ret));
+            ped->dev->err = (int)ret;
+            return -1;
+        }
+        memmove(ped->wbuf, ped->wbuf + ret, ped->sz_wbuf - ret);
+        ped->sz_wbuf -= ret;
+    }
+    events = (ped->sz_wbuf > 0)?(UV_READABLE | UV_WRITABLE):UV_READABLE;
+    if (events != ped->events) {
+        ped->events = events;
+        uv_poll_start(&(ped->uvpoll), events, on_tty_cli_poll);
+    }
+    return 0;
+}
+
+/**
+ * \brief the send function of the command queue of the serial port
+ * \param userdata: the ubxcli
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on successs, <0 on error
+ *
+ * The packet is appended to the data pending, the UART is slower than the
+ * commands queued, the rest is written when the port is writable.
+ */
+static int
+ubxcli_send_tty(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)userdata;
+    uint8_t * p;
+    size_t sz;
+
+    if (ped->sz_wbuf + sz_in > ped->max_wbuf) {
+        sz = (ped->max_wbuf > 0)?(2 * ped->max_wbuf):1024;
+        while (sz < ped->sz_wbuf + sz_in) {
+            sz *= 2;
+        }
+        p = realloc(ped->wbuf, sz);
+        if (NULL == p) {
+            TE("out of memory\n");
+            return -1;
+        }
+        ped->wbuf = p;
+        ped->max_wbuf = sz;
+    }
+    memmove(ped->wbuf + ped->sz_wbuf, buffer_in, sz_in);
+    ped->sz_wbuf += sz_in;
+    return ubxcli_tty_flush(ped);
+}
+
+void
+on_tty_cli_poll(uv_poll_t *handle, int status, int events)
+{
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)(handle->data);
+    ssize_t ret = 0;
+
+    if (status < 0) {
+        // libuv reports POLLERR as UV_EBADF, it's the hang up of the port
+        ped->dev->err = (UV_EBADF == status)?UV_EIO:status;
+        TI("tty cli poll %s error %s\n", ped->dev->host, uv_strerror(ped->dev->err));
+        ubxcli_close(ped, UBLOX_DEV_CLOSED);
+        return;
+    }
+    if (events & UV_WRITABLE) {
+        if (ubxcli_tty_flush(ped) < 0) {
+            ubxcli_close(ped, UBLOX_DEV_CLOSED);
+            return;
+        }
+    }
+    if (events & UV_READABLE) {
+        // drain the port to the ring buffer in place
+        ret = ublox_tty_read_ring(ped->fd, &(ped->ring));
+        if (ret < 0) {
+            TI("tty cli read %s error %s\n", ped->dev->host, uv_strerror((int)ret));
+            ped->dev->err = (int)ret;
+            ubxcli_close(ped, UBLOX_DEV_CLOSED);
+            return;
+        }
+        TD("tty cli read block, size=%" PRIiSZ "\n", ret);
     }
+    ubxcli_on_data(ped, ret);
 }
 
 /**
@@ -278,12 +646,13 @@ send_buffer(uv_stream_t* stream, uint8_t *buffer1, size_t szbuf)
  *
  * \return 0 on successs, <0 on error
  *
+ * The packets are queued to ublox_cmdq_t, and sent by ublox_cmdq_pump().
  * TODO: add command 'sleep' to support delay between commands.
  */
 int
 process_command_libuv(off_t pos, char * buf, size_t size, void *userdata)
 {
-    uv_stream_t* stream = (uv_stream_t *)userdata;
+    ublox_cmdq_t * q = (ublox_cmdq_t *)userdata;
 
     ssize_t ret = -1;
     uint8_t buffer1[200];
@@ -311,40 +680,189 @@ process_command_libuv(off_t pos, char * buf, size_t size, void *userdata)
     assert (ret <= sizeof(buffer1));
 #endif
 
-    send_buffer(stream, buffer1, ret);
-    g_ubxcli.num_requests ++;
-
+    if (ublox_cmdq_add(q, buffer1, ret, (long)pos) < 0) {
+        return -1;
+    }
     return 0;
 }
 
+/* send the first commands of the window */
+static void
+ubxcli_on_connected(ubloxdata_client_t * ped)
+{
+    ped->dev->tm_connected = uv_now(ped->fleet->loop);
+    ublox_cmdq_pump(&(ped->cmdq), uv_now(ped->fleet->loop));
+    if (ubxcli_update_deadline(ped)) {
+        ubxfleet_wheel_arm(ped->fleet);
+    }
+}
+
 void
 on_tcp_cli_connect(uv_connect_t* connection, int status)
 {
     uv_stream_t* stream = connection->handle;
+    ubloxdata_client_t * ped = (ubloxdata_client_t *)(stream->data);
 
     TD("tcp cli connected.\n");
 
-    read_file_lines (g_ubxcli.fn_execute, (void *)stream, process_command_libuv);
-    uv_read_start(stream, alloc_buffer, on_tcp_cli_read);
+    if (status < 0) {
+        TE("tcp cli connect %s:%d error %s\n", ped->dev->host, ped->dev->port, uv_strerror(status));
+        ped->dev->err = status;
+        ubxcli_close(ped, UBLOX_DEV_CONNECT);
+        return;
+    }
+    if (uv_is_closing((uv_handle_t*)stream)) {
+        return;
+    }
+    ubxcli_on_connected(ped);
+    uv_read_start(stream, alloc_buffer_ring, on_tcp_cli_read);
 }
 
-/*****************************************************************************/
+/**
+ * \brief the time to wait for the responses of a command on the serial port
+ * \param script: the commands
+ * \param window: the max number of the commands in flight
+ * \param baud: the baud rate
+ *
+ * \return the timeout (ms)
+ *
+ * A command is sent when it's appended to the data pending, the commands in
+ * flight ahead of it are still on the UART, such as 0.5 s for 8 CFG-VALSET
+ * at 9600 baud, so the time to write them is added to the timeout.
+ */
+static uint32_t
+ubxcli_tty_timeout(const ublox_cmdq_t * script, size_t window, int baud)
+{
+    size_t sz_max = 0;
+    size_t i;
 
-static char flg_has_error = 0;
+    for (i = 0; (NULL != script) && (i < script->num_cmds); i ++) {
+        if (script->cmds[i].sz_pkt > sz_max) {
+            sz_max = script->cmds[i].sz_pkt;
+        }
+    }
+    if ((NULL != script) && (window > script->num_cmds)) {
+        window = script->num_cmds;
+    }
+    if (baud < 1) {
+        baud = UBLOX_TTY_BAUD_DEFAULT;
+    }
+    // 10 bits per byte of 8N1
+    return UBLOX_CLI_CMD_TIMEOUT + (uint32_t)((uint64_t)window * sz_max * 10 * 1000 / baud);
+}
 
-static void
-idle_cb (uv_idle_t *handle)
+/**
+ * \brief connect to a device
+ * \param fleet: the fleet
+ * \param dev: the device
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ubxcli_start(ubloxfleet_t * fleet, ubloxfleet_dev_t * dev)
 {
-    time_t curtime;
-    time(&curtime);
-    if (g_ubxcli.starttime + g_ubxcli.timeout <= curtime) {
-        flg_has_error = 1;
-        uv_idle_stop(handle);
-        uv_stop(uv_default_loop());
-        TW("timeout: %d\n", (int)g_ubxcli.timeout);
+    ubloxdata_client_t * ped;
+    const ublox_cmd_t * cmd;
+    size_t i;
+    int ret;
+
+    dev->status = UBLOX_DEV_RUNNING;
+    dev->tm_start = uv_now(fleet->loop);
+    ped = (ubloxdata_client_t *)calloc(1, sizeof(*ped));
+    if (NULL == ped) {
+        TE("out of memory\n");
+        dev->status = UBLOX_DEV_CONNECT;
+        return -1;
+    }
+    ped->fleet = fleet;
+    ped->dev = dev;
+    ped->fd = -1;
+    ublox_ring_init(&(ped->ring), ped->buffer, sizeof(ped->buffer), ped->buf_linear, sizeof(ped->buf_linear));
+    ublox_registry_init(&(ped->registry));
+    if (fleet->format >= 0) {
+        if (0 > ublox_out_init(&(ped->out), STDOUT_FILENO, fleet->format, NULL, UBLOX_RING_SIZE)) {
+            goto err_out;
+        }
+        ped->flg_out = 1;
+        if ((0 > ublox_registry_add_writer(&(ped->registry), &(ped->out))) || (0 > ublox_out_header(&(ped->out)))) {
+            goto err_out;
+        }
+    }
+    if (dev->flg_tty) {
+        ublox_cmdq_init(&(ped->cmdq), fleet->window, ubxcli_tty_timeout(fleet->script, fleet->window, dev->port), ubxcli_send_tty, ped);
+    } else {
+        ublox_cmdq_init(&(ped->cmdq), fleet->window, UBLOX_CLI_CMD_TIMEOUT, ubxcli_send_cmd, &(ped->uvtcp));
+    }
+    ped->cmdq.retries = UBLOX_CLI_CMD_RETRIES;
+    for (i = 0; (NULL != fleet->script) && (i < fleet->script->num_cmds); i ++) {
+        cmd = fleet->script->cmds + i;
+        if (ublox_cmdq_add(&(ped->cmdq), fleet->script->data + cmd->offset, cmd->sz_pkt, cmd->pos) < 0) {
+            goto err_out;
+        }
+    }
+    ublox_tmnode_init(&(ped->tmn_cmd), ped);
+    ublox_tmnode_init(&(ped->tmn_quit), ped);
+    if (fleet->timeout > 0) {
+        ublox_wheel_add(&(fleet->wheel), &(ped->tmn_quit), dev->tm_start + (uint64_t)fleet->timeout * 1000);
+    }
+
+    if (dev->flg_tty) {
+        ped->fd = ublox_tty_open(dev->host, dev->port);
+        if (ped->fd < 0) {
+            dev->err = ped->fd;
+            goto err_out;
+        }
+        ret = uv_poll_init(fleet->loop, &(ped->uvpoll), ped->fd);
+        if (ret < 0) {
+            TE("tty cli poll %s error %s\n", dev->host, uv_strerror(ret));
+            dev->err = ret;
+            goto err_out;
+        }
+        ped->uvpoll.data = ped;
+        fleet->num_active ++;
+        ped->events = UV_READABLE;
+        uv_poll_start(&(ped->uvpoll), ped->events, on_tty_cli_poll);
+        // the port is ready after opened
+        ubxcli_on_connected(ped);
+        ubxfleet_wheel_arm(fleet);
+        return 0;
+    }
+    if (0 != (ret = uv_ip4_addr(dev->host, dev->port, &(ped->addr_tcp)))) {
+        TE("tcp cli unknown address %s:%d\n", dev->host, dev->port);
+        dev->err = ret;
+        goto err_out;
+    }
+    uv_tcp_init(fleet->loop, &(ped->uvtcp));
+    ped->uvtcp.data = ped;
+    fleet->num_active ++;
+    uv_tcp_keepalive(&(ped->uvtcp), 1, 60);
+    ret = uv_tcp_connect(&(ped->connect), &(ped->uvtcp), (const struct sockaddr*)&(ped->addr_tcp), on_tcp_cli_connect);
+    if (ret < 0) {
+        TE("tcp cli connect %s:%d error %s\n", dev->host, dev->port, uv_strerror(ret));
+        dev->err = ret;
+        ubxcli_close(ped, UBLOX_DEV_CONNECT);
+        return 0;
     }
+    ubxfleet_wheel_arm(fleet);
+    return 0;
+
+err_out:
+    dev->status = UBLOX_DEV_CONNECT;
+    ublox_wheel_del(&(fleet->wheel), &(ped->tmn_quit));
+    if (ped->fd >= 0) {
+        close(ped->fd);
+    }
+    ublox_cmdq_clear(&(ped->cmdq));
+    ublox_registry_clear(&(ped->registry));
+    if (ped->flg_out) {
+        ublox_out_clear(&(ped->out));
+    }
+    free(ped);
+    return -1;
 }
 
+/*****************************************************************************/
+
 static void
 on_uv_close(uv_handle_t* handle)
 {
@@ -353,63 +871,356 @@ on_uv_close(uv_handle_t* handle)
     }
 }
 
+/* connect to the next devices under the cap; close the loop handles after the last one */
+static void
+ubxfleet_next(ubloxfleet_t * fleet)
+{
+    ubloxfleet_dev_t * dev;
+
+    while ((! fleet->flg_stop) && (fleet->idx_next < fleet->num_devs) && (fleet->num_active < fleet->max_active)) {
+        dev = fleet->devs + fleet->idx_next ++;
+        if (ubxcli_start(fleet, dev) < 0) {
+            dev->tm_done = uv_now(fleet->loop);
+        }
+    }
+    if ((fleet->num_active > 0) || ((! fleet->flg_stop) && (fleet->idx_next < fleet->num_devs))) {
+        return;
+    }
+    // all of the devices are finished, uv_run() returns after the handles are closed
+    if (! uv_is_closing((uv_handle_t *)&(fleet->uvtimer_wheel))) {
+        uv_close((uv_handle_t *)&(fleet->uvtimer_wheel), on_uv_close);
+    }
+    if (! uv_is_closing((uv_handle_t *)&(fleet->sigint))) {
+        uv_close((uv_handle_t *)&(fleet->sigint), on_uv_close);
+    }
+}
+
 static void
 on_uv_walk(uv_handle_t* handle, void* arg)
 {
+    if (uv_is_closing(handle)) {
+        return;
+    }
+    if ((UV_TCP == handle->type) || (UV_POLL == handle->type)) {
+        ubxcli_close((ubloxdata_client_t *)(handle->data), UBLOX_DEV_STOPPED);
+        return;
+    }
     uv_close(handle, on_uv_close);
 }
 
 static void
 on_sigint_received(uv_signal_t *handle, int signum)
 {
-    int result = uv_loop_close(handle->loop);
-    if (result == UV_EBUSY) {
-        uv_walk(handle->loop, on_uv_walk, NULL);
+    ubloxfleet_t * fleet = (ubloxfleet_t *)(handle->data);
+
+    fleet->flg_stop = 1;
+    uv_walk(handle->loop, on_uv_walk, NULL);
+}
+
+/**
+ * \brief run the commands on the devices in the loop
+ * \param fleet: the fleet with the devices, the commands and the options
+ * \param loop: the libuv loop
+ *
+ * \return the return value of uv_run()
+ */
+static int
+ubxfleet_run(ubloxfleet_t * fleet, uv_loop_t * loop)
+{
+    fleet->loop = loop;
+    fleet->idx_next = 0;
+    fleet->num_active = 0;
+    fleet->flg_stop = 0;
+    if (fleet->max_active < 1) {
+        fleet->max_active = 1;
     }
+    uv_signal_init(loop, &(fleet->sigint));
+    fleet->sigint.data = fleet;
+    uv_signal_start(&(fleet->sigint), on_sigint_received, SIGINT);
+    uv_timer_init(loop, &(fleet->uvtimer_wheel));
+    fleet->uvtimer_wheel.data = fleet;
+    ublox_wheel_init(&(fleet->wheel), UBLOX_CLI_TICK, uv_now(loop));
+
+    ubxfleet_next(fleet);
+    return uv_run(loop, UV_RUN_DEFAULT);
 }
 
-/*****************************************************************************/
-int
-main_cli(const char * host, int port_tcp, time_t timeout, const char * fn_execute)
+/* the thread of a shard */
+static void
+ubxfleet_shard(void * arg)
 {
-    int ret = 0;
-    struct sockaddr_in broadcast_addr;
-    struct sockaddr_in addr_udp;
-    uint32_t connect_code = 0;
-    uv_idle_t idler;
-    uv_signal_t sigint;
+    ubloxfleet_t * fleet = (ubloxfleet_t *)arg;
+
+    fleet->ret = uv_loop_init(&(fleet->uvloop));
+    if (0 != fleet->ret) {
+        TE("unable to init the loop: %s\n", uv_strerror(fleet->ret));
+        return;
+    }
+    fleet->ret = ubxfleet_run(fleet, &(fleet->uvloop));
+    uv_loop_close(&(fleet->uvloop));
+}
+
+/**
+ * \brief the name of the status of a device
+ * \param status: UBLOX_DEV_xxx
+ *
+ * \return the name
+ */
+static const char *
+ubxfleet_status_cstr(int status)
+{
+    static const char * names[] = { "pending", "running", "ok", "failed", "connect", "timeout", "closed", "stopped" };
+
+    if ((status < 0) || (status >= (int)NUM_ARRAY(names))) {
+        return "unknown";
+    }
+    return names[status];
+}
+
+/**
+ * \brief print the result and the timings of each device
+ * \param devs: the devices
+ * \param num_devs: the number of the devices
+ * \param fp: the output
+ *
+ * \return the number of the devices not finished without error
+ */
+static size_t
+ubxfleet_report(const ubloxfleet_dev_t * devs, size_t num_devs, FILE * fp)
+{
+    const ubloxfleet_dev_t * dev;
+    size_t num_fail = 0;
+    size_t i;
+
+    for (i = 0; i < num_devs; i ++) {
+        dev = devs + i;
+        if (UBLOX_DEV_OK != dev->status) {
+            num_fail ++;
+        }
+        fprintf(fp, "[fleet] %s:%d %s", dev->host, dev->port, ubxfleet_status_cstr(dev->status));
+        if (dev->err < 0) {
+            fprintf(fp, " (%s)", uv_strerror(dev->err));
+        }
+        if (dev->tm_connected > 0) {
+            fprintf(fp, " connect=%lu ms", (unsigned long)(dev->tm_connected - dev->tm_start));
+        }
+        if (dev->tm_done > 0) {
+            fprintf(fp, " total=%lu ms", (unsigned long)(dev->tm_done - dev->tm_start));
+        }
+        fprintf(fp, " cmds=%" PRIuSZ " ok=%" PRIuSZ " nak=%" PRIuSZ " timeout=%" PRIuSZ " error=%" PRIuSZ " resent=%" PRIuSZ,
+            dev->num_cmds, dev->num_ok, dev->num_nak, dev->num_timeout, dev->num_error, dev->num_retry);
+        if (dev->num_rtt > 0) {
+            fprintf(fp, " rtt avg=%lu max=%lu ms", (unsigned long)(dev->rtt_sum / dev->num_rtt), (unsigned long)dev->rtt_max);
+        }
+        fprintf(fp, " pkts=%" PRIuSZ " bytes=%" PRIuSZ, dev->num_pkts, dev->num_bytes);
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, "[fleet] devices = %" PRIuSZ ", ok = %" PRIuSZ ", failed = %" PRIuSZ "\n", num_devs, num_devs - num_fail, num_fail);
+    return num_fail;
+}
+
+/**
+ * \brief append a device of "host[:port]", or the serial port of "path[:baud]"
+ * \param pdevs: the array of the devices
+ * \param pnum: the number of the devices
+ * \param pmax: the capacity of the array
+ * \param cstr: the host and the port
+ * \param port: the default port
+ * \param flg_tty: 1 if the device is a serial port; an absolute path is a serial port too
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ubxfleet_add_host(ubloxfleet_dev_t ** pdevs, size_t * pnum, size_t * pmax, const char * cstr, int port, char flg_tty)
+{
+    ubloxfleet_dev_t * dev;
+    char * p;
+    size_t sz;
+
+    if (*pnum >= *pmax) {
+        sz = (*pmax > 0)?(2 * (*pmax)):16;
+        p = realloc(*pdevs, sz * sizeof(**pdevs));
+        if (NULL == p) {
+            TE("out of memory\n");
+            return -1;
+        }
+        *pdevs = (ubloxfleet_dev_t *)p;
+        *pmax = sz;
+    }
+    dev = *pdevs + *pnum;
+    memset(dev, 0, sizeof(*dev));
+    dev->host = strdup(cstr);
+    if (NULL == dev->host) {
+        TE("out of memory\n");
+        return -1;
+    }
+    dev->port = port;
+    if (flg_tty || ('/' == cstr[0])) {
+        dev->flg_tty = 1;
+        dev->port = UBLOX_TTY_BAUD_DEFAULT;
+    }
+    p = strchr(dev->host, ':');
+    if (NULL != p) {
+        *p = 0;
+        dev->port = atoi(p + 1);
+    }
+    (*pnum) ++;
+    return 0;
+}
+
+/** the devices of the command line */
+typedef struct _ubloxfleet_hosts_t {
+    ubloxfleet_dev_t * devs;
+    size_t num_devs;
+    size_t max_devs;
+    int port;             /**< the default port */
+    char flg_tty;         /**< 1 if the devices added are the serial ports */
+} ubloxfleet_hosts_t;
 
-    // setup service related info
-    memset (&g_ubxcli, 0, sizeof (g_ubxcli));
-    g_ubxcli.sz_data = 0;
-    g_ubxcli.num_requests = 0;
-    g_ubxcli.num_responds = 0;
-    g_ubxcli.fn_execute = fn_execute;
-    uv_ip4_addr(host, port_tcp, &(g_ubxcli.addr_tcp));
+/**
+ * \brief append the devices of "host[:port]" separated by ',', ' ' or tab
+ * \param hosts: the devices
+ * \param cstr: the list
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ubxfleet_hosts_add(ubloxfleet_hosts_t * hosts, const char * cstr)
+{
+    char buf[256];
+    const char * p;
+    size_t len;
+
+    while (0 != *cstr) {
+        len = strcspn(cstr, ", \t\r\n");
+        if ((len > 0) && (len < sizeof(buf))) {
+            memmove(buf, cstr, len);
+            buf[len] = 0;
+            if (ubxfleet_add_host(&(hosts->devs), &(hosts->num_devs), &(hosts->max_devs), buf, hosts->port, hosts->flg_tty) < 0) {
+                return -1;
+            }
+        }
+        p = cstr + len;
+        cstr = (0 != *p)?(p + 1):p;
+    }
+    return 0;
+}
 
-    loop = uv_default_loop();
-    assert (NULL != loop);
+/* add the devices of a line of the host list, '#' starts a comment */
+static int
+process_host_line(off_t pos, char * buf, size_t size, void *userdata)
+{
+    char * p = strchr(buf, '#');
 
-    uv_signal_init(loop, &sigint);
-    uv_signal_start(&sigint, on_sigint_received, SIGINT);
-    if (timeout > 0) {
-        uv_idle_init(loop, &idler);
-        uv_idle_start(&idler, idle_cb);
+    if (NULL != p) {
+        *p = 0;
     }
-    time (&(g_ubxcli.starttime));
-    g_ubxcli.timeout = timeout;
+    return ubxfleet_hosts_add((ubloxfleet_hosts_t *)userdata, buf);
+}
 
-    uv_tcp_init(loop, &(g_ubxcli.uvtcp));
-    uv_tcp_keepalive(&(g_ubxcli.uvtcp), 1, 60);
+/*****************************************************************************/
+/**
+ * \brief run the commands on the devices
+ * \param devs: the devices, the results are stored in
+ * \param num_devs: the number of the devices
+ * \param max_active: the max number of the devices connected at the same time
+ * \param num_jobs: the number of the threads, each with its own loop, 0 - the number of CPUs
+ * \param timeout: the seconds of each device, 0 - wait forever
+ * \param fn_execute: the file of the commands, NULL - stdin
+ * \param window: the max number of the commands in flight of a device
+ * \param format: the format to print the received packets of a single device
+ *
+ * \return 0 on success, 1 if any of the devices failed, <0 on error
+ *
+ * The devices are split to the shards in order, the cap of the connections is
+ * split evenly. The result of each command of a single device is printed to
+ * stderr, the result of each device of more devices is printed to stdout
+ * after all of the shards are finished.
+ */
+int
+main_cli(ubloxfleet_dev_t * devs, size_t num_devs, size_t max_active, size_t num_jobs, time_t timeout, const char * fn_execute, size_t window, int format)
+{
+    ubloxfleet_t * shards;
+    uv_thread_t * threads;
+    ublox_cmdq_t script;
+    size_t num_shards;
+    size_t num_threads;
+    size_t num_fail;
+    size_t start;
+    size_t i;
+    int ret = 0;
 
-    uv_tcp_connect(&(g_ubxcli.connect), &(g_ubxcli.uvtcp), (const struct sockaddr*)&(g_ubxcli.addr_tcp), on_tcp_cli_connect);
+    ublox_cmdq_init(&script, window, 0, NULL, NULL);
+    if (0 > read_file_lines (fn_execute, (void *)&script, process_command_libuv)) {
+        ublox_cmdq_clear(&script);
+        return -1;
+    }
+    if (num_jobs < 1) {
+        long num_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+        num_jobs = (num_cpu > 0)?num_cpu:1;
+    }
+    num_shards = (num_jobs < num_devs)?num_jobs:num_devs;
+    if (num_shards < 1) {
+        num_shards = 1;
+    }
+    shards = calloc(num_shards, sizeof(ubloxfleet_t));
+    threads = calloc(num_shards, sizeof(uv_thread_t));
+    if ((NULL == shards) || (NULL == threads)) {
+        TE("out of memory\n");
+        free(shards);
+        free(threads);
+        ublox_cmdq_clear(&script);
+        return -1;
+    }
+    for (i = 0, start = 0; i < num_shards; i ++) {
+        shards[i].devs = devs + start;
+        shards[i].num_devs = num_devs * (i + 1) / num_shards - start;
+        start += shards[i].num_devs;
+        shards[i].max_active = (max_active + num_shards - 1) / num_shards;
+        shards[i].script = &script;
+        shards[i].window = window;
+        shards[i].timeout = timeout;
+        shards[i].format = (num_devs > 1)?-1:format;
+        shards[i].flg_single = (1 == num_devs);
+    }
 
-    ret = uv_run(loop, UV_RUN_DEFAULT);
-    // uv_signal_stop(&sigint);
+    if (num_shards > 1) {
+        // select the header search and the bit-field extraction before the threads, they're selected at the first use
+        ublox_pkt_sync_impl_select(UBLOX_SYNC_IMPL_AUTO);
+        ublox_bitfield_impl_select(UBLOX_BITFIELD_IMPL_AUTO);
+        for (num_threads = 0; num_threads < num_shards; num_threads ++) {
+            if (0 != uv_thread_create(&(threads[num_threads]), ubxfleet_shard, shards + num_threads)) {
+                TE("unable to create thread %" PRIuSZ "\n", num_threads);
+                break;
+            }
+        }
+        // run the rest of the shards in this thread
+        for (i = num_threads; i < num_shards; i ++) {
+            ubxfleet_shard(shards + i);
+        }
+        for (i = 0; i < num_threads; i ++) {
+            uv_thread_join(&(threads[i]));
+        }
+    } else {
+        shards[0].ret = ubxfleet_run(shards, uv_default_loop());
+    }
+    for (i = 0; i < num_shards; i ++) {
+        if (0 != shards[i].ret) {
+            ret = shards[i].ret;
+        }
+    }
+    free(threads);
+    free(shards);
+    ublox_cmdq_clear(&script);
     if (ret != 0) {
         return ret;
     }
-    if (flg_has_error) {
+    if (num_devs > 1) {
+        num_fail = ubxfleet_report(devs, num_devs, stdout);
+    } else {
+        num_fail = (UBLOX_DEV_OK == devs[0].status)?0:1;
+    }
+    if (num_fail > 0) {
         return 1;
     }
     return 0;
@@ -456,44 +1267,634 @@ process_command_stdout(off_t pos, char * buf, size_t size, void *userdata)
     return 0;
 }
 
-void
-decode_bin(FILE *fp)
+#define UBLOX_DECODE_SZ_STREAM (4 * UBLOX_PKT_LENGTH_MAX) /**< the size of the buffer to read the stream, >= UBLOX_PKT_LENGTH_MAX */
+#define UBLOX_DECODE_SZ_CHUNK (4 * 1024 * 1024) /**< the size of a chunk of file decoded by a thread */
+#define UBLOX_DECODE_COL_BLOCK (1024 * 1024) /**< the number of measurements in a block of columnar file */
+#define UBLOX_DECODE_SZ_RINEX (1024 * 1024) /**< the size of the buffer of RINEX writer */
+#define UBLOX_DECODE_SZ_OUTPUT (4 * 1024 * 1024) /**< the size of the buffer of the output, written by one write() */
+#define UBLOX_DECODE_RTCM_STA 10 /**< the number of epochs between the 1005 messages of the RTCM 3 output */
+
+/** the statistics of the decoder */
+typedef struct _ubloxdec_stat_t {
+    size_t sz_data;    /**< the total bytes decoded */
+    size_t num_frames; /**< the number of packets passed the checksum */
+    size_t num_bad;    /**< the number of frames with bad checksum */
+    size_t num_nmea;   /**< the number of NMEA sentences */
+    size_t num_rtcm3;  /**< the number of RTCM 3 frames */
+} ubloxdec_stat_t;
+
+/** the outputs of the raw measurements other than the text */
+typedef struct _ubloxdec_out_t {
+    ublox_rawx_col_t col; /**< the columnar store of RXM-RAWX, written to fp_col by blocks */
+    FILE * fp_col;        /**< the columnar file, can be NULL */
+    ublox_out_t * out;    /**< the output of the RTCM 3 frames */
+    ublox_rtcm_t rtcm;    /**< the decoder of the RTCM 3 MSMs appended to col */
+    ublox_rnx_t * rnx;    /**< the RINEX writer, can be NULL */
+    FILE * fp_rnx;        /**< the RINEX file */
+    ublox_rtcm_enc_t * enc; /**< the RTCM 3 encoder, can be NULL */
+    FILE * fp_rtcm;       /**< the RTCM 3 file */
+} ubloxdec_out_t;
+
+/**
+ * \brief write a frame generated by the RTCM 3 encoder
+ * \param userdata: the file
+ * \param buffer_in: the frame
+ * \param sz_in: the byte size of the frame
+ * \return 0 on success, <0 on error
+ */
+static int
+decode_rtcm3_writer(void * userdata, const uint8_t * buffer_in, size_t sz_in)
 {
-    uint8_t buffer1[200];
-    size_t sz_processed;
-    size_t sz_needed_in;
-    size_t sz_in;
-    ssize_t ret;
-    size_t sz_cur = 0;
-
-    sz_in = 0;
-    for(;;) {
-        ret = fread(buffer1 + sz_in, 1, sizeof(buffer1) - sz_in, fp);
-        if (ret > 0) {
-            sz_in += ret;
-            fprintf(stderr, "[ubloxconf] processed data size = %lu\n", sz_cur);
-        } else {
+    return (fwrite(buffer_in, 1, sz_in, (FILE *)userdata) == sz_in)?0:-1;
+}
+
+/**
+ * \brief the handler of RXM-RAWX to store the measurements to the columnar file, RINEX and RTCM 3
+ * \param userdata: ubloxdec_out_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ * \return 0 on success, <0 on error
+ */
+static int
+decode_rawx_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ubloxdec_out_t * dout = (ubloxdec_out_t *)userdata;
+    int ret = 0;
+
+    if (NULL != dout->rnx) {
+        ret = ublox_rnx_handler_rawx(dout->rnx, buffer_in, sz_in);
+    }
+    if ((NULL != dout->enc) && (ublox_rtcm_enc_handler(dout->enc, buffer_in, sz_in) < 0)) {
+        ret = -1;
+    }
+    if (NULL == dout->fp_col) {
+        return ret;
+    }
+    if (ublox_rawx_col_handler(&(dout->col), buffer_in, sz_in) < 0) {
+        ret = -1;
+    }
+    if (dout->col.num_meas >= UBLOX_DECODE_COL_BLOCK) {
+        if (ublox_rawx_col_save(&(dout->col), dout->fp_col) < 0) {
+            ret = -1;
+        }
+        ublox_rawx_col_reset(&(dout->col));
+    }
+    return ret;
+}
+
+/**
+ * \brief the handler of the RTCM 3 frames to output them and store the MSMs to the columnar file
+ * \param userdata: ubloxdec_out_t
+ * \param buffer_in: the frame
+ * \param sz_in: the byte size of the frame
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+decode_rtcm3_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ubloxdec_out_t * dout = (ubloxdec_out_t *)userdata;
+    int ret;
+
+    ret = ublox_out_rtcm3_handler(dout->out, buffer_in, sz_in);
+    if (NULL == dout->fp_col) {
+        return ret;
+    }
+    if (ublox_rtcm_add_frame(&(dout->rtcm), buffer_in, sz_in) < 0) {
+        ret = -1;
+    }
+    // keep the MSMs of an epoch in one block
+    if ((dout->col.num_meas >= UBLOX_DECODE_COL_BLOCK) && (! dout->rtcm.flg_more)) {
+        if (ublox_rawx_col_save(&(dout->col), dout->fp_col) < 0) {
+            ret = -1;
+        }
+        ublox_rawx_col_reset(&(dout->col));
+    }
+    return ret;
+}
+
+/**
+ * \brief decode all of the complete frames starting before sz_end in the buffer
+ * \param dmx: the demultiplexer with the handlers of the UBX, NMEA and RTCM 3 frames
+ * \param buffer_in: the buffer contains the frames
+ * \param sz_in: the byte size of the buffer
+ * \param sz_end: the frames start at or after this offset are not decoded
+ * \param flg_eof: 1 if the buffer is the end of the data, the incomplete frames are skipped
+ * \param stat: the statistics
+ * \return the offset of the tail which was not decoded
+ *
+ * The frames may end after sz_end, so the data after sz_end is also needed.
+ */
+size_t
+decode_buffer(ublox_demux_t * dmx, const uint8_t * buffer_in, size_t sz_in, size_t sz_end, int flg_eof, ubloxdec_stat_t * stat)
+{
+    ublox_demux_t prev = *dmx;
+    size_t pos;
+    size_t i;
+
+    pos = ublox_demux_process(dmx, buffer_in, sz_in, sz_end);
+    if (flg_eof && (pos < sz_end)) {
+        pos += ublox_demux_finish(dmx, buffer_in + pos, sz_in - pos);
+    }
+    stat->num_frames += dmx->num_frames[UBLOX_PROTO_UBX] - prev.num_frames[UBLOX_PROTO_UBX];
+    stat->num_nmea += dmx->num_frames[UBLOX_PROTO_NMEA] - prev.num_frames[UBLOX_PROTO_NMEA];
+    stat->num_rtcm3 += dmx->num_frames[UBLOX_PROTO_RTCM3] - prev.num_frames[UBLOX_PROTO_RTCM3];
+    for (i = 0; i < UBLOX_PROTO_NUM; i ++) {
+        stat->num_bad += dmx->num_bad[i] - prev.num_bad[i];
+    }
+    return pos;
+}
+
+/** a chunk of the file decoded by a thread */
+typedef struct _ubloxdec_chunk_t {
+    ublox_out_t out;      /**< the output of the chunk, kept in the memory */
+    ublox_rawx_col_t col; /**< the RXM-RAWX of the chunk */
+    ublox_rtcm_t rtcm;    /**< the decoder of the RTCM 3 MSMs appended to col */
+    ubloxdec_stat_t stat; /**< the statistics of the chunk */
+    int flg_done;         /**< 1 if the chunk is decoded */
+    int ret;              /**< the return value of decode_chunk() */
+} ubloxdec_chunk_t;
+
+/** the thread pool to decode the chunks of a file */
+typedef struct _ubloxdec_pool_t {
+    const uint8_t * buffer; /**< the mapped file */
+    size_t sz_file;         /**< the size of the file */
+    FILE * fp_col;          /**< the columnar file of RXM-RAWX, can be NULL */
+    int format;             /**< the format of the output, UBLOX_OUT_xxx */
+    ubloxdec_chunk_t * chunks;
+    size_t num_chunks;
+    size_t idx_next;        /**< the next chunk to be decoded */
+    size_t idx_written;     /**< the number of chunks written out */
+    size_t num_window;      /**< the max number of chunks decoded but not written */
+    uv_mutex_t mutex;
+    uv_cond_t cond_done;    /**< signaled when a chunk is decoded */
+    uv_cond_t cond_free;    /**< signaled when a chunk is written */
+} ubloxdec_pool_t;
+
+/**
+ * \brief get the start offset of a chunk
+ * \param pool: the thread pool
+ * \param idx: the index of the chunk
+ * \return the offset of the first verified packet after the nominal start of the chunk
+ *
+ * The offset is resynchronized on a packet with the correct checksum, it is
+ * clamped to the nominal start of the next chunk if no packet is found.
+ */
+static size_t
+decode_chunk_start(ubloxdec_pool_t * pool, size_t idx)
+{
+    size_t pos;
+    size_t sz_scan;
+    size_t off;
+
+    if (idx < 1) {
+        return 0;
+    }
+    if (idx >= pool->num_chunks) {
+        return pool->sz_file;
+    }
+    pos = idx * UBLOX_DECODE_SZ_CHUNK;
+    sz_scan = pool->sz_file - pos;
+    if (sz_scan > UBLOX_DECODE_SZ_CHUNK + UBLOX_PKT_LENGTH_MAX) {
+        sz_scan = UBLOX_DECODE_SZ_CHUNK + UBLOX_PKT_LENGTH_MAX;
+    }
+    off = ublox_pkt_find_verified(pool->buffer + pos, sz_scan);
+    if (off > UBLOX_DECODE_SZ_CHUNK) {
+        off = UBLOX_DECODE_SZ_CHUNK;
+    }
+    if (pos + off > pool->sz_file) {
+        return pool->sz_file;
+    }
+    return pos + off;
+}
+
+/**
+ * \brief the handler of the RTCM 3 frames of a chunk, see decode_rtcm3_handler()
+ * \param userdata: ubloxdec_chunk_t
+ * \param buffer_in: the frame
+ * \param sz_in: the byte size of the frame
+ * \return 0 on success, <0 on error
+ */
+static int
+decode_chunk_rtcm3_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ubloxdec_chunk_t * chunk = (ubloxdec_chunk_t *)userdata;
+    int ret;
+
+    ret = ublox_out_rtcm3_handler(&(chunk->out), buffer_in, sz_in);
+    if (ublox_rtcm_add_frame(&(chunk->rtcm), buffer_in, sz_in) < 0) {
+        ret = -1;
+    }
+    return ret;
+}
+
+/**
+ * \brief decode a chunk to its memory buffer
+ * \param pool: the thread pool
+ * \param idx: the index of the chunk
+ * \return 0 on success, <0 on error
+ */
+static int
+decode_chunk(ubloxdec_pool_t * pool, size_t idx)
+{
+    ubloxdec_chunk_t * chunk = &(pool->chunks[idx]);
+    ublox_registry_t registry;
+    ublox_demux_t dmx;
+    size_t pos_start;
+    size_t pos_end;
+
+    pos_start = decode_chunk_start(pool, idx);
+    pos_end = decode_chunk_start(pool, idx + 1);
+    if (ublox_out_init(&(chunk->out), -1, pool->format, NULL, UBLOX_DECODE_SZ_CHUNK) < 0) {
+        TE("out of memory\n");
+        return -1;
+    }
+    ublox_registry_init(&registry);
+    ublox_rawx_col_init(&(chunk->col));
+    if ((ublox_registry_add_writer(&registry, &(chunk->out)) < 0)
+        || ((NULL != pool->fp_col) && (ublox_registry_set(&registry, UBX_RXM_RAWX, ublox_rawx_col_handler, &(chunk->col)) < 0))) {
+        TE("unable to register the handlers\n");
+        ublox_registry_clear(&registry);
+        return -1;
+    }
+    ublox_demux_init(&dmx);
+    ublox_demux_add_writer(&dmx, &registry, &(chunk->out));
+    if (NULL != pool->fp_col) {
+        // the GLONASS channels and the epochs split by the chunks are decoded independently
+        ublox_rtcm_init(&(chunk->rtcm), &(chunk->col));
+        ublox_demux_set(&dmx, UBLOX_PROTO_RTCM3, decode_chunk_rtcm3_handler, chunk);
+    }
+    if (pos_end > pos_start) {
+        decode_buffer(&dmx, pool->buffer + pos_start, pool->sz_file - pos_start, pos_end - pos_start, (pos_end >= pool->sz_file), &(chunk->stat));
+    }
+    ublox_registry_clear(&registry);
+    return 0;
+}
+
+static void
+decode_worker(void * arg)
+{
+    ubloxdec_pool_t * pool = (ubloxdec_pool_t *)arg;
+    size_t idx;
+    int ret;
+
+    for (;;) {
+        uv_mutex_lock(&(pool->mutex));
+        while ((pool->idx_next < pool->num_chunks) && (pool->idx_next >= pool->idx_written + pool->num_window)) {
+            uv_cond_wait(&(pool->cond_free), &(pool->mutex));
+        }
+        if (pool->idx_next >= pool->num_chunks) {
+            uv_mutex_unlock(&(pool->mutex));
             break;
         }
-        while (sz_in > 0) {
-            sz_processed = 0;
-            sz_needed_in = 0;
-            ublox_cli_verify_tcp(buffer1, ret, &sz_processed, &sz_needed_in);
-            if (sz_processed > 0) {
-                if (sz_in > sz_processed) {
-                    sz_in -= sz_processed;
-                    sz_cur += sz_processed;
-                    memmove(buffer1, buffer1 + sz_processed, sz_in);
-                } else {
-                    sz_in = 0;
-                }
-            }
-            if (sz_needed_in > 0) {
-                break;
+        idx = pool->idx_next ++;
+        uv_mutex_unlock(&(pool->mutex));
+
+        ret = decode_chunk(pool, idx);
+
+        uv_mutex_lock(&(pool->mutex));
+        pool->chunks[idx].ret = ret;
+        pool->chunks[idx].flg_done = 1;
+        uv_cond_broadcast(&(pool->cond_done));
+        uv_mutex_unlock(&(pool->mutex));
+    }
+}
+
+/**
+ * \brief decode the mapped file by a pool of threads
+ * \param buffer: the mapped file
+ * \param sz_file: the size of the file
+ * \param num_jobs: the number of threads
+ * \param fp_col: the columnar file of RXM-RAWX, NULL to print RXM-RAWX
+ * \param out: the writer of the output
+ * \param stat: the statistics
+ * \return 0 on success, <0 on error
+ *
+ * The file is split to chunks of UBLOX_DECODE_SZ_CHUNK, each chunk starts at
+ * a packet with the correct checksum and is decoded to a memory buffer.
+ * The output of the chunks is written to the writer in the order of the file.
+ */
+int
+decode_bin_parallel(const uint8_t * buffer, size_t sz_file, size_t num_jobs, FILE * fp_col, ublox_out_t * out, ubloxdec_stat_t * stat)
+{
+    ubloxdec_pool_t pool;
+    uv_thread_t * threads;
+    size_t num_threads = 0;
+    size_t i;
+    int ret = 0;
+
+    memset(&pool, 0, sizeof(pool));
+    pool.buffer = buffer;
+    pool.sz_file = sz_file;
+    pool.fp_col = fp_col;
+    pool.format = out->format;
+    pool.num_chunks = (sz_file + UBLOX_DECODE_SZ_CHUNK - 1) / UBLOX_DECODE_SZ_CHUNK;
+    pool.num_window = 2 * num_jobs;
+    pool.chunks = calloc(pool.num_chunks, sizeof(ubloxdec_chunk_t));
+    threads = calloc(num_jobs, sizeof(uv_thread_t));
+    if ((NULL == pool.chunks) || (NULL == threads)) {
+        TE("out of memory\n");
+        free(pool.chunks);
+        free(threads);
+        return -1;
+    }
+    uv_mutex_init(&(pool.mutex));
+    uv_cond_init(&(pool.cond_done));
+    uv_cond_init(&(pool.cond_free));
+    // the decoders of the threads share the implementations selected at the first use
+    ublox_pkt_sync_impl_select(UBLOX_SYNC_IMPL_AUTO);
+    ublox_bitfield_impl_select(UBLOX_BITFIELD_IMPL_AUTO);
+    for (num_threads = 0; num_threads < num_jobs; num_threads ++) {
+        if (0 != uv_thread_create(&(threads[num_threads]), decode_worker, &pool)) {
+            TE("unable to create thread %" PRIuSZ "\n", num_threads);
+            break;
+        }
+    }
+    if (num_threads < 1) {
+        // decode in this thread
+        pool.num_window = pool.num_chunks;
+        decode_worker(&pool);
+    }
+
+    // merge the output in the order of chunks
+    for (i = 0; i < pool.num_chunks; i ++) {
+        uv_mutex_lock(&(pool.mutex));
+        while (! pool.chunks[i].flg_done) {
+            uv_cond_wait(&(pool.cond_done), &(pool.mutex));
+        }
+        uv_mutex_unlock(&(pool.mutex));
+
+        if (pool.chunks[i].ret < 0) {
+            ret = -1;
+        }
+        if ((pool.chunks[i].out.sz_data > 0) && (ublox_out_write(out, pool.chunks[i].out.buf, pool.chunks[i].out.sz_data) < 0)) {
+            ret = -1;
+        }
+        ublox_out_clear(&(pool.chunks[i].out));
+        if ((NULL != fp_col) && (pool.chunks[i].col.num_epoch > 0) && (ublox_rawx_col_save(&(pool.chunks[i].col), fp_col) < 0)) {
+            ret = -1;
+        }
+        ublox_rawx_col_clear(&(pool.chunks[i].col));
+        stat->num_frames += pool.chunks[i].stat.num_frames;
+        stat->num_bad += pool.chunks[i].stat.num_bad;
+        stat->num_nmea += pool.chunks[i].stat.num_nmea;
+        stat->num_rtcm3 += pool.chunks[i].stat.num_rtcm3;
+
+        uv_mutex_lock(&(pool.mutex));
+        pool.idx_written ++;
+        uv_cond_broadcast(&(pool.cond_free));
+        uv_mutex_unlock(&(pool.mutex));
+    }
+    for (i = 0; i < num_threads; i ++) {
+        uv_thread_join(&(threads[i]));
+    }
+    stat->sz_data += sz_file;
+
+    uv_cond_destroy(&(pool.cond_free));
+    uv_cond_destroy(&(pool.cond_done));
+    uv_mutex_destroy(&(pool.mutex));
+    free(threads);
+    free(pool.chunks);
+    return ret;
+}
+
+/**
+ * \brief decode the file mapped to the memory
+ * \param dmx: the demultiplexer with the handlers of the frames
+ * \param fd: the file descriptor
+ * \param sz_file: the size of the file
+ * \param num_jobs: the number of threads
+ * \param fp_col: the columnar file of RXM-RAWX, NULL to print RXM-RAWX
+ * \param out: the writer of the output, the same one registered in reg
+ * \param stat: the statistics
+ * \return 0 on success, <0 on error
+ */
+int
+decode_bin_mmap(ublox_demux_t * dmx, int fd, size_t sz_file, size_t num_jobs, FILE * fp_col, ublox_out_t * out, ubloxdec_stat_t * stat)
+{
+    uint8_t * buffer;
+    int ret = 0;
+
+    buffer = mmap(NULL, sz_file, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == buffer) {
+        TE("mmap error: %s\n", strerror(errno));
+        return -1;
+    }
+    // the advices are the values instead of the bits, one call for each
+    madvise(buffer, sz_file, MADV_SEQUENTIAL);
+    madvise(buffer, sz_file, MADV_WILLNEED);
+    if ((num_jobs > 1) && (sz_file > UBLOX_DECODE_SZ_CHUNK)) {
+        ret = decode_bin_parallel(buffer, sz_file, num_jobs, fp_col, out, stat);
+    } else {
+        decode_buffer(dmx, buffer, sz_file, sz_file, 1, stat);
+        stat->sz_data += sz_file;
+    }
+    munmap(buffer, sz_file);
+    return ret;
+}
+
+/**
+ * \brief decode the data read from a stream, such as stdin or a pipe
+ * \param dmx: the demultiplexer with the handlers of the frames
+ * \param fd: the file descriptor
+ * \param stat: the statistics
+ * \return 0 on success, <0 on error
+ */
+int
+decode_bin_stream(ublox_demux_t * dmx, int fd, ubloxdec_stat_t * stat)
+{
+    uint8_t * buffer;
+    size_t sz_in = 0;
+    size_t pos;
+    ssize_t ret;
+
+    buffer = malloc(UBLOX_DECODE_SZ_STREAM);
+    if (NULL == buffer) {
+        TE("out of memory\n");
+        return -1;
+    }
+    for (;;) {
+        ret = read(fd, buffer + sz_in, UBLOX_DECODE_SZ_STREAM - sz_in);
+        if (ret < 0) {
+            if (EINTR == errno) {
+                continue;
             }
+            TE("read error: %s\n", strerror(errno));
+            break;
+        }
+        if (ret == 0) {
+            break;
+        }
+        sz_in += ret;
+        stat->sz_data += ret;
+        pos = decode_buffer(dmx, buffer, sz_in, sz_in, 0, stat);
+        assert (pos <= sz_in);
+        sz_in -= pos;
+        if ((pos > 0) && (sz_in > 0)) {
+            memmove(buffer, buffer + pos, sz_in);
+        }
+    }
+    if ((0 == ret) && (sz_in > 0)) {
+        decode_buffer(dmx, buffer, sz_in, sz_in, 1, stat);
+    }
+    free(buffer);
+    return (ret < 0)?-1:0;
+}
+
+/**
+ * \brief decode the binary packets in the file
+ * \param fn_decode: the file name, "-" for stdin
+ * \param num_jobs: the number of threads to decode a regular file, 0 - the number of CPUs
+ * \param fn_col: the columnar file to store RXM-RAWX, NULL to print RXM-RAWX
+ * \param fn_rnx: the RINEX observation file of RXM-RAWX and RXM-RAW, NULL to print them
+ * \param fn_rtcm: the RTCM 3 file of MSM7 generated from RXM-RAWX, can be NULL
+ * \param pos_sta: the ECEF position of the base station (m) for 1005, NULL to skip 1005
+ * \param format: the format of the output to stdout, UBLOX_OUT_xxx
+ * \return 0 on success, <0 on error
+ *
+ * A regular file is mapped to the memory, other files are read as a stream.
+ */
+int
+decode_bin(const char * fn_decode, size_t num_jobs, const char * fn_col, const char * fn_rnx, const char * fn_rtcm, const double * pos_sta, int format)
+{
+    ublox_registry_t registry;
+    ublox_demux_t dmx;
+    ublox_out_t out;
+    ubloxdec_out_t dout;
+    ubloxdec_stat_t stat;
+    struct stat st;
+    struct timespec ts_start;
+    struct timespec ts_end;
+    char * buf_rnx = NULL;
+    double tm_used;
+    int fd = STDIN_FILENO;
+    int ret = -1;
+
+    memset(&dout, 0, sizeof(dout));
+    ublox_rawx_col_init(&(dout.col));
+    ublox_registry_init(&registry);
+    if (ublox_out_init(&out, STDOUT_FILENO, format, NULL, UBLOX_DECODE_SZ_OUTPUT) < 0) {
+        TE("out of memory\n");
+        return -1;
+    }
+    if (0 != strcmp("-", fn_decode)) {
+        fd = open(fn_decode, O_RDONLY);
+        if (fd < 0) {
+            TE("open file '%s' error: %s\n", fn_decode, strerror(errno));
+            ublox_out_clear(&out);
+            return -1;
+        }
+    }
+    if (NULL != fn_col) {
+        dout.fp_col = fopen(fn_col, "wb");
+        if (NULL == dout.fp_col) {
+            TE("open file '%s' error: %s\n", fn_col, strerror(errno));
+            goto end_decode;
+        }
+    }
+    if (NULL != fn_rnx) {
+        dout.fp_rnx = fopen(fn_rnx, "wb");
+        if (NULL == dout.fp_rnx) {
+            TE("open file '%s' error: %s\n", fn_rnx, strerror(errno));
+            goto end_decode;
+        }
+        dout.rnx = malloc(sizeof(ublox_rnx_t));
+        buf_rnx = malloc(UBLOX_DECODE_SZ_RINEX);
+        if ((NULL == dout.rnx) || (NULL == buf_rnx)) {
+            TE("out of memory\n");
+            goto end_decode;
         }
+        ublox_rnx_init(dout.rnx, dout.fp_rnx, buf_rnx, UBLOX_DECODE_SZ_RINEX);
+        if (num_jobs != 1) {
+            // the epochs of RINEX depend on the previous epochs
+            TW("RINEX output is written by one thread\n");
+            num_jobs = 1;
+        }
+    }
+    if (NULL != fn_rtcm) {
+        dout.fp_rtcm = fopen(fn_rtcm, "wb");
+        if (NULL == dout.fp_rtcm) {
+            TE("open file '%s' error: %s\n", fn_rtcm, strerror(errno));
+            goto end_decode;
+        }
+        dout.enc = malloc(sizeof(ublox_rtcm_enc_t));
+        if (NULL == dout.enc) {
+            TE("out of memory\n");
+            goto end_decode;
+        }
+        ublox_rtcm_enc_init(dout.enc, 0, 7, decode_rtcm3_writer, dout.fp_rtcm);
+        if (NULL != pos_sta) {
+            ublox_rtcm_enc_set_sta(dout.enc, pos_sta);
+            dout.enc->interval_sta = UBLOX_DECODE_RTCM_STA;
+        }
+        if (num_jobs != 1) {
+            // the frames are written in the order of the epochs
+            TW("RTCM 3 output is written by one thread\n");
+            num_jobs = 1;
+        }
+    }
+    if ((ublox_registry_add_writer(&registry, &out) < 0)
+        || (ublox_out_header(&out) < 0)
+        || (((NULL != dout.fp_col) || (NULL != dout.rnx) || (NULL != dout.enc)) && (ublox_registry_set(&registry, UBX_RXM_RAWX, decode_rawx_handler, &dout) < 0))
+        || ((NULL != dout.rnx) && (ublox_registry_set(&registry, UBX_RXM_RAW, ublox_rnx_handler_raw, dout.rnx) < 0))) {
+        TE("unable to register the handlers\n");
+        goto end_decode;
+    }
+    ublox_demux_init(&dmx);
+    ublox_demux_add_writer(&dmx, &registry, &out);
+    if (NULL != dout.fp_col) {
+        dout.out = &out;
+        ublox_rtcm_init(&(dout.rtcm), &(dout.col));
+        ublox_demux_set(&dmx, UBLOX_PROTO_RTCM3, decode_rtcm3_handler, &dout);
     }
-    fprintf(stderr, "[ubloxconf] processed data size = %lu\n", sz_cur);
+    if (num_jobs < 1) {
+        long num_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+        num_jobs = (num_cpu > 0)?num_cpu:1;
+    }
+    memset(&stat, 0, sizeof(stat));
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+    if ((0 == fstat(fd, &st)) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+        ret = decode_bin_mmap(&dmx, fd, st.st_size, num_jobs, dout.fp_col, &out, &stat);
+    } else {
+        ret = decode_bin_stream(&dmx, fd, &stat);
+    }
+    if ((NULL != dout.fp_col) && (dout.col.num_epoch > 0) && (ublox_rawx_col_save(&(dout.col), dout.fp_col) < 0)) {
+        ret = -1;
+    }
+    if ((NULL != dout.rnx) && (ublox_rnx_flush(dout.rnx) < 0)) {
+        ret = -1;
+    }
+    if (ublox_out_flush(&out) < 0) {
+        ret = -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    tm_used = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+    fprintf(stderr, "[ubloxconf] processed data size = %" PRIuSZ ", packets = %" PRIuSZ ", nmea = %" PRIuSZ ", rtcm3 = %" PRIuSZ ", bad checksum = %" PRIuSZ ", time = %.3f s, %.1f MB/s\n",
+        stat.sz_data, stat.num_frames, stat.num_nmea, stat.num_rtcm3, stat.num_bad, tm_used, (tm_used > 0)?(stat.sz_data / tm_used / 1e6):0.0);
+
+end_decode:
+    ublox_registry_clear(&registry);
+    ublox_out_clear(&out);
+    if (NULL != dout.fp_col) {
+        fclose(dout.fp_col);
+    }
+    ublox_rawx_col_clear(&(dout.col));
+    if (NULL != dout.fp_rnx) {
+        fclose(dout.fp_rnx);
+    }
+    free(dout.rnx);
+    free(buf_rnx);
+    if (NULL != dout.enc) {
+        ublox_rtcm_enc_clear(dout.enc);
+        free(dout.enc);
+    }
+    if (NULL != dout.fp_rtcm) {
+        fclose(dout.fp_rtcm);
+    }
+    if (STDIN_FILENO != fd) {
+        close(fd);
+    }
+    return ret;
 }
 
 /*****************************************************************************/
@@ -512,13 +1913,23 @@ void
 help (char *progname)
 {
     fprintf (stderr, "Usage: \n"
-        "\t%s [-hv] [-r <host>[:port]] [commands...]\n"
+        "\t%s [-hv] [-r <host>[:port]] [-s <tty>[:baud]] [-l <host file>] [commands...]\n"
         , basename(progname));
     fprintf (stderr, "\nOptions:\n");
-    fprintf (stderr, "\t-r\tRemote host and port\n");
+    fprintf (stderr, "\t-r\tRemote host and port, more hosts separated by ',' or by more -r\n");
+    fprintf (stderr, "\t-s <tty>[:baud]\tThe serial port and the baud rate, default %d, more ports separated by ',' or by more -s\n", UBLOX_TTY_BAUD_DEFAULT);
+    fprintf (stderr, "\t-l <host file>\tThe remote hosts, one host[:port] or /dev/tty[:baud] per line, for the fleet mode\n");
+    fprintf (stderr, "\t-n <num>\tThe number of the hosts connected at the same time, default %d\n", UBLOX_FLEET_CONCURRENCY);
     fprintf (stderr, "\t-e <cmd file>\tExecute/encode the text command lines in the file\n");
     fprintf (stderr, "\t-d <cmd file>\tDecode the binary packet from file or stdin\n");
-    fprintf (stderr, "\t-t <timeout>\tThe seconds before quit, 0 - wait forever, default 30\n");
+    fprintf (stderr, "\t-c <file>\tStore RXM-RAWX to the columnar file instead of printing it\n");
+    fprintf (stderr, "\t-x <file>\tWrite RXM-RAWX and RXM-RAW to the RINEX 3 observation file instead of printing them\n");
+    fprintf (stderr, "\t-m <file>\tWrite RTCM 3 MSM7 generated from RXM-RAWX to the file\n");
+    fprintf (stderr, "\t-p <x,y,z>\tThe ECEF position (m) of the base station sent by RTCM 3 1005 with -m\n");
+    fprintf (stderr, "\t-f <format>\tThe format of the decoded packets: text, jsonl, csv or bin, default text\n");
+    fprintf (stderr, "\t-j <jobs>\tThe number of threads to decode a file, or the event loops of the hosts, 0 - the number of CPUs, default 1\n");
+    fprintf (stderr, "\t-t <timeout>\tThe seconds of each host before quit, 0 - wait forever and keep the hosts until SIGINT, default 30\n");
+    fprintf (stderr, "\t-w <window>\tThe number of the commands of -e in flight with -r or -s, 1 - wait for the responses of each command, default %d\n", UBLOX_CLI_WINDOW);
 
     fprintf (stderr, "\t-h\tPrint this message.\n");
     fprintf (stderr, "\t-v\tVerbose information.\n");
@@ -527,7 +1938,11 @@ help (char *progname)
         "\t\t%s -r localhost:23\n\n"
         "\t2. connect and execute command\n"
         "\t\t%s -r localhost:23 reset\n\n"
-        , basename(progname), basename(progname));
+        "\t3. execute the commands on the hosts of a file, 100 hosts at the same time, and print the summary\n"
+        "\t\t%s -l hosts.txt -n 100 -e cmds.txt\n\n"
+        "\t4. execute the commands on the receiver of the USB serial port\n"
+        "\t\t%s -s /dev/ttyACM0:115200 -e cmds.txt\n\n"
+        , basename(progname), basename(progname), basename(progname), basename(progname));
 }
 
 void
@@ -540,49 +1955,77 @@ usage (char *progname)
 int
 main (int argc, char **argv)
 {
-    const char host[200] = "";
-    int port = UBLOX_PORT_DEFAULT;
+    ubloxfleet_hosts_t hosts;
+    const char * fn_hosts = NULL;
+    size_t max_active = UBLOX_FLEET_CONCURRENCY;
+    size_t i;
+    int ret;
     const char * fn_execute = NULL;
-    FILE * fp_bin = stdin;
+    const char * fn_decode = "-";
+    size_t num_jobs = 1;
+    const char * fn_col = NULL;
+    const char * fn_rnx = NULL;
+    const char * fn_rtcm = NULL;
+    double pos_sta[3];
+    int flg_pos = 0;
     time_t timeout = 30;
+    size_t window = UBLOX_CLI_WINDOW;
+    int format = UBLOX_OUT_TEXT;
 
     int c;
     struct option longopts[]  = {
         { "remote",       1, 0, 'r' },
+        { "serial",       1, 0, 's' },
         { "execute",      1, 0, 'e' },
         { "decode",       1, 0, 'd' },
         { "timeout",      1, 0, 't' },
+        { "jobs",         1, 0, 'j' },
+        { "columnar",     1, 0, 'c' },
+        { "rinex",        1, 0, 'x' },
+        { "msm",          1, 0, 'm' },
+        { "position",     1, 0, 'p' },
+        { "format",       1, 0, 'f' },
+        { "window",       1, 0, 'w' },
+        { "hosts",        1, 0, 'l' },
+        { "concurrency",  1, 0, 'n' },
 
         { "help",         0, 0, 'h' },
         { "verbose",      0, 0, 'v' },
         { 0,              0, 0,  0  },
     };
 
-    while ((c = getopt_long( argc, argv, "r:e:d:t:vh", longopts, NULL )) != EOF) {
+    memset(&hosts, 0, sizeof(hosts));
+    hosts.port = UBLOX_PORT_DEFAULT;
+    while ((c = getopt_long( argc, argv, "r:s:l:n:e:d:t:j:c:x:m:p:f:w:vh", longopts, NULL )) != EOF) {
         switch (c) {
         case 'r':
-        {
-            char *p;
-            strncpy(host, optarg, sizeof(host)-1);
-            p = strchr(host, ':');
-            if (0 != p) {
-                *p = 0;
-                p ++;
-                port = atoi(p);
+            if (ubxfleet_hosts_add(&hosts, optarg) < 0) {
+                exit (-1);
+            }
+            break;
+
+        case 's':
+            hosts.flg_tty = 1;
+            ret = ubxfleet_hosts_add(&hosts, optarg);
+            hosts.flg_tty = 0;
+            if (ret < 0) {
+                exit (-1);
             }
-        }
+            break;
+
+        case 'l':
+            if (strlen (optarg) > 0) {
+                fn_hosts = optarg;
+            }
+            break;
+
+        case 'n':
+            max_active = (atoi(optarg) > 0)?atoi(optarg):1;
             break;
 
         case 'd':
             if (strlen (optarg) > 0) {
-                if (stdin != fp_bin) {
-                    fclose(fp_bin);
-                }
-                if (0 == strcmp("-", optarg)) {
-                    fp_bin = stdin;
-                } else {
-                    fp_bin = fopen(optarg, "rb");
-                }
+                fn_decode = optarg;
             }
             break;
 
@@ -596,6 +2039,48 @@ main (int argc, char **argv)
             timeout = atoi(optarg);
             break;
 
+        case 'c':
+            if (strlen (optarg) > 0) {
+                fn_col = optarg;
+            }
+            break;
+
+        case 'x':
+            if (strlen (optarg) > 0) {
+                fn_rnx = optarg;
+            }
+            break;
+
+        case 'm':
+            if (strlen (optarg) > 0) {
+                fn_rtcm = optarg;
+            }
+            break;
+
+        case 'p':
+            if (3 != sscanf(optarg, "%lf,%lf,%lf", pos_sta, pos_sta + 1, pos_sta + 2)) {
+                fprintf (stderr, "Unknown position: '%s'.\n", optarg);
+                exit (-1);
+            }
+            flg_pos = 1;
+            break;
+
+        case 'f':
+            format = ublox_out_cstr2format(optarg);
+            if (format < 0) {
+                fprintf (stderr, "Unknown format: '%s'.\n", optarg);
+                exit (-1);
+            }
+            break;
+
+        case 'j':
+            num_jobs = (atoi(optarg) > 0)?atoi(optarg):0;
+            break;
+
+        case 'w':
+            window = (atoi(optarg) > 0)?atoi(optarg):1;
+            break;
+
         case 'h':
             usage (argv[0]);
             exit (0);
@@ -611,18 +2096,23 @@ main (int argc, char **argv)
         }
     }
 
-    if (strlen(host) < 1) {
+    if ((NULL != fn_hosts) && (0 > read_file_lines (fn_hosts, (void *)&hosts, process_host_line))) {
+        return 1;
+    }
+    if (hosts.num_devs < 1) {
         if (fn_execute) {
             // parse the execute file
             read_file_lines (fn_execute, (void *)stdout, process_command_stdout);
-        } else if (fp_bin) {
-            decode_bin(fp_bin);
-        }
-        if (stdin != fp_bin) {
-            fclose(fp_bin);
+        } else if (decode_bin(fn_decode, num_jobs, fn_col, fn_rnx, fn_rtcm, flg_pos?pos_sta:NULL, format) < 0) {
+            return 1;
         }
         return 0;
     }
-    return main_cli(host, port, timeout, fn_execute);
+    ret = main_cli(hosts.devs, hosts.num_devs, max_active, num_jobs, timeout, fn_execute, window, format);
+    for (i = 0; i < hosts.num_devs; i ++) {
+        free(hosts.devs[i].host);
+    }
+    free(hosts.devs);
+    return ret;
 }
 #endif /* CIUT_ENABLED */
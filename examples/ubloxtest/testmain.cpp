@@ -15,6 +15,7 @@
 
 #include "ubloxconn.h"
 #include "ubloxcstr.h"
+#include "ubloxring.h"
 
 #if DEBUG
 #include "hexdump.h"
@@ -350,48 +351,53 @@ void setup_gps()
   uart_gps.write(buffer, sz_buf);
 }
 
-uint8_t g_buffer_gps[1200];
-size_t sz_buf_gps = 0;
+#define GPS_RING_SIZE 1024 // power of 2
+uint8_t g_buffer_gps[GPS_RING_SIZE];
+uint8_t g_buffer_gps_linear[GPS_RING_SIZE];
+ublox_ring_t g_ring_gps;
 void loop_gps()
 {
   int ret;
+  uint8_t * p;
+  uint8_t * p_frame;
+  size_t sz_frame;
+  size_t sz_space = 0;
+  size_t cnt;
   size_t sz_processed = 0;
   size_t sz_needed_in = 0;
-  while (uart_gps.available() && sz_buf_gps < sizeof(g_buffer_gps)) {
-    g_buffer_gps[sz_buf_gps] = uart_gps.read();
-    sz_buf_gps ++;
+
+  if (NULL == g_ring_gps.buffer) {
+    ublox_ring_init(&g_ring_gps, g_buffer_gps, sizeof(g_buffer_gps), g_buffer_gps_linear, sizeof(g_buffer_gps_linear));
+  }
+  // read to the ring directly
+  p = ublox_ring_write_ptr(&g_ring_gps, &sz_space);
+  for (cnt = 0; (cnt < sz_space) && uart_gps.available(); ) {
+    p[cnt] = uart_gps.read();
+    cnt ++;
     //Serial.print('.');
-    assert (sz_buf_gps <= sizeof(g_buffer_gps));
-    if (sz_buf_gps % 11 == 0) {
+    if (cnt % 11 == 0) {
       // to break the loop for 'Interrupt wdt timeout on CPU1'
       break;
     }
   }
-  if (sz_buf_gps < 1) {
+  ublox_ring_commit(&g_ring_gps, cnt);
+  if (ublox_ring_size(&g_ring_gps) < 1) {
     return;
   }
-  ret = ublox_process_buffer_data(g_buffer_gps, sz_buf_gps, &sz_processed, &sz_needed_in);
-  if (sz_processed > 0) {
-    TI("current buffer:");
-    hex_dump_to_fp(stderr, g_buffer_gps, sz_buf_gps);
-    TD("buffer advanced %d", sz_processed);
-    if (sz_buf_gps > sz_processed) {
-      memmove(g_buffer_gps, g_buffer_gps + sz_processed, sz_buf_gps - sz_processed);
-      sz_buf_gps -= sz_processed;
-    } else {
-      sz_buf_gps = 0;
-    }
-  }
-  if (sz_needed_in + sz_buf_gps > sizeof(g_buffer_gps)) {
-    TI("current buffer:");
-    hex_dump_to_fp(stderr, g_buffer_gps, sz_buf_gps);
-    TW("ignore the current since no enough buffer, szbuf=%d+needed=%d > sz_g_buf=%d", sz_buf_gps, sz_needed_in, sizeof(g_buffer_gps));
-    memmove(g_buffer_gps, g_buffer_gps + 1, sz_buf_gps - 1);
-    sz_buf_gps --;
+  ret = ublox_ring_peek_frame(&g_ring_gps, &p_frame, &sz_frame, &sz_needed_in);
+  if (ret == 2) {
+    TW("ignore the current since no enough buffer or checksum error, sz_ring=%d", sizeof(g_buffer_gps));
+    return;
   }
   if (ret != 0) {
     return;
   }
+  ret = ublox_cli_verify_tcp(p_frame, sz_frame, &sz_processed, &sz_needed_in);
+  if ((sz_processed < 1) || (sz_needed_in > 0)) {
+    sz_processed = 1;
+  }
+  TD("buffer advanced %d", sz_processed);
+  ublox_ring_consume(&g_ring_gps, sz_processed);
 }
 
 #else
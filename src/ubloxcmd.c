@@ -0,0 +1,637 @@
+/**
+ * \file    ubloxcmd.c
+ * \brief   The pipelined command queue with the correlation of ACK/NAK and the poll replies
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The receiver handles the commands in order, so a window of commands can be
+ * in flight and the responses are matched in order per class/id. A window of
+ * 1 is the stop-and-wait of the commands which reset the port.
+ */
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxcmd.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/**
+ * \brief setup the queue
+ * \param q: the queue
+ * \param window: the max number of the commands in flight, at least 1
+ * \param timeout: the time to wait for the responses of a command (ms), 0 to wait forever
+ * \param send: the function to send a packet
+ * \param userdata: the user data of send
+ */
+void
+ublox_cmdq_init(ublox_cmdq_t * q, size_t window, uint32_t timeout, ublox_handler_t send, void * userdata)
+{
+    assert (NULL != q);
+    memset(q, 0, sizeof(*q));
+    q->window = (window > 0)?window:1;
+    q->timeout = timeout;
+    q->send = send;
+    q->userdata = userdata;
+}
+
+/**
+ * \brief release the memory of the queue
+ * \param q: the queue
+ */
+void
+ublox_cmdq_clear(ublox_cmdq_t * q)
+{
+    free(q->cmds);
+    free(q->data);
+    q->cmds = NULL;
+    q->data = NULL;
+    q->num_cmds = q->max_cmds = 0;
+    q->sz_data = q->max_data = 0;
+}
+
+/* the responses of the command */
+static uint8_t
+ublox_cmd_expect(const uint8_t * pkt)
+{
+    uint16_t class_id = UBLOX_CLASS_ID(pkt[2], pkt[3]);
+    size_t len = UBLOX_PKG_LENGTH(pkt);
+    uint8_t expect = 0;
+
+    // the receiver is reset without ACK
+    if ((UBLOX_CLASS_CFG == pkt[2]) && (UBX_CFG_RST != class_id)) {
+        expect |= UBLOX_CMD_EXPECT_ACK;
+    }
+    // the polls of the messages, and the polls of a port/message/protocol
+    if ((0 == len)
+        || ((UBX_CFG_PRT == class_id) && (1 == len))
+        || ((UBX_CFG_MSG == class_id) && (2 == len))
+        || ((UBX_CFG_INF == class_id) && (1 == len))
+        || (UBLOX_CLASS_ID(UBLOX_CLASS_CFG, 0x8B) == class_id)) { // CFG-VALGET
+        expect |= UBLOX_CMD_EXPECT_REPLY;
+    }
+    return expect;
+}
+
+/**
+ * \brief append a command to the queue
+ * \param q: the queue
+ * \param pkt: the packet, copied to the queue
+ * \param sz_pkt: the byte size of the packet
+ * \param pos: the position of the command in the source, for the report
+ *
+ * \return the index of the command, <0 on error
+ */
+int
+ublox_cmdq_add(ublox_cmdq_t * q, const uint8_t * pkt, size_t sz_pkt, long pos)
+{
+    ublox_cmd_t * cmd;
+    size_t sz;
+    void * p;
+
+    assert (NULL != q);
+    if ((sz_pkt < UBLOX_PKT_LENGTH_MIN) || (sz_pkt < UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(pkt))) {
+        TE("the command is not a packet, size=%" PRIuSZ "\n", sz_pkt);
+        return -1;
+    }
+    if (q->num_cmds >= q->max_cmds) {
+        sz = (q->max_cmds > 0)?(2 * q->max_cmds):16;
+        p = realloc(q->cmds, sz * sizeof(*(q->cmds)));
+        if (NULL == p) {
+            TE("out of memory\n");
+            return -1;
+        }
+        q->cmds = (ublox_cmd_t *)p;
+        q->max_cmds = sz;
+    }
+    if (q->sz_data + sz_pkt > q->max_data) {
+        sz = (q->max_data > 0)?(2 * q->max_data):1024;
+        if (sz < q->sz_data + sz_pkt) {
+            sz = q->sz_data + sz_pkt;
+        }
+        p = realloc(q->data, sz);
+        if (NULL == p) {
+            TE("out of memory\n");
+            return -1;
+        }
+        q->data = (uint8_t *)p;
+        q->max_data = sz;
+    }
+    memmove(q->data + q->sz_data, pkt, sz_pkt);
+    cmd = q->cmds + q->num_cmds;
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->offset = q->sz_data;
+    cmd->sz_pkt = sz_pkt;
+    cmd->pos = pos;
+    cmd->class_id = UBLOX_CLASS_ID(pkt[2], pkt[3]);
+    cmd->expect = ublox_cmd_expect(pkt);
+    cmd->status = UBLOX_CMD_QUEUED;
+    q->sz_data += sz_pkt;
+    return q->num_cmds ++;
+}
+
+/* set the result of the command */
+static void
+ublox_cmdq_finish(ublox_cmdq_t * q, ublox_cmd_t * cmd, uint8_t status, uint64_t now)
+{
+    if (UBLOX_CMD_SENT == cmd->status) {
+        q->num_inflight --;
+    }
+    cmd->status = status;
+    cmd->tm_done = now;
+    switch (status) {
+    case UBLOX_CMD_OK:      q->num_ok ++;      break;
+    case UBLOX_CMD_NAK:     q->num_nak ++;     break;
+    case UBLOX_CMD_TIMEOUT: q->num_timeout ++; break;
+    default:                q->num_error ++;   break;
+    }
+    while ((q->idx_wait < q->idx_next) && (q->cmds[q->idx_wait].status >= UBLOX_CMD_OK)) {
+        q->idx_wait ++;
+    }
+}
+
+/**
+ * \brief send the commands until the window is full
+ * \param q: the queue
+ * \param now: the current time (ms)
+ *
+ * \return the number of the commands sent
+ */
+int
+ublox_cmdq_pump(ublox_cmdq_t * q, uint64_t now)
+{
+    ublox_cmd_t * cmd;
+    int num = 0;
+
+    assert (NULL != q);
+    while ((q->idx_next < q->num_cmds) && (q->num_inflight < q->window)) {
+        cmd = q->cmds + q->idx_next ++;
+        cmd->tm_first = now;
+        cmd->tm_sent = now;
+        cmd->num_sent ++;
+        if ((NULL != q->send) && (q->send(q->userdata, q->data + cmd->offset, cmd->sz_pkt) < 0)) {
+            ublox_cmdq_finish(q, cmd, UBLOX_CMD_ERROR, now);
+            continue;
+        }
+        num ++;
+        if (0 == cmd->expect) {
+            ublox_cmdq_finish(q, cmd, UBLOX_CMD_OK, now);
+            continue;
+        }
+        cmd->status = UBLOX_CMD_SENT;
+        q->num_inflight ++;
+    }
+    return num;
+}
+
+/* the oldest command in flight of class_id waiting for the response */
+static ublox_cmd_t *
+ublox_cmdq_find(ublox_cmdq_t * q, uint16_t class_id, uint8_t expect)
+{
+    ublox_cmd_t * cmd;
+    size_t i;
+
+    for (i = q->idx_wait; i < q->idx_next; i ++) {
+        cmd = q->cmds + i;
+        if ((UBLOX_CMD_SENT == cmd->status) && (class_id == cmd->class_id) && (cmd->expect & expect) && ! (cmd->got & expect)) {
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+/* the command of class_id owing the earliest ACK/NAK, which may be finished and get a surplus ACK */
+static ublox_cmd_t *
+ublox_cmdq_find_ack(ublox_cmdq_t * q, uint16_t class_id, uint64_t now)
+{
+    ublox_cmd_t * cmd;
+    ublox_cmd_t * ret = NULL;
+    uint64_t tm_ret = 0;
+    uint64_t tm;
+    size_t i;
+
+    // the finished commands which owe nothing
+    while (q->idx_owe < q->idx_wait) {
+        cmd = q->cmds + q->idx_owe;
+        if ((cmd->expect & UBLOX_CMD_EXPECT_ACK) && (cmd->num_ack > 0) && (cmd->num_ack < cmd->num_sent)
+            && ((q->timeout < 1) || (cmd->tm_sent + q->timeout > now))) {
+            break;
+        }
+        q->idx_owe ++;
+    }
+    for (i = q->idx_owe; i < q->idx_next; i ++) {
+        cmd = q->cmds + i;
+        if ((class_id != cmd->class_id) || ! (cmd->expect & UBLOX_CMD_EXPECT_ACK) || (cmd->num_ack >= cmd->num_sent)) {
+            continue;
+        }
+        if (UBLOX_CMD_SENT == cmd->status) {
+            // the responses come in the order of the sendings
+            tm = (cmd->num_ack > 0)?cmd->tm_sent:cmd->tm_first;
+        } else if (((UBLOX_CMD_OK == cmd->status) || (UBLOX_CMD_NAK == cmd->status)) && (cmd->num_ack > 0)
+            && ((q->timeout < 1) || (cmd->tm_sent + q->timeout > now))) {
+            tm = cmd->tm_sent;
+        } else {
+            continue;
+        }
+        if ((NULL == ret) || (tm < tm_ret)) {
+            ret = cmd;
+            tm_ret = tm;
+        }
+    }
+    return ret;
+}
+
+/**
+ * \brief match a received packet to the commands in flight, and send more commands
+ * \param q: the queue
+ * \param buffer_in: the verified packet
+ * \param sz_in: the byte size of the packet
+ * \param now: the current time (ms)
+ *
+ * \return 1 if the packet is a response of a command, 0 if not
+ */
+int
+ublox_cmdq_on_packet(ublox_cmdq_t * q, const uint8_t * buffer_in, size_t sz_in, uint64_t now)
+{
+    ublox_cmd_t * cmd = NULL;
+    uint16_t class_id;
+
+    assert (NULL != q);
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return 0;
+    }
+    class_id = UBLOX_CLASS_ID(buffer_in[2], buffer_in[3]);
+    if (UBLOX_CLASS_ACK == buffer_in[2]) {
+        if ((UBLOX_PKG_LENGTH(buffer_in) < 2) || (sz_in < UBLOX_PKT_LENGTH_MIN + 2)) {
+            return 0;
+        }
+        cmd = ublox_cmdq_find_ack(q, UBLOX_CLASS_ID(buffer_in[6], buffer_in[7]), now);
+        if (NULL == cmd) {
+            return 0;
+        }
+        cmd->num_ack ++;
+        if (UBLOX_CMD_SENT != cmd->status) {
+            // the late ACK of a resent command
+            return 1;
+        }
+        if (UBX_ACK_ACK != class_id) {
+            ublox_cmdq_finish(q, cmd, UBLOX_CMD_NAK, now);
+            ublox_cmdq_pump(q, now);
+            return 1;
+        }
+        cmd->got |= UBLOX_CMD_EXPECT_ACK;
+    } else {
+        cmd = ublox_cmdq_find(q, class_id, UBLOX_CMD_EXPECT_REPLY);
+        if (NULL == cmd) {
+            return 0;
+        }
+        cmd->got |= UBLOX_CMD_EXPECT_REPLY;
+    }
+    if (cmd->got == cmd->expect) {
+        ublox_cmdq_finish(q, cmd, UBLOX_CMD_OK, now);
+        ublox_cmdq_pump(q, now);
+    }
+    return 1;
+}
+
+/**
+ * \brief resend or finish the commands in flight after the deadline, and send more commands
+ * \param q: the queue
+ * \param now: the current time (ms)
+ *
+ * \return the number of the commands timed out
+ */
+int
+ublox_cmdq_check_timeout(ublox_cmdq_t * q, uint64_t now)
+{
+    ublox_cmd_t * cmd;
+    size_t i;
+    int num = 0;
+
+    assert (NULL != q);
+    if (q->timeout < 1) {
+        return 0;
+    }
+    for (i = q->idx_wait; i < q->idx_next; i ++) {
+        cmd = q->cmds + i;
+        if ((UBLOX_CMD_SENT != cmd->status) || (cmd->tm_sent + q->timeout > now)) {
+            continue;
+        }
+        if (cmd->num_sent <= q->retries) {
+            cmd->tm_sent = now;
+            cmd->num_sent ++;
+            q->num_retry ++;
+            if ((NULL == q->send) || (q->send(q->userdata, q->data + cmd->offset, cmd->sz_pkt) >= 0)) {
+                continue;
+            }
+            ublox_cmdq_finish(q, cmd, UBLOX_CMD_ERROR, now);
+        } else {
+            ublox_cmdq_finish(q, cmd, UBLOX_CMD_TIMEOUT, now);
+        }
+        num ++;
+    }
+    if (num > 0) {
+        ublox_cmdq_pump(q, now);
+    }
+    return num;
+}
+
+/**
+ * \brief the earliest deadline of the commands in flight
+ * \param q: the queue
+ *
+ * \return the time (ms), 0 if no command is waiting or no timeout
+ */
+uint64_t
+ublox_cmdq_deadline(const ublox_cmdq_t * q)
+{
+    uint64_t ret = 0;
+    size_t i;
+
+    if (q->timeout < 1) {
+        return 0;
+    }
+    // the resent commands are out of order, scan the window
+    for (i = q->idx_wait; i < q->idx_next; i ++) {
+        if ((UBLOX_CMD_SENT == q->cmds[i].status) && ((0 == ret) || (q->cmds[i].tm_sent + q->timeout < ret))) {
+            ret = q->cmds[i].tm_sent + q->timeout;
+        }
+    }
+    return ret;
+}
+
+/**
+ * \brief the name of the status of a command
+ * \param status: UBLOX_CMD_xxx
+ *
+ * \return the name
+ */
+const char *
+ublox_cmd_status_cstr(int status)
+{
+    static const char * names[] = { "queued", "sent", "ok", "nak", "timeout", "error" };
+
+    if ((status < 0) || (status >= (int)NUM_ARRAY(names))) {
+        return "unknown";
+    }
+    return names[status];
+}
+
+/**
+ * \brief print the result and the round-trip time of each command
+ * \param q: the queue
+ * \param fp: the output
+ */
+void
+ublox_cmdq_report(const ublox_cmdq_t * q, FILE * fp)
+{
+    const ublox_cmd_t * cmd;
+    size_t i;
+
+    for (i = 0; i < q->num_cmds; i ++) {
+        cmd = q->cmds + i;
+        fprintf(fp, "[ubloxcmd] #%" PRIuSZ " pos=%ld class=0x%02X id=0x%02X %s", i, cmd->pos,
+            UBLOX_2CLASS(cmd->class_id), UBLOX_2ID(cmd->class_id), ublox_cmd_status_cstr(cmd->status));
+        if ((UBLOX_CMD_OK == cmd->status) || (UBLOX_CMD_NAK == cmd->status) || (UBLOX_CMD_TIMEOUT == cmd->status)) {
+            fprintf(fp, " rtt=%lu ms", (unsigned long)(cmd->tm_done - cmd->tm_sent));
+        }
+        if (cmd->num_sent > 1) {
+            fprintf(fp, " sent=%d", cmd->num_sent);
+        }
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, "[ubloxcmd] commands = %" PRIuSZ ", ok = %" PRIuSZ ", nak = %" PRIuSZ ", timeout = %" PRIuSZ ", error = %" PRIuSZ ", resent = %" PRIuSZ "\n",
+        q->num_cmds, q->num_ok, q->num_nak, q->num_timeout, q->num_error, q->num_retry);
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* record the packets sent */
+static int
+ublox_cmdq_test_send(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    size_t * pnum = (size_t *)userdata;
+
+    (void)buffer_in;
+    (void)sz_in;
+    (*pnum) ++;
+    return 0;
+}
+
+/* create a packet of the class/id with the payload */
+static size_t
+ublox_cmdq_test_pkt(uint8_t * buffer, uint16_t class_id, const uint8_t * payload, size_t sz_payload)
+{
+    buffer[0] = 0xB5;
+    buffer[1] = 0x62;
+    buffer[2] = UBLOX_2CLASS(class_id);
+    buffer[3] = UBLOX_2ID(class_id);
+    buffer[4] = sz_payload & 0xFF;
+    buffer[5] = (sz_payload >> 8) & 0xFF;
+    memmove(buffer + 6, payload, sz_payload);
+    ublox_pkt_checksum(buffer + 2, 4 + sz_payload, buffer + 6 + sz_payload);
+    return UBLOX_PKT_LENGTH_MIN + sz_payload;
+}
+
+/* CFG-RATE set, MON-VER poll, CFG-PRT poll, CFG-RST, CFG-RATE set */
+static size_t
+ublox_cmdq_test_setup(ublox_cmdq_t * q, size_t * pnum_sent)
+{
+    uint8_t pkt[64];
+    uint8_t payload[4];
+    size_t sz;
+
+    *pnum_sent = 0;
+    ublox_cmdq_init(q, 2, 1000, ublox_cmdq_test_send, pnum_sent);
+    sz = ublox_pkt_create_set_cfgrate(pkt, sizeof(pkt), 1000, 1, 1);
+    ublox_cmdq_add(q, pkt, sz, 10);
+    sz = ublox_pkt_create_get_version(pkt, sizeof(pkt));
+    ublox_cmdq_add(q, pkt, sz, 20);
+    sz = ublox_pkt_create_get_cfgprt(pkt, sizeof(pkt), 1);
+    ublox_cmdq_add(q, pkt, sz, 30);
+    memset(payload, 0, sizeof(payload));
+    sz = ublox_cmdq_test_pkt(pkt, UBX_CFG_RST, payload, 4);
+    ublox_cmdq_add(q, pkt, sz, 40);
+    sz = ublox_pkt_create_set_cfgrate(pkt, sizeof(pkt), 200, 1, 1);
+    ublox_cmdq_add(q, pkt, sz, 50);
+    ublox_cmdq_add(q, pkt, 7, 60);
+    return q->num_cmds;
+}
+
+TEST_CASE( .name="ublox-cmdq", .description="Test ublox pipelined command queue." ) {
+    uint8_t pkt[64];
+    uint8_t payload[8];
+    ublox_cmdq_t q;
+    size_t num_sent = 0;
+    size_t sz;
+
+    SECTION("test the expected responses") {
+        REQUIRE(5 == ublox_cmdq_test_setup(&q, &num_sent));
+        REQUIRE(UBLOX_CMD_EXPECT_ACK == q.cmds[0].expect);
+        REQUIRE(UBLOX_CMD_EXPECT_REPLY == q.cmds[1].expect);
+        REQUIRE((UBLOX_CMD_EXPECT_ACK | UBLOX_CMD_EXPECT_REPLY) == q.cmds[2].expect);
+        REQUIRE(0 == q.cmds[3].expect);
+        REQUIRE(UBX_CFG_PRT == q.cmds[2].class_id);
+        REQUIRE(30 == q.cmds[2].pos);
+        ublox_cmdq_clear(&q);
+    }
+
+    SECTION("test the window and the correlation") {
+        REQUIRE(5 == ublox_cmdq_test_setup(&q, &num_sent));
+        REQUIRE(2 == ublox_cmdq_pump(&q, 100));
+        REQUIRE(2 == num_sent);
+        REQUIRE(0 == ublox_cmdq_pump(&q, 100));
+        REQUIRE(1100 == ublox_cmdq_deadline(&q));
+
+        // the unrelated packets
+        payload[0] = 0x06;
+        payload[1] = 0x01;
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(0 == ublox_cmdq_on_packet(&q, pkt, sz, 105));
+        sz = ublox_cmdq_test_pkt(pkt, UBX_CFG_PRT, payload, 2);
+        REQUIRE(0 == ublox_cmdq_on_packet(&q, pkt, sz, 105));
+
+        // the poll reply of MON-VER before the ACK of CFG-RATE
+        sz = ublox_cmdq_test_pkt(pkt, UBX_MON_VER, payload, 8);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 110));
+        REQUIRE(UBLOX_CMD_OK == q.cmds[1].status);
+        REQUIRE(10 == q.cmds[1].tm_done - q.cmds[1].tm_sent);
+        REQUIRE(0 == q.idx_wait);
+        REQUIRE(3 == num_sent);
+        REQUIRE(UBLOX_CMD_SENT == q.cmds[2].status);
+
+        payload[0] = 0x06;
+        payload[1] = 0x08;
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 120));
+        REQUIRE(UBLOX_CMD_OK == q.cmds[0].status);
+        REQUIRE(20 == q.cmds[0].tm_done - q.cmds[0].tm_sent);
+        REQUIRE(2 == q.idx_wait);
+        // CFG-RST is finished when sent, CFG-RATE is in flight
+        REQUIRE(5 == num_sent);
+        REQUIRE(UBLOX_CMD_OK == q.cmds[3].status);
+        REQUIRE(UBLOX_CMD_SENT == q.cmds[4].status);
+        REQUIRE(2 == q.num_inflight);
+
+        // CFG-PRT poll needs both of the reply and ACK
+        payload[0] = 0x06;
+        payload[1] = 0x00;
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 130));
+        REQUIRE(UBLOX_CMD_SENT == q.cmds[2].status);
+        sz = ublox_cmdq_test_pkt(pkt, UBX_CFG_PRT, payload, 8);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 131));
+        REQUIRE(UBLOX_CMD_OK == q.cmds[2].status);
+
+        payload[0] = 0x06;
+        payload[1] = 0x08;
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_NAK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 140));
+        REQUIRE(UBLOX_CMD_NAK == q.cmds[4].status);
+        REQUIRE(ublox_cmdq_done(&q));
+        REQUIRE(4 == q.num_ok);
+        REQUIRE(1 == q.num_nak);
+        REQUIRE(0 == q.num_inflight);
+        REQUIRE(0 == ublox_cmdq_deadline(&q));
+        ublox_cmdq_clear(&q);
+    }
+
+    SECTION("test the timeout") {
+        REQUIRE(5 == ublox_cmdq_test_setup(&q, &num_sent));
+        REQUIRE(2 == ublox_cmdq_pump(&q, 0));
+        REQUIRE(0 == ublox_cmdq_check_timeout(&q, 999));
+        REQUIRE(2 == ublox_cmdq_check_timeout(&q, 1000));
+        REQUIRE(UBLOX_CMD_TIMEOUT == q.cmds[0].status);
+        REQUIRE(UBLOX_CMD_TIMEOUT == q.cmds[1].status);
+        REQUIRE(2 == q.num_inflight);
+        REQUIRE(5 == num_sent);
+        REQUIRE(2000 == ublox_cmdq_deadline(&q));
+        REQUIRE(2 == ublox_cmdq_check_timeout(&q, 2500));
+        REQUIRE(ublox_cmdq_done(&q));
+        REQUIRE(4 == q.num_timeout);
+        REQUIRE(0 == strcmp("timeout", ublox_cmd_status_cstr(q.cmds[4].status)));
+        ublox_cmdq_clear(&q);
+    }
+
+    SECTION("test the retransmission") {
+        REQUIRE(5 == ublox_cmdq_test_setup(&q, &num_sent));
+        q.retries = 1;
+        REQUIRE(2 == ublox_cmdq_pump(&q, 0));
+        REQUIRE(0 == ublox_cmdq_check_timeout(&q, 1000));
+        REQUIRE(4 == num_sent);
+        REQUIRE(2 == q.num_retry);
+        REQUIRE(2 == q.num_inflight);
+        REQUIRE(2000 == ublox_cmdq_deadline(&q));
+
+        payload[0] = 0x06;
+        payload[1] = 0x08;
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 1010));
+        REQUIRE(UBLOX_CMD_OK == q.cmds[0].status);
+        REQUIRE(2 == q.cmds[0].num_sent);
+        REQUIRE(10 == q.cmds[0].tm_done - q.cmds[0].tm_sent);
+        REQUIRE(5 == num_sent);
+        REQUIRE(2000 == ublox_cmdq_deadline(&q));
+
+        // MON-VER is not replied after the retry
+        REQUIRE(1 == ublox_cmdq_check_timeout(&q, 2000));
+        REQUIRE(UBLOX_CMD_TIMEOUT == q.cmds[1].status);
+        REQUIRE(UBLOX_CMD_OK == q.cmds[3].status);
+        REQUIRE(7 == num_sent);
+        REQUIRE(2010 == ublox_cmdq_deadline(&q));
+        ublox_cmdq_clear(&q);
+    }
+
+    SECTION("test the late ACK of a resent command") {
+        // 4 CFG-VALSET of the same class/id
+        num_sent = 0;
+        ublox_cmdq_init(&q, 3, 100, ublox_cmdq_test_send, &num_sent);
+        q.retries = 1;
+        memset(payload, 0, sizeof(payload));
+        sz = ublox_cmdq_test_pkt(pkt, UBLOX_CLASS_ID(UBLOX_CLASS_CFG, 0x8A), payload, 8);
+        REQUIRE(0 == ublox_cmdq_add(&q, pkt, sz, 10));
+        REQUIRE(1 == ublox_cmdq_pump(&q, 0));
+        REQUIRE(1 == ublox_cmdq_add(&q, pkt, sz, 20));
+        REQUIRE(2 == ublox_cmdq_add(&q, pkt, sz, 30));
+        REQUIRE(3 == ublox_cmdq_add(&q, pkt, sz, 40));
+        REQUIRE(2 == ublox_cmdq_pump(&q, 50));
+        // #0 is resent, its first ACK is late
+        REQUIRE(0 == ublox_cmdq_check_timeout(&q, 100));
+        REQUIRE(2 == q.cmds[0].num_sent);
+        REQUIRE(4 == num_sent);
+
+        payload[0] = 0x06;
+        payload[1] = 0x8A;
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 110));
+        REQUIRE(UBLOX_CMD_OK == q.cmds[0].status);
+        REQUIRE(UBLOX_CMD_SENT == q.cmds[3].status);
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_NAK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 120));
+        REQUIRE(UBLOX_CMD_NAK == q.cmds[1].status);
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 130));
+        REQUIRE(UBLOX_CMD_OK == q.cmds[2].status);
+
+        // the ACK of the resending of #0 is not credited to #3
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 140));
+        REQUIRE(2 == q.cmds[0].num_ack);
+        REQUIRE(UBLOX_CMD_SENT == q.cmds[3].status);
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_NAK, payload, 2);
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, pkt, sz, 150));
+        REQUIRE(UBLOX_CMD_NAK == q.cmds[3].status);
+        REQUIRE(ublox_cmdq_done(&q));
+        REQUIRE(2 == q.num_ok);
+        REQUIRE(2 == q.num_nak);
+
+        // no command owes an ACK
+        sz = ublox_cmdq_test_pkt(pkt, UBX_ACK_ACK, payload, 2);
+        REQUIRE(0 == ublox_cmdq_on_packet(&q, pkt, sz, 160));
+        ublox_cmdq_clear(&q);
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,103 @@
+/**
+ * \file    ubloxcmd.h
+ * \brief   The pipelined command queue with the correlation of ACK/NAK and the poll replies
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_CMD_H
+#define UBLOX_CMD_H 1
+
+#include <stdio.h>
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxreg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_CMD_QUEUED  0 /**< not sent yet */
+#define UBLOX_CMD_SENT    1 /**< sent, waiting for the responses */
+#define UBLOX_CMD_OK      2 /**< all of the expected responses are received, or no response is expected */
+#define UBLOX_CMD_NAK     3 /**< UBX-ACK-NAK is received */
+#define UBLOX_CMD_TIMEOUT 4 /**< the responses are not received before the deadline */
+#define UBLOX_CMD_ERROR   5 /**< unable to send the command */
+
+#define UBLOX_CMD_EXPECT_ACK   0x01 /**< the command is acknowledged by UBX-ACK-ACK/NAK */
+#define UBLOX_CMD_EXPECT_REPLY 0x02 /**< the command is a poll, replied by the message of the same class/id */
+
+/** a command in the queue */
+typedef struct _ublox_cmd_t {
+    size_t offset;        /**< the offset of the packet in the data of the queue */
+    size_t sz_pkt;        /**< the byte size of the packet */
+    long pos;             /**< the position of the command in the source, such as the line of the file */
+    uint16_t class_id;    /**< the class and id of the request */
+    uint8_t expect;       /**< UBLOX_CMD_EXPECT_xxx */
+    uint8_t got;          /**< UBLOX_CMD_EXPECT_xxx received */
+    uint8_t status;       /**< UBLOX_CMD_xxx */
+    uint8_t num_sent;     /**< the times sent */
+    uint8_t num_ack;      /**< the ACK/NAK received, the rest of num_sent may come late */
+    uint64_t tm_first;    /**< the time of the first sending (ms) */
+    uint64_t tm_sent;     /**< the time of the last sending (ms) */
+    uint64_t tm_done;     /**< the time finished (ms) */
+} ublox_cmd_t;
+
+/**
+ * The commands are sent in order while the number of the commands waiting
+ * for the responses is less than the window. Each ACK/NAK and poll reply is
+ * matched to the oldest command in flight of the same class/id, so the
+ * result and the round-trip time of every command are known. A command
+ * without the responses before the timeout is sent again up to the retries.
+ * The receiver acknowledges every copy of a resent command, so the ACK/NAK
+ * is matched to the earliest sending still owed, and a surplus ACK of a
+ * finished command is absorbed until the timeout after its last sending,
+ * instead of being credited to the next command of the same class/id.
+ * The time is given by the caller in ms, such as uv_now().
+ */
+typedef struct _ublox_cmdq_t {
+    ublox_cmd_t * cmds;
+    size_t num_cmds;
+    size_t max_cmds;
+    uint8_t * data;       /**< the packets of the commands */
+    size_t sz_data;
+    size_t max_data;
+
+    size_t window;        /**< the max number of the commands in flight */
+    uint32_t timeout;     /**< the time to wait for the responses of a command (ms) */
+    uint8_t retries;      /**< the times to resend a command after the timeout, 0 by default */
+    ublox_handler_t send; /**< the function to send a packet */
+    void * userdata;      /**< the user data of send */
+
+    size_t idx_next;      /**< the next command to be sent */
+    size_t idx_wait;      /**< the first command not finished */
+    size_t idx_owe;       /**< the first command which may still get a late ACK/NAK */
+    size_t num_inflight;  /**< the number of the commands sent and not finished */
+    size_t num_ok;
+    size_t num_nak;
+    size_t num_timeout;
+    size_t num_error;
+    size_t num_retry;     /**< the number of the commands resent */
+} ublox_cmdq_t;
+
+void ublox_cmdq_init(ublox_cmdq_t * q, size_t window, uint32_t timeout, ublox_handler_t send, void * userdata);
+void ublox_cmdq_clear(ublox_cmdq_t * q);
+int ublox_cmdq_add(ublox_cmdq_t * q, const uint8_t * pkt, size_t sz_pkt, long pos);
+int ublox_cmdq_pump(ublox_cmdq_t * q, uint64_t now);
+int ublox_cmdq_on_packet(ublox_cmdq_t * q, const uint8_t * buffer_in, size_t sz_in, uint64_t now);
+int ublox_cmdq_check_timeout(ublox_cmdq_t * q, uint64_t now);
+uint64_t ublox_cmdq_deadline(const ublox_cmdq_t * q);
+void ublox_cmdq_report(const ublox_cmdq_t * q, FILE * fp);
+const char * ublox_cmd_status_cstr(int status);
+
+/** all of the commands are finished */
+#define ublox_cmdq_done(q) ((q)->idx_wait >= (q)->num_cmds)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_CMD_H */
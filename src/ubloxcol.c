@@ -0,0 +1,561 @@
+/**
+ * \file    ubloxcol.c
+ * \brief   Columnar store of the RXM-RAWX observations
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The columnar file is a sequence of blocks, each block is:
+ *   - 8 bytes magic UBLOX_COL_MAGIC
+ *   - u64 num_epoch, u64 num_meas
+ *   - the epoch columns: rcvTow(r8), week(u2), leapS(i1), recStat(u1), meas_start(u8)
+ *   - the measurement columns: prMes(r8), cpMes(r8), doMes(r4), gnssId(u1),
+ *     svId(u1), sigId(u1), freqId(u1), locktime(u2), cno(u1), prStdev(u1),
+ *     cpStdev(u1), doStdev(u1), trkStat(u1)
+ * All of the values are little endian, every column is padded to 8 bytes,
+ * meas_start is relative to the block.
+ */
+
+#include <stddef.h> // offsetof()
+#include <stdlib.h> // realloc()
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdec.h"
+#include "ubloxcol.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_COL_EPOCH 0 /**< the column of epochs */
+#define UBLOX_COL_MEAS  1 /**< the column of measurements */
+
+/** the columns, in the order of the file; meas_start is handled separately */
+static const struct _ublox_col_field_t {
+    size_t offset;  /**< the offset of the pointer in ublox_rawx_col_t */
+    size_t sz_item; /**< the byte size of an item */
+    int type;       /**< UBLOX_COL_EPOCH or UBLOX_COL_MEAS */
+} ublox_rawx_col_fields[] = {
+#define ITEM(name, type) {offsetof(ublox_rawx_col_t, name), sizeof(*(((ublox_rawx_col_t *)0)->name)), type}
+    ITEM(rcvTow, UBLOX_COL_EPOCH),
+    ITEM(week, UBLOX_COL_EPOCH),
+    ITEM(leapS, UBLOX_COL_EPOCH),
+    ITEM(recStat, UBLOX_COL_EPOCH),
+    ITEM(prMes, UBLOX_COL_MEAS),
+    ITEM(cpMes, UBLOX_COL_MEAS),
+    ITEM(doMes, UBLOX_COL_MEAS),
+    ITEM(gnssId, UBLOX_COL_MEAS),
+    ITEM(svId, UBLOX_COL_MEAS),
+    ITEM(sigId, UBLOX_COL_MEAS),
+    ITEM(freqId, UBLOX_COL_MEAS),
+    ITEM(locktime, UBLOX_COL_MEAS),
+    ITEM(cno, UBLOX_COL_MEAS),
+    ITEM(prStdev, UBLOX_COL_MEAS),
+    ITEM(cpStdev, UBLOX_COL_MEAS),
+    ITEM(doStdev, UBLOX_COL_MEAS),
+    ITEM(trkStat, UBLOX_COL_MEAS),
+#undef ITEM
+};
+
+#define UBLOX_COL_PTR(col, field) ((uint8_t **)((uint8_t *)(col) + (field)->offset))
+
+/**
+ * \brief setup an empty store
+ * \param col: the store
+ */
+void
+ublox_rawx_col_init(ublox_rawx_col_t * col)
+{
+    assert (NULL != col);
+    memset(col, 0, sizeof(*col));
+}
+
+/**
+ * \brief free the memory of the store
+ * \param col: the store
+ */
+void
+ublox_rawx_col_clear(ublox_rawx_col_t * col)
+{
+    size_t i;
+    assert (NULL != col);
+    for (i = 0; i < NUM_ARRAY(ublox_rawx_col_fields); i ++) {
+        free(*UBLOX_COL_PTR(col, ublox_rawx_col_fields + i));
+    }
+    free(col->meas_start);
+    ublox_rawx_col_init(col);
+}
+
+/**
+ * \brief remove all of the data, keep the memory for the next data
+ * \param col: the store
+ */
+void
+ublox_rawx_col_reset(ublox_rawx_col_t * col)
+{
+    assert (NULL != col);
+    col->num_epoch = 0;
+    col->num_meas = 0;
+    if (NULL != col->meas_start) {
+        col->meas_start[0] = 0;
+    }
+}
+
+/**
+ * \brief make sure the store has room for the epochs and the measurements
+ * \param col: the store
+ * \param max_epoch: the number of epochs
+ * \param max_meas: the number of measurements
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The capacity is at least doubled, so the append is amortized O(1).
+ */
+int
+ublox_rawx_col_reserve(ublox_rawx_col_t * col, size_t max_epoch, size_t max_meas)
+{
+    const struct _ublox_col_field_t * field;
+    size_t new_epoch = col->max_epoch;
+    size_t new_meas = col->max_meas;
+    size_t num;
+    uint8_t * p;
+    size_t i;
+
+    assert (NULL != col);
+    // the index has one more item for the end, even without epochs
+    if ((max_epoch > new_epoch) || (NULL == col->meas_start)) {
+        new_epoch = (max_epoch > 2 * new_epoch)?max_epoch:(2 * new_epoch);
+        p = realloc(col->meas_start, (new_epoch + 1) * sizeof(*(col->meas_start)));
+        if (NULL == p) {
+            TE("out of memory");
+            return -1;
+        }
+        col->meas_start = (uint64_t *)p;
+        if (col->max_epoch < 1) {
+            col->meas_start[0] = 0;
+        }
+    }
+    if (max_meas > new_meas) {
+        new_meas = (max_meas > 2 * new_meas)?max_meas:(2 * new_meas);
+    }
+    for (i = 0; i < NUM_ARRAY(ublox_rawx_col_fields); i ++) {
+        field = ublox_rawx_col_fields + i;
+        if (UBLOX_COL_EPOCH == field->type) {
+            if (new_epoch == col->max_epoch) {
+                continue;
+            }
+            num = new_epoch;
+        } else {
+            if (new_meas == col->max_meas) {
+                continue;
+            }
+            num = new_meas;
+        }
+        p = realloc(*UBLOX_COL_PTR(col, field), num * field->sz_item);
+        if (NULL == p) {
+            // the columns realloc-ed keep the data, the capacity is not changed
+            TE("out of memory");
+            return -1;
+        }
+        *UBLOX_COL_PTR(col, field) = p;
+    }
+    col->max_epoch = new_epoch;
+    col->max_meas = new_meas;
+    return 0;
+}
+
+/**
+ * \brief append the epoch of a RXM-RAWX packet to the store
+ * \param col: the store
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rawx_col_append(ublox_rawx_col_t * col, const uint8_t * payload, size_t sz_payload)
+{
+    ublox_rxm_rawx_t rawx;
+    ublox_rxm_rawx_meas_t meas;
+    size_t idx;
+    size_t i;
+
+    assert (NULL != col);
+    memset(&rawx, 0, sizeof(rawx));
+    if (ublox_decode_rxm_rawx(payload, sz_payload, &rawx) < 0) {
+        TE("malformed RXM-RAWX, size=%" PRIuSZ, sz_payload);
+        return -1;
+    }
+    if (ublox_rawx_col_reserve(col, col->num_epoch + 1, col->num_meas + rawx.numMeas) < 0) {
+        return -1;
+    }
+    idx = col->num_epoch;
+    col->rcvTow[idx] = rawx.rcvTow;
+    col->week[idx] = rawx.week;
+    col->leapS[idx] = rawx.leapS;
+    col->recStat[idx] = rawx.recStat;
+    col->meas_start[idx] = col->num_meas;
+
+    for (i = 0; i < rawx.numMeas; i ++) {
+        ublox_decode_rxm_rawx_item(payload, sz_payload, i, &meas);
+        idx = col->num_meas + i;
+        col->prMes[idx] = meas.prMes;
+        col->cpMes[idx] = meas.cpMes;
+        col->doMes[idx] = meas.doMes;
+        col->gnssId[idx] = meas.gnssId;
+        col->svId[idx] = meas.svId;
+        col->sigId[idx] = meas.sigId;
+        col->freqId[idx] = meas.freqId;
+        col->locktime[idx] = meas.locktime;
+        col->cno[idx] = meas.cno;
+        col->prStdev[idx] = meas.prStdev;
+        col->cpStdev[idx] = meas.cpStdev;
+        col->doStdev[idx] = meas.doStdev;
+        col->trkStat[idx] = meas.trkStat;
+    }
+    col->num_meas += rawx.numMeas;
+    col->num_epoch ++;
+    col->meas_start[col->num_epoch] = col->num_meas;
+    return 0;
+}
+
+/**
+ * \brief the handler of RXM-RAWX for the registry
+ * \param userdata: the store, ublox_rawx_col_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rawx_col_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    return ublox_rawx_col_append((ublox_rawx_col_t *)userdata, buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN);
+}
+
+/*****************************************************************************/
+// the file
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define UBLOX_COL_SWAP 1
+#else
+#define UBLOX_COL_SWAP 0
+#endif
+
+#if UBLOX_COL_SWAP
+static void
+ublox_col_swap(uint8_t * data, size_t sz_item, size_t num)
+{
+    uint8_t tmp;
+    size_t i;
+    size_t j;
+    for (; num > 0; num --, data += sz_item) {
+        for (i = 0, j = sz_item - 1; i < j; i ++, j --) {
+            tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+}
+#endif
+
+/**
+ * \brief write a column in little endian and pad it to 8 bytes
+ * \return 0 on success, <0 on error
+ */
+static int
+ublox_col_write(FILE * fp, const void * data, size_t sz_item, size_t num)
+{
+    static const uint8_t pad[8] = {0};
+    size_t sz_pad = (8 - (sz_item * num) % 8) % 8;
+#if UBLOX_COL_SWAP
+    uint8_t buf[256];
+    const uint8_t * p = (const uint8_t *)data;
+    size_t num_buf;
+    while (num > 0) {
+        num_buf = sizeof(buf) / sz_item;
+        if (num_buf > num) {
+            num_buf = num;
+        }
+        memmove(buf, p, num_buf * sz_item);
+        ublox_col_swap(buf, sz_item, num_buf);
+        if (fwrite(buf, sz_item, num_buf, fp) != num_buf) {
+            return -1;
+        }
+        p += num_buf * sz_item;
+        num -= num_buf;
+    }
+#else
+    if ((num > 0) && (fwrite(data, sz_item, num, fp) != num)) {
+        return -1;
+    }
+#endif
+    if ((sz_pad > 0) && (fwrite(pad, 1, sz_pad, fp) != sz_pad)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief read a column in little endian and skip the padding
+ * \return 0 on success, <0 on error
+ */
+static int
+ublox_col_read(FILE * fp, void * data, size_t sz_item, size_t num)
+{
+    uint8_t pad[8];
+    size_t sz_pad = (8 - (sz_item * num) % 8) % 8;
+    if ((num > 0) && (fread(data, sz_item, num, fp) != num)) {
+        return -1;
+    }
+#if UBLOX_COL_SWAP
+    ublox_col_swap((uint8_t *)data, sz_item, num);
+#endif
+    if ((sz_pad > 0) && (fread(pad, 1, sz_pad, fp) != sz_pad)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief write the store to the file as a block
+ * \param col: the store
+ * \param fp: the file
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rawx_col_save(const ublox_rawx_col_t * col, FILE * fp)
+{
+    const struct _ublox_col_field_t * field;
+    uint64_t hdr[2];
+    size_t i;
+
+    assert (NULL != col);
+    assert (NULL != fp);
+    hdr[0] = col->num_epoch;
+    hdr[1] = col->num_meas;
+    if (fwrite(UBLOX_COL_MAGIC, 1, 8, fp) != 8) {
+        goto err_write;
+    }
+    if (ublox_col_write(fp, hdr, sizeof(hdr[0]), NUM_ARRAY(hdr)) < 0) {
+        goto err_write;
+    }
+    for (i = 0; i < NUM_ARRAY(ublox_rawx_col_fields); i ++) {
+        field = ublox_rawx_col_fields + i;
+        if (ublox_col_write(fp, *UBLOX_COL_PTR(col, field), field->sz_item, (UBLOX_COL_EPOCH == field->type)?col->num_epoch:col->num_meas) < 0) {
+            goto err_write;
+        }
+        if ((UBLOX_COL_EPOCH == field->type) && (UBLOX_COL_MEAS == field[1].type)) {
+            // the last epoch column
+            if (ublox_col_write(fp, col->meas_start, sizeof(*(col->meas_start)), col->num_epoch) < 0) {
+                goto err_write;
+            }
+        }
+    }
+    return 0;
+
+err_write:
+    TE("write columnar file error");
+    return -1;
+}
+
+/**
+ * \brief read all of the blocks in the file and append them to the store
+ * \param col: the store
+ * \param fp: the file
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rawx_col_load(ublox_rawx_col_t * col, FILE * fp)
+{
+    const struct _ublox_col_field_t * field;
+    uint8_t magic[8];
+    uint64_t hdr[2];
+    size_t ret;
+    size_t num;
+    size_t prev;
+    size_t i;
+
+    assert (NULL != col);
+    assert (NULL != fp);
+    for (;;) {
+        ret = fread(magic, 1, sizeof(magic), fp);
+        if (0 == ret) {
+            break;
+        }
+        if ((ret != sizeof(magic)) || (0 != memcmp(magic, UBLOX_COL_MAGIC, sizeof(magic)))) {
+            TE("not a columnar file");
+            return -1;
+        }
+        if (ublox_col_read(fp, hdr, sizeof(hdr[0]), NUM_ARRAY(hdr)) < 0) {
+            goto err_read;
+        }
+        if ((hdr[0] > SIZE_MAX / 2) || (hdr[1] > SIZE_MAX / 2)) {
+            goto err_read;
+        }
+        if (ublox_rawx_col_reserve(col, col->num_epoch + hdr[0], col->num_meas + hdr[1]) < 0) {
+            return -1;
+        }
+        for (i = 0; i < NUM_ARRAY(ublox_rawx_col_fields); i ++) {
+            field = ublox_rawx_col_fields + i;
+            if (UBLOX_COL_EPOCH == field->type) {
+                num = col->num_epoch;
+            } else {
+                num = col->num_meas;
+            }
+            if (ublox_col_read(fp, *UBLOX_COL_PTR(col, field) + num * field->sz_item, field->sz_item, (UBLOX_COL_EPOCH == field->type)?hdr[0]:hdr[1]) < 0) {
+                goto err_read;
+            }
+            if ((UBLOX_COL_EPOCH == field->type) && (UBLOX_COL_MEAS == field[1].type)) {
+                if (ublox_col_read(fp, col->meas_start + col->num_epoch, sizeof(*(col->meas_start)), hdr[0]) < 0) {
+                    goto err_read;
+                }
+            }
+        }
+        // rebase the index of measurements to the store
+        for (prev = 0, i = 0; i < hdr[0]; i ++) {
+            num = col->meas_start[col->num_epoch + i];
+            if ((num > hdr[1]) || (num < prev)) {
+                TE("corrupted epoch index %" PRIuSZ, i);
+                return -1;
+            }
+            prev = num;
+            col->meas_start[col->num_epoch + i] = num + col->num_meas;
+        }
+        col->num_epoch += hdr[0];
+        col->num_meas += hdr[1];
+        col->meas_start[col->num_epoch] = col->num_meas;
+    }
+    return 0;
+
+err_read:
+    TE("read columnar file error");
+    return -1;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* create the payload of RXM-RAWX, the measurement i is (prMes=base+i, svId=i+1) */
+static size_t
+ublox_col_test_rawx(uint8_t * payload, double rcvTow, uint8_t num_meas, double base)
+{
+    uint8_t * p;
+    uint64_t u8;
+    size_t i;
+
+    memset(payload, 0, 16 + 32 * num_meas);
+    memmove(&u8, &rcvTow, sizeof(u8));
+    for (i = 0; i < 8; i ++) { payload[i] = (u8 >> (8 * i)) & 0xFF; }
+    payload[8] = 2000 & 0xFF;
+    payload[9] = 2000 >> 8;
+    payload[10] = 18;
+    payload[11] = num_meas;
+    payload[12] = 0x01;
+    for (p = payload + 16; p < payload + 16 + 32 * num_meas; p += 32) {
+        double val = base + (p - payload - 16) / 32;
+        size_t j;
+        memmove(&u8, &val, sizeof(u8));
+        for (j = 0; j < 8; j ++) { p[j] = (u8 >> (8 * j)) & 0xFF; }
+        p[20] = 0; // GPS
+        p[21] = (p - payload - 16) / 32 + 1;
+        p[22] = (p - payload - 16) / 32 % 2; // L1C/A, L2C
+        p[24] = 0x34;
+        p[25] = 0x12;
+        p[26] = 45;
+        p[30] = 0x07;
+    }
+    return 16 + 32 * num_meas;
+}
+
+TEST_CASE( .name="ublox-rawx-col", .description="Test ublox columnar store of RXM-RAWX." ) {
+    uint8_t payload[16 + 32 * 8];
+    ublox_rawx_col_t col;
+    ublox_rawx_col_t col2;
+    size_t sz;
+    size_t i;
+    FILE * fp;
+
+    SECTION("test ublox_rawx_col_append") {
+        ublox_rawx_col_init(&col);
+        sz = ublox_col_test_rawx(payload, 100.0, 3, 2.0e7);
+        REQUIRE(0 == ublox_rawx_col_append(&col, payload, sz));
+        sz = ublox_col_test_rawx(payload, 101.0, 0, 0);
+        REQUIRE(0 == ublox_rawx_col_append(&col, payload, sz));
+        sz = ublox_col_test_rawx(payload, 102.0, 8, 2.1e7);
+        REQUIRE(0 == ublox_rawx_col_append(&col, payload, sz));
+        REQUIRE(0 > ublox_rawx_col_append(&col, payload, sz - 1));
+
+        REQUIRE(col.num_epoch == 3);
+        REQUIRE(col.num_meas == 11);
+        REQUIRE(col.meas_start[0] == 0);
+        REQUIRE(col.meas_start[1] == 3);
+        REQUIRE(col.meas_start[2] == 3);
+        REQUIRE(col.meas_start[3] == 11);
+        REQUIRE(col.rcvTow[2] == 102.0);
+        REQUIRE(col.week[1] == 2000);
+        REQUIRE(col.leapS[0] == 18);
+        REQUIRE(col.prMes[2] == 2.0e7 + 2);
+        REQUIRE(col.prMes[10] == 2.1e7 + 7);
+        REQUIRE(col.svId[10] == 8);
+        REQUIRE(col.sigId[9] == 0);
+        REQUIRE(col.sigId[10] == 1);
+        REQUIRE(col.locktime[4] == 0x1234);
+        REQUIRE(col.cno[5] == 45);
+        REQUIRE(col.trkStat[6] == 0x07);
+
+        // save two blocks and load them back
+        fp = tmpfile();
+        REQUIRE(NULL != fp);
+        REQUIRE(0 == ublox_rawx_col_save(&col, fp));
+        REQUIRE(0 == ublox_rawx_col_save(&col, fp));
+        rewind(fp);
+        ublox_rawx_col_init(&col2);
+        REQUIRE(0 == ublox_rawx_col_load(&col2, fp));
+        fclose(fp);
+        REQUIRE(col2.num_epoch == 6);
+        REQUIRE(col2.num_meas == 22);
+        for (i = 0; i < col2.num_epoch; i ++) {
+            REQUIRE(col2.rcvTow[i] == col.rcvTow[i % 3]);
+            REQUIRE(col2.meas_start[i] == col.meas_start[i % 3] + (i / 3) * 11);
+        }
+        REQUIRE(col2.meas_start[6] == 22);
+        for (i = 0; i < col2.num_meas; i ++) {
+            REQUIRE(col2.prMes[i] == col.prMes[i % 11]);
+            REQUIRE(col2.svId[i] == col.svId[i % 11]);
+            REQUIRE(col2.sigId[i] == col.sigId[i % 11]);
+            REQUIRE(col2.locktime[i] == col.locktime[i % 11]);
+        }
+        ublox_rawx_col_clear(&col2);
+
+        ublox_rawx_col_reset(&col);
+        REQUIRE(col.num_epoch == 0);
+        REQUIRE(col.num_meas == 0);
+        ublox_rawx_col_clear(&col);
+    }
+
+    SECTION("test the empty store") {
+        ublox_rawx_col_init(&col);
+        fp = tmpfile();
+        REQUIRE(NULL != fp);
+        REQUIRE(0 == ublox_rawx_col_save(&col, fp));
+        rewind(fp);
+        ublox_rawx_col_init(&col2);
+        REQUIRE(0 == ublox_rawx_col_load(&col2, fp));
+        fclose(fp);
+        REQUIRE(col2.num_epoch == 0);
+        REQUIRE(col2.num_meas == 0);
+        REQUIRE(NULL != col2.meas_start);
+        REQUIRE(col2.meas_start[0] == 0);
+        ublox_rawx_col_clear(&col2);
+        ublox_rawx_col_clear(&col);
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,67 @@
+/**
+ * \file    ubloxcol.h
+ * \brief   Columnar store of the RXM-RAWX observations
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_COL_H
+#define UBLOX_COL_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The observations are stored as one array per field. The measurements of
+ * the epoch i are [meas_start[i], meas_start[i+1]) of the measurement arrays,
+ * meas_start[num_epoch] is always num_meas.
+ */
+typedef struct _ublox_rawx_col_t {
+    size_t num_epoch;       /**< the number of epochs */
+    size_t max_epoch;       /**< the capacity of the epoch arrays */
+    double * rcvTow;
+    uint16_t * week;
+    int8_t * leapS;
+    uint8_t * recStat;
+    uint64_t * meas_start;  /**< the index of the first measurement of the epoch, (max_epoch + 1) items */
+
+    size_t num_meas;        /**< the number of measurements */
+    size_t max_meas;        /**< the capacity of the measurement arrays */
+    double * prMes;
+    double * cpMes;
+    float * doMes;
+    uint8_t * gnssId;
+    uint8_t * svId;
+    uint8_t * sigId;
+    uint8_t * freqId;
+    uint16_t * locktime;
+    uint8_t * cno;
+    uint8_t * prStdev;
+    uint8_t * cpStdev;
+    uint8_t * doStdev;
+    uint8_t * trkStat;
+} ublox_rawx_col_t;
+
+void ublox_rawx_col_init(ublox_rawx_col_t * col);
+void ublox_rawx_col_clear(ublox_rawx_col_t * col);
+void ublox_rawx_col_reset(ublox_rawx_col_t * col);
+int ublox_rawx_col_reserve(ublox_rawx_col_t * col, size_t max_epoch, size_t max_meas);
+int ublox_rawx_col_append(ublox_rawx_col_t * col, const uint8_t * payload, size_t sz_payload);
+int ublox_rawx_col_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+#define UBLOX_COL_MAGIC "UBXCOL\x00\x02" /**< the magic and the version of the columnar file */
+
+int ublox_rawx_col_save(const ublox_rawx_col_t * col, FILE * fp);
+int ublox_rawx_col_load(ublox_rawx_col_t * col, FILE * fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_COL_H */
@@ -9,6 +9,7 @@
 
 #include "ubloxconn.h"
 #include "ubloxcstr.h"
+#include "ubloxdec.h"
 
 #ifndef DEBUG
 #define DEBUG 0
@@ -40,6 +41,127 @@
 #endif // DEBUG
 
 
+/*****************************************************************************/
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * \brief reset the checksum state
+ * \param st: the state
+ */
+void
+ublox_cksum_init(ublox_cksum_t * st)
+{
+    assert (NULL != st);
+    st->ck_a = 0;
+    st->ck_b = 0;
+}
+
+/*
+ * The 8-bit Fletcher of a block x[0..n-1] can be added at once:
+ *   A' = A + sum(x[i])
+ *   B' = B + n * A + sum((n - i) * x[i])
+ * the sums are kept in 32 bits, only the low 8 bits are used at the end.
+ */
+
+#if defined(__SSE2__)
+/**
+ * \brief add the 16-byte blocks to the checksum by SSE2
+ * \return the byte size processed
+ */
+static size_t
+ublox_cksum_update_sse2(ublox_cksum_t * st, const uint8_t * buf, size_t sz)
+{
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128i v_wlo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i v_whi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    __m128i v_s = _mm_setzero_si128();  // sum of the bytes
+    __m128i v_ps = _mm_setzero_si128(); // sum of v_s of the previous blocks
+    __m128i v_w = _mm_setzero_si128();  // weighted sum in the block
+    __m128i v;
+    uint32_t tmp[4];
+    size_t num = sz / 16;
+    size_t i;
+    uint32_t sum_s;
+    uint32_t sum_ps;
+    uint32_t sum_w;
+
+    for (i = 0; i < num; i ++) {
+        v_ps = _mm_add_epi32(v_ps, v_s);
+        v = _mm_loadu_si128((const __m128i *)(buf + i * 16));
+        v_s = _mm_add_epi32(v_s, _mm_sad_epu8(v, v_zero));
+        v_w = _mm_add_epi32(v_w, _mm_add_epi32(
+            _mm_madd_epi16(_mm_unpacklo_epi8(v, v_zero), v_wlo),
+            _mm_madd_epi16(_mm_unpackhi_epi8(v, v_zero), v_whi)));
+    }
+    _mm_storeu_si128((__m128i *)tmp, v_s);
+    sum_s = tmp[0] + tmp[2];
+    _mm_storeu_si128((__m128i *)tmp, v_ps);
+    sum_ps = tmp[0] + tmp[2];
+    _mm_storeu_si128((__m128i *)tmp, v_w);
+    sum_w = tmp[0] + tmp[1] + tmp[2] + tmp[3];
+
+    st->ck_b += (uint32_t)(num * 16) * st->ck_a + 16 * sum_ps + sum_w;
+    st->ck_a += sum_s;
+    return num * 16;
+}
+#endif /* __SSE2__ */
+
+/**
+ * \brief add the data to the checksum
+ * \param st: the state
+ * \param buffer: the data
+ * \param sz: the byte size of the data
+ *
+ * The data of a packet can be fed in pieces as they arrive.
+ */
+void
+ublox_cksum_update(ublox_cksum_t * st, const uint8_t * buffer, size_t sz)
+{
+    uint32_t a;
+    uint32_t b;
+    size_t i = 0;
+
+    assert (NULL != st);
+    assert ((NULL != buffer) || (sz < 1));
+#if defined(__SSE2__)
+    if (sz >= 64) {
+        i = ublox_cksum_update_sse2(st, buffer, sz);
+    }
+#endif
+    a = st->ck_a;
+    b = st->ck_b;
+    // 8 bytes per step
+    for (; i + 8 <= sz; i += 8) {
+        const uint8_t * p = buffer + i;
+        b += 8 * a + 8 * (uint32_t)p[0] + 7 * (uint32_t)p[1] + 6 * (uint32_t)p[2] + 5 * (uint32_t)p[3]
+            + 4 * (uint32_t)p[4] + 3 * (uint32_t)p[5] + 2 * (uint32_t)p[6] + (uint32_t)p[7];
+        a += (uint32_t)p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+    }
+    for (; i < sz; i ++) {
+        a += buffer[i];
+        b += a;
+    }
+    st->ck_a = a;
+    st->ck_b = b;
+}
+
+/**
+ * \brief get the 2-byte checksum
+ * \param st: the state
+ * \param out_buf: 2-byte length buffer to store the checksum
+ */
+void
+ublox_cksum_final(const ublox_cksum_t * st, uint8_t * out_buf)
+{
+    assert (NULL != st);
+    assert (NULL != out_buf);
+    out_buf[0] = (uint8_t)(st->ck_a & 0xFF);
+    out_buf[1] = (uint8_t)(st->ck_b & 0xFF);
+}
+
 /*****************************************************************************/
 /**
  * \brief calculate the checksum of UBlox protocol packet
@@ -51,17 +173,13 @@
 void
 ublox_pkt_checksum(void *buffer, int length, uint8_t * out_buf)
 {
-    uint8_t *chk_a = out_buf;
-    uint8_t *chk_b = out_buf + 1;
-
-    int i;
+    ublox_cksum_t st;
     assert (NULL != buffer);
-    *chk_a = 0;
-    *chk_b = 0;
-    for (i = 0; i < length; i++) {
-        *chk_a += ((unsigned char*) buffer)[i];
-        *chk_b += *chk_a;
+    ublox_cksum_init(&st);
+    if (length > 0) {
+        ublox_cksum_update(&st, (const uint8_t *)buffer, length);
     }
+    ublox_cksum_final(&st, out_buf);
 }
 
 /**
@@ -89,12 +207,16 @@ ublox_pkt_verify (uint8_t *buffer, size_t sz_buf)
         return -1;
     }
     count = UBLOX_PKG_LENGTH(buffer);
+    if (sz_buf < UBLOX_PKT_LENGTH_MIN + (size_t)count) {
+        TE("Verify error: packet size %" PRIuSZ " < %d.\n", sz_buf, UBLOX_PKT_LENGTH_MIN + count);
+        return -1;
+    }
     ublox_pkt_checksum(buffer + 2, 4 + count, chksum);
     if ((chksum[0] == *(buffer + 6 + count)) && (chksum[1] == *(buffer + 6 + count + 1))) {
         return 0;
     }
 
-    TE("Verify error: checksum. sz_buf=" PRIuSZ ",count=%d, expected=0x%02X%02X, got=0x%02X%02X\n", sz_buf, count, *(buffer + 6 + count), *(buffer + 6 + count + 1), chksum[0], chksum[1]);
+    TE("Verify error: checksum. sz_buf=%" PRIuSZ ",count=%d, expected=0x%02X%02X, got=0x%02X%02X\n", sz_buf, count, *(buffer + 6 + count), *(buffer + 6 + count + 1), chksum[0], chksum[1]);
     return -1;
 }
 
@@ -172,6 +294,43 @@ TEST_CASE( .name="ublox-checksum", .description="Test ublox checksum functions."
         REQUIRE(UBLOX_PKG_LENGTH(buffer) == 260);
         ublox_pkt_checksum(buffer + 2, 4 + UBLOX_PKG_LENGTH(buffer), buffer + 6 + UBLOX_PKG_LENGTH(buffer));
         REQUIRE(ublox_pkt_verify(buffer, 8 + UBLOX_PKG_LENGTH(buffer) + 10000) == 0);
+        REQUIRE(ublox_pkt_verify(buffer, 8 + UBLOX_PKG_LENGTH(buffer) - 1) < 0);
+    }
+    SECTION("test ublox checksum incremental") {
+        uint8_t data[1000];
+        uint8_t ck_ref[2];
+        uint8_t ck[2];
+        ublox_cksum_t st;
+        size_t sz;
+        size_t i;
+        size_t j;
+
+        for (i = 0; i < sizeof(data); i ++) {
+            data[i] = (uint8_t)(i * 131 + (i >> 3) * 7 + 0xA5);
+        }
+        for (sz = 0; sz < sizeof(data); sz += 37) {
+            // the byte by byte Fletcher
+            ck_ref[0] = 0;
+            ck_ref[1] = 0;
+            for (i = 0; i < sz; i ++) {
+                ck_ref[0] += data[i];
+                ck_ref[1] += ck_ref[0];
+            }
+            ublox_cksum_init(&st);
+            ublox_cksum_update(&st, data, sz);
+            ublox_cksum_final(&st, ck);
+            REQUIRE(ck[0] == ck_ref[0]);
+            REQUIRE(ck[1] == ck_ref[1]);
+
+            // feed in pieces
+            ublox_cksum_init(&st);
+            for (i = 0, j = 1; i < sz; i += j, j = (j * 3) % 97 + 1) {
+                ublox_cksum_update(&st, data + i, ((i + j > sz)?(sz - i):j));
+            }
+            ublox_cksum_final(&st, ck);
+            REQUIRE(ck[0] == ck_ref[0]);
+            REQUIRE(ck[1] == ck_ref[1]);
+        }
     }
 }
 #endif /* CIUT_ENABLED */
@@ -924,6 +1083,263 @@ TEST_CASE( .name="ublox-ext", .description="Test ublox ublox_pkt_create_get_vers
 
 /*****************************************************************************/
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UBLOX_SYNC_USE_X86 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__ARM_NEON) && defined(__aarch64__)
+#define UBLOX_SYNC_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef size_t (* ublox_sync_find_t)(const uint8_t * buffer_in, size_t sz_in);
+
+/**
+ * \brief find the header 0xB5 0x62 byte by byte
+ * \param buffer_in: the buffer
+ * \param sz_in: the byte size of the buffer
+ *
+ * \return the offset of the header, or the offset of the last byte if it's 0xB5, or sz_in if not found
+ */
+static size_t
+ublox_sync_find_scalar(const uint8_t * buffer_in, size_t sz_in)
+{
+    const uint8_t *p = buffer_in;
+    const uint8_t *p_end = buffer_in + sz_in;
+
+    for (; p < p_end; p ++) {
+        p = memchr(p, 0xB5, p_end - p);
+        if (NULL == p) {
+            return sz_in;
+        }
+        if ((p + 1 >= p_end) || (*(p+1) == 0x62)) {
+            return p - buffer_in;
+        }
+    }
+    return sz_in;
+}
+
+#if defined(UBLOX_SYNC_USE_X86)
+__attribute__((target("sse2")))
+static size_t
+ublox_sync_find_sse2(const uint8_t * buffer_in, size_t sz_in)
+{
+    const __m128i v_b5 = _mm_set1_epi8((char)0xB5);
+    const __m128i v_62 = _mm_set1_epi8((char)0x62);
+    size_t i;
+    size_t ret;
+    unsigned int mask;
+
+    // compare the byte i and the byte i+1 of 16 positions at once
+    for (i = 0; i + 16 + 1 <= sz_in; i += 16) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(buffer_in + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(buffer_in + i + 1));
+        mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(v0, v_b5), _mm_cmpeq_epi8(v1, v_62)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    ret = ublox_sync_find_scalar(buffer_in + i, sz_in - i);
+    return i + ret;
+}
+
+__attribute__((target("avx2")))
+static size_t
+ublox_sync_find_avx2(const uint8_t * buffer_in, size_t sz_in)
+{
+    const __m256i v_b5 = _mm256_set1_epi8((char)0xB5);
+    const __m256i v_62 = _mm256_set1_epi8((char)0x62);
+    size_t i;
+    size_t ret;
+    unsigned int mask;
+
+    for (i = 0; i + 32 + 1 <= sz_in; i += 32) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(buffer_in + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(buffer_in + i + 1));
+        mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(v0, v_b5), _mm256_cmpeq_epi8(v1, v_62)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    ret = ublox_sync_find_scalar(buffer_in + i, sz_in - i);
+    return i + ret;
+}
+#endif /* UBLOX_SYNC_USE_X86 */
+
+#if defined(UBLOX_SYNC_USE_NEON)
+static size_t
+ublox_sync_find_neon(const uint8_t * buffer_in, size_t sz_in)
+{
+    const uint8x16_t v_b5 = vdupq_n_u8(0xB5);
+    const uint8x16_t v_62 = vdupq_n_u8(0x62);
+    size_t i;
+    size_t ret;
+    uint64_t mask;
+
+    for (i = 0; i + 16 + 1 <= sz_in; i += 16) {
+        uint8x16_t v0 = vld1q_u8(buffer_in + i);
+        uint8x16_t v1 = vld1q_u8(buffer_in + i + 1);
+        uint8x16_t veq = vandq_u8(vceqq_u8(v0, v_b5), vceqq_u8(v1, v_62));
+        // narrow to 4 bits per byte
+        mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(veq), 4)), 0);
+        if (mask) {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+    ret = ublox_sync_find_scalar(buffer_in + i, sz_in - i);
+    return i + ret;
+}
+#endif /* UBLOX_SYNC_USE_NEON */
+
+static ublox_sync_find_t g_ublox_sync_find = NULL;
+static int g_ublox_sync_impl = UBLOX_SYNC_IMPL_AUTO;
+
+/**
+ * \brief the name of the implementation of the header search
+ * \param impl: UBLOX_SYNC_IMPL_xxx
+ *
+ * \return the name
+ */
+const char *
+ublox_pkt_sync_impl_name(int impl)
+{
+    switch (impl) {
+    case UBLOX_SYNC_IMPL_AUTO:   return "auto";
+    case UBLOX_SYNC_IMPL_SCALAR: return "scalar";
+    case UBLOX_SYNC_IMPL_SSE2:   return "sse2";
+    case UBLOX_SYNC_IMPL_AVX2:   return "avx2";
+    case UBLOX_SYNC_IMPL_NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+/**
+ * \brief select the implementation of the header search
+ * \param impl: UBLOX_SYNC_IMPL_xxx, UBLOX_SYNC_IMPL_AUTO to select the best one supported by the CPU
+ *
+ * \return the implementation selected, <0 if the implementation is not supported by this CPU
+ */
+int
+ublox_pkt_sync_impl_select(int impl)
+{
+    if (UBLOX_SYNC_IMPL_AUTO == impl) {
+        impl = UBLOX_SYNC_IMPL_SCALAR;
+#if defined(UBLOX_SYNC_USE_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            impl = UBLOX_SYNC_IMPL_AVX2;
+        } else if (__builtin_cpu_supports("sse2")) {
+            impl = UBLOX_SYNC_IMPL_SSE2;
+        }
+#elif defined(UBLOX_SYNC_USE_NEON)
+        impl = UBLOX_SYNC_IMPL_NEON;
+#endif
+    }
+    switch (impl) {
+    case UBLOX_SYNC_IMPL_SCALAR:
+        g_ublox_sync_find = ublox_sync_find_scalar;
+        break;
+#if defined(UBLOX_SYNC_USE_X86)
+    case UBLOX_SYNC_IMPL_SSE2:
+        __builtin_cpu_init();
+        if (! __builtin_cpu_supports("sse2")) {
+            return -1;
+        }
+        g_ublox_sync_find = ublox_sync_find_sse2;
+        break;
+    case UBLOX_SYNC_IMPL_AVX2:
+        __builtin_cpu_init();
+        if (! __builtin_cpu_supports("avx2")) {
+            return -1;
+        }
+        g_ublox_sync_find = ublox_sync_find_avx2;
+        break;
+#endif
+#if defined(UBLOX_SYNC_USE_NEON)
+    case UBLOX_SYNC_IMPL_NEON:
+        g_ublox_sync_find = ublox_sync_find_neon;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    g_ublox_sync_impl = impl;
+    TD("ublox sync search: %s", ublox_pkt_sync_impl_name(impl));
+    return impl;
+}
+
+/**
+ * \brief find the header 0xB5 0x62 of UBX packet
+ * \param buffer_in: the buffer
+ * \param sz_in: the byte size of the buffer
+ *
+ * \return the offset of the header;
+ *         the offset of the last byte if it's 0xB5 (the header may be completed by the next data);
+ *         sz_in if not found
+ *
+ * The implementation (SSE2/AVX2/NEON/scalar) is selected at the first call.
+ */
+size_t
+ublox_pkt_find_sync(const uint8_t * buffer_in, size_t sz_in)
+{
+    if (NULL == g_ublox_sync_find) {
+        ublox_pkt_sync_impl_select(UBLOX_SYNC_IMPL_AUTO);
+    }
+    return g_ublox_sync_find(buffer_in, sz_in);
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+TEST_CASE( .name="ublox-find-sync", .description="Test ublox header search functions." ) {
+    uint8_t buffer[300];
+    size_t i;
+    size_t j;
+    size_t off;
+    int impl;
+
+    SECTION("test ublox_pkt_find_sync scalar") {
+        REQUIRE(UBLOX_SYNC_IMPL_SCALAR == ublox_pkt_sync_impl_select(UBLOX_SYNC_IMPL_SCALAR));
+        REQUIRE(0 == ublox_pkt_find_sync(buffer, 0));
+        buffer[0] = 0xB5;
+        REQUIRE(0 == ublox_pkt_find_sync(buffer, 1));
+        buffer[1] = 0x00;
+        REQUIRE(2 == ublox_pkt_find_sync(buffer, 2));
+        buffer[1] = 0x62;
+        REQUIRE(0 == ublox_pkt_find_sync(buffer, 2));
+    }
+    SECTION("test ublox_pkt_find_sync implementations") {
+        // noisy data with a lot of 0xB5
+        for (i = 0; i < sizeof(buffer); i ++) {
+            buffer[i] = ((i * 7) % 3)?0xB5:(uint8_t)(i * 13);
+            if (buffer[i] == 0x62) {
+                buffer[i] = 0x00;
+            }
+        }
+        for (impl = UBLOX_SYNC_IMPL_SCALAR; impl <= UBLOX_SYNC_IMPL_NEON; impl ++) {
+            if (0 > ublox_pkt_sync_impl_select(impl)) {
+                continue;
+            }
+            CIUT_LOG("check %s", ublox_pkt_sync_impl_name(impl));
+            for (j = 0; j < 70; j ++) {
+                // the header at j, the search begins at any position before j
+                buffer[j] = 0xB5;
+                buffer[j + 1] = 0x62;
+                for (i = 0; i <= j; i ++) {
+                    REQUIRE(j - i == ublox_pkt_find_sync(buffer + i, sizeof(buffer) - i));
+                    REQUIRE(j - i == ublox_pkt_find_sync(buffer + i, j - i + 2));
+                    off = ublox_pkt_find_sync(buffer + i, j - i + 1);
+                    REQUIRE(j - i == off);
+                }
+                buffer[j + 1] = 0x00;
+            }
+            off = ublox_pkt_find_sync(buffer, sizeof(buffer) - 1);
+            REQUIRE((off == sizeof(buffer) - 1) || (off == sizeof(buffer) - 2));
+        }
+        REQUIRE(0 < ublox_pkt_sync_impl_select(UBLOX_SYNC_IMPL_AUTO));
+    }
+}
+#endif /* CIUT_ENABLED */
+
 /**
  * \brief ignore any data until reach to the header of UBX packet
  * \param buffer_in: the buffer contains received packets
@@ -947,53 +1363,47 @@ ublox_pkt_nexthdr_ubx(uint8_t * buffer_in, size_t sz_in, size_t * sz_processed,
     *sz_processed = 0;
     *sz_needed_in = 0;
 
-    p = buffer_in;
+    if (sz_in < 1) {
+        return -1;
+    }
     p_end = buffer_in + sz_in;
-    for (; p < p_end;) {
-        p = memchr(p, 0xB5, p_end - p);
-        if ((p >= p_end) || (p == 0)) {
-            *sz_processed = sz_in;
-            *sz_needed_in = UBLOX_PKT_LENGTH_MIN;
-            assert(*sz_processed <= sz_in);
-            return 1;
-        }
-        if (p + 1 >= p_end) {
-            assert (p + 1 == p_end);
-            *sz_processed = p - buffer_in;
-            *sz_needed_in = UBLOX_PKT_LENGTH_MIN - (sz_in - *sz_processed);
-            assert ((sz_in - *sz_processed) == 1);
-            assert(*sz_processed <= sz_in);
-            return 1;
-        }
-        if (*(p+1) != 0x62) {
-            // search again
-            p ++;
-            continue;
-        }
+    p = buffer_in + ublox_pkt_find_sync(buffer_in, sz_in);
+    if (p >= p_end) {
+        *sz_processed = sz_in;
+        *sz_needed_in = UBLOX_PKT_LENGTH_MIN;
+        assert(*sz_processed <= sz_in);
+        return 1;
+    }
+    if (p + 1 >= p_end) {
+        assert (p + 1 == p_end);
         *sz_processed = p - buffer_in;
-        if (*sz_processed > sz_in) {
-            *sz_processed = sz_in;
-        }
+        *sz_needed_in = UBLOX_PKT_LENGTH_MIN - (sz_in - *sz_processed);
+        assert ((sz_in - *sz_processed) == 1);
         assert(*sz_processed <= sz_in);
-        *sz_needed_in = 0;
-        if (p_end - p < UBLOX_PKT_LENGTH_HDR) {
-            // no length
-            *sz_needed_in = UBLOX_PKT_LENGTH_MIN - (sz_in - *sz_processed);;
-        } else {
-            // get the length
-            uint16_t len;
-            len = UBLOX_PKG_LENGTH(p);
-            if (sz_in - *sz_processed < UBLOX_PKT_LENGTH_MIN + len) {
-                *sz_needed_in = UBLOX_PKT_LENGTH_MIN - (sz_in - *sz_processed) + len;
-            }
-        }
-        if (*sz_needed_in > 0) {
-            return 1;
-        }
-        return 0;
+        return 1;
+    }
+    assert (*(p+1) == 0x62);
+    *sz_processed = p - buffer_in;
+    if (*sz_processed > sz_in) {
+        *sz_processed = sz_in;
     }
     assert(*sz_processed <= sz_in);
-    return -1;
+    *sz_needed_in = 0;
+    if (p_end - p < UBLOX_PKT_LENGTH_HDR) {
+        // no length
+        *sz_needed_in = UBLOX_PKT_LENGTH_MIN - (sz_in - *sz_processed);;
+    } else {
+        // get the length
+        uint16_t len;
+        len = UBLOX_PKG_LENGTH(p);
+        if (sz_in - *sz_processed < UBLOX_PKT_LENGTH_MIN + len) {
+            *sz_needed_in = UBLOX_PKT_LENGTH_MIN - (sz_in - *sz_processed) + len;
+        }
+    }
+    if (*sz_needed_in > 0) {
+        return 1;
+    }
+    return 0;
 }
 
 #if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
@@ -1044,6 +1454,216 @@ TEST_CASE( .name="test ublox_pkt_nexthdr_ubx", .description="Test ublox inner fu
 }
 #endif /* CIUT_ENABLED */
 
+/**
+ * \brief scan the buffer once and index all of the UBX packets in it
+ * \param buffer_in: the buffer contains received packets
+ * \param sz_in: the byte size of the received packets
+ * \param frames: the caller provided array to store the descriptors of the packets
+ * \param max_frames: the max number of items in frames
+ * \param pnum_frames: the number of descriptors stored in frames
+ *
+ * \return the offset of the tail which was not indexed, the caller should keep
+ *         the data from this offset and append more data to it.
+ *
+ * The bytes before a sync word are skipped. A packet with a wrong checksum is
+ * also stored, with flg_ckok=0, and the scan goes on from the byte next to its
+ * sync word, since the sync word may be a part of the garbage data.
+ * The scan stops when the array is full or a packet is not complete.
+ */
+size_t
+ublox_pkt_index_frames(const uint8_t * buffer_in, size_t sz_in, ublox_frame_t * frames, size_t max_frames, size_t * pnum_frames)
+{
+    ublox_cksum_t st;
+    uint8_t chksum[2];
+    size_t pos = 0;
+    size_t num = 0;
+    size_t sz_frame;
+
+    assert (NULL != pnum_frames);
+    assert ((NULL != frames) || (max_frames < 1));
+    *pnum_frames = 0;
+    if ((NULL == buffer_in) || (sz_in < 1)) {
+        return 0;
+    }
+    while (num < max_frames) {
+        pos += ublox_pkt_find_sync(buffer_in + pos, sz_in - pos);
+        if (sz_in - pos < UBLOX_PKT_LENGTH_HDR) {
+            break;
+        }
+        sz_frame = UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in + pos);
+        if (sz_in - pos < sz_frame) {
+            break;
+        }
+        ublox_cksum_init(&st);
+        ublox_cksum_update(&st, buffer_in + pos + 2, sz_frame - 4);
+        ublox_cksum_final(&st, chksum);
+
+        frames[num].offset = pos;
+        frames[num].length = sz_frame;
+        frames[num].classid = UBLOX_CLASS_ID(buffer_in[pos + 2], buffer_in[pos + 3]);
+        frames[num].flg_ckok = ((chksum[0] == buffer_in[pos + sz_frame - 2]) && (chksum[1] == buffer_in[pos + sz_frame - 1]));
+        if (frames[num].flg_ckok) {
+            pos += sz_frame;
+        } else {
+            pos ++;
+        }
+        num ++;
+    }
+    *pnum_frames = num;
+    assert (pos <= sz_in);
+    return pos;
+}
+
+/**
+ * \brief find the first complete UBX packet with the correct checksum
+ * \param buffer_in: the buffer contains received packets
+ * \param sz_in: the byte size of the received packets
+ *
+ * \return the offset of the packet, sz_in if not found
+ *
+ * It is used to resynchronize at an arbitrary position of a stream, such as
+ * the start of a chunk of a file, where a sync word may be a part of data.
+ */
+size_t
+ublox_pkt_find_verified(const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_cksum_t st;
+    uint8_t chksum[2];
+    size_t pos = 0;
+    size_t sz_frame;
+
+    for (; pos < sz_in; pos ++) {
+        pos += ublox_pkt_find_sync(buffer_in + pos, sz_in - pos);
+        if (sz_in - pos < UBLOX_PKT_LENGTH_MIN) {
+            break;
+        }
+        sz_frame = UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in + pos);
+        if (sz_in - pos < sz_frame) {
+            continue;
+        }
+        ublox_cksum_init(&st);
+        ublox_cksum_update(&st, buffer_in + pos + 2, sz_frame - 4);
+        ublox_cksum_final(&st, chksum);
+        if ((chksum[0] == buffer_in[pos + sz_frame - 2]) && (chksum[1] == buffer_in[pos + sz_frame - 1])) {
+            return pos;
+        }
+    }
+    return sz_in;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+TEST_CASE( .name="ublox-index-frames", .description="Test ublox batch frame indexer." ) {
+    uint8_t buffer[200];
+    ublox_frame_t frames[8];
+    size_t num_frames;
+    size_t pos;
+    ssize_t ret;
+    size_t sz_buf = 0;
+    size_t off_ver;
+    size_t off_hw;
+    size_t off_bad;
+    size_t off_rate;
+    size_t off_tail;
+
+    SECTION("test ublox_pkt_index_frames") {
+        // garbage + MON-VER + CFG-RATE + garbage + MON-HW + bad CFG-RATE + partial CFG-RATE
+        memset(buffer, 0, sizeof(buffer));
+        buffer[sz_buf ++] = 0x00;
+        buffer[sz_buf ++] = 0xB5;
+        buffer[sz_buf ++] = 0x07;
+        off_ver = sz_buf;
+        ret = ublox_pkt_create_get_version(buffer + sz_buf, sizeof(buffer) - sz_buf);
+        REQUIRE(ret > 0);
+        sz_buf += ret;
+        off_rate = sz_buf;
+        ret = ublox_pkt_create_set_cfgrate(buffer + sz_buf, sizeof(buffer) - sz_buf, 1000, 1, 1);
+        REQUIRE(ret > 0);
+        sz_buf += ret;
+        buffer[sz_buf ++] = 0x27;
+        off_hw = sz_buf;
+        ret = ublox_pkt_create_get_hw(buffer + sz_buf, sizeof(buffer) - sz_buf);
+        REQUIRE(ret > 0);
+        sz_buf += ret;
+        off_bad = sz_buf;
+        ret = ublox_pkt_create_set_cfgrate(buffer + sz_buf, sizeof(buffer) - sz_buf, 1000, 1, 1);
+        REQUIRE(ret > 0);
+        buffer[sz_buf + ret - 1] ^= 0xFF;
+        sz_buf += ret;
+        off_tail = sz_buf;
+        ret = ublox_pkt_create_set_cfgrate(buffer + sz_buf, sizeof(buffer) - sz_buf, 1000, 1, 1);
+        REQUIRE(ret > 0);
+        sz_buf += ret - 3;
+
+        pos = ublox_pkt_index_frames(buffer, sz_buf, frames, NUM_ARRAY(frames), &num_frames);
+        CIUT_LOG("index frames: pos=%" PRIuSZ ", num=%" PRIuSZ, pos, num_frames);
+        REQUIRE(pos == off_tail);
+        REQUIRE(num_frames == 4);
+        REQUIRE(frames[0].offset == off_ver);
+        REQUIRE(frames[0].length == 8);
+        REQUIRE(frames[0].classid == UBX_MON_VER);
+        REQUIRE(frames[0].flg_ckok == 1);
+        REQUIRE(frames[1].offset == off_rate);
+        REQUIRE(frames[1].length == 14);
+        REQUIRE(frames[1].classid == UBX_CFG_RATE);
+        REQUIRE(frames[1].flg_ckok == 1);
+        REQUIRE(frames[2].offset == off_hw);
+        REQUIRE(frames[2].classid == UBX_MON_HW);
+        REQUIRE(frames[2].flg_ckok == 1);
+        REQUIRE(frames[3].offset == off_bad);
+        REQUIRE(frames[3].classid == UBX_CFG_RATE);
+        REQUIRE(frames[3].flg_ckok == 0);
+
+        // the array is full
+        pos = ublox_pkt_index_frames(buffer, sz_buf, frames, 2, &num_frames);
+        REQUIRE(num_frames == 2);
+        REQUIRE(pos == off_hw - 1);
+
+        // no sync word
+        pos = ublox_pkt_index_frames(buffer, 2, frames, NUM_ARRAY(frames), &num_frames);
+        REQUIRE(num_frames == 0);
+        REQUIRE(pos == 1);
+        pos = ublox_pkt_index_frames(buffer, 1, frames, NUM_ARRAY(frames), &num_frames);
+        REQUIRE(num_frames == 0);
+        REQUIRE(pos == 1);
+    }
+
+    SECTION("test ublox_pkt_find_verified") {
+        // garbage sync word + bad CFG-RATE + MON-VER
+        memset(buffer, 0, sizeof(buffer));
+        sz_buf = 0;
+        buffer[sz_buf ++] = 0xB5;
+        buffer[sz_buf ++] = 0x62;
+        buffer[sz_buf ++] = 0x06;
+        off_bad = sz_buf;
+        ret = ublox_pkt_create_set_cfgrate(buffer + sz_buf, sizeof(buffer) - sz_buf, 1000, 1, 1);
+        REQUIRE(ret > 0);
+        buffer[sz_buf + ret - 2] ^= 0xFF;
+        sz_buf += ret;
+        off_ver = sz_buf;
+        ret = ublox_pkt_create_get_version(buffer + sz_buf, sizeof(buffer) - sz_buf);
+        REQUIRE(ret > 0);
+        sz_buf += ret;
+
+        REQUIRE(ublox_pkt_find_verified(buffer, sz_buf) == off_ver);
+        REQUIRE(ublox_pkt_find_verified(buffer + off_ver, sz_buf - off_ver) == 0);
+        REQUIRE(ublox_pkt_find_verified(buffer, sz_buf - 1) == sz_buf - 1);
+        REQUIRE(ublox_pkt_find_verified(buffer, off_bad) == off_bad);
+    }
+}
+#endif /* CIUT_ENABLED */
+
+/**
+ * \brief get the byte size of the packet
+ * \param buffer_in: the buffer contains the header of the packet
+ * \param sz_in: the byte size of the buffer
+ *
+ * \return the byte size of the packet, 0 or 1 if it's not a packet
+ *
+ * The size comes from the length field, the layout of the payload is checked
+ * by the decoders.
+ */
 size_t
 ublox_pkt_expected_size(uint8_t * buffer_in, size_t sz_in)
 {
@@ -1055,37 +1675,7 @@ ublox_pkt_expected_size(uint8_t * buffer_in, size_t sz_in)
     if (buffer_in[1] != 0x62) {
         return 1;
     }
-    // check class,id
-    size_t sz = 8+UBLOX_PKG_LENGTH(buffer_in);
-    switch (UBLOX_CLASS_ID(buffer_in[2], buffer_in[3])) {
-    case UBX_MON_VER: break;
-    case UBX_MON_HW:  if (UBLOX_PKG_LENGTH(buffer_in)) sz=8+68; break;
-    case UBX_MON_HW2: if (UBLOX_PKG_LENGTH(buffer_in)) sz=8+28; break;
-    case UBX_MON_RXR: sz=8+1; break;
-    case UBX_ACK_ACK: sz=8+2; break;
-    case UBX_ACK_NAK: sz=8+2; break;
-    case UBX_CFG_MSG: sz=8+2; break;
-    case UBX_RXM_RAW:
-        sz = 8 + 8 + buffer_in[6+6];
-        break;
-    case UBX_RXM_SFRB: sz=8+42; break;
-    case UBX_UPD_DOWNL: sz=8+16; break;
-    }
-
-    return sz;
-}
-
-static char * ublox_val2cstr_gnss(int gnss)
-{
-    switch (gnss) {
-        case 0: return "GPS";
-        case 1: return "SBS";
-        case 2: return "GAL";
-        case 3: return "CMP"; // beidou
-        case 5: return "QZS";
-        case 6: return "GLO";
-    }
-    return "UNKNOWN_GNSS";
+    return UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in);
 }
 
 /**
@@ -1104,10 +1694,8 @@ int
 ublox_cli_verify_tcp(uint8_t * buffer_in, size_t sz_in, size_t * sz_processed, size_t * sz_needed_in)
 {
     size_t sz;
-    int i;
-    uint8_t *p;
+    int ret;
     uint16_t classid;
-    uint8_t status;
     uint16_t count;
 
     assert (sz_processed != nullptr);
@@ -1168,1070 +1756,8 @@ ublox_cli_verify_tcp(uint8_t * buffer_in, size_t sz_in, size_t * sz_processed, s
 
     TD("ublox info: received %s, value: 0x%04X\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]), classid);
 
-    p = buffer_in + 6;
-
-    fprintf(stdout, "ublox %s:\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]));
-    switch (classid) {
-    case UBX_MON_VER:
-    {
-        char buf[40];
-        assert(sizeof(buf)-1 >= 30);
-        //fprintf(stdout, "ublox firmware version:\n");
-
-        if (count == 0) {
-            // query
-            fprintf(stdout, "\t(type): Poll Receiver/Software Version\n");
-            break;
-        } else {
-            fprintf(stdout, "\t(type): Receiver/Software Version\n");
-        }
-
-#define LEN_SEG 30
-        buf[0] = 0;
-        strncpy(buf, buffer_in + 6, LEN_SEG);
-        buf[LEN_SEG] = 0;
-        fprintf(stdout, "\tswVersion: %s\n", buf);
-#undef LEN_SEG
-
-#define LEN_SEG 10
-        buf[0] = 0;
-        strncpy(buf, buffer_in + 6 + 30, LEN_SEG);
-        buf[LEN_SEG] = 0;
-        fprintf(stdout, "\thwVersion: %s\n", buf);
-#undef LEN_SEG
-
-        if (count >= 30 + 10 + 30) {
-#define LEN_SEG 30
-            buf[0] = 0;
-            strncpy(buf, buffer_in + 6 + 30 + 10, LEN_SEG);
-            buf[LEN_SEG] = 0;
-            fprintf(stdout, "\tromVersion: %s\n", buf);
-#undef LEN_SEG
-        }
-
-#define LEN_SEG 30
-        for (i = 0; 30 + 10 + 30 + i * 30 + 30 <= count; i ++) {
-            buf[0] = 0;
-            strncpy(buf, buffer_in + 6 + 30 + 10 + 30 + i * 30, LEN_SEG);
-            buf[LEN_SEG] = 0;
-            fprintf(stdout, "\textPackageVer[%d]: %s\n", i, buf);
-        }
-#undef LEN_SEG
-    }
-        break;
-
-
-// little endian
-#define U32_LE(p) ( \
-    (uint32_t)(*((uint8_t *)(p) + 0)) \
-    | ((uint32_t)(*((uint8_t *)(p) + 1)) << 8) \
-    | ((uint32_t)(*((uint8_t *)(p) + 2)) << 16) \
-    | ((uint32_t)(*((uint8_t *)(p) + 3)) << 24) \
-    )
-#define U16_LE(p) ( \
-    (uint16_t)(*((uint8_t *)(p) + 0)) \
-    | ((uint16_t)(*((uint8_t *)(p) + 1)) << 8) \
-    )
-
-    case UBX_MON_HW:
-    {
-        uint32_t val32;
-        uint16_t val16;
-        //fprintf(stdout, "ublox hardware version:\n");
-
-        if (count == 0) {
-            // query
-            fprintf(stdout, "\t(type): Poll Hardware Status\n");
-            break;
-        } else {
-            fprintf(stdout, "\t(type): Hardware Status\n");
-        }
-        assert(count == 68);
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpinSel: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpinBank: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpinDir: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpinVal: %08X\n", val32);
-        p += 4;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tnoisePerMS: %04X\n", val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tagcCnt: %04X\n", val16);
-        p += 2;
-
-        fprintf(stdout, "\taStatus: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\taPower: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tflags: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\treserved1: %02X\n", *p);
-        p += 1;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tusedMask: %08X\n", val32);
-        p += 4;
-
-        fprintf(stdout, "\tVP: sz=%d\n", 25);
-        //hex_dump_to_fd(STDERR_FILENO, p, 25);
-        hex_dump_to_fp(stderr, p, 25);
-        p += 25;
-
-        fprintf(stdout, "\tjamInd: %02X\n", *p);
-        p += 1;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\treserved3: %04X\n", val16);
-        p += 2;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpinIrq: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpullH: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpullL: %08X\n", val32);
-        p += 4;
-    }
-        break;
-
-    case UBX_MON_HW2:
-    {
-        uint32_t val32;
-        //fprintf(stdout, "ublox hardware version 2:\n");
-
-        if (count == 0) {
-            // query
-            fprintf(stdout, "\t(type): Poll Extended Hardware Status\n");
-            break;
-        } else {
-            fprintf(stdout, "\t(type): Extended Hardware Status\n");
-        }
-        assert(count == 68);
-
-        fprintf(stdout, "\tofsI: %d\n", *((char *)p) );
-        p += 1;
-
-        fprintf(stdout, "\tmagI: %d\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tofsQ: %d\n", *((char *)p) );
-        p += 1;
-
-        fprintf(stdout, "\tmagQ: %d\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tcfgSource: %d\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\treserved0: sz=%d\n", 3);
-        //hex_dump_to_fd(STDERR_FILENO, p, 3);
-        hex_dump_to_fp(stderr, p, 3);
-        p += 3;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tlowLevCfg: %08X\n", val32);
-        p += 4;
-
-        fprintf(stdout, "\treserved1: sz=%d\n", 8);
-        //hex_dump_to_fd(STDERR_FILENO, p, 8);
-        hex_dump_to_fp(stderr, p, 8);
-        p += 8;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tpostStatus: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\treserved2: %08X\n", val32);
-        p += 4;
-    }
-        break;
-
-    case UBX_ACK_ACK:
-    {
-        assert(count == 2);
-
-        //fprintf(stdout, "ublox ACK:\n");
-
-        fprintf(stdout, "\tclsID: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tmsgID: %02X\n", *p);
-        p += 1;
-    }
-        break;
-
-    case UBX_ACK_NAK:
-    {
-        assert(count == 2);
-
-        //fprintf(stdout, "ublox NAK:\n");
-
-        fprintf(stdout, "\tclsID: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tmsgID: %02X\n", *p);
-        p += 1;
-    }
-        break;
-
-    case UBX_UPD_DOWNL:
-    {
-        uint32_t val32;
-
-        //fprintf(stdout, "ublox !UBX UPD-DOWNL:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tStartAddr: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tFlags: %08X (%s)\n", val32, (val32?((val32 == 1)?"Download ACK":"Download NACK"):"Download"));
-        p += 4;
-
-        for (i = 0; p < buffer_in + 6 + count; i ++) {
-            fprintf(stdout, "\tdata[%d]: %02X\n", i, *p);
-            p += 1;
-        }
-    }
-        break;
-
-    case UBX_UPD_UPLOAD:
-    {
-        uint32_t val32;
-
-        //fprintf(stdout, "ublox !UBX UPD-UPLOAD:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tStartAddr: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tSize: %d\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tFlags: %08X (%s)\n", val32, (val32?((val32 == 1)?"Upload ACK":"Upload NACK"):"Upload"));
-        p += 4;
-
-        for (i = 0; p < buffer_in + 6 + count; i ++) {
-            fprintf(stdout, "\tdata[%d]: %02X\n", i, *p);
-            p += 1;
-        }
-    }
-        break;
-
-    case UBX_UPD_EXEC:
-    {
-        uint32_t val32;
-        assert(count == 8);
-
-        //fprintf(stdout, "ublox !UBX UPD-EXEC:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tStartAddr: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tFlags: %08X (%s%s%s%s%s)\n"
-                , val32
-                , ((val32 & 0x01)?"Execution,":"Do not Execute")
-                , ((val32 & 0x02)?"ACK,":"")
-                , ((val32 & 0x04)?"NACK,":"")
-                , ((val32 & 0x08)?"IRQs and FIQ enabled,":"IRQs and FIQ disabled")
-                , ((val32 & 0x10)?"Reset after execution":"")
-                );
-        p += 4;
-    }
-        break;
-
-    case UBX_UPD_MEMCPY:
-    {
-        uint32_t val32;
-        assert(count == 16);
-
-        //fprintf(stdout, "ublox !UBX UPD-MEMCPY:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tStartAddr: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tDestAddr: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tSize: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tFlags: %08X (%s%s%s%s%s)\n"
-                , val32
-                , ((val32 & 0x01)?"Copy,":"Do not Copy")
-                , ((val32 & 0x02)?"ACK,":"")
-                , ((val32 & 0x04)?"NACK,":"")
-                , ((val32 & 0x09)?"IRQs and FIQ enabled,":"IRQs and FIQ disabled")
-                , ((val32 & 0x10)?"Reset after execution":"")
-               );
-        p += 4;
-    }
-        break;
-
-    case UBX_UPD_SOS:
-    {
-        uint8_t val8;
-        //fprintf(stdout, "ublox !UBX UPD-SOS:\n");
-
-        if (count == 0) {
-            // query
-            fprintf(stdout, "\t(type): Poll Backup File Restore Status\n");
-            break;
-        }
-        val8 = *p;
-        switch (val8) {
-        case 0:
-            fprintf(stdout, "\t(type): Create Backup File in Flash\n");
-            fprintf(stdout, "\tcmd: %02X\n", *p);
-            p += 1;
-            // reserved
-            p += 3;
-            break;
-        case 1:
-            fprintf(stdout, "\t(type): Clear Backup in Flash\n");
-            fprintf(stdout, "\tcmd: %02X\n", *p);
-            p += 1;
-            // reserved
-            p += 3;
-            break;
-        case 2:
-            fprintf(stdout, "\t(type): Backup File Creation Acknowledge\n");
-            fprintf(stdout, "\tcmd: %02X\n", *p);
-            p += 1;
-            // reserved
-            p += 3;
-            fprintf(stdout, "\tresponse: %02X(%s)\n", *p, (*p == 1)?"Acknowledged":"Not Acknowledged");
-            p += 1;
-            break;
-        case 3:
-            fprintf(stdout, "\t(type): System Restored from Backup\n");
-            fprintf(stdout, "\tcmd: %02X\n", *p);
-            p += 1;
-            // reserved
-            p += 3;
-            fprintf(stdout, "\tresponse: %02X(%s)\n", *p, (*p > 0)?(*p==1?"Failed restoring from backup file":(*p==2?"Restored from backup file":(*p==3?"Not restored (no backup)":""))):"Unknown");
-            p += 1;
-            break;
-        }
-    }
-        break;
-
-    case UBX_CFG_BDS:
-    {
-        uint32_t val32;
-        assert(count == 24);
-
-        //fprintf(stdout, "ublox !UBX CFG-BDS:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tX4_1: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tX4_2: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tX4_3: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tX4_4: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tX4_5: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tX4_6: %08X\n", val32);
-        p += 4;
-    }
-        break;
-
-    case UBX_CFG_GNSS:
-    {
-        uint32_t val32;
-        int num;
-        //fprintf(stdout, "ublox !UBX CFG-GNSS:\n");
-
-        fprintf(stdout, "\tmsgVer: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tnumTrkChHw: %d\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tnumTrkChUse: %d\n", *p);
-        p += 1;
-
-        num = *p;
-        fprintf(stdout, "\tnumConfigBlocks: %d\n", *p);
-        p += 1;
-
-        for (i = 0; i < num; i ++) {
-            fprintf(stdout, "\t[%d]\tgnssId: %0d\n", i, *p);
-            p += 1;
-            fprintf(stdout, "\t\tresTrkCh: %d\n", *p);
-            p += 1;
-            fprintf(stdout, "\t\tmaxTrkCh: %d\n", *p);
-            p += 1;
-            fprintf(stdout, "\t\treserved1: %02X\n", *p);
-            p += 1;
-
-            val32 = U32_LE(p);
-            fprintf(stdout, "\t\tflags: %08X (%s,sigCfgMask=%02X)\n"
-                    , val32
-                    , ((val32 & 0x01)?"Enabled":"Disabled")
-                    , ((val32 >> 16) & 0xFF)
-                   );
-            p += 4;
-        }
-    }
-        break;
-
-    case UBX_CFG_MSG:
-    {
-        assert(count >= 2);
-
-        //fprintf(stdout, "ublox !UBX CFG-MSG:\n");
-
-        if (count == 2) {
-            // query
-            fprintf(stdout, "\t(type): Poll a message configuration\n");
-        } else {
-            fprintf(stdout, "\t(type): Set Message Rate(s)\n");
-        }
-
-        fprintf(stdout, "\tmsgClass: %02X\n", *p);
-        p += 1;
-
-        fprintf(stdout, "\tmsgID: %02X\n", *p);
-        p += 1;
-        fprintf(stdout, "\t(classid) %s\n", val2cstr_ublox_classid(*(p-2),*(p-1)));
-
-        for (i = 0; p - buffer_in - 6 < count; i ++) {
-            fprintf(stdout, "\tout[%d]: %02X (%s:%s)\n", i, *p, val2cstr_ublox_portid(i), (*p==0?"OFF":"ON"));
-            p += 1;
-        }
-
-    }
-        break;
-
-    case UBX_CFG_PRT:
-    {
-        uint32_t val32;
-        uint16_t val16;
-        uint8_t portid;
-        assert(count >= 0);
-        assert(count <= 20);
-
-        //fprintf(stdout, "ublox !UBX CFG-PRT:\n");
-
-        if (count == 0) {
-            // query
-            fprintf(stdout, "\t(type): Polls the configuration of the used I/O Port\n");
-            break;
-        } else if (count == 1) {
-            fprintf(stdout, "\t(type): Polls the configuration for one I/O Port\n");
-        } else {
-            fprintf(stdout, "\t(type): Gotten/Set Port Configuration\n");
-        }
-
-        // for UART
-        // U1 portID(=1 or 2), U1 reserved0, X2 txReady, X4 mode, U4 baudRate, X2 inPortoMask, X2 outPortoMask, U2 reserved4, U2 reserved5
-        // for USB
-        // U1 portID(=3), U1 reserved0, X2 txReady, X4 reserved2, U4 reserved3, X2 inPortoMask, X2 outPortoMask, U2 reserved4, U2 reserved5
-        // for SPI
-        // U1 portID(=4), U1 reserved0, X2 txReady, X4 mode, U4 reserved3, X2 inPortoMask, X2 outPortoMask, U2 reserved4, U2 reserved5
-        // for DDC
-        // U1 portID(=0), U1 reserved0, X2 txReady, X4 mode, U4 reserved3, X2 inPortoMask, X2 outPortoMask, U2 reserved4, U2 reserved5
-
-        portid = *p;
-        fprintf(stdout, "\tPortID: %s (0x%02X)\n", val2cstr_ublox_portid(*p), *p);
-        p += 1;
-
-        if (count == 1) {
-            break;
-        }
-        assert(count == 20);
-
-        fprintf(stdout, "\treserved0: %02X\n", *p);
-        p += 1;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\ttxReady: %04X\n", val16);
-        p += 2;
-
-        if (portid == 3) {
-            // usb
-            val32 = U32_LE(p);
-            fprintf(stdout, "\treserved2: %08X\n", val32);
-            p += 4;
-        } else {
-            val32 = U32_LE(p);
-            fprintf(stdout, "\tmode: %08X\n", val32);
-            p += 4;
-        }
-        if (portid == 1 || portid == 2) {
-            // UART
-            val32 = U32_LE(p);
-            fprintf(stdout, "\tbaudRate: %d(0x%08X)\n", val32, val32);
-            p += 4;
-        } else {
-            val32 = U32_LE(p);
-            fprintf(stdout, "\treserved3: %08X\n", val32);
-            p += 4;
-        }
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tinPortoMask: %04X\n", val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\toutPortoMask: %04X\n", val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\treserved4: %04X\n", val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\treserved5: %04X\n", val16);
-        p += 2;
-
-    }
-        break;
-
-    case UBX_CFG_RATE:
-    {
-        uint16_t val16;
-        assert(count >= 0);
-        assert(count <= 6);
-
-        //fprintf(stdout, "ublox !UBX CFG-RATE:\n");
-
-        if (count == 0) {
-            // query
-            fprintf(stdout, "\t(type): Poll Navigation/Measurement Rate Settings\n");
-            break;
-        } else {
-            fprintf(stdout, "\t(type): Navigation/Measurement Rate Settings\n");
-        }
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tmeasRate: %d(0x%04X)\n", val16, val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tnavRate: %d(0x%04X)\n", val16, val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\ttimeRef: %d(0x%04X)\n", val16, val16);
-        p += 2;
-
-    }
-        break;
-
-    case UBX_CFG_CFG:
-    {
-        uint16_t val32;
-        assert((count == 12) || (count == 13));
-
-        //fprintf(stdout, "ublox !UBX CFG-RATE:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tclearMask: %d(0x%08X)\n", val32, val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tsaveMask: %d(0x%08X)\n", val32, val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tloadMask: %d(0x%08X)\n", val32, val32);
-        p += 4;
-
-        if (count >= 13) {
-            fprintf(stdout, "\tdeviceMask: %d(0x%08X)\n", (int)*p, (int)*p);
-        }
-    }
-        break;
-
-
-    case UBX_NAV_TIMEGPS:
-    {
-        uint32_t val32;
-        int32_t vali32;
-        uint16_t val16;
-        int16_t vali16;
-        assert(count == 16);
-
-        //fprintf(stdout, "ublox !UBX NAV-TIMEGPS:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tiTOW: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        memmove(&vali32, &val32, sizeof(val32));
-        fprintf(stdout, "\tfTOW: %d\n", vali32);
-        p += 4;
-
-        val16 = U16_LE(p);
-        memmove(&vali16, &val16, sizeof(val16));
-        fprintf(stdout, "\tweek: %d\n", vali16);
-        p += 2;
-
-        fprintf(stdout, "\tleapS: %d\n", *((char *)p));
-        p += 1;
-
-        fprintf(stdout, "\tvalid: %02X\n", *p);
-        p += 1;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\ttAcc: %08X\n", val32);
-        p += 4;
-    }
-        break;
-
-    case UBX_NAV_CLOCK:
-    {
-        uint32_t val32;
-        int32_t vali32;
-        assert(count == 20);
-        //fprintf(stdout, "ublox !UBX NAV-CLOCK:\n");
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tiTOW: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        memmove(&vali32, &val32, sizeof(val32));
-        fprintf(stdout, "\tclkB: %d\n", vali32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        memmove(&vali32, &val32, sizeof(val32));
-        fprintf(stdout, "\tclkD: %d\n", vali32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\ttAcc: %08X\n", val32);
-        p += 4;
-
-        val32 = U32_LE(p);
-        fprintf(stdout, "\tfAcc: %08X\n", val32);
-        p += 4;
-    }
-        break;
-
-    case UBX_RXM_RAW:
-    {
-        // R4 IEEE 754 Single Precision
-        // R8 IEEE 754 Double Precision
-        int numSV;
-        float  f4;
-        double f8;
-
-        uint32_t val32;
-        int32_t vali32;
-        uint16_t val16;
-        int16_t vali16;
-        //fprintf(stdout, "ublox !UBX RXM-RAW:\n");
-
-        // l4 iTOW
-        val32 = U32_LE(p);
-        memmove(&vali32, &val32, sizeof(val32));
-        fprintf(stdout, "\tiTOW: %d\n", vali32);
-        p += 4;
-
-        // l2 week
-        val16 = U16_LE(p);
-        memmove(&vali16, &val16, sizeof(val16));
-        fprintf(stdout, "\tweek: %d\n", vali16);
-        p += 2;
-
-        // U1 numSV
-        numSV = *p;
-        fprintf(stdout, "\tnumSV: %02X\n", *p);
-        p += 1;
-
-        // U1 reserved1
-        fprintf(stdout, "\treserved1: %02X\n", *p);
-        p += 1;
-
-        // repeats: 24*numSV
-        //   R8 cpMes
-        //   R8 prMes
-        //   R4 doMes
-        //   U1 sv
-        //   l1 mesQI
-        //   l1 cno
-        //   U1 lli
-        for (i = 0; i < numSV; i ++) {
-            memmove(&f8, p, sizeof(f8));
-            fprintf(stdout, "\t[%d]\tcpMes: %f\n", i, f8);
-            p += 8;
-
-            memmove(&f8, p, sizeof(f8));
-            fprintf(stdout, "\t\tprMes: %f\n", f8);
-            p += 8;
-
-            memmove(&f4, p, sizeof(f4));
-            fprintf(stdout, "\t\tdoMes: %f\n", f4);
-            p += 4;
-
-            fprintf(stdout, "\t\tsv: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\tmesQI: %d\n", *((char *)p));
-            p += 1;
-
-            fprintf(stdout, "\t\tcno: %d\n", *((char *)p));
-            p += 1;
-
-            fprintf(stdout, "\t\tlli: %02X\n", *p);
-            p += 1;
-        }
-    }
-        break;
-
-    case UBX_RXM_SFRB:
-    {
-        uint32_t val32;
-        //fprintf(stdout, "ublox !UBX RXM-SFRB:\n");
-
-        // U1 chn
-        fprintf(stdout, "\tchn: %02X\n", *p);
-        p += 1;
-        // U1 svid
-        fprintf(stdout, "\tsvid: %02X\n", *p);
-        p += 1;
-        // X4[10] dwrd
-        for(i = 0; i < 10; i ++) {
-            val32 = U32_LE(p);
-            fprintf(stdout, "\tdwrd[%d]: %d\n", i, val32);
-            p += 4;
-        }
-    }
-        break;
-
-    case UBX_RXM_SFRBX: // ublox8
-    {
-        int numWords;
-        uint32_t val32;
-        //fprintf(stdout, "ublox !UBX RXM-SFRBX:\n");
-
-        // U1 gnssId
-        fprintf(stdout, "\tgnssId: %02X\n", *p);
-        p += 1;
-        // U1 svId
-        fprintf(stdout, "\tsvId: %02X\n", *p);
-        p += 1;
-        // U1 reserved1
-        fprintf(stdout, "\treserved1: %02X\n", *p);
-        p += 1;
-        // U1 freqId
-        fprintf(stdout, "\tfreqId: %02X\n", *p);
-        p += 1;
-        // U1 numWords
-        numWords = *p;
-        fprintf(stdout, "\tnumWords: %02X\n", *p);
-        p += 1;
-        // U1 reserved2
-        fprintf(stdout, "\treserved2: %02X\n", *p);
-        p += 1;
-        // U1 version
-        fprintf(stdout, "\tversion: %02X\n", *p);
-        p += 1;
-        // U1 reserved3
-        fprintf(stdout, "\treserved3: %02X\n", *p);
-        p += 1;
-
-        // repeats: 4*numWords
-        //   U4 dwrd
-        for(i = 0; i < numWords; i ++) {
-            val32 = U32_LE(p);
-            fprintf(stdout, "\tdwrd[%d]: %08X\n", i, val32);
-            p += 4;
-        }
-    }
-        break;
-
-    case UBX_RXM_RAWX: // ublox8
-    {
-        float  f4;
-        double f8;
-        uint16_t val16;
-        int numMeas;
-        //fprintf(stdout, "ublox !UBX RXM-RAWX:\n");
-
-        // R8 rcvTow
-        memmove(&f8, p, sizeof(f8));
-        fprintf(stdout, "\trcvTow: %f\n", f8);
-        p += 8;
-
-        // U2 week
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tweek: %d\n", val16);
-        p += 2;
-
-        // l1 leapS
-        fprintf(stdout, "\tleapS: %d\n", *((char *)p));
-        p += 1;
-
-        // U1 numMeas
-        numMeas = *p;
-        fprintf(stdout, "\tnumMeas: %02X\n", *p);
-        p += 1;
-
-        // X1 recStat
-        fprintf(stdout, "\trecStat: %02X\n", *p);
-        p += 1;
-
-        // U1[3] reserved1
-        p += 3;
-
-        // repeats: 32*numMeas
-        //   R8 prMes
-        //   R8 cpMes
-        //   R4 doMes
-        //   U1 gnssId
-        //   U1 svId
-        //   U1 reserved2
-        //   U1 freqId
-        //   U2 locktime
-        //   U1 cno
-        //   X1 prStdev
-        //   X1 cpStdev
-        //   X1 doStdev
-        //   X1 trkStat
-        //   U1 reserved3
-        for (i = 0; i < numMeas; i ++) {
-            memmove(&f8, p, sizeof(f8));
-            fprintf(stdout, "\t[%d]\tprMes: %f\n", i, f8);
-            p += 8;
-
-            memmove(&f8, p, sizeof(f8));
-            fprintf(stdout, "\t\tcpMes: %f\n", f8);
-            p += 8;
-
-            memmove(&f4, p, sizeof(f4));
-            fprintf(stdout, "\t\tdoMes: %f\n", f4);
-            p += 4;
-
-            fprintf(stdout, "\t\tgnssId: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\tsvId: %02X\n", *p);
-            p += 1;
-
-            p += 1;
-
-            fprintf(stdout, "\t\tfreqId: %02X\n", *p);
-            p += 1;
-
-            val16 = U16_LE(p);
-            fprintf(stdout, "\t\tlocktime: %04X\n", val16);
-            p += 2;
-
-            fprintf(stdout, "\t\tcno: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\tprStdev: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\tcpStdev: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\tdoStdev: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\ttrkStat: %02X\n", *p);
-            p += 1;
-
-            fprintf(stdout, "\t\treserved3: %02X\n", *p);
-            p += 1;
-
-        }
-
-    }
-        break;
-
-    case UBX_TRK_D5:
-    {
-        float  f4;
-        double f8;
-        uint16_t val16;
-
-        int len;
-        int type;
-        type = *p;
-        //fprintf(stdout, "ublox !UBX TRK-D5:\n");
-
-        fprintf(stdout, "\ttype: %d\n", type);
-        switch(type) {
-        case 3: p += 80; len = 56; break;
-        case 6: p += 80; len = 64; break; // ublox7
-        default: p += 72; len = 56; break;
-        }
-        for (i = 0; p < buffer_in + sz_in - 2; i ++, p += len) {
-            memmove(&f8, p, sizeof(f8));
-            fprintf(stdout, "\t[%d]\tts: %f\n", i, f8); // transmission time
-
-            memmove(&f8, p+8, sizeof(f8));
-            fprintf(stdout, "\t\tadr: %f\n", f8);
-            memmove(&f4, p+16, sizeof(f4));
-            fprintf(stdout, "\t\tdop: %f\n", f4);
-
-            val16 = U16_LE(p+32);
-            fprintf(stdout, "\t\tsnr: %04X\n", val16);
-
-            // quality indicator
-            fprintf(stdout, "\t\tqi=%02X\n", (*(p+41)) & 0x07);
-
-#define MINPRNSBS   120                 /* min satellite PRN number of SBAS */
-            if (type == 6) {
-                fprintf(stdout, "\t\tgnssId=%s\n", ublox_val2cstr_gnss(*(p+56)));
-                fprintf(stdout, "\t\tsvId=%d\n", (*(p+57)));
-                fprintf(stdout, "\t\tfreqId=%d\n", (*(p+59)));
-            } else {
-                int svId;
-                svId = *(p+34);
-                fprintf(stdout, "\t\tgnssId=%s\n", ublox_val2cstr_gnss((svId<MINPRNSBS)?0/*GPS*/:1/*SBS*/));
-                fprintf(stdout, "\t\tsvId=%d\n", (*(p+34)));
-            }
-            fprintf(stdout, "\t\tflags=%02X\n", (*(p+54)));
-
-        }
-    }
-        break;
-
-    case UBX_TRK_MEAS:
-    {
-        float  f4;
-        double f8;
-        uint16_t val16;
-
-        int len;
-        int nch; // number of channel
-
-        //fprintf(stdout, "ublox !UBX TRK-MEAS:\n");
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tunknown: %d\n", val16);
-        p += 2;
-
-        val16 = U16_LE(p);
-        fprintf(stdout, "\tnch: %d (number of channels)\n", val16);
-        p += 2;
-        nch = val16;
-
-        p += 100;
-        len = 56;
-        for (i = 0; p < buffer_in + sz_in - 2; i ++, p += len) {
-            fprintf(stdout, "\t[%d]:\t# %d\n", i, *p);
-
-            /* quality indicator (0:idle,1:search,2:aquired,3:unusable, */
-            /*                    4:code lock,5,6,7:code/carrier lock) */
-            fprintf(stdout, "\t\tqi=%02X\n", (*(p+1)));
-            fprintf(stdout, "\t\tmesQI: %02X\n", *(p+2));
-            fprintf(stdout, "\t\tgnss: %s\n", ublox_val2cstr_gnss(*(p+4)));
-            fprintf(stdout, "\t\tsvid: %02X (satellite ID (PRN/slot number))\n", (*(p+5)));
-
-            fprintf(stdout, "\t\tfcn: %02X (GLO frequency channel number+7)\n", (*(p+7)));
-            fprintf(stdout, "\t\tstatus: %02X (tracking/lock status (bit3: half-cycle))\n", (*(p+8)));
-
-            fprintf(stdout, "\t\tlock1: %02X (code lock count)\n", *(p+16));
-            fprintf(stdout, "\t\tlock2: %02X (carrier lock count)\n", *(p+17));
-
-            val16 = U16_LE(p + 20);
-            fprintf(stdout, "\t\tcno: %04X (C/N0 (2^{-8} dBHz))\n", val16);
-
-            memmove(&f8, p+24, sizeof(f8));
-            fprintf(stdout, "\t\ttxTow: %f (transmission time in gps week (2^{-32} ms))\n", f8);
-
-            memmove(&f8, p+32, sizeof(f8));
-            fprintf(stdout, "\t\tadr: %f (accumulated Doppler range (2^{-32} cycle))\n", f8);
-
-            memmove(&f4, p+40, sizeof(f4));
-            fprintf(stdout, "\t\tdop: %f (Doppler frequency (2^{-32}x10 Hz))\n", f4);
-        }
-    }
-        break;
-
-    case UBX_TRK_SFRBX:
-    {
-        int gnss;
-
-        //fprintf(stdout, "ublox !UBX TRK-SFRBX:\n");
-        fprintf(stdout, "\tunknown: %02X\n", *p);
-        p += 1;
-
-        gnss = *p;
-        fprintf(stdout, "\tgnss: %s\n", ublox_val2cstr_gnss(*p));
-        p += 1;
-        fprintf(stdout, "\tsvid: %02X (satellite ID (PRN/slot number))\n", *p);
-        p += 1;
-
-        p += 1;
-
-        fprintf(stdout, "\tfcn: %02X (GLO frequency channel number+7)\n", (*p));
-        p += 1;
-        switch (gnss) {
-        case 0: // "GPS"
-            // X4[10] GPS nav GPS LNAV subframe (24 bits x 10)
-            break;
-        case 1: // "SBS"
-            // X4[8] SBS nav SBAS message frame (226 bits)
-            break;
-        case 2: // "GAL"
-            break;
-        case 3: // beidou
-            // X4[10] BDS nav BDS D1/D2 subframe (26 bits x 10)
-            break;
-        case 5: // "QZS"
-            // X4[10] QZS nav QZSS LNAV subframe (24 bits x 10)
-            break;
-        case 6: // "GLO"
-            // X4[4] GLO nav GLO nav string with hamming (85 bits)
-            break;
-        }
-
-    }
-        break;
-
-    default:
+    ret = ublox_print_packet(stdout, buffer_in, sz_in);
+    if (ret != 0) {
         sz = ublox_pkt_expected_size(buffer_in, sz_in);
         if (sz < 1) {
             sz = 1;
@@ -2242,12 +1768,15 @@ ublox_cli_verify_tcp(uint8_t * buffer_in, size_t sz_in, size_t * sz_processed, s
         *sz_processed = sz;
         assert(*sz_processed <= sz_in);
 
-        TE("ublox error: unsupport command in packet: classid=%s(0x%04X)\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]), classid);
+        if (ret < 0) {
+            TE("ublox error: malformed payload in packet: classid=%s(0x%04X), length=%d\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]), classid, count);
+        } else {
+            TE("ublox error: unsupport command in packet: classid=%s(0x%04X)\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]), classid);
+        }
         //hex_dump_to_fd(STDERR_FILENO, buffer_in, sz_in);
         hex_dump_to_fp(stderr, buffer_in, sz_in);
 
         return 2;
-        break;
     }
     TD("+++++++++++++++++++++++++++++++++++++++++++++\n");
 
@@ -18,6 +18,7 @@ extern "C" {
 
 #define UBLOX_PKT_LENGTH_HDR 6
 #define UBLOX_PKT_LENGTH_MIN 8 /**< the mininal length of a UBLOX packet */
+#define UBLOX_PKT_LENGTH_MAX (UBLOX_PKT_LENGTH_MIN + 0xFFFF) /**< the maximal length of a UBLOX packet */
 
 #define UBLOX_CLASS_NAV 0x01
 #define UBLOX_CLASS_RXM 0x02
@@ -154,6 +155,16 @@ extern "C" {
 #define UBLOX_2CLASS(class_id) (((class_id) & 0xFF00) >> 8)
 #define UBLOX_2ID(class_id) ((class_id) & 0xFF)
 
+/** the state of the 8-bit Fletcher checksum, can be fed incrementally */
+typedef struct _ublox_cksum_t {
+    uint32_t ck_a; /**< the low 8 bits is CK_A */
+    uint32_t ck_b; /**< the low 8 bits is CK_B */
+} ublox_cksum_t;
+
+void ublox_cksum_init(ublox_cksum_t * st);
+void ublox_cksum_update(ublox_cksum_t * st, const uint8_t * buffer, size_t sz);
+void ublox_cksum_final(const ublox_cksum_t * st, uint8_t * out_buf);
+
 void ublox_pkt_checksum(void *buffer, int length, uint8_t * out_buf);
 int ublox_pkt_verify (uint8_t *buffer, size_t sz_buf);
 
@@ -174,6 +185,26 @@ ssize_t ublox_pkt_create_set_cfgrate (uint8_t *buffer, size_t sz_buf, uint16_t m
 ssize_t ublox_pkt_create_upd_downl (uint8_t *buffer, size_t sz_buf, uint32_t startAddr, uint32_t flags, uint8_t *data, size_t len);
 ssize_t ublox_pkt_create_cfg_bds (uint8_t *buffer, size_t sz_buf, uint32_t u4_1, uint32_t u4_2, uint32_t u4_3_mask, uint32_t u4_4_mask, uint32_t u4_5, uint32_t u4_6);
 
+#define UBLOX_SYNC_IMPL_AUTO   0 /**< select the best implementation supported by the CPU */
+#define UBLOX_SYNC_IMPL_SCALAR 1
+#define UBLOX_SYNC_IMPL_SSE2   2
+#define UBLOX_SYNC_IMPL_AVX2   3
+#define UBLOX_SYNC_IMPL_NEON   4
+int ublox_pkt_sync_impl_select(int impl);
+const char * ublox_pkt_sync_impl_name(int impl);
+size_t ublox_pkt_find_sync(const uint8_t * buffer_in, size_t sz_in);
+
+/** the descriptor of a packet found by ublox_pkt_index_frames() */
+typedef struct _ublox_frame_t {
+    size_t offset;    /**< the offset of the packet in the buffer */
+    size_t length;    /**< the byte size of the packet, including the header and checksum */
+    uint16_t classid; /**< the class and id of the packet */
+    uint8_t flg_ckok; /**< 1 if the checksum is correct */
+} ublox_frame_t;
+
+size_t ublox_pkt_index_frames(const uint8_t * buffer_in, size_t sz_in, ublox_frame_t * frames, size_t max_frames, size_t * pnum_frames);
+size_t ublox_pkt_find_verified(const uint8_t * buffer_in, size_t sz_in);
+
 int ublox_pkt_nexthdr_ubx(uint8_t * buffer_in, size_t sz_in, size_t * sz_processed, size_t * sz_needed_in);
 int ublox_cli_verify_tcp(uint8_t * buffer_in, size_t sz_in, size_t * sz_processed, size_t * sz_needed_in);
 int ublox_process_buffer_data(uint8_t * buffer_in, size_t sz_in, size_t * psz_processed, size_t * psz_needed_in);
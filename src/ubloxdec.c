@@ -0,0 +1,1898 @@
+/**
+ * \file    ubloxdec.c
+ * \brief   Decode UBX packets to C structures
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#include "ubloxconn.h"
+#include "ubloxcstr.h"
+#include "ubloxdec.h"
+#include "ubloxfmt.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#if DEBUG
+#include "hexdump.h"
+#endif
+#ifndef hex_dump_to_fp
+#define hex_dump_to_fp(a,b,c)
+#endif
+
+/*****************************************************************************/
+// little endian
+static uint16_t
+ublox_get_u16(const uint8_t * p)
+{
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static uint32_t
+ublox_get_u32(const uint8_t * p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int16_t
+ublox_get_i16(const uint8_t * p)
+{
+    uint16_t val16 = ublox_get_u16(p);
+    int16_t vali16;
+    memmove(&vali16, &val16, sizeof(val16));
+    return vali16;
+}
+
+static int32_t
+ublox_get_i32(const uint8_t * p)
+{
+    uint32_t val32 = ublox_get_u32(p);
+    int32_t vali32;
+    memmove(&vali32, &val32, sizeof(val32));
+    return vali32;
+}
+
+// R4 IEEE 754 Single Precision
+static float
+ublox_get_r4(const uint8_t * p)
+{
+    uint32_t val32 = ublox_get_u32(p);
+    float f4;
+    memmove(&f4, &val32, sizeof(f4));
+    return f4;
+}
+
+// R8 IEEE 754 Double Precision
+static double
+ublox_get_r8(const uint8_t * p)
+{
+    uint64_t val64 = (uint64_t)ublox_get_u32(p) | ((uint64_t)ublox_get_u32(p + 4) << 32);
+    double f8;
+    memmove(&f8, &val64, sizeof(f8));
+    return f8;
+}
+
+/**
+ * \brief copy a fixed size string field
+ * \param out: the buffer, the size should be >= sz + 1
+ * \param p: the field
+ * \param sz: the byte size of the field
+ */
+static void
+ublox_get_str(char * out, const uint8_t * p, size_t sz)
+{
+    size_t i;
+    for (i = 0; (i < sz) && (p[i] != 0); i ++) {
+        out[i] = (char)p[i];
+    }
+    out[i] = 0;
+}
+
+const char *
+ublox_val2cstr_gnss(int gnss)
+{
+    switch (gnss) {
+        case 0: return "GPS";
+        case 1: return "SBS";
+        case 2: return "GAL";
+        case 3: return "CMP"; // beidou
+        case 5: return "QZS";
+        case 6: return "GLO";
+    }
+    return "UNKNOWN_GNSS";
+}
+
+/*****************************************************************************/
+// MON
+
+/**
+ * \brief decode MON-VER
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_mon_ver(const uint8_t * payload, size_t sz_payload, ublox_mon_ver_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < UBLOX_MON_VER_LEN_SW + UBLOX_MON_VER_LEN_HW) {
+        return -1;
+    }
+    ublox_get_str(out->swVersion, payload, UBLOX_MON_VER_LEN_SW);
+    ublox_get_str(out->hwVersion, payload + UBLOX_MON_VER_LEN_SW, UBLOX_MON_VER_LEN_HW);
+    out->flg_rom = 0;
+    out->romVersion[0] = 0;
+    out->num_ext = 0;
+    if (sz_payload >= UBLOX_MON_VER_LEN_SW + UBLOX_MON_VER_LEN_HW + UBLOX_MON_VER_LEN_EXT) {
+        out->flg_rom = 1;
+        ublox_get_str(out->romVersion, payload + UBLOX_MON_VER_LEN_SW + UBLOX_MON_VER_LEN_HW, UBLOX_MON_VER_LEN_EXT);
+        out->num_ext = (sz_payload - UBLOX_MON_VER_LEN_SW - UBLOX_MON_VER_LEN_HW - UBLOX_MON_VER_LEN_EXT) / UBLOX_MON_VER_LEN_EXT;
+    }
+    return 0;
+}
+
+/**
+ * \brief decode the extPackageVer of MON-VER
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the item
+ * \param out: the buffer of UBLOX_MON_VER_LEN_EXT + 1 bytes
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_mon_ver_item(const uint8_t * payload, size_t sz_payload, size_t idx, char * out)
+{
+    size_t off = UBLOX_MON_VER_LEN_SW + UBLOX_MON_VER_LEN_HW + UBLOX_MON_VER_LEN_EXT + idx * UBLOX_MON_VER_LEN_EXT;
+    assert (NULL != out);
+    if (off + UBLOX_MON_VER_LEN_EXT > sz_payload) {
+        return -1;
+    }
+    ublox_get_str(out, payload + off, UBLOX_MON_VER_LEN_EXT);
+    return 0;
+}
+
+/**
+ * \brief decode MON-HW
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_mon_hw(const uint8_t * payload, size_t sz_payload, ublox_mon_hw_t * out)
+{
+    const uint8_t * p = payload;
+    assert (NULL != out);
+    if (sz_payload < 68) {
+        return -1;
+    }
+    out->pinSel = ublox_get_u32(p); p += 4;
+    out->pinBank = ublox_get_u32(p); p += 4;
+    out->pinDir = ublox_get_u32(p); p += 4;
+    out->pinVal = ublox_get_u32(p); p += 4;
+    out->noisePerMS = ublox_get_u16(p); p += 2;
+    out->agcCnt = ublox_get_u16(p); p += 2;
+    out->aStatus = *p; p += 1;
+    out->aPower = *p; p += 1;
+    out->flags = *p; p += 1;
+    out->reserved1 = *p; p += 1;
+    out->usedMask = ublox_get_u32(p); p += 4;
+    memmove(out->VP, p, sizeof(out->VP)); p += sizeof(out->VP);
+    out->jamInd = *p; p += 1;
+    out->reserved3 = ublox_get_u16(p); p += 2;
+    out->pinIrq = ublox_get_u32(p); p += 4;
+    out->pullH = ublox_get_u32(p); p += 4;
+    out->pullL = ublox_get_u32(p); p += 4;
+    return 0;
+}
+
+/**
+ * \brief decode MON-HW2
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_mon_hw2(const uint8_t * payload, size_t sz_payload, ublox_mon_hw2_t * out)
+{
+    const uint8_t * p = payload;
+    assert (NULL != out);
+    if (sz_payload < 28) {
+        return -1;
+    }
+    out->ofsI = (int8_t)*p; p += 1;
+    out->magI = *p; p += 1;
+    out->ofsQ = (int8_t)*p; p += 1;
+    out->magQ = *p; p += 1;
+    out->cfgSource = *p; p += 1;
+    memmove(out->reserved0, p, sizeof(out->reserved0)); p += sizeof(out->reserved0);
+    out->lowLevCfg = ublox_get_u32(p); p += 4;
+    memmove(out->reserved1, p, sizeof(out->reserved1)); p += sizeof(out->reserved1);
+    out->postStatus = ublox_get_u32(p); p += 4;
+    out->reserved2 = ublox_get_u32(p); p += 4;
+    return 0;
+}
+
+/*****************************************************************************/
+// ACK
+
+/**
+ * \brief decode ACK-ACK and ACK-NAK
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_ack(const uint8_t * payload, size_t sz_payload, ublox_ack_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 2) {
+        return -1;
+    }
+    out->clsID = payload[0];
+    out->msgID = payload[1];
+    return 0;
+}
+
+/*****************************************************************************/
+// UPD
+
+/**
+ * \brief decode UPD-DOWNL
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the data points to the payload
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_upd_downl(const uint8_t * payload, size_t sz_payload, ublox_upd_data_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 8) {
+        return -1;
+    }
+    out->StartAddr = ublox_get_u32(payload);
+    out->Size = 0;
+    out->Flags = ublox_get_u32(payload + 4);
+    out->data = payload + 8;
+    out->sz_data = sz_payload - 8;
+    return 0;
+}
+
+/**
+ * \brief decode UPD-UPLOAD
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the data points to the payload
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_upd_upload(const uint8_t * payload, size_t sz_payload, ublox_upd_data_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 12) {
+        return -1;
+    }
+    out->StartAddr = ublox_get_u32(payload);
+    out->Size = ublox_get_u32(payload + 4);
+    out->Flags = ublox_get_u32(payload + 8);
+    out->data = payload + 12;
+    out->sz_data = sz_payload - 12;
+    return 0;
+}
+
+/**
+ * \brief decode UPD-EXEC
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_upd_exec(const uint8_t * payload, size_t sz_payload, ublox_upd_exec_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 8) {
+        return -1;
+    }
+    out->StartAddr = ublox_get_u32(payload);
+    out->DestAddr = 0;
+    out->Size = 0;
+    out->Flags = ublox_get_u32(payload + 4);
+    return 0;
+}
+
+/**
+ * \brief decode UPD-MEMCPY
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_upd_memcpy(const uint8_t * payload, size_t sz_payload, ublox_upd_exec_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 16) {
+        return -1;
+    }
+    out->StartAddr = ublox_get_u32(payload);
+    out->DestAddr = ublox_get_u32(payload + 4);
+    out->Size = ublox_get_u32(payload + 8);
+    out->Flags = ublox_get_u32(payload + 12);
+    return 0;
+}
+
+/**
+ * \brief decode UPD-SOS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_upd_sos(const uint8_t * payload, size_t sz_payload, ublox_upd_sos_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 4) {
+        return -1;
+    }
+    out->cmd = payload[0];
+    out->response = 0;
+    if ((out->cmd == 2) || (out->cmd == 3)) {
+        if (sz_payload < 5) {
+            return -1;
+        }
+        out->response = payload[4];
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+// CFG
+
+/**
+ * \brief decode CFG-BDS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_bds(const uint8_t * payload, size_t sz_payload, ublox_cfg_bds_t * out)
+{
+    int i;
+    assert (NULL != out);
+    if (sz_payload < 24) {
+        return -1;
+    }
+    for (i = 0; i < 6; i ++) {
+        out->X4[i] = ublox_get_u32(payload + i * 4);
+    }
+    return 0;
+}
+
+/**
+ * \brief decode a configuration block of CFG-GNSS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the block
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_gnss_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_cfg_gnss_block_t * out)
+{
+    const uint8_t * p = payload + 4 + idx * 8;
+    assert (NULL != out);
+    if (4 + idx * 8 + 8 > sz_payload) {
+        return -1;
+    }
+    out->gnssId = p[0];
+    out->resTrkCh = p[1];
+    out->maxTrkCh = p[2];
+    out->reserved1 = p[3];
+    out->flags = ublox_get_u32(p + 4);
+    return 0;
+}
+
+/**
+ * \brief decode CFG-GNSS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the blocks are stored in out->blocks
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_gnss(const uint8_t * payload, size_t sz_payload, ublox_cfg_gnss_t * out)
+{
+    size_t i;
+    assert (NULL != out);
+    out->num_blocks = 0;
+    if (sz_payload < 4) {
+        return -1;
+    }
+    out->msgVer = payload[0];
+    out->numTrkChHw = payload[1];
+    out->numTrkChUse = payload[2];
+    out->numConfigBlocks = payload[3];
+    if (4 + (size_t)out->numConfigBlocks * 8 > sz_payload) {
+        return -1;
+    }
+    for (i = 0; (NULL != out->blocks) && (i < out->max_blocks) && (i < out->numConfigBlocks); i ++) {
+        ublox_decode_cfg_gnss_item(payload, sz_payload, i, out->blocks + i);
+    }
+    out->num_blocks = i;
+    return 0;
+}
+
+/**
+ * \brief decode CFG-MSG
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_msg(const uint8_t * payload, size_t sz_payload, ublox_cfg_msg_t * out)
+{
+    size_t i;
+    assert (NULL != out);
+    if (sz_payload < 2) {
+        return -1;
+    }
+    out->msgClass = payload[0];
+    out->msgID = payload[1];
+    for (i = 0; (i < UBLOX_CFG_MSG_NUM_PORT) && (2 + i < sz_payload); i ++) {
+        out->rate[i] = payload[2 + i];
+    }
+    out->num_rate = i;
+    return 0;
+}
+
+/**
+ * \brief decode CFG-PRT
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_prt(const uint8_t * payload, size_t sz_payload, ublox_cfg_prt_t * out)
+{
+    const uint8_t * p = payload;
+    assert (NULL != out);
+    memset(out, 0, sizeof(*out));
+    if (sz_payload < 1) {
+        return -1;
+    }
+    out->portID = *p; p += 1;
+    if (sz_payload == 1) {
+        // poll the configuration for one I/O Port
+        out->flg_poll = 1;
+        return 0;
+    }
+    if (sz_payload < 20) {
+        return -1;
+    }
+    out->reserved0 = *p; p += 1;
+    out->txReady = ublox_get_u16(p); p += 2;
+    out->mode = ublox_get_u32(p); p += 4;
+    out->baudRate = ublox_get_u32(p); p += 4;
+    out->inProtoMask = ublox_get_u16(p); p += 2;
+    out->outProtoMask = ublox_get_u16(p); p += 2;
+    out->reserved4 = ublox_get_u16(p); p += 2;
+    out->reserved5 = ublox_get_u16(p); p += 2;
+    return 0;
+}
+
+/**
+ * \brief decode CFG-RATE
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_rate(const uint8_t * payload, size_t sz_payload, ublox_cfg_rate_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 6) {
+        return -1;
+    }
+    out->measRate = ublox_get_u16(payload);
+    out->navRate = ublox_get_u16(payload + 2);
+    out->timeRef = ublox_get_u16(payload + 4);
+    return 0;
+}
+
+/**
+ * \brief decode CFG-CFG
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_cfg_cfg(const uint8_t * payload, size_t sz_payload, ublox_cfg_cfg_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 12) {
+        return -1;
+    }
+    out->clearMask = ublox_get_u32(payload);
+    out->saveMask = ublox_get_u32(payload + 4);
+    out->loadMask = ublox_get_u32(payload + 8);
+    out->flg_devicemask = 0;
+    out->deviceMask = 0;
+    if (sz_payload >= 13) {
+        out->flg_devicemask = 1;
+        out->deviceMask = payload[12];
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+// NAV
+
+/**
+ * \brief decode NAV-TIMEGPS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_nav_timegps(const uint8_t * payload, size_t sz_payload, ublox_nav_timegps_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 16) {
+        return -1;
+    }
+    out->iTOW = ublox_get_u32(payload);
+    out->fTOW = ublox_get_i32(payload + 4);
+    out->week = ublox_get_i16(payload + 8);
+    out->leapS = (int8_t)payload[10];
+    out->valid = payload[11];
+    out->tAcc = ublox_get_u32(payload + 12);
+    return 0;
+}
+
+/**
+ * \brief decode NAV-CLOCK
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_nav_clock(const uint8_t * payload, size_t sz_payload, ublox_nav_clock_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 20) {
+        return -1;
+    }
+    out->iTOW = ublox_get_u32(payload);
+    out->clkB = ublox_get_i32(payload + 4);
+    out->clkD = ublox_get_i32(payload + 8);
+    out->tAcc = ublox_get_u32(payload + 12);
+    out->fAcc = ublox_get_u32(payload + 16);
+    return 0;
+}
+
+/*****************************************************************************/
+// RXM
+
+/**
+ * \brief decode a satellite of RXM-RAW
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the satellite
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_raw_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_rxm_raw_sv_t * out)
+{
+    const uint8_t * p = payload + 8 + idx * 24;
+    assert (NULL != out);
+    if (8 + idx * 24 + 24 > sz_payload) {
+        return -1;
+    }
+    out->cpMes = ublox_get_r8(p);
+    out->prMes = ublox_get_r8(p + 8);
+    out->doMes = ublox_get_r4(p + 16);
+    out->sv = p[20];
+    out->mesQI = (int8_t)p[21];
+    out->cno = (int8_t)p[22];
+    out->lli = p[23];
+    return 0;
+}
+
+/**
+ * \brief decode RXM-RAW
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the satellites are stored in out->sv
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_raw(const uint8_t * payload, size_t sz_payload, ublox_rxm_raw_t * out)
+{
+    size_t i;
+    assert (NULL != out);
+    out->num_sv = 0;
+    if (sz_payload < 8) {
+        return -1;
+    }
+    out->iTOW = ublox_get_i32(payload);
+    out->week = ublox_get_i16(payload + 4);
+    out->numSV = payload[6];
+    out->reserved1 = payload[7];
+    if (8 + (size_t)out->numSV * 24 > sz_payload) {
+        return -1;
+    }
+    for (i = 0; (NULL != out->sv) && (i < out->max_sv) && (i < out->numSV); i ++) {
+        ublox_decode_rxm_raw_item(payload, sz_payload, i, out->sv + i);
+    }
+    out->num_sv = i;
+    return 0;
+}
+
+/**
+ * \brief decode RXM-SFRB
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_sfrb(const uint8_t * payload, size_t sz_payload, ublox_rxm_sfrb_t * out)
+{
+    int i;
+    assert (NULL != out);
+    if (sz_payload < 42) {
+        return -1;
+    }
+    out->chn = payload[0];
+    out->svid = payload[1];
+    for (i = 0; i < 10; i ++) {
+        out->dwrd[i] = ublox_get_u32(payload + 2 + i * 4);
+    }
+    return 0;
+}
+
+/**
+ * \brief decode a word of RXM-SFRBX
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the word
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_sfrbx_item(const uint8_t * payload, size_t sz_payload, size_t idx, uint32_t * out)
+{
+    assert (NULL != out);
+    if (8 + idx * 4 + 4 > sz_payload) {
+        return -1;
+    }
+    *out = ublox_get_u32(payload + 8 + idx * 4);
+    return 0;
+}
+
+/**
+ * \brief decode RXM-SFRBX
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the words are stored in out->dwrd
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_sfrbx(const uint8_t * payload, size_t sz_payload, ublox_rxm_sfrbx_t * out)
+{
+    size_t i;
+    assert (NULL != out);
+    out->num_dwrd = 0;
+    if (sz_payload < 8) {
+        return -1;
+    }
+    out->gnssId = payload[0];
+    out->svId = payload[1];
+    out->reserved1 = payload[2];
+    out->freqId = payload[3];
+    out->numWords = payload[4];
+    out->reserved2 = payload[5];
+    out->version = payload[6];
+    out->reserved3 = payload[7];
+    if (8 + (size_t)out->numWords * 4 > sz_payload) {
+        return -1;
+    }
+    for (i = 0; (NULL != out->dwrd) && (i < out->max_dwrd) && (i < out->numWords); i ++) {
+        out->dwrd[i] = ublox_get_u32(payload + 8 + i * 4);
+    }
+    out->num_dwrd = i;
+    return 0;
+}
+
+/**
+ * \brief decode a measurement of RXM-RAWX
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the measurement
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_rawx_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_rxm_rawx_meas_t * out)
+{
+    const uint8_t * p = payload + 16 + idx * 32;
+    assert (NULL != out);
+    if (16 + idx * 32 + 32 > sz_payload) {
+        return -1;
+    }
+    out->prMes = ublox_get_r8(p);
+    out->cpMes = ublox_get_r8(p + 8);
+    out->doMes = ublox_get_r4(p + 16);
+    out->gnssId = p[20];
+    out->svId = p[21];
+    out->sigId = p[22];
+    out->freqId = p[23];
+    out->locktime = ublox_get_u16(p + 24);
+    out->cno = p[26];
+    out->prStdev = p[27];
+    out->cpStdev = p[28];
+    out->doStdev = p[29];
+    out->trkStat = p[30];
+    out->reserved3 = p[31];
+    return 0;
+}
+
+/**
+ * \brief decode RXM-RAWX
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the measurements are stored in out->meas
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_rxm_rawx(const uint8_t * payload, size_t sz_payload, ublox_rxm_rawx_t * out)
+{
+    size_t i;
+    assert (NULL != out);
+    out->num_meas = 0;
+    if (sz_payload < 16) {
+        return -1;
+    }
+    out->rcvTow = ublox_get_r8(payload);
+    out->week = ublox_get_u16(payload + 8);
+    out->leapS = (int8_t)payload[10];
+    out->numMeas = payload[11];
+    out->recStat = payload[12];
+    if (16 + (size_t)out->numMeas * 32 > sz_payload) {
+        return -1;
+    }
+    for (i = 0; (NULL != out->meas) && (i < out->max_meas) && (i < out->numMeas); i ++) {
+        ublox_decode_rxm_rawx_item(payload, sz_payload, i, out->meas + i);
+    }
+    out->num_meas = i;
+    return 0;
+}
+
+/*****************************************************************************/
+// TRK
+
+#define MINPRNSBS   120                 /* min satellite PRN number of SBAS */
+
+/**
+ * \brief get the layout of TRK-D5
+ * \param type: the type of the packet
+ * \param psz_item: the byte size of an item
+ *
+ * \return the offset of the first item
+ */
+static size_t
+ublox_trk_d5_layout(uint8_t type, size_t * psz_item)
+{
+    switch(type) {
+    case 3: *psz_item = 56; return 80;
+    case 6: *psz_item = 64; return 80; // ublox7
+    }
+    *psz_item = 56;
+    return 72;
+}
+
+/**
+ * \brief decode a satellite of TRK-D5
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the satellite
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_trk_d5_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_trk_d5_sat_t * out)
+{
+    const uint8_t * p;
+    size_t off;
+    size_t len;
+    assert (NULL != out);
+    if (sz_payload < 1) {
+        return -1;
+    }
+    off = ublox_trk_d5_layout(payload[0], &len);
+    off += idx * len;
+    if (off + len > sz_payload) {
+        return -1;
+    }
+    p = payload + off;
+    out->ts = ublox_get_r8(p);
+    out->adr = ublox_get_r8(p + 8);
+    out->dop = ublox_get_r4(p + 16);
+    out->snr = ublox_get_u16(p + 32);
+    out->qi = p[41] & 0x07;
+    if (payload[0] == 6) {
+        out->gnssId = p[56];
+        out->svId = p[57];
+        out->freqId = p[59];
+    } else {
+        out->svId = p[34];
+        out->gnssId = (out->svId < MINPRNSBS)?0/*GPS*/:1/*SBS*/;
+        out->freqId = 0;
+    }
+    out->flags = p[54];
+    return 0;
+}
+
+/**
+ * \brief decode TRK-D5
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the satellites are stored in out->sat
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_trk_d5(const uint8_t * payload, size_t sz_payload, ublox_trk_d5_t * out)
+{
+    size_t i;
+    size_t off;
+    size_t len;
+    assert (NULL != out);
+    out->num_sat = 0;
+    out->num_item = 0;
+    if (sz_payload < 1) {
+        return -1;
+    }
+    out->type = payload[0];
+    off = ublox_trk_d5_layout(out->type, &len);
+    if (sz_payload > off) {
+        out->num_item = (sz_payload - off) / len;
+    }
+    for (i = 0; (NULL != out->sat) && (i < out->max_sat) && (i < out->num_item); i ++) {
+        ublox_decode_trk_d5_item(payload, sz_payload, i, out->sat + i);
+    }
+    out->num_sat = i;
+    return 0;
+}
+
+#define UBLOX_TRK_MEAS_OFFSET 104
+#define UBLOX_TRK_MEAS_LEN    56
+
+/**
+ * \brief decode a channel of TRK-MEAS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param idx: the index of the channel
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_trk_meas_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_trk_meas_ch_t * out)
+{
+    const uint8_t * p = payload + UBLOX_TRK_MEAS_OFFSET + idx * UBLOX_TRK_MEAS_LEN;
+    assert (NULL != out);
+    if (UBLOX_TRK_MEAS_OFFSET + idx * UBLOX_TRK_MEAS_LEN + UBLOX_TRK_MEAS_LEN > sz_payload) {
+        return -1;
+    }
+    out->ch = p[0];
+    out->qi = p[1];
+    out->mesQI = p[2];
+    out->gnssId = p[4];
+    out->svId = p[5];
+    out->fcn = p[7];
+    out->status = p[8];
+    out->lock1 = p[16];
+    out->lock2 = p[17];
+    out->cno = ublox_get_u16(p + 20);
+    out->txTow = ublox_get_r8(p + 24);
+    out->adr = ublox_get_r8(p + 32);
+    out->dop = ublox_get_r4(p + 40);
+    return 0;
+}
+
+/**
+ * \brief decode TRK-MEAS
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result, the channels are stored in out->ch
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_trk_meas(const uint8_t * payload, size_t sz_payload, ublox_trk_meas_t * out)
+{
+    size_t i;
+    assert (NULL != out);
+    out->num_ch = 0;
+    out->num_item = 0;
+    if (sz_payload < 4) {
+        return -1;
+    }
+    out->unknown = ublox_get_u16(payload);
+    out->nch = ublox_get_u16(payload + 2);
+    if (sz_payload > UBLOX_TRK_MEAS_OFFSET) {
+        out->num_item = (sz_payload - UBLOX_TRK_MEAS_OFFSET) / UBLOX_TRK_MEAS_LEN;
+    }
+    for (i = 0; (NULL != out->ch) && (i < out->max_ch) && (i < out->num_item); i ++) {
+        ublox_decode_trk_meas_item(payload, sz_payload, i, out->ch + i);
+    }
+    out->num_ch = i;
+    return 0;
+}
+
+/**
+ * \brief decode TRK-SFRBX
+ * \param payload: the payload of the packet
+ * \param sz_payload: the byte size of the payload
+ * \param out: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_decode_trk_sfrbx(const uint8_t * payload, size_t sz_payload, ublox_trk_sfrbx_t * out)
+{
+    assert (NULL != out);
+    if (sz_payload < 5) {
+        return -1;
+    }
+    out->unknown = payload[0];
+    out->gnssId = payload[1];
+    out->svId = payload[2];
+    out->fcn = payload[4];
+    return 0;
+}
+
+/*****************************************************************************/
+// the text output
+
+#define UBLOX_PRINT_SZ_LINES 1024 /**< the buffer of the lines of a measurement formatted by ublox_fmt_xxx() */
+
+/* the line of "label" + value + '\n' */
+static char *
+ublox_print_line_hex(char * p, const char * label, uint64_t val, size_t width)
+{
+    p = ublox_fmt_cstr(p, label);
+    p = ublox_fmt_hex(p, val, width);
+    *p ++ = '\n';
+    return p;
+}
+
+static char *
+ublox_print_line_int(char * p, const char * label, int64_t val)
+{
+    p = ublox_fmt_cstr(p, label);
+    p = ublox_fmt_int(p, val);
+    *p ++ = '\n';
+    return p;
+}
+
+static char *
+ublox_print_line_double(char * p, const char * label, double val)
+{
+    p = ublox_fmt_cstr(p, label);
+    p = ublox_fmt_double(p, val);
+    *p ++ = '\n';
+    return p;
+}
+
+void
+ublox_print_mon_ver_item(FILE * fp, size_t idx, const char * ext)
+{
+    fprintf(fp, "\textPackageVer[%d]: %s\n", (int)idx, ext);
+}
+
+void
+ublox_print_mon_ver(FILE * fp, const ublox_mon_ver_t * msg)
+{
+    fprintf(fp, "\t(type): Receiver/Software Version\n");
+    fprintf(fp, "\tswVersion: %s\n", msg->swVersion);
+    fprintf(fp, "\thwVersion: %s\n", msg->hwVersion);
+    if (msg->flg_rom) {
+        fprintf(fp, "\tromVersion: %s\n", msg->romVersion);
+    }
+}
+
+void
+ublox_print_mon_hw(FILE * fp, const ublox_mon_hw_t * msg)
+{
+    fprintf(fp, "\t(type): Hardware Status\n");
+    fprintf(fp, "\tpinSel: %08X\n", msg->pinSel);
+    fprintf(fp, "\tpinBank: %08X\n", msg->pinBank);
+    fprintf(fp, "\tpinDir: %08X\n", msg->pinDir);
+    fprintf(fp, "\tpinVal: %08X\n", msg->pinVal);
+    fprintf(fp, "\tnoisePerMS: %04X\n", msg->noisePerMS);
+    fprintf(fp, "\tagcCnt: %04X\n", msg->agcCnt);
+    fprintf(fp, "\taStatus: %02X\n", msg->aStatus);
+    fprintf(fp, "\taPower: %02X\n", msg->aPower);
+    fprintf(fp, "\tflags: %02X\n", msg->flags);
+    fprintf(fp, "\treserved1: %02X\n", msg->reserved1);
+    fprintf(fp, "\tusedMask: %08X\n", msg->usedMask);
+    fprintf(fp, "\tVP: sz=%d\n", (int)sizeof(msg->VP));
+    hex_dump_to_fp(stderr, msg->VP, sizeof(msg->VP));
+    fprintf(fp, "\tjamInd: %02X\n", msg->jamInd);
+    fprintf(fp, "\treserved3: %04X\n", msg->reserved3);
+    fprintf(fp, "\tpinIrq: %08X\n", msg->pinIrq);
+    fprintf(fp, "\tpullH: %08X\n", msg->pullH);
+    fprintf(fp, "\tpullL: %08X\n", msg->pullL);
+}
+
+void
+ublox_print_mon_hw2(FILE * fp, const ublox_mon_hw2_t * msg)
+{
+    fprintf(fp, "\t(type): Extended Hardware Status\n");
+    fprintf(fp, "\tofsI: %d\n", msg->ofsI);
+    fprintf(fp, "\tmagI: %d\n", msg->magI);
+    fprintf(fp, "\tofsQ: %d\n", msg->ofsQ);
+    fprintf(fp, "\tmagQ: %d\n", msg->magQ);
+    fprintf(fp, "\tcfgSource: %d\n", msg->cfgSource);
+    fprintf(fp, "\treserved0: sz=%d\n", (int)sizeof(msg->reserved0));
+    hex_dump_to_fp(stderr, msg->reserved0, sizeof(msg->reserved0));
+    fprintf(fp, "\tlowLevCfg: %08X\n", msg->lowLevCfg);
+    fprintf(fp, "\treserved1: sz=%d\n", (int)sizeof(msg->reserved1));
+    hex_dump_to_fp(stderr, msg->reserved1, sizeof(msg->reserved1));
+    fprintf(fp, "\tpostStatus: %08X\n", msg->postStatus);
+    fprintf(fp, "\treserved2: %08X\n", msg->reserved2);
+}
+
+void
+ublox_print_ack(FILE * fp, const ublox_ack_t * msg)
+{
+    fprintf(fp, "\tclsID: %02X\n", msg->clsID);
+    fprintf(fp, "\tmsgID: %02X\n", msg->msgID);
+}
+
+static void
+ublox_print_upd_data(FILE * fp, const ublox_upd_data_t * msg)
+{
+    size_t i;
+    for (i = 0; i < msg->sz_data; i ++) {
+        fprintf(fp, "\tdata[%d]: %02X\n", (int)i, msg->data[i]);
+    }
+}
+
+void
+ublox_print_upd_downl(FILE * fp, const ublox_upd_data_t * msg)
+{
+    fprintf(fp, "\tStartAddr: %08X\n", msg->StartAddr);
+    fprintf(fp, "\tFlags: %08X (%s)\n", msg->Flags, (msg->Flags?((msg->Flags == 1)?"Download ACK":"Download NACK"):"Download"));
+    ublox_print_upd_data(fp, msg);
+}
+
+void
+ublox_print_upd_upload(FILE * fp, const ublox_upd_data_t * msg)
+{
+    fprintf(fp, "\tStartAddr: %08X\n", msg->StartAddr);
+    fprintf(fp, "\tSize: %d\n", msg->Size);
+    fprintf(fp, "\tFlags: %08X (%s)\n", msg->Flags, (msg->Flags?((msg->Flags == 1)?"Upload ACK":"Upload NACK"):"Upload"));
+    ublox_print_upd_data(fp, msg);
+}
+
+void
+ublox_print_upd_exec(FILE * fp, const ublox_upd_exec_t * msg)
+{
+    uint32_t val32 = msg->Flags;
+    fprintf(fp, "\tStartAddr: %08X\n", msg->StartAddr);
+    fprintf(fp, "\tFlags: %08X (%s%s%s%s%s)\n"
+            , val32
+            , ((val32 & 0x01)?"Execution,":"Do not Execute")
+            , ((val32 & 0x02)?"ACK,":"")
+            , ((val32 & 0x04)?"NACK,":"")
+            , ((val32 & 0x08)?"IRQs and FIQ enabled,":"IRQs and FIQ disabled")
+            , ((val32 & 0x10)?"Reset after execution":"")
+            );
+}
+
+void
+ublox_print_upd_memcpy(FILE * fp, const ublox_upd_exec_t * msg)
+{
+    uint32_t val32 = msg->Flags;
+    fprintf(fp, "\tStartAddr: %08X\n", msg->StartAddr);
+    fprintf(fp, "\tDestAddr: %08X\n", msg->DestAddr);
+    fprintf(fp, "\tSize: %08X\n", msg->Size);
+    fprintf(fp, "\tFlags: %08X (%s%s%s%s%s)\n"
+            , val32
+            , ((val32 & 0x01)?"Copy,":"Do not Copy")
+            , ((val32 & 0x02)?"ACK,":"")
+            , ((val32 & 0x04)?"NACK,":"")
+            , ((val32 & 0x09)?"IRQs and FIQ enabled,":"IRQs and FIQ disabled")
+            , ((val32 & 0x10)?"Reset after execution":"")
+           );
+}
+
+void
+ublox_print_upd_sos(FILE * fp, const ublox_upd_sos_t * msg)
+{
+    switch (msg->cmd) {
+    case 0:
+        fprintf(fp, "\t(type): Create Backup File in Flash\n");
+        fprintf(fp, "\tcmd: %02X\n", msg->cmd);
+        break;
+    case 1:
+        fprintf(fp, "\t(type): Clear Backup in Flash\n");
+        fprintf(fp, "\tcmd: %02X\n", msg->cmd);
+        break;
+    case 2:
+        fprintf(fp, "\t(type): Backup File Creation Acknowledge\n");
+        fprintf(fp, "\tcmd: %02X\n", msg->cmd);
+        fprintf(fp, "\tresponse: %02X(%s)\n", msg->response, (msg->response == 1)?"Acknowledged":"Not Acknowledged");
+        break;
+    case 3:
+        fprintf(fp, "\t(type): System Restored from Backup\n");
+        fprintf(fp, "\tcmd: %02X\n", msg->cmd);
+        fprintf(fp, "\tresponse: %02X(%s)\n", msg->response, (msg->response > 0)?(msg->response==1?"Failed restoring from backup file":(msg->response==2?"Restored from backup file":(msg->response==3?"Not restored (no backup)":""))):"Unknown");
+        break;
+    }
+}
+
+void
+ublox_print_cfg_bds(FILE * fp, const ublox_cfg_bds_t * msg)
+{
+    int i;
+    for (i = 0; i < 6; i ++) {
+        fprintf(fp, "\tX4_%d: %08X\n", i + 1, msg->X4[i]);
+    }
+}
+
+void
+ublox_print_cfg_gnss_item(FILE * fp, size_t idx, const ublox_cfg_gnss_block_t * item)
+{
+    fprintf(fp, "\t[%d]\tgnssId: %0d\n", (int)idx, item->gnssId);
+    fprintf(fp, "\t\tresTrkCh: %d\n", item->resTrkCh);
+    fprintf(fp, "\t\tmaxTrkCh: %d\n", item->maxTrkCh);
+    fprintf(fp, "\t\treserved1: %02X\n", item->reserved1);
+    fprintf(fp, "\t\tflags: %08X (%s,sigCfgMask=%02X)\n"
+            , item->flags
+            , ((item->flags & 0x01)?"Enabled":"Disabled")
+            , ((item->flags >> 16) & 0xFF)
+           );
+}
+
+void
+ublox_print_cfg_gnss(FILE * fp, const ublox_cfg_gnss_t * msg)
+{
+    size_t i;
+    fprintf(fp, "\tmsgVer: %02X\n", msg->msgVer);
+    fprintf(fp, "\tnumTrkChHw: %d\n", msg->numTrkChHw);
+    fprintf(fp, "\tnumTrkChUse: %d\n", msg->numTrkChUse);
+    fprintf(fp, "\tnumConfigBlocks: %d\n", msg->numConfigBlocks);
+    for (i = 0; i < msg->num_blocks; i ++) {
+        ublox_print_cfg_gnss_item(fp, i, msg->blocks + i);
+    }
+}
+
+void
+ublox_print_cfg_msg(FILE * fp, const ublox_cfg_msg_t * msg)
+{
+    int i;
+    if (msg->num_rate < 1) {
+        fprintf(fp, "\t(type): Poll a message configuration\n");
+    } else {
+        fprintf(fp, "\t(type): Set Message Rate(s)\n");
+    }
+    fprintf(fp, "\tmsgClass: %02X\n", msg->msgClass);
+    fprintf(fp, "\tmsgID: %02X\n", msg->msgID);
+    fprintf(fp, "\t(classid) %s\n", val2cstr_ublox_classid(msg->msgClass, msg->msgID));
+    for (i = 0; i < msg->num_rate; i ++) {
+        fprintf(fp, "\tout[%d]: %02X (%s:%s)\n", i, msg->rate[i], val2cstr_ublox_portid(i), (msg->rate[i]==0?"OFF":"ON"));
+    }
+}
+
+void
+ublox_print_cfg_prt(FILE * fp, const ublox_cfg_prt_t * msg)
+{
+    if (msg->flg_poll) {
+        fprintf(fp, "\t(type): Polls the configuration for one I/O Port\n");
+    } else {
+        fprintf(fp, "\t(type): Gotten/Set Port Configuration\n");
+    }
+    fprintf(fp, "\tPortID: %s (0x%02X)\n", val2cstr_ublox_portid(msg->portID), msg->portID);
+    if (msg->flg_poll) {
+        return;
+    }
+    fprintf(fp, "\treserved0: %02X\n", msg->reserved0);
+    fprintf(fp, "\ttxReady: %04X\n", msg->txReady);
+    if (msg->portID == 3) {
+        // usb
+        fprintf(fp, "\treserved2: %08X\n", msg->mode);
+    } else {
+        fprintf(fp, "\tmode: %08X\n", msg->mode);
+    }
+    if (msg->portID == 1 || msg->portID == 2) {
+        // UART
+        fprintf(fp, "\tbaudRate: %d(0x%08X)\n", msg->baudRate, msg->baudRate);
+    } else {
+        fprintf(fp, "\treserved3: %08X\n", msg->baudRate);
+    }
+    fprintf(fp, "\tinPortoMask: %04X\n", msg->inProtoMask);
+    fprintf(fp, "\toutPortoMask: %04X\n", msg->outProtoMask);
+    fprintf(fp, "\treserved4: %04X\n", msg->reserved4);
+    fprintf(fp, "\treserved5: %04X\n", msg->reserved5);
+}
+
+void
+ublox_print_cfg_rate(FILE * fp, const ublox_cfg_rate_t * msg)
+{
+    fprintf(fp, "\t(type): Navigation/Measurement Rate Settings\n");
+    fprintf(fp, "\tmeasRate: %d(0x%04X)\n", msg->measRate, msg->measRate);
+    fprintf(fp, "\tnavRate: %d(0x%04X)\n", msg->navRate, msg->navRate);
+    fprintf(fp, "\ttimeRef: %d(0x%04X)\n", msg->timeRef, msg->timeRef);
+}
+
+void
+ublox_print_cfg_cfg(FILE * fp, const ublox_cfg_cfg_t * msg)
+{
+    fprintf(fp, "\tclearMask: %u(0x%08X)\n", msg->clearMask, msg->clearMask);
+    fprintf(fp, "\tsaveMask: %u(0x%08X)\n", msg->saveMask, msg->saveMask);
+    fprintf(fp, "\tloadMask: %u(0x%08X)\n", msg->loadMask, msg->loadMask);
+    if (msg->flg_devicemask) {
+        fprintf(fp, "\tdeviceMask: %d(0x%08X)\n", (int)msg->deviceMask, (int)msg->deviceMask);
+    }
+}
+
+void
+ublox_print_nav_timegps(FILE * fp, const ublox_nav_timegps_t * msg)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_print_line_hex(p, "\tiTOW: ", msg->iTOW, 8);
+    p = ublox_print_line_int(p, "\tfTOW: ", msg->fTOW);
+    p = ublox_print_line_int(p, "\tweek: ", msg->week);
+    p = ublox_print_line_int(p, "\tleapS: ", msg->leapS);
+    p = ublox_print_line_hex(p, "\tvalid: ", msg->valid, 2);
+    p = ublox_print_line_hex(p, "\ttAcc: ", msg->tAcc, 8);
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_nav_clock(FILE * fp, const ublox_nav_clock_t * msg)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_print_line_hex(p, "\tiTOW: ", msg->iTOW, 8);
+    p = ublox_print_line_int(p, "\tclkB: ", msg->clkB);
+    p = ublox_print_line_int(p, "\tclkD: ", msg->clkD);
+    p = ublox_print_line_hex(p, "\ttAcc: ", msg->tAcc, 8);
+    p = ublox_print_line_hex(p, "\tfAcc: ", msg->fAcc, 8);
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_rxm_raw_item(FILE * fp, size_t idx, const ublox_rxm_raw_sv_t * item)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_fmt_cstr(p, "\t[");
+    p = ublox_fmt_uint(p, idx);
+    p = ublox_print_line_double(p, "]\tcpMes: ", item->cpMes);
+    p = ublox_print_line_double(p, "\t\tprMes: ", item->prMes);
+    p = ublox_print_line_double(p, "\t\tdoMes: ", item->doMes);
+    p = ublox_print_line_hex(p, "\t\tsv: ", item->sv, 2);
+    p = ublox_print_line_int(p, "\t\tmesQI: ", item->mesQI);
+    p = ublox_print_line_int(p, "\t\tcno: ", item->cno);
+    p = ublox_print_line_hex(p, "\t\tlli: ", item->lli, 2);
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_rxm_raw(FILE * fp, const ublox_rxm_raw_t * msg)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    size_t i;
+    p = ublox_print_line_int(p, "\tiTOW: ", msg->iTOW);
+    p = ublox_print_line_int(p, "\tweek: ", msg->week);
+    p = ublox_print_line_hex(p, "\tnumSV: ", msg->numSV, 2);
+    p = ublox_print_line_hex(p, "\treserved1: ", msg->reserved1, 2);
+    fwrite(line, 1, p - line, fp);
+    for (i = 0; i < msg->num_sv; i ++) {
+        ublox_print_rxm_raw_item(fp, i, msg->sv + i);
+    }
+}
+
+void
+ublox_print_rxm_sfrb(FILE * fp, const ublox_rxm_sfrb_t * msg)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    int i;
+    p = ublox_print_line_hex(p, "\tchn: ", msg->chn, 2);
+    p = ublox_print_line_hex(p, "\tsvid: ", msg->svid, 2);
+    for(i = 0; i < 10; i ++) {
+        p = ublox_fmt_cstr(p, "\tdwrd[");
+        p = ublox_fmt_uint(p, i);
+        p = ublox_print_line_int(p, "]: ", (int)msg->dwrd[i]);
+    }
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_rxm_sfrbx_item(FILE * fp, size_t idx, uint32_t dwrd)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_fmt_cstr(p, "\tdwrd[");
+    p = ublox_fmt_uint(p, idx);
+    p = ublox_print_line_hex(p, "]: ", dwrd, 8);
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_rxm_sfrbx(FILE * fp, const ublox_rxm_sfrbx_t * msg)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    size_t i;
+    p = ublox_print_line_hex(p, "\tgnssId: ", msg->gnssId, 2);
+    p = ublox_print_line_hex(p, "\tsvId: ", msg->svId, 2);
+    p = ublox_print_line_hex(p, "\treserved1: ", msg->reserved1, 2);
+    p = ublox_print_line_hex(p, "\tfreqId: ", msg->freqId, 2);
+    p = ublox_print_line_hex(p, "\tnumWords: ", msg->numWords, 2);
+    p = ublox_print_line_hex(p, "\treserved2: ", msg->reserved2, 2);
+    p = ublox_print_line_hex(p, "\tversion: ", msg->version, 2);
+    p = ublox_print_line_hex(p, "\treserved3: ", msg->reserved3, 2);
+    fwrite(line, 1, p - line, fp);
+    for (i = 0; i < msg->num_dwrd; i ++) {
+        ublox_print_rxm_sfrbx_item(fp, i, msg->dwrd[i]);
+    }
+}
+
+void
+ublox_print_rxm_rawx_item(FILE * fp, size_t idx, const ublox_rxm_rawx_meas_t * item)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_fmt_cstr(p, "\t[");
+    p = ublox_fmt_uint(p, idx);
+    p = ublox_print_line_double(p, "]\tprMes: ", item->prMes);
+    p = ublox_print_line_double(p, "\t\tcpMes: ", item->cpMes);
+    p = ublox_print_line_double(p, "\t\tdoMes: ", item->doMes);
+    p = ublox_print_line_hex(p, "\t\tgnssId: ", item->gnssId, 2);
+    p = ublox_print_line_hex(p, "\t\tsvId: ", item->svId, 2);
+    p = ublox_print_line_hex(p, "\t\tfreqId: ", item->freqId, 2);
+    p = ublox_print_line_hex(p, "\t\tlocktime: ", item->locktime, 4);
+    p = ublox_print_line_hex(p, "\t\tcno: ", item->cno, 2);
+    p = ublox_print_line_hex(p, "\t\tprStdev: ", item->prStdev, 2);
+    p = ublox_print_line_hex(p, "\t\tcpStdev: ", item->cpStdev, 2);
+    p = ublox_print_line_hex(p, "\t\tdoStdev: ", item->doStdev, 2);
+    p = ublox_print_line_hex(p, "\t\ttrkStat: ", item->trkStat, 2);
+    p = ublox_print_line_hex(p, "\t\treserved3: ", item->reserved3, 2);
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_rxm_rawx(FILE * fp, const ublox_rxm_rawx_t * msg)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    size_t i;
+    p = ublox_print_line_double(p, "\trcvTow: ", msg->rcvTow);
+    p = ublox_print_line_int(p, "\tweek: ", msg->week);
+    p = ublox_print_line_int(p, "\tleapS: ", msg->leapS);
+    p = ublox_print_line_hex(p, "\tnumMeas: ", msg->numMeas, 2);
+    p = ublox_print_line_hex(p, "\trecStat: ", msg->recStat, 2);
+    fwrite(line, 1, p - line, fp);
+    for (i = 0; i < msg->num_meas; i ++) {
+        ublox_print_rxm_rawx_item(fp, i, msg->meas + i);
+    }
+}
+
+void
+ublox_print_trk_d5_item(FILE * fp, const ublox_trk_d5_t * msg, size_t idx, const ublox_trk_d5_sat_t * item)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_fmt_cstr(p, "\t[");
+    p = ublox_fmt_uint(p, idx);
+    p = ublox_print_line_double(p, "]\tts: ", item->ts); // transmission time
+    p = ublox_print_line_double(p, "\t\tadr: ", item->adr);
+    p = ublox_print_line_double(p, "\t\tdop: ", item->dop);
+    p = ublox_print_line_hex(p, "\t\tsnr: ", item->snr, 4);
+    p = ublox_print_line_hex(p, "\t\tqi=", item->qi, 2);
+    p = ublox_fmt_cstr(p, "\t\tgnssId=");
+    p = ublox_fmt_cstr(p, ublox_val2cstr_gnss(item->gnssId));
+    p = ublox_print_line_int(p, "\n\t\tsvId=", item->svId);
+    if (msg->type == 6) {
+        p = ublox_print_line_int(p, "\t\tfreqId=", item->freqId);
+    }
+    p = ublox_print_line_hex(p, "\t\tflags=", item->flags, 2);
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_trk_d5(FILE * fp, const ublox_trk_d5_t * msg)
+{
+    size_t i;
+    fprintf(fp, "\ttype: %d\n", msg->type);
+    for (i = 0; i < msg->num_sat; i ++) {
+        ublox_print_trk_d5_item(fp, msg, i, msg->sat + i);
+    }
+}
+
+void
+ublox_print_trk_meas_item(FILE * fp, size_t idx, const ublox_trk_meas_ch_t * item)
+{
+    char line[UBLOX_PRINT_SZ_LINES];
+    char * p = line;
+    p = ublox_fmt_cstr(p, "\t[");
+    p = ublox_fmt_uint(p, idx);
+    p = ublox_print_line_int(p, "]:\t# ", item->ch);
+    p = ublox_print_line_hex(p, "\t\tqi=", item->qi, 2);
+    p = ublox_print_line_hex(p, "\t\tmesQI: ", item->mesQI, 2);
+    p = ublox_fmt_cstr(p, "\t\tgnss: ");
+    p = ublox_fmt_cstr(p, ublox_val2cstr_gnss(item->gnssId));
+    p = ublox_fmt_cstr(p, "\n\t\tsvid: ");
+    p = ublox_fmt_hex(p, item->svId, 2);
+    p = ublox_fmt_cstr(p, " (satellite ID (PRN/slot number))\n\t\tfcn: ");
+    p = ublox_fmt_hex(p, item->fcn, 2);
+    p = ublox_fmt_cstr(p, " (GLO frequency channel number+7)\n\t\tstatus: ");
+    p = ublox_fmt_hex(p, item->status, 2);
+    p = ublox_fmt_cstr(p, " (tracking/lock status (bit3: half-cycle))\n\t\tlock1: ");
+    p = ublox_fmt_hex(p, item->lock1, 2);
+    p = ublox_fmt_cstr(p, " (code lock count)\n\t\tlock2: ");
+    p = ublox_fmt_hex(p, item->lock2, 2);
+    p = ublox_fmt_cstr(p, " (carrier lock count)\n\t\tcno: ");
+    p = ublox_fmt_hex(p, item->cno, 4);
+    p = ublox_fmt_cstr(p, " (C/N0 (2^{-8} dBHz))\n\t\ttxTow: ");
+    p = ublox_fmt_double(p, item->txTow);
+    p = ublox_fmt_cstr(p, " (transmission time in gps week (2^{-32} ms))\n\t\tadr: ");
+    p = ublox_fmt_double(p, item->adr);
+    p = ublox_fmt_cstr(p, " (accumulated Doppler range (2^{-32} cycle))\n\t\tdop: ");
+    p = ublox_fmt_double(p, item->dop);
+    p = ublox_fmt_cstr(p, " (Doppler frequency (2^{-32}x10 Hz))\n");
+    fwrite(line, 1, p - line, fp);
+}
+
+void
+ublox_print_trk_meas(FILE * fp, const ublox_trk_meas_t * msg)
+{
+    size_t i;
+    fprintf(fp, "\tunknown: %d\n", msg->unknown);
+    fprintf(fp, "\tnch: %d (number of channels)\n", msg->nch);
+    for (i = 0; i < msg->num_ch; i ++) {
+        ublox_print_trk_meas_item(fp, i, msg->ch + i);
+    }
+}
+
+void
+ublox_print_trk_sfrbx(FILE * fp, const ublox_trk_sfrbx_t * msg)
+{
+    fprintf(fp, "\tunknown: %02X\n", msg->unknown);
+    fprintf(fp, "\tgnss: %s\n", ublox_val2cstr_gnss(msg->gnssId));
+    fprintf(fp, "\tsvid: %02X (satellite ID (PRN/slot number))\n", msg->svId);
+    fprintf(fp, "\tfcn: %02X (GLO frequency channel number+7)\n", msg->fcn);
+}
+
+/**
+ * \brief decode the packet and print the text
+ * \param fp: the output
+ * \param buffer_in: the buffer contains the verified packet
+ * \param sz_in: the byte size of the buffer
+ *
+ * \return 0 on success, =2 the packet is not supported, <0 the packet is malformed
+ *
+ * The repeated blocks are decoded and printed one by one, no storage needed.
+ */
+int
+ublox_print_packet(FILE * fp, const uint8_t * buffer_in, size_t sz_in)
+{
+    const uint8_t * payload;
+    uint16_t classid;
+    size_t count;
+    size_t i;
+    int ret = 0;
+
+    assert (NULL != fp);
+    if ((NULL == buffer_in) || (sz_in < UBLOX_PKT_LENGTH_MIN)) {
+        return -1;
+    }
+    count = UBLOX_PKG_LENGTH(buffer_in);
+    if (sz_in < UBLOX_PKT_LENGTH_MIN + count) {
+        return -1;
+    }
+    classid = UBLOX_CLASS_ID(buffer_in[2], buffer_in[3]);
+    payload = buffer_in + UBLOX_PKT_LENGTH_HDR;
+
+    fprintf(fp, "ublox %s:\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]));
+
+#define UBLOX_PRINT_MSG(type_t, name) \
+    { \
+        type_t msg; \
+        memset(&msg, 0, sizeof(msg)); \
+        ret = ublox_decode_##name(payload, count, &msg); \
+        if (ret >= 0) { \
+            ublox_print_##name(fp, &msg); \
+        } \
+    }
+#define UBLOX_PRINT_POLL(cstr) \
+    if (count == 0) { \
+        fprintf(fp, "\t(type): " cstr "\n"); \
+        break; \
+    }
+
+    switch (classid) {
+    case UBX_MON_VER:
+        UBLOX_PRINT_POLL("Poll Receiver/Software Version");
+        {
+            ublox_mon_ver_t msg;
+            char buf[UBLOX_MON_VER_LEN_EXT + 1];
+            ret = ublox_decode_mon_ver(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_mon_ver(fp, &msg);
+            for (i = 0; i < msg.num_ext; i ++) {
+                if (ublox_decode_mon_ver_item(payload, count, i, buf) < 0) {
+                    break;
+                }
+                ublox_print_mon_ver_item(fp, i, buf);
+            }
+        }
+        break;
+    case UBX_MON_HW:
+        UBLOX_PRINT_POLL("Poll Hardware Status");
+        UBLOX_PRINT_MSG(ublox_mon_hw_t, mon_hw);
+        break;
+    case UBX_MON_HW2:
+        UBLOX_PRINT_POLL("Poll Extended Hardware Status");
+        UBLOX_PRINT_MSG(ublox_mon_hw2_t, mon_hw2);
+        break;
+
+    case UBX_ACK_ACK:
+    case UBX_ACK_NAK:
+        UBLOX_PRINT_MSG(ublox_ack_t, ack);
+        break;
+
+    case UBX_UPD_DOWNL:
+        UBLOX_PRINT_MSG(ublox_upd_data_t, upd_downl);
+        break;
+    case UBX_UPD_UPLOAD:
+        UBLOX_PRINT_MSG(ublox_upd_data_t, upd_upload);
+        break;
+    case UBX_UPD_EXEC:
+        UBLOX_PRINT_MSG(ublox_upd_exec_t, upd_exec);
+        break;
+    case UBX_UPD_MEMCPY:
+        UBLOX_PRINT_MSG(ublox_upd_exec_t, upd_memcpy);
+        break;
+    case UBX_UPD_SOS:
+        UBLOX_PRINT_POLL("Poll Backup File Restore Status");
+        UBLOX_PRINT_MSG(ublox_upd_sos_t, upd_sos);
+        break;
+
+    case UBX_CFG_BDS:
+        UBLOX_PRINT_MSG(ublox_cfg_bds_t, cfg_bds);
+        break;
+    case UBX_CFG_GNSS:
+        {
+            ublox_cfg_gnss_t msg;
+            ublox_cfg_gnss_block_t item;
+            memset(&msg, 0, sizeof(msg));
+            ret = ublox_decode_cfg_gnss(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_cfg_gnss(fp, &msg);
+            for (i = 0; i < msg.numConfigBlocks; i ++) {
+                if (ublox_decode_cfg_gnss_item(payload, count, i, &item) < 0) {
+                    break;
+                }
+                ublox_print_cfg_gnss_item(fp, i, &item);
+            }
+        }
+        break;
+    case UBX_CFG_MSG:
+        UBLOX_PRINT_MSG(ublox_cfg_msg_t, cfg_msg);
+        break;
+    case UBX_CFG_PRT:
+        UBLOX_PRINT_POLL("Polls the configuration of the used I/O Port");
+        UBLOX_PRINT_MSG(ublox_cfg_prt_t, cfg_prt);
+        break;
+    case UBX_CFG_RATE:
+        UBLOX_PRINT_POLL("Poll Navigation/Measurement Rate Settings");
+        UBLOX_PRINT_MSG(ublox_cfg_rate_t, cfg_rate);
+        break;
+    case UBX_CFG_CFG:
+        UBLOX_PRINT_MSG(ublox_cfg_cfg_t, cfg_cfg);
+        break;
+
+    case UBX_NAV_TIMEGPS:
+        UBLOX_PRINT_MSG(ublox_nav_timegps_t, nav_timegps);
+        break;
+    case UBX_NAV_CLOCK:
+        UBLOX_PRINT_MSG(ublox_nav_clock_t, nav_clock);
+        break;
+
+    case UBX_RXM_RAW:
+        {
+            ublox_rxm_raw_t msg;
+            ublox_rxm_raw_sv_t item;
+            memset(&msg, 0, sizeof(msg));
+            ret = ublox_decode_rxm_raw(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_rxm_raw(fp, &msg);
+            for (i = 0; i < msg.numSV; i ++) {
+                if (ublox_decode_rxm_raw_item(payload, count, i, &item) < 0) {
+                    break;
+                }
+                ublox_print_rxm_raw_item(fp, i, &item);
+            }
+        }
+        break;
+    case UBX_RXM_SFRB:
+        UBLOX_PRINT_MSG(ublox_rxm_sfrb_t, rxm_sfrb);
+        break;
+    case UBX_RXM_SFRBX: // ublox8
+        {
+            ublox_rxm_sfrbx_t msg;
+            uint32_t item;
+            memset(&msg, 0, sizeof(msg));
+            ret = ublox_decode_rxm_sfrbx(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_rxm_sfrbx(fp, &msg);
+            for (i = 0; i < msg.numWords; i ++) {
+                if (ublox_decode_rxm_sfrbx_item(payload, count, i, &item) < 0) {
+                    break;
+                }
+                ublox_print_rxm_sfrbx_item(fp, i, item);
+            }
+        }
+        break;
+    case UBX_RXM_RAWX: // ublox8
+        {
+            ublox_rxm_rawx_t msg;
+            ublox_rxm_rawx_meas_t item;
+            memset(&msg, 0, sizeof(msg));
+            ret = ublox_decode_rxm_rawx(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_rxm_rawx(fp, &msg);
+            for (i = 0; i < msg.numMeas; i ++) {
+                if (ublox_decode_rxm_rawx_item(payload, count, i, &item) < 0) {
+                    break;
+                }
+                ublox_print_rxm_rawx_item(fp, i, &item);
+            }
+        }
+        break;
+
+    case UBX_TRK_D5:
+        {
+            ublox_trk_d5_t msg;
+            ublox_trk_d5_sat_t item;
+            memset(&msg, 0, sizeof(msg));
+            ret = ublox_decode_trk_d5(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_trk_d5(fp, &msg);
+            for (i = 0; i < msg.num_item; i ++) {
+                if (ublox_decode_trk_d5_item(payload, count, i, &item) < 0) {
+                    break;
+                }
+                ublox_print_trk_d5_item(fp, &msg, i, &item);
+            }
+        }
+        break;
+    case UBX_TRK_MEAS:
+        {
+            ublox_trk_meas_t msg;
+            ublox_trk_meas_ch_t item;
+            memset(&msg, 0, sizeof(msg));
+            ret = ublox_decode_trk_meas(payload, count, &msg);
+            if (ret < 0) {
+                break;
+            }
+            ublox_print_trk_meas(fp, &msg);
+            for (i = 0; i < msg.num_item; i ++) {
+                if (ublox_decode_trk_meas_item(payload, count, i, &item) < 0) {
+                    break;
+                }
+                ublox_print_trk_meas_item(fp, i, &item);
+            }
+        }
+        break;
+    case UBX_TRK_SFRBX:
+        UBLOX_PRINT_MSG(ublox_trk_sfrbx_t, trk_sfrbx);
+        break;
+
+    default:
+        ret = 2;
+        break;
+    }
+#undef UBLOX_PRINT_POLL
+#undef UBLOX_PRINT_MSG
+
+    return ret;
+}
+
+/**
+ * \brief the handler to print the packet, see ublox_registry_set()
+ * \param userdata: the FILE * of the output
+ * \param buffer_in: the verified packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_print_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    int ret;
+    ret = ublox_print_packet((FILE *)userdata, buffer_in, sz_in);
+    if (ret != 0) {
+        TE("ublox error: malformed payload in packet: classid=%s(0x%04X), size=%" PRIuSZ "\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]), UBLOX_CLASS_ID(buffer_in[2], buffer_in[3]), sz_in);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief register the text printer for all of the packets supported by ublox_print_packet()
+ * \param reg: the registry
+ * \param fp: the output
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_registry_add_printer(ublox_registry_t * reg, FILE * fp)
+{
+    static const uint16_t list_classid[] = {
+        UBX_MON_VER, UBX_MON_HW, UBX_MON_HW2,
+        UBX_ACK_ACK, UBX_ACK_NAK,
+        UBX_UPD_DOWNL, UBX_UPD_UPLOAD, UBX_UPD_EXEC, UBX_UPD_MEMCPY, UBX_UPD_SOS,
+        UBX_CFG_BDS, UBX_CFG_GNSS, UBX_CFG_MSG, UBX_CFG_PRT, UBX_CFG_RATE, UBX_CFG_CFG,
+        UBX_NAV_TIMEGPS, UBX_NAV_CLOCK,
+        UBX_RXM_RAW, UBX_RXM_SFRB, UBX_RXM_SFRBX, UBX_RXM_RAWX,
+        UBX_TRK_D5, UBX_TRK_MEAS, UBX_TRK_SFRBX,
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(list_classid) / sizeof(list_classid[0]); i ++) {
+        if (0 > ublox_registry_set(reg, list_classid[i], ublox_print_handler, fp)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+#include "ubloxutils.h"
+
+TEST_CASE( .name="ublox-decode", .description="Test ublox decode functions." ) {
+    uint8_t buffer[8 + 16 + 32 * 3];
+    uint8_t * p;
+    ublox_rxm_rawx_t rawx;
+    ublox_rxm_rawx_meas_t meas[2];
+    ublox_rxm_rawx_meas_t item;
+    ublox_cfg_rate_t rate;
+    ublox_ack_t ack;
+    double f8;
+    float f4;
+    ssize_t ret;
+    int i;
+
+    SECTION("test ublox decode fixed size packets") {
+        ret = ublox_pkt_create_set_cfgrate(buffer, sizeof(buffer), 100, 1, 1);
+        REQUIRE(ret > 0);
+        REQUIRE(0 == ublox_decode_cfg_rate(buffer + 6, UBLOX_PKG_LENGTH(buffer), &rate));
+        REQUIRE(100 == rate.measRate);
+        REQUIRE(1 == rate.navRate);
+        REQUIRE(1 == rate.timeRef);
+        REQUIRE(0 > ublox_decode_cfg_rate(buffer + 6, 5, &rate));
+
+        buffer[6] = 0x06;
+        buffer[7] = 0x01;
+        REQUIRE(0 == ublox_decode_ack(buffer + 6, 2, &ack));
+        REQUIRE(0x06 == ack.clsID);
+        REQUIRE(0x01 == ack.msgID);
+        REQUIRE(0 > ublox_decode_ack(buffer + 6, 1, &ack));
+    }
+    SECTION("test ublox decode RXM-RAWX") {
+        memset(buffer, 0, sizeof(buffer));
+        buffer[0] = 0xB5;
+        buffer[1] = 0x62;
+        buffer[2] = UBLOX_2CLASS(UBX_RXM_RAWX);
+        buffer[3] = UBLOX_2ID(UBX_RXM_RAWX);
+        buffer[4] = 16 + 32 * 3;
+        buffer[5] = 0;
+        p = buffer + 6;
+        f8 = 123456.5;
+        memmove(p, &f8, sizeof(f8));
+        p[8] = 0x2B; p[9] = 0x08; // week 2091
+        p[10] = 18;
+        p[11] = 3;
+        for (i = 0; i < 3; i ++) {
+            p = buffer + 6 + 16 + i * 32;
+            f8 = 20000000.0 + i;
+            memmove(p, &f8, sizeof(f8));
+            f4 = -100.25f * i;
+            memmove(p + 16, &f4, sizeof(f4));
+            p[20] = (uint8_t)i;
+            p[21] = (uint8_t)(10 + i);
+            p[26] = 40;
+        }
+        // header only
+        memset(&rawx, 0, sizeof(rawx));
+        REQUIRE(0 == ublox_decode_rxm_rawx(buffer + 6, UBLOX_PKG_LENGTH(buffer), &rawx));
+        REQUIRE(123456.5 == rawx.rcvTow);
+        REQUIRE(2091 == rawx.week);
+        REQUIRE(18 == rawx.leapS);
+        REQUIRE(3 == rawx.numMeas);
+        REQUIRE(0 == rawx.num_meas);
+        // the storage is smaller than the number of measurements
+        rawx.meas = meas;
+        rawx.max_meas = NUM_ARRAY(meas);
+        REQUIRE(0 == ublox_decode_rxm_rawx(buffer + 6, UBLOX_PKG_LENGTH(buffer), &rawx));
+        REQUIRE(2 == rawx.num_meas);
+        REQUIRE(20000001.0 == meas[1].prMes);
+        REQUIRE(-100.25f == meas[1].doMes);
+        REQUIRE(11 == meas[1].svId);
+        REQUIRE(40 == meas[1].cno);
+        REQUIRE(0 == ublox_decode_rxm_rawx_item(buffer + 6, UBLOX_PKG_LENGTH(buffer), 2, &item));
+        REQUIRE(12 == item.svId);
+        REQUIRE(0 > ublox_decode_rxm_rawx_item(buffer + 6, UBLOX_PKG_LENGTH(buffer), 3, &item));
+        // truncated
+        REQUIRE(0 > ublox_decode_rxm_rawx(buffer + 6, UBLOX_PKG_LENGTH(buffer) - 1, &rawx));
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,375 @@
+/**
+ * \file    ubloxdec.h
+ * \brief   Decode UBX packets to C structures
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_DEC_H
+#define UBLOX_DEC_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxreg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The decoders take the payload of a packet (the data after the 6-byte header,
+ * without the checksum) and fill the structure, they return 0 on success and
+ * <0 if the payload is too short.
+ *
+ * The repeated blocks (RXM-RAWX, RXM-SFRBX, TRK-MEAS, ...) are stored in the
+ * array provided by the caller: set the pointer and the max number of items
+ * before calling the decoder, it fills min(number in packet, max) items and
+ * sets num_xxx to the number filled. The pointer can be NULL to decode the
+ * header only; the items can then be decoded one by one by ublox_decode_xxx_item().
+ *
+ * The printers output the text of ublox_cli_verify_tcp().
+ */
+
+#define UBLOX_MON_VER_LEN_SW  30
+#define UBLOX_MON_VER_LEN_HW  10
+#define UBLOX_MON_VER_LEN_EXT 30
+
+typedef struct _ublox_mon_ver_t {
+    char swVersion[UBLOX_MON_VER_LEN_SW + 1];
+    char hwVersion[UBLOX_MON_VER_LEN_HW + 1];
+    uint8_t flg_rom;                            /**< if romVersion exists */
+    char romVersion[UBLOX_MON_VER_LEN_EXT + 1];
+    size_t num_ext;                             /**< the number of extPackageVer */
+} ublox_mon_ver_t;
+
+typedef struct _ublox_mon_hw_t {
+    uint32_t pinSel;
+    uint32_t pinBank;
+    uint32_t pinDir;
+    uint32_t pinVal;
+    uint16_t noisePerMS;
+    uint16_t agcCnt;
+    uint8_t aStatus;
+    uint8_t aPower;
+    uint8_t flags;
+    uint8_t reserved1;
+    uint32_t usedMask;
+    uint8_t VP[25];
+    uint8_t jamInd;
+    uint16_t reserved3;
+    uint32_t pinIrq;
+    uint32_t pullH;
+    uint32_t pullL;
+} ublox_mon_hw_t;
+
+typedef struct _ublox_mon_hw2_t {
+    int8_t ofsI;
+    uint8_t magI;
+    int8_t ofsQ;
+    uint8_t magQ;
+    uint8_t cfgSource;
+    uint8_t reserved0[3];
+    uint32_t lowLevCfg;
+    uint8_t reserved1[8];
+    uint32_t postStatus;
+    uint32_t reserved2;
+} ublox_mon_hw2_t;
+
+/** ACK-ACK, ACK-NAK */
+typedef struct _ublox_ack_t {
+    uint8_t clsID;
+    uint8_t msgID;
+} ublox_ack_t;
+
+/** UPD-DOWNL, UPD-UPLOAD */
+typedef struct _ublox_upd_data_t {
+    uint32_t StartAddr;
+    uint32_t Size;       /**< UPD-UPLOAD only */
+    uint32_t Flags;
+    const uint8_t * data; /**< points to the payload */
+    size_t sz_data;
+} ublox_upd_data_t;
+
+/** UPD-EXEC, UPD-MEMCPY */
+typedef struct _ublox_upd_exec_t {
+    uint32_t StartAddr;
+    uint32_t DestAddr;   /**< UPD-MEMCPY only */
+    uint32_t Size;       /**< UPD-MEMCPY only */
+    uint32_t Flags;
+} ublox_upd_exec_t;
+
+typedef struct _ublox_upd_sos_t {
+    uint8_t cmd;
+    uint8_t response;    /**< for cmd 2 and 3 */
+} ublox_upd_sos_t;
+
+typedef struct _ublox_cfg_bds_t {
+    uint32_t X4[6];
+} ublox_cfg_bds_t;
+
+typedef struct _ublox_cfg_gnss_block_t {
+    uint8_t gnssId;
+    uint8_t resTrkCh;
+    uint8_t maxTrkCh;
+    uint8_t reserved1;
+    uint32_t flags;
+} ublox_cfg_gnss_block_t;
+
+typedef struct _ublox_cfg_gnss_t {
+    uint8_t msgVer;
+    uint8_t numTrkChHw;
+    uint8_t numTrkChUse;
+    uint8_t numConfigBlocks;
+    ublox_cfg_gnss_block_t * blocks; /**< the storage from the caller, can be NULL */
+    size_t max_blocks;
+    size_t num_blocks;               /**< the number of items stored in blocks */
+} ublox_cfg_gnss_t;
+
+#define UBLOX_CFG_MSG_NUM_PORT 6
+typedef struct _ublox_cfg_msg_t {
+    uint8_t msgClass;
+    uint8_t msgID;
+    uint8_t num_rate;                  /**< 0 for poll */
+    uint8_t rate[UBLOX_CFG_MSG_NUM_PORT];
+} ublox_cfg_msg_t;
+
+typedef struct _ublox_cfg_prt_t {
+    uint8_t flg_poll;    /**< only portID */
+    uint8_t portID;
+    uint8_t reserved0;
+    uint16_t txReady;
+    uint32_t mode;       /**< reserved2 for USB */
+    uint32_t baudRate;   /**< reserved3 for the port other than UART */
+    uint16_t inProtoMask;
+    uint16_t outProtoMask;
+    uint16_t reserved4;
+    uint16_t reserved5;
+} ublox_cfg_prt_t;
+
+typedef struct _ublox_cfg_rate_t {
+    uint16_t measRate;
+    uint16_t navRate;
+    uint16_t timeRef;
+} ublox_cfg_rate_t;
+
+typedef struct _ublox_cfg_cfg_t {
+    uint32_t clearMask;
+    uint32_t saveMask;
+    uint32_t loadMask;
+    uint8_t flg_devicemask; /**< if deviceMask exists */
+    uint8_t deviceMask;
+} ublox_cfg_cfg_t;
+
+typedef struct _ublox_nav_timegps_t {
+    uint32_t iTOW;
+    int32_t fTOW;
+    int16_t week;
+    int8_t leapS;
+    uint8_t valid;
+    uint32_t tAcc;
+} ublox_nav_timegps_t;
+
+typedef struct _ublox_nav_clock_t {
+    uint32_t iTOW;
+    int32_t clkB;
+    int32_t clkD;
+    uint32_t tAcc;
+    uint32_t fAcc;
+} ublox_nav_clock_t;
+
+typedef struct _ublox_rxm_raw_sv_t {
+    double cpMes;
+    double prMes;
+    float doMes;
+    uint8_t sv;
+    int8_t mesQI;
+    int8_t cno;
+    uint8_t lli;
+} ublox_rxm_raw_sv_t;
+
+typedef struct _ublox_rxm_raw_t {
+    int32_t iTOW;
+    int16_t week;
+    uint8_t numSV;
+    uint8_t reserved1;
+    ublox_rxm_raw_sv_t * sv;  /**< the storage from the caller, can be NULL */
+    size_t max_sv;
+    size_t num_sv;            /**< the number of items stored in sv */
+} ublox_rxm_raw_t;
+
+typedef struct _ublox_rxm_sfrb_t {
+    uint8_t chn;
+    uint8_t svid;
+    uint32_t dwrd[10];
+} ublox_rxm_sfrb_t;
+
+typedef struct _ublox_rxm_sfrbx_t {
+    uint8_t gnssId;
+    uint8_t svId;
+    uint8_t reserved1;
+    uint8_t freqId;
+    uint8_t numWords;
+    uint8_t reserved2;
+    uint8_t version;
+    uint8_t reserved3;
+    uint32_t * dwrd;          /**< the storage from the caller, can be NULL */
+    size_t max_dwrd;
+    size_t num_dwrd;          /**< the number of items stored in dwrd */
+} ublox_rxm_sfrbx_t;
+
+typedef struct _ublox_rxm_rawx_meas_t {
+    double prMes;
+    double cpMes;
+    float doMes;
+    uint8_t gnssId;
+    uint8_t svId;
+    uint8_t sigId;            /**< the signal ID, reserved before the protocol version 27 */
+    uint8_t freqId;
+    uint16_t locktime;
+    uint8_t cno;
+    uint8_t prStdev;
+    uint8_t cpStdev;
+    uint8_t doStdev;
+    uint8_t trkStat;
+    uint8_t reserved3;
+} ublox_rxm_rawx_meas_t;
+
+typedef struct _ublox_rxm_rawx_t {
+    double rcvTow;
+    uint16_t week;
+    int8_t leapS;
+    uint8_t numMeas;
+    uint8_t recStat;
+    ublox_rxm_rawx_meas_t * meas; /**< the storage from the caller, can be NULL */
+    size_t max_meas;
+    size_t num_meas;              /**< the number of items stored in meas */
+} ublox_rxm_rawx_t;
+
+typedef struct _ublox_trk_d5_sat_t {
+    double ts;        /**< transmission time */
+    double adr;
+    float dop;
+    uint16_t snr;
+    uint8_t qi;       /**< quality indicator */
+    uint8_t gnssId;
+    uint8_t svId;
+    uint8_t freqId;   /**< type 6 only */
+    uint8_t flags;
+} ublox_trk_d5_sat_t;
+
+typedef struct _ublox_trk_d5_t {
+    uint8_t type;
+    size_t num_item;          /**< the number of satellites in the packet */
+    ublox_trk_d5_sat_t * sat; /**< the storage from the caller, can be NULL */
+    size_t max_sat;
+    size_t num_sat;           /**< the number of items stored in sat */
+} ublox_trk_d5_t;
+
+typedef struct _ublox_trk_meas_ch_t {
+    uint8_t ch;
+    uint8_t qi;       /**< quality indicator (0:idle,1:search,2:aquired,3:unusable,4:code lock,5,6,7:code/carrier lock) */
+    uint8_t mesQI;
+    uint8_t gnssId;
+    uint8_t svId;     /**< satellite ID (PRN/slot number) */
+    uint8_t fcn;      /**< GLO frequency channel number+7 */
+    uint8_t status;   /**< tracking/lock status (bit3: half-cycle) */
+    uint8_t lock1;    /**< code lock count */
+    uint8_t lock2;    /**< carrier lock count */
+    uint16_t cno;     /**< C/N0 (2^{-8} dBHz) */
+    double txTow;     /**< transmission time in gps week (2^{-32} ms) */
+    double adr;       /**< accumulated Doppler range (2^{-32} cycle) */
+    float dop;        /**< Doppler frequency (2^{-32}x10 Hz) */
+} ublox_trk_meas_ch_t;
+
+typedef struct _ublox_trk_meas_t {
+    uint16_t unknown;
+    uint16_t nch;             /**< number of channels */
+    size_t num_item;          /**< the number of channels in the packet */
+    ublox_trk_meas_ch_t * ch; /**< the storage from the caller, can be NULL */
+    size_t max_ch;
+    size_t num_ch;            /**< the number of items stored in ch */
+} ublox_trk_meas_t;
+
+typedef struct _ublox_trk_sfrbx_t {
+    uint8_t unknown;
+    uint8_t gnssId;
+    uint8_t svId;
+    uint8_t fcn;
+} ublox_trk_sfrbx_t;
+
+int ublox_decode_mon_ver(const uint8_t * payload, size_t sz_payload, ublox_mon_ver_t * out);
+int ublox_decode_mon_ver_item(const uint8_t * payload, size_t sz_payload, size_t idx, char * out /* UBLOX_MON_VER_LEN_EXT + 1 */);
+int ublox_decode_mon_hw(const uint8_t * payload, size_t sz_payload, ublox_mon_hw_t * out);
+int ublox_decode_mon_hw2(const uint8_t * payload, size_t sz_payload, ublox_mon_hw2_t * out);
+int ublox_decode_ack(const uint8_t * payload, size_t sz_payload, ublox_ack_t * out);
+int ublox_decode_upd_downl(const uint8_t * payload, size_t sz_payload, ublox_upd_data_t * out);
+int ublox_decode_upd_upload(const uint8_t * payload, size_t sz_payload, ublox_upd_data_t * out);
+int ublox_decode_upd_exec(const uint8_t * payload, size_t sz_payload, ublox_upd_exec_t * out);
+int ublox_decode_upd_memcpy(const uint8_t * payload, size_t sz_payload, ublox_upd_exec_t * out);
+int ublox_decode_upd_sos(const uint8_t * payload, size_t sz_payload, ublox_upd_sos_t * out);
+int ublox_decode_cfg_bds(const uint8_t * payload, size_t sz_payload, ublox_cfg_bds_t * out);
+int ublox_decode_cfg_gnss(const uint8_t * payload, size_t sz_payload, ublox_cfg_gnss_t * out);
+int ublox_decode_cfg_gnss_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_cfg_gnss_block_t * out);
+int ublox_decode_cfg_msg(const uint8_t * payload, size_t sz_payload, ublox_cfg_msg_t * out);
+int ublox_decode_cfg_prt(const uint8_t * payload, size_t sz_payload, ublox_cfg_prt_t * out);
+int ublox_decode_cfg_rate(const uint8_t * payload, size_t sz_payload, ublox_cfg_rate_t * out);
+int ublox_decode_cfg_cfg(const uint8_t * payload, size_t sz_payload, ublox_cfg_cfg_t * out);
+int ublox_decode_nav_timegps(const uint8_t * payload, size_t sz_payload, ublox_nav_timegps_t * out);
+int ublox_decode_nav_clock(const uint8_t * payload, size_t sz_payload, ublox_nav_clock_t * out);
+int ublox_decode_rxm_raw(const uint8_t * payload, size_t sz_payload, ublox_rxm_raw_t * out);
+int ublox_decode_rxm_raw_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_rxm_raw_sv_t * out);
+int ublox_decode_rxm_sfrb(const uint8_t * payload, size_t sz_payload, ublox_rxm_sfrb_t * out);
+int ublox_decode_rxm_sfrbx(const uint8_t * payload, size_t sz_payload, ublox_rxm_sfrbx_t * out);
+int ublox_decode_rxm_sfrbx_item(const uint8_t * payload, size_t sz_payload, size_t idx, uint32_t * out);
+int ublox_decode_rxm_rawx(const uint8_t * payload, size_t sz_payload, ublox_rxm_rawx_t * out);
+int ublox_decode_rxm_rawx_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_rxm_rawx_meas_t * out);
+int ublox_decode_trk_d5(const uint8_t * payload, size_t sz_payload, ublox_trk_d5_t * out);
+int ublox_decode_trk_d5_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_trk_d5_sat_t * out);
+int ublox_decode_trk_meas(const uint8_t * payload, size_t sz_payload, ublox_trk_meas_t * out);
+int ublox_decode_trk_meas_item(const uint8_t * payload, size_t sz_payload, size_t idx, ublox_trk_meas_ch_t * out);
+int ublox_decode_trk_sfrbx(const uint8_t * payload, size_t sz_payload, ublox_trk_sfrbx_t * out);
+
+void ublox_print_mon_ver(FILE * fp, const ublox_mon_ver_t * msg);
+void ublox_print_mon_ver_item(FILE * fp, size_t idx, const char * ext);
+void ublox_print_mon_hw(FILE * fp, const ublox_mon_hw_t * msg);
+void ublox_print_mon_hw2(FILE * fp, const ublox_mon_hw2_t * msg);
+void ublox_print_ack(FILE * fp, const ublox_ack_t * msg);
+void ublox_print_upd_downl(FILE * fp, const ublox_upd_data_t * msg);
+void ublox_print_upd_upload(FILE * fp, const ublox_upd_data_t * msg);
+void ublox_print_upd_exec(FILE * fp, const ublox_upd_exec_t * msg);
+void ublox_print_upd_memcpy(FILE * fp, const ublox_upd_exec_t * msg);
+void ublox_print_upd_sos(FILE * fp, const ublox_upd_sos_t * msg);
+void ublox_print_cfg_bds(FILE * fp, const ublox_cfg_bds_t * msg);
+void ublox_print_cfg_gnss(FILE * fp, const ublox_cfg_gnss_t * msg);
+void ublox_print_cfg_gnss_item(FILE * fp, size_t idx, const ublox_cfg_gnss_block_t * item);
+void ublox_print_cfg_msg(FILE * fp, const ublox_cfg_msg_t * msg);
+void ublox_print_cfg_prt(FILE * fp, const ublox_cfg_prt_t * msg);
+void ublox_print_cfg_rate(FILE * fp, const ublox_cfg_rate_t * msg);
+void ublox_print_cfg_cfg(FILE * fp, const ublox_cfg_cfg_t * msg);
+void ublox_print_nav_timegps(FILE * fp, const ublox_nav_timegps_t * msg);
+void ublox_print_nav_clock(FILE * fp, const ublox_nav_clock_t * msg);
+void ublox_print_rxm_raw(FILE * fp, const ublox_rxm_raw_t * msg);
+void ublox_print_rxm_raw_item(FILE * fp, size_t idx, const ublox_rxm_raw_sv_t * item);
+void ublox_print_rxm_sfrb(FILE * fp, const ublox_rxm_sfrb_t * msg);
+void ublox_print_rxm_sfrbx(FILE * fp, const ublox_rxm_sfrbx_t * msg);
+void ublox_print_rxm_sfrbx_item(FILE * fp, size_t idx, uint32_t dwrd);
+void ublox_print_rxm_rawx(FILE * fp, const ublox_rxm_rawx_t * msg);
+void ublox_print_rxm_rawx_item(FILE * fp, size_t idx, const ublox_rxm_rawx_meas_t * item);
+void ublox_print_trk_d5(FILE * fp, const ublox_trk_d5_t * msg);
+void ublox_print_trk_d5_item(FILE * fp, const ublox_trk_d5_t * msg, size_t idx, const ublox_trk_d5_sat_t * item);
+void ublox_print_trk_meas(FILE * fp, const ublox_trk_meas_t * msg);
+void ublox_print_trk_meas_item(FILE * fp, size_t idx, const ublox_trk_meas_ch_t * item);
+void ublox_print_trk_sfrbx(FILE * fp, const ublox_trk_sfrbx_t * msg);
+
+const char * ublox_val2cstr_gnss(int gnss);
+int ublox_print_packet(FILE * fp, const uint8_t * buffer_in, size_t sz_in);
+int ublox_print_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_registry_add_printer(ublox_registry_t * reg, FILE * fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_DEC_H */
@@ -0,0 +1,396 @@
+/**
+ * \file    ubloxdmx.c
+ * \brief   The demultiplexer of the UBX, NMEA and RTCM 3 frames in one stream
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The receiver may output UBX, NMEA and RTCM 3 on the same port. The frames
+ * are recognized by the first byte, 0xB5, '$' or 0xD3, and verified by the
+ * checksum of the protocol: the 8-bit Fletcher of UBX, the XOR of NMEA and
+ * the CRC-24Q of RTCM 3. The bytes which are not in a verified frame are
+ * skipped.
+ */
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdmx.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/** the protocol + 1 of the first byte of the frames, 0 for the other bytes */
+static const uint8_t g_ublox_demux_start[256] = {
+    [0xB5] = 1 + UBLOX_PROTO_UBX,
+    ['$']  = 1 + UBLOX_PROTO_NMEA,
+    [0xD3] = 1 + UBLOX_PROTO_RTCM3,
+};
+
+/**
+ * \brief setup the demultiplexer without handler
+ * \param dmx: the demultiplexer
+ */
+void
+ublox_demux_init(ublox_demux_t * dmx)
+{
+    assert (NULL != dmx);
+    memset(dmx, 0, sizeof(*dmx));
+}
+
+/**
+ * \brief set the handler of the frames of a protocol
+ * \param dmx: the demultiplexer
+ * \param proto: UBLOX_PROTO_xxx
+ * \param handler: the handler, NULL to skip the frames; ublox_registry_handler() to dispatch UBX by a registry
+ * \param userdata: the user data of the handler
+ */
+void
+ublox_demux_set(ublox_demux_t * dmx, int proto, ublox_handler_t handler, void * userdata)
+{
+    assert (NULL != dmx);
+    assert ((0 <= proto) && (proto < UBLOX_PROTO_NUM));
+    dmx->handlers[proto].handler = handler;
+    dmx->handlers[proto].userdata = userdata;
+}
+
+static int
+ublox_demux_hex2val(uint8_t c)
+{
+    if (('0' <= c) && (c <= '9')) {
+        return c - '0';
+    }
+    if (('A' <= c) && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    if (('a' <= c) && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/* see ublox_demux_frame(), buffer_in[0] is '$' */
+static int
+ublox_demux_frame_nmea(const uint8_t * buffer_in, size_t sz_in, size_t * psz_frame)
+{
+    uint8_t cksum = 0;
+    size_t i;
+    int h;
+    int l;
+
+    for (i = 1; (i < sz_in) && (i < UBLOX_NMEA_LENGTH_MAX); i ++) {
+        if ('*' == buffer_in[i]) {
+            if (sz_in < i + 5) {
+                return 1;
+            }
+            h = ublox_demux_hex2val(buffer_in[i + 1]);
+            l = ublox_demux_hex2val(buffer_in[i + 2]);
+            if ((h < 0) || (l < 0) || ('\r' != buffer_in[i + 3]) || ('\n' != buffer_in[i + 4])) {
+                return -1;
+            }
+            *psz_frame = i + 5;
+            return (((h << 4) | l) == cksum)?0:-2;
+        }
+        if ((buffer_in[i] < 0x20) || (buffer_in[i] > 0x7E)) {
+            return -1;
+        }
+        cksum ^= buffer_in[i];
+    }
+    return (i < UBLOX_NMEA_LENGTH_MAX)?1:-1;
+}
+
+/**
+ * \brief check the frame at the start of the buffer
+ * \param buffer_in: the buffer
+ * \param sz_in: the byte size of the data in the buffer
+ * \param pproto: the protocol of the first byte, UBLOX_PROTO_xxx; -1 if the byte is not the start of any frame
+ * \param psz_frame: the byte size of the frame
+ *
+ * \return 0 the frame is verified, 1 need more data, -1 not a frame, -2 the checksum is wrong
+ */
+int
+ublox_demux_frame(const uint8_t * buffer_in, size_t sz_in, int * pproto, size_t * psz_frame)
+{
+    ublox_cksum_t st;
+    uint8_t chksum[2];
+    size_t sz_frame;
+    uint32_t crc;
+
+    assert (NULL != pproto);
+    assert (NULL != psz_frame);
+    *pproto = -1;
+    *psz_frame = 0;
+    if (sz_in < 1) {
+        return 1;
+    }
+    *pproto = (int)g_ublox_demux_start[buffer_in[0]] - 1;
+    switch (*pproto) {
+    case UBLOX_PROTO_UBX:
+        if (sz_in < 2) {
+            return 1;
+        }
+        if (0x62 != buffer_in[1]) {
+            return -1;
+        }
+        if (sz_in < UBLOX_PKT_LENGTH_HDR) {
+            return 1;
+        }
+        sz_frame = UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in);
+        if (sz_in < sz_frame) {
+            return 1;
+        }
+        *psz_frame = sz_frame;
+        ublox_cksum_init(&st);
+        ublox_cksum_update(&st, buffer_in + 2, sz_frame - 4);
+        ublox_cksum_final(&st, chksum);
+        if ((chksum[0] != buffer_in[sz_frame - 2]) || (chksum[1] != buffer_in[sz_frame - 1])) {
+            return -2;
+        }
+        return 0;
+
+    case UBLOX_PROTO_NMEA:
+        return ublox_demux_frame_nmea(buffer_in, sz_in, psz_frame);
+
+    case UBLOX_PROTO_RTCM3:
+        if (sz_in < 2) {
+            return 1;
+        }
+        if (0 != (buffer_in[1] & 0xFC)) {
+            // the reserved bits
+            return -1;
+        }
+        if (sz_in < UBLOX_RTCM3_LENGTH_HDR) {
+            return 1;
+        }
+        sz_frame = UBLOX_RTCM3_LENGTH_MIN + UBLOX_RTCM3_LENGTH(buffer_in);
+        if (sz_in < sz_frame) {
+            return 1;
+        }
+        *psz_frame = sz_frame;
+        crc = ublox_crc24q(buffer_in, sz_frame - 3);
+        if (crc != (((uint32_t)buffer_in[sz_frame - 3] << 16) | ((uint32_t)buffer_in[sz_frame - 2] << 8) | buffer_in[sz_frame - 1])) {
+            return -2;
+        }
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * \brief scan the buffer once and call the handlers of the verified frames
+ * \param dmx: the demultiplexer
+ * \param buffer_in: the buffer contains the received data
+ * \param sz_in: the byte size of the data
+ * \param sz_end: the frames start at or after this offset are not processed, sz_in for a stream
+ *
+ * \return the offset of the tail which was not processed, the caller should
+ *         keep the data from this offset and append more data to it.
+ *
+ * The frame with the wrong checksum is counted, and the scan goes on from the
+ * byte next to its first byte. The return value of the handler is ignored.
+ */
+size_t
+ublox_demux_process(ublox_demux_t * dmx, const uint8_t * buffer_in, size_t sz_in, size_t sz_end)
+{
+    const ublox_handler_entry_t * entry;
+    size_t pos = 0;
+    size_t pos_skip;
+    size_t sz_frame;
+    int proto;
+    int ret;
+
+    assert (NULL != dmx);
+    assert (sz_end <= sz_in);
+    while (pos < sz_end) {
+        for (pos_skip = pos; (pos < sz_end) && (0 == g_ublox_demux_start[buffer_in[pos]]); pos ++) {
+        }
+        dmx->sz_skipped += pos - pos_skip;
+        if (pos >= sz_end) {
+            break;
+        }
+        ret = ublox_demux_frame(buffer_in + pos, sz_in - pos, &proto, &sz_frame);
+        if (ret > 0) {
+            // need more data
+            break;
+        }
+        if (ret < 0) {
+            if (-2 == ret) {
+                dmx->num_bad[proto] ++;
+            }
+            dmx->sz_skipped ++;
+            pos ++;
+            continue;
+        }
+        dmx->num_frames[proto] ++;
+        entry = &(dmx->handlers[proto]);
+        if (NULL != entry->handler) {
+            entry->handler(entry->userdata, buffer_in + pos, sz_frame);
+        }
+        pos += sz_frame;
+    }
+    assert (pos <= sz_in);
+    return pos;
+}
+
+/**
+ * \brief process all of the data at the end of the stream
+ * \param dmx: the demultiplexer
+ * \param buffer_in: the buffer contains the last data of the stream
+ * \param sz_in: the byte size of the data
+ *
+ * \return sz_in
+ *
+ * The incomplete frames will never be completed, so they are skipped and the
+ * frames after them are processed.
+ */
+size_t
+ublox_demux_finish(ublox_demux_t * dmx, const uint8_t * buffer_in, size_t sz_in)
+{
+    size_t pos = 0;
+
+    while (pos < sz_in) {
+        pos += ublox_demux_process(dmx, buffer_in + pos, sz_in - pos, sz_in - pos);
+        if (pos < sz_in) {
+            dmx->sz_skipped ++;
+            pos ++;
+        }
+    }
+    return pos;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/** the frames received by the handler */
+typedef struct _ublox_demux_test_t {
+    const uint8_t * frame[8];
+    size_t sz_frame[8];
+    int num;
+} ublox_demux_test_t;
+
+static int
+ublox_demux_test_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_demux_test_t * rec = (ublox_demux_test_t *)userdata;
+    if (rec->num < 8) {
+        rec->frame[rec->num] = buffer_in;
+        rec->sz_frame[rec->num] = sz_in;
+    }
+    rec->num ++;
+    return 0;
+}
+
+TEST_CASE( .name="ublox-demux", .description="Test ublox UBX/NMEA/RTCM 3 demultiplexer." ) {
+    static const char nmea[] = "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76\r\n";
+    uint8_t buffer[512];
+    uint8_t * rtcm;
+    ublox_demux_t dmx;
+    ublox_demux_test_t rec[UBLOX_PROTO_NUM];
+    size_t pos = 0;
+    size_t pos_ubx;
+    size_t pos_nmea;
+    size_t pos_rtcm;
+    size_t sz_ubx;
+    size_t sz_frame;
+    uint32_t crc;
+    int proto;
+    int i;
+
+    // garbage, UBX, NMEA, garbage with the start bytes, RTCM 3 (1005), bad RTCM 3, the partial UBX
+    memset(buffer, 0, sizeof(buffer));
+    memmove(buffer, "\x01\xB5\x00$\x02\xD3\xFF", 7);
+    pos = 7;
+    pos_ubx = pos;
+    sz_ubx = ublox_pkt_create_set_cfgrate(buffer + pos, sizeof(buffer) - pos, 1000, 1, 1);
+    pos += sz_ubx;
+    pos_nmea = pos;
+    memmove(buffer + pos, nmea, strlen(nmea));
+    pos += strlen(nmea);
+    memmove(buffer + pos, "$GP\x01*\xB5\x61", 7);
+    pos += 7;
+    pos_rtcm = pos;
+    rtcm = buffer + pos;
+    rtcm[0] = 0xD3;
+    rtcm[1] = 0;
+    rtcm[2] = 19;
+    ublox_setbitu(rtcm + 3, 0, 12, 1005);
+    ublox_setbitu(rtcm + 3, 12, 12, 2002);
+    crc = ublox_crc24q(rtcm, 3 + 19);
+    ublox_setbitu(rtcm + 3 + 19, 0, 24, crc);
+    pos += 3 + 19 + 3;
+    memmove(buffer + pos, rtcm, 25);
+    buffer[pos + 10] ^= 0x01;
+    pos += 25;
+    memmove(buffer + pos, buffer + pos_ubx, 7);
+    pos += 7;
+
+    SECTION("test ublox_demux_frame") {
+        REQUIRE(0 == ublox_demux_frame(buffer + pos_ubx, pos - pos_ubx, &proto, &sz_frame));
+        REQUIRE(UBLOX_PROTO_UBX == proto);
+        REQUIRE(sz_ubx == sz_frame);
+        REQUIRE(0 == ublox_demux_frame(buffer + pos_nmea, pos - pos_nmea, &proto, &sz_frame));
+        REQUIRE(UBLOX_PROTO_NMEA == proto);
+        REQUIRE(strlen(nmea) == sz_frame);
+        REQUIRE(1 == ublox_demux_frame(buffer + pos_nmea, 20, &proto, &sz_frame));
+        REQUIRE(1 == ublox_demux_frame(buffer + pos_nmea, strlen(nmea) - 1, &proto, &sz_frame));
+        REQUIRE(0 == ublox_demux_frame(buffer + pos_rtcm, 25, &proto, &sz_frame));
+        REQUIRE(UBLOX_PROTO_RTCM3 == proto);
+        REQUIRE(25 == sz_frame);
+        REQUIRE(1 == ublox_demux_frame(buffer + pos_rtcm, 24, &proto, &sz_frame));
+        REQUIRE(-2 == ublox_demux_frame(buffer + pos_rtcm + 25, 25, &proto, &sz_frame));
+        REQUIRE(-1 == ublox_demux_frame(buffer + 1, 10, &proto, &sz_frame));
+        REQUIRE(-1 == ublox_demux_frame(buffer + 3, 10, &proto, &sz_frame));
+        REQUIRE(-1 == ublox_demux_frame(buffer + 5, 10, &proto, &sz_frame));
+        REQUIRE(-1 == ublox_demux_frame(buffer, 10, &proto, &sz_frame));
+        REQUIRE(-1 == proto);
+        REQUIRE(1005 == ublox_getbitu(buffer + pos_rtcm + 3, 0, 12));
+    }
+
+    SECTION("test ublox_demux_process") {
+        memset(rec, 0, sizeof(rec));
+        ublox_demux_init(&dmx);
+        for (i = 0; i < UBLOX_PROTO_NUM; i ++) {
+            ublox_demux_set(&dmx, i, ublox_demux_test_handler, rec + i);
+        }
+        REQUIRE(pos - 7 == ublox_demux_process(&dmx, buffer, pos, pos));
+        REQUIRE(1 == rec[UBLOX_PROTO_UBX].num);
+        REQUIRE(buffer + pos_ubx == rec[UBLOX_PROTO_UBX].frame[0]);
+        REQUIRE(sz_ubx == rec[UBLOX_PROTO_UBX].sz_frame[0]);
+        REQUIRE(1 == rec[UBLOX_PROTO_NMEA].num);
+        REQUIRE(buffer + pos_nmea == rec[UBLOX_PROTO_NMEA].frame[0]);
+        REQUIRE(strlen(nmea) == rec[UBLOX_PROTO_NMEA].sz_frame[0]);
+        REQUIRE(1 == rec[UBLOX_PROTO_RTCM3].num);
+        REQUIRE(buffer + pos_rtcm == rec[UBLOX_PROTO_RTCM3].frame[0]);
+        REQUIRE(1 == dmx.num_frames[UBLOX_PROTO_NMEA]);
+        REQUIRE(1 == dmx.num_bad[UBLOX_PROTO_RTCM3]);
+        REQUIRE(0 == dmx.num_bad[UBLOX_PROTO_UBX]);
+        REQUIRE(7 + 7 + 25 == dmx.sz_skipped);
+
+        // the frames start at or after sz_end are not processed
+        memset(rec, 0, sizeof(rec));
+        REQUIRE(pos_nmea == ublox_demux_process(&dmx, buffer, pos, pos_nmea));
+        REQUIRE(1 == rec[UBLOX_PROTO_UBX].num);
+        REQUIRE(0 == rec[UBLOX_PROTO_NMEA].num);
+    }
+
+    SECTION("test ublox_demux_finish") {
+        memset(rec, 0, sizeof(rec));
+        ublox_demux_init(&dmx);
+        for (i = 0; i < UBLOX_PROTO_NUM; i ++) {
+            ublox_demux_set(&dmx, i, ublox_demux_test_handler, rec + i);
+        }
+        // the incomplete UBX packet before the NMEA sentence
+        memmove(buffer + pos - 7, "\xB5\x62\x06\x08\xFF\x00", 6);
+        memmove(buffer + pos - 1, nmea, strlen(nmea));
+        pos += strlen(nmea) - 1;
+        sz_frame = ublox_demux_process(&dmx, buffer, pos, pos);
+        REQUIRE(pos - strlen(nmea) - 6 == sz_frame);
+        REQUIRE(1 == rec[UBLOX_PROTO_NMEA].num);
+        REQUIRE(pos - sz_frame == ublox_demux_finish(&dmx, buffer + sz_frame, pos - sz_frame));
+        REQUIRE(2 == rec[UBLOX_PROTO_NMEA].num);
+        REQUIRE(buffer + pos - strlen(nmea) == rec[UBLOX_PROTO_NMEA].frame[1]);
+        REQUIRE(1 == rec[UBLOX_PROTO_UBX].num);
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,54 @@
+/**
+ * \file    ubloxdmx.h
+ * \brief   The demultiplexer of the UBX, NMEA and RTCM 3 frames in one stream
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_DMX_H
+#define UBLOX_DMX_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxreg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_PROTO_UBX   0 /**< 0xB5 0x62 class id length(2) payload ck_a ck_b */
+#define UBLOX_PROTO_NMEA  1 /**< $...*hh\r\n */
+#define UBLOX_PROTO_RTCM3 2 /**< 0xD3 length(10 bits) payload CRC-24Q(3) */
+#define UBLOX_PROTO_NUM   3
+
+#define UBLOX_NMEA_LENGTH_MAX 256 /**< the max length of a NMEA sentence, longer than 82 of NMEA 0183 for the proprietary sentences */
+#define UBLOX_RTCM3_LENGTH_HDR 3
+#define UBLOX_RTCM3_LENGTH_MIN 6 /**< the header and the CRC */
+#define UBLOX_RTCM3_LENGTH_MAX (UBLOX_RTCM3_LENGTH_MIN + 1023)
+#define UBLOX_RTCM3_LENGTH(p) ((((size_t)((p)[1]) & 0x03) << 8) | (p)[2]) /**< the length of the payload */
+
+/**
+ * The demultiplexer scans the buffer once and calls the handler of the
+ * protocol of each verified frame with the pointer to the frame in the
+ * buffer, the frames are not copied.
+ */
+typedef struct _ublox_demux_t {
+    ublox_handler_entry_t handlers[UBLOX_PROTO_NUM]; /**< the handlers of the frames, can be NULL */
+    size_t num_frames[UBLOX_PROTO_NUM]; /**< the number of verified frames */
+    size_t num_bad[UBLOX_PROTO_NUM];    /**< the number of frames with the wrong checksum */
+    size_t sz_skipped;                  /**< the bytes not in any verified frame */
+} ublox_demux_t;
+
+void ublox_demux_init(ublox_demux_t * dmx);
+void ublox_demux_set(ublox_demux_t * dmx, int proto, ublox_handler_t handler, void * userdata);
+int ublox_demux_frame(const uint8_t * buffer_in, size_t sz_in, int * pproto, size_t * psz_frame);
+size_t ublox_demux_process(ublox_demux_t * dmx, const uint8_t * buffer_in, size_t sz_in, size_t sz_end);
+size_t ublox_demux_finish(ublox_demux_t * dmx, const uint8_t * buffer_in, size_t sz_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_DMX_H */
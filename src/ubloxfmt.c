@@ -0,0 +1,576 @@
+/**
+ * \file    ubloxfmt.c
+ * \brief   The printf-free number formatters of the text output
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The formatters write the characters at the position from the caller and
+ * return the position after the number, the buffer should have at least
+ * UBLOX_FMT_SZ_MAX bytes. No terminating zero is written. The output does
+ * not depend on the locale or the C library.
+ *
+ * The doubles are printed by the shortest digits which are read back to the
+ * same value (Steele & White, Burger & Dybvig), computed by the exact integer
+ * arithmetic, in the same layout as Number.prototype.toString() of ECMAScript.
+ */
+
+#include "ubloxutils.h"
+#include "ubloxfmt.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/**
+ * \brief append the string
+ * \param p: the position of the output
+ * \param cstr: the string
+ *
+ * \return the position after the string
+ */
+char *
+ublox_fmt_cstr(char * p, const char * cstr)
+{
+    while (0 != *cstr) {
+        *p ++ = *cstr ++;
+    }
+    return p;
+}
+
+/**
+ * \brief append the unsigned integer in decimal
+ * \param p: the position of the output
+ * \param val: the value
+ *
+ * \return the position after the number
+ */
+char *
+ublox_fmt_uint(char * p, uint64_t val)
+{
+    char tmp[20];
+    size_t i = sizeof(tmp);
+
+    do {
+        tmp[-- i] = '0' + (val % 10);
+        val /= 10;
+    } while (val > 0);
+    memcpy(p, tmp + i, sizeof(tmp) - i);
+    return p + sizeof(tmp) - i;
+}
+
+/**
+ * \brief append the signed integer in decimal
+ * \param p: the position of the output
+ * \param val: the value
+ *
+ * \return the position after the number
+ */
+char *
+ublox_fmt_int(char * p, int64_t val)
+{
+    if (val < 0) {
+        *p ++ = '-';
+        return ublox_fmt_uint(p, (uint64_t)(-(val + 1)) + 1);
+    }
+    return ublox_fmt_uint(p, val);
+}
+
+/**
+ * \brief append the unsigned integer in upper case hexadecimal, the same as "%0*X"
+ * \param p: the position of the output
+ * \param val: the value
+ * \param width: the min number of digits, padded by '0'
+ *
+ * \return the position after the number
+ */
+char *
+ublox_fmt_hex(char * p, uint64_t val, size_t width)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    size_t n = 1;
+    size_t i;
+
+    while ((n < 16) && ((val >> (4 * n)) > 0)) {
+        n ++;
+    }
+    if (width > UBLOX_FMT_SZ_MAX) {
+        width = UBLOX_FMT_SZ_MAX;
+    }
+    for (; width > n; width --) {
+        *p ++ = '0';
+    }
+    for (i = n; i > 0; i --, val >>= 4) {
+        p[i - 1] = hex[val & 0x0F];
+    }
+    return p + n;
+}
+
+/*****************************************************************************/
+// the unsigned big integer of the digit generation
+
+#define UBLOX_FMT_BN_LIMBS 40 /**< 1280 bits, the max is about 1130 bits for 4.9e-324 */
+
+typedef struct _ublox_fmt_bn_t {
+    uint32_t d[UBLOX_FMT_BN_LIMBS]; /**< the limbs, the least significant first */
+    size_t n;                       /**< the number of limbs in use, no leading zero limb */
+} ublox_fmt_bn_t;
+
+static void
+ublox_fmt_bn_set(ublox_fmt_bn_t * b, uint64_t val)
+{
+    b->d[0] = (uint32_t)val;
+    b->d[1] = (uint32_t)(val >> 32);
+    b->n = (b->d[1] > 0)?2:((b->d[0] > 0)?1:0);
+}
+
+static void
+ublox_fmt_bn_shl(ublox_fmt_bn_t * b, size_t bits)
+{
+    size_t sh_limb = bits / 32;
+    size_t sh = bits % 32;
+    size_t i;
+
+    if (b->n < 1) {
+        return;
+    }
+    assert (b->n + sh_limb + 1 <= UBLOX_FMT_BN_LIMBS);
+    if (sh > 0) {
+        b->d[b->n] = 0;
+        for (i = b->n; i > 0; i --) {
+            b->d[i + sh_limb] = (b->d[i] << sh) | (b->d[i - 1] >> (32 - sh));
+        }
+        b->d[sh_limb] = b->d[0] << sh;
+        b->n += sh_limb + 1;
+        if (0 == b->d[b->n - 1]) {
+            b->n --;
+        }
+    } else {
+        memmove(b->d + sh_limb, b->d, b->n * sizeof(b->d[0]));
+        b->n += sh_limb;
+    }
+    memset(b->d, 0, sh_limb * sizeof(b->d[0]));
+}
+
+static void
+ublox_fmt_bn_mul(ublox_fmt_bn_t * b, uint32_t m)
+{
+    uint64_t carry = 0;
+    size_t i;
+
+    for (i = 0; i < b->n; i ++) {
+        carry += (uint64_t)b->d[i] * m;
+        b->d[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry > 0) {
+        assert (b->n < UBLOX_FMT_BN_LIMBS);
+        b->d[b->n ++] = (uint32_t)carry;
+    }
+}
+
+static void
+ublox_fmt_bn_mul_pow10(ublox_fmt_bn_t * b, int k)
+{
+    static const uint32_t pow10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+    };
+    for (; k >= 9; k -= 9) {
+        ublox_fmt_bn_mul(b, pow10[9]);
+    }
+    ublox_fmt_bn_mul(b, pow10[k]);
+}
+
+/* the sum a + b, the limbs of dst are not shared with a and b */
+static void
+ublox_fmt_bn_add(ublox_fmt_bn_t * dst, const ublox_fmt_bn_t * a, const ublox_fmt_bn_t * b)
+{
+    uint64_t carry = 0;
+    size_t n = (a->n > b->n)?a->n:b->n;
+    size_t i;
+
+    for (i = 0; i < n; i ++) {
+        carry += (uint64_t)((i < a->n)?a->d[i]:0) + ((i < b->n)?b->d[i]:0);
+        dst->d[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry > 0) {
+        assert (n < UBLOX_FMT_BN_LIMBS);
+        dst->d[n ++] = (uint32_t)carry;
+    }
+    dst->n = n;
+}
+
+/* a -= b, a >= b */
+static void
+ublox_fmt_bn_sub(ublox_fmt_bn_t * a, const ublox_fmt_bn_t * b)
+{
+    int64_t borrow = 0;
+    size_t i;
+
+    for (i = 0; i < a->n; i ++) {
+        borrow += (int64_t)a->d[i] - ((i < b->n)?b->d[i]:0);
+        a->d[i] = (uint32_t)borrow;
+        borrow = (borrow < 0)?-1:0;
+    }
+    while ((a->n > 0) && (0 == a->d[a->n - 1])) {
+        a->n --;
+    }
+}
+
+static int
+ublox_fmt_bn_cmp(const ublox_fmt_bn_t * a, const ublox_fmt_bn_t * b)
+{
+    size_t i;
+
+    if (a->n != b->n) {
+        return (a->n > b->n)?1:-1;
+    }
+    for (i = a->n; i > 0; i --) {
+        if (a->d[i - 1] != b->d[i - 1]) {
+            return (a->d[i - 1] > b->d[i - 1])?1:-1;
+        }
+    }
+    return 0;
+}
+
+/* the same digit generation as ublox_fmt_digits() by the 64-bit integers, 10 * s < 2^64 */
+static size_t
+ublox_fmt_digits_u64(uint64_t r, uint64_t s, uint64_t mp, uint64_t mm, int flg_even, char * digits)
+{
+    uint64_t d;
+    int tc_low;
+    int tc_high;
+    size_t n = 0;
+
+    for (;;) {
+        r *= 10;
+        mp *= 10;
+        mm *= 10;
+        d = r / s;
+        r -= d * s;
+        tc_low = flg_even?(r <= mm):(r < mm);
+        tc_high = flg_even?(r + mp >= s):(r + mp > s);
+        if (tc_low && tc_high) {
+            if (r * 2 >= s) {
+                d ++;
+            }
+        } else if (tc_high) {
+            d ++;
+        }
+        digits[n ++] = '0' + d;
+        if (tc_low || tc_high) {
+            break;
+        }
+    }
+    return n;
+}
+
+/**
+ * \brief get the shortest decimal digits which are read back to the same double
+ * \param val: the finite value > 0
+ * \param digits: the output digits '0'-'9', at least 17 characters, not terminated by zero
+ * \param exp10: the output decimal exponent, val is about d[0].d[1]d[2]... x 10^exp10
+ *
+ * \return the number of digits
+ *
+ * If two digit strings of the same length are read back to the value, the
+ * one closer to the value is used.
+ */
+size_t
+ublox_fmt_digits(double val, char * digits, int * exp10)
+{
+    ublox_fmt_bn_t r; // the remainder, r/s is the value
+    ublox_fmt_bn_t s;
+    ublox_fmt_bn_t mp; // the half of the gap to the next double
+    ublox_fmt_bn_t mm; // the half of the gap to the previous double
+    ublox_fmt_bn_t t;
+    uint64_t bits;
+    uint64_t f;
+    int be;
+    int e;
+    int k;
+    int flg_even; // the ties of the round-half-even are read back to val
+    int flg_asym; // the gap to the previous double is the half
+    int tc_low;
+    int tc_high;
+    int c;
+    double x;
+    uint32_t d;
+    size_t n = 0;
+
+    assert (val > 0);
+    memcpy(&bits, &val, sizeof(bits));
+    be = (int)((bits >> 52) & 0x7FF);
+    f = bits & ((1ULL << 52) - 1);
+    if (be > 0) {
+        f |= 1ULL << 52;
+        e = be - 1075;
+    } else {
+        e = -1074;
+    }
+    flg_even = (0 == (f & 1));
+    flg_asym = ((be > 1) && (f == (1ULL << 52)));
+
+    // k = ceil(log10(val)), the estimation from the binary exponent may be 1 less
+    x = (e + 63 - __builtin_clzll(f)) * 0.30102999566398114 - 1e-10;
+    k = (int)x;
+    if (x > k) {
+        k ++;
+    }
+
+    // the values of the measurements, such as 2^-60 < val < 2^53, fit in 64 bits
+    if ((e < 0) && (e > -60)) {
+        static const uint64_t pow10[] = {
+            1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+            1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+            100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+            1000000000000000000ULL,
+        };
+        const uint64_t max_s = UINT64_MAX / 100; // s may be multiplied by 10 before the generation
+        uint64_t r64 = f << (1 + flg_asym);
+        uint64_t s64 = 1ULL << (1 - e + flg_asym);
+        uint64_t mp64 = 1ULL << flg_asym;
+        uint64_t mm64 = 1;
+
+        if ((k >= 0) && (k < (int)NUM_ARRAY(pow10)) && (s64 <= max_s / pow10[k])) {
+            s64 *= pow10[k];
+        } else if ((k < 0) && (-k < (int)NUM_ARRAY(pow10)) && (s64 <= max_s) && (r64 <= UINT64_MAX / pow10[-k])) {
+            r64 *= pow10[-k];
+            mp64 *= pow10[-k];
+            mm64 *= pow10[-k];
+        } else {
+            s64 = 0;
+        }
+        if (s64 > 0) {
+            if (flg_even?(r64 + mp64 >= s64):(r64 + mp64 > s64)) {
+                s64 *= 10;
+                k ++;
+            }
+            *exp10 = k - 1;
+            return ublox_fmt_digits_u64(r64, s64, mp64, mm64, flg_even, digits);
+        }
+    }
+
+    // val = r/s, the boundaries are (r - mm)/s and (r + mp)/s
+    if (e >= 0) {
+        ublox_fmt_bn_set(&r, f);
+        ublox_fmt_bn_shl(&r, e + 1 + flg_asym);
+        ublox_fmt_bn_set(&s, 2 << flg_asym);
+        ublox_fmt_bn_set(&mp, 1);
+        ublox_fmt_bn_shl(&mp, e + flg_asym);
+        ublox_fmt_bn_set(&mm, 1);
+        ublox_fmt_bn_shl(&mm, e);
+    } else {
+        ublox_fmt_bn_set(&r, f << (1 + flg_asym));
+        ublox_fmt_bn_set(&s, 1);
+        ublox_fmt_bn_shl(&s, 1 - e + flg_asym);
+        ublox_fmt_bn_set(&mp, 1 << flg_asym);
+        ublox_fmt_bn_set(&mm, 1);
+    }
+
+    if (k >= 0) {
+        ublox_fmt_bn_mul_pow10(&s, k);
+    } else {
+        ublox_fmt_bn_mul_pow10(&r, -k);
+        ublox_fmt_bn_mul_pow10(&mp, -k);
+        ublox_fmt_bn_mul_pow10(&mm, -k);
+    }
+    ublox_fmt_bn_add(&t, &r, &mp);
+    c = ublox_fmt_bn_cmp(&t, &s);
+    if (flg_even?(c >= 0):(c > 0)) {
+        ublox_fmt_bn_mul(&s, 10);
+        k ++;
+    }
+
+    // now val = 0.d[0]d[1]... x 10^k
+    for (;;) {
+        ublox_fmt_bn_mul(&r, 10);
+        ublox_fmt_bn_mul(&mp, 10);
+        ublox_fmt_bn_mul(&mm, 10);
+        for (d = 0; ublox_fmt_bn_cmp(&r, &s) >= 0; d ++) {
+            ublox_fmt_bn_sub(&r, &s);
+        }
+        c = ublox_fmt_bn_cmp(&r, &mm);
+        tc_low = flg_even?(c <= 0):(c < 0);
+        ublox_fmt_bn_add(&t, &r, &mp);
+        c = ublox_fmt_bn_cmp(&t, &s);
+        tc_high = flg_even?(c >= 0):(c > 0);
+        if (tc_low && tc_high) {
+            // both of the digits are in the range, use the closer one
+            ublox_fmt_bn_add(&t, &r, &r);
+            if (ublox_fmt_bn_cmp(&t, &s) >= 0) {
+                d ++;
+            }
+        } else if (tc_high) {
+            d ++;
+        }
+        assert (d < 10);
+        digits[n ++] = '0' + d;
+        if (tc_low || tc_high) {
+            break;
+        }
+    }
+    *exp10 = k - 1;
+    return n;
+}
+
+/**
+ * \brief append the double by the shortest digits which are read back to the same value
+ * \param p: the position of the output
+ * \param val: the value
+ *
+ * \return the position after the number
+ *
+ * The layout is the same as Number.prototype.toString() of ECMAScript, such
+ * as "21000000.25", "0.000125", "1.5e-7" and "1e+21", the numbers are valid
+ * in JSON. The special values are "NaN", "Infinity" and "-Infinity", -0 is "0".
+ */
+char *
+ublox_fmt_double(char * p, double val)
+{
+    char digits[20];
+    size_t n;
+    int exp10;
+    int k;
+    int i;
+
+    if (val != val) {
+        return ublox_fmt_cstr(p, "NaN");
+    }
+    if (val < 0) {
+        *p ++ = '-';
+        val = -val;
+    }
+    if (val > 1.7976931348623157e308) {
+        return ublox_fmt_cstr(p, "Infinity");
+    }
+    if (val < 9007199254740992.0) { // 2^53
+        // the integers are printed exactly, including 0
+        uint64_t v = (uint64_t)val;
+        if ((double)v == val) {
+            return ublox_fmt_uint(p, v);
+        }
+    }
+    n = ublox_fmt_digits(val, digits, &exp10);
+    k = exp10 + 1; // the position of the decimal point
+    if (((int)n <= k) && (k <= 21)) {
+        memcpy(p, digits, n);
+        p += n;
+        for (i = n; i < k; i ++) {
+            *p ++ = '0';
+        }
+    } else if ((0 < k) && (k <= 21)) {
+        memcpy(p, digits, k);
+        p += k;
+        *p ++ = '.';
+        memcpy(p, digits + k, n - k);
+        p += n - k;
+    } else if ((-6 < k) && (k <= 0)) {
+        *p ++ = '0';
+        *p ++ = '.';
+        for (i = k; i < 0; i ++) {
+            *p ++ = '0';
+        }
+        memcpy(p, digits, n);
+        p += n;
+    } else {
+        *p ++ = digits[0];
+        if (n > 1) {
+            *p ++ = '.';
+            memcpy(p, digits + 1, n - 1);
+            p += n - 1;
+        }
+        *p ++ = 'e';
+        *p ++ = (exp10 < 0)?'-':'+';
+        p = ublox_fmt_uint(p, (exp10 < 0)?-exp10:exp10);
+    }
+    return p;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* the output of the formatter, terminated by zero */
+#define UBLOX_FMT_TEST(fn, ...) (*(fn(buf, __VA_ARGS__)) = 0, buf)
+
+TEST_CASE( .name="ublox-fmt", .description="Test ublox number formatters." ) {
+    char buf[UBLOX_FMT_SZ_MAX + 1];
+    char ref[64];
+
+    SECTION("test integers") {
+        REQUIRE(0 == strcmp("0", UBLOX_FMT_TEST(ublox_fmt_uint, 0)));
+        REQUIRE(0 == strcmp("18446744073709551615", UBLOX_FMT_TEST(ublox_fmt_uint, UINT64_MAX)));
+        REQUIRE(0 == strcmp("-9223372036854775808", UBLOX_FMT_TEST(ublox_fmt_int, INT64_MIN)));
+        REQUIRE(0 == strcmp("-1", UBLOX_FMT_TEST(ublox_fmt_int, -1)));
+        REQUIRE(0 == strcmp("2090", UBLOX_FMT_TEST(ublox_fmt_int, 2090)));
+        REQUIRE(0 == strcmp("00", UBLOX_FMT_TEST(ublox_fmt_hex, 0, 2)));
+        REQUIRE(0 == strcmp("0", UBLOX_FMT_TEST(ublox_fmt_hex, 0, 0)));
+        REQUIRE(0 == strcmp("00ABCDEF", UBLOX_FMT_TEST(ublox_fmt_hex, 0xABCDEF, 8)));
+        REQUIRE(0 == strcmp("FFFFFFFFFFFFFFFF", UBLOX_FMT_TEST(ublox_fmt_hex, UINT64_MAX, 2)));
+    }
+
+    SECTION("test doubles") {
+        REQUIRE(0 == strcmp("0", UBLOX_FMT_TEST(ublox_fmt_double, 0.0)));
+        REQUIRE(0 == strcmp("0", UBLOX_FMT_TEST(ublox_fmt_double, -0.0)));
+        REQUIRE(0 == strcmp("-3", UBLOX_FMT_TEST(ublox_fmt_double, -3.0)));
+        REQUIRE(0 == strcmp("21000000.25", UBLOX_FMT_TEST(ublox_fmt_double, 21000000.25)));
+        REQUIRE(0 == strcmp("345600.5", UBLOX_FMT_TEST(ublox_fmt_double, 345600.5)));
+        REQUIRE(0 == strcmp("0.1", UBLOX_FMT_TEST(ublox_fmt_double, 0.1)));
+        REQUIRE(0 == strcmp("0.30000000000000004", UBLOX_FMT_TEST(ublox_fmt_double, 0.1 + 0.2)));
+        REQUIRE(0 == strcmp("0.000125", UBLOX_FMT_TEST(ublox_fmt_double, 0.000125)));
+        REQUIRE(0 == strcmp("1.5e-7", UBLOX_FMT_TEST(ublox_fmt_double, 1.5e-7)));
+        REQUIRE(0 == strcmp("123456789012345680000", UBLOX_FMT_TEST(ublox_fmt_double, 1.2345678901234568e20)));
+        REQUIRE(0 == strcmp("1e+21", UBLOX_FMT_TEST(ublox_fmt_double, 1e21)));
+        REQUIRE(0 == strcmp("1.7976931348623157e+308", UBLOX_FMT_TEST(ublox_fmt_double, 1.7976931348623157e308)));
+        REQUIRE(0 == strcmp("5e-324", UBLOX_FMT_TEST(ublox_fmt_double, 4.9406564584124654e-324)));
+        REQUIRE(0 == strcmp("2.2250738585072014e-308", UBLOX_FMT_TEST(ublox_fmt_double, 2.2250738585072014e-308)));
+        REQUIRE(0 == strcmp("9007199254740992", UBLOX_FMT_TEST(ublox_fmt_double, 9007199254740992.0)));
+        REQUIRE(0 == strcmp("-Infinity", UBLOX_FMT_TEST(ublox_fmt_double, -1.0 / 0.0)));
+        REQUIRE(0 == strcmp("NaN", UBLOX_FMT_TEST(ublox_fmt_double, 0.0 / 0.0)));
+    }
+
+    SECTION("test the round trip and the shortest digits") {
+        uint64_t bits = 0x123456789ABCDEFULL;
+        double val;
+        char digits[20];
+        int exp10;
+        size_t n;
+        int i;
+
+        for (i = 0; i < 100000; i ++) {
+            // xorshift, all of the exponents
+            bits ^= bits << 13;
+            bits ^= bits >> 7;
+            bits ^= bits << 17;
+            memcpy(&val, &bits, sizeof(val));
+            if (i % 2) {
+                // the range of the measurements, 2^-60 < val < 2^53
+                uint64_t b = (bits & ~(0x7FFULL << 52)) | ((uint64_t)(1023 - 60 + (bits >> 52) % 112) << 52);
+                memcpy(&val, &b, sizeof(val));
+            }
+            if ((val != val) || (val - val != 0.0)) {
+                continue;
+            }
+            UBLOX_FMT_TEST(ublox_fmt_double, val);
+            REQUIRE(strlen(buf) <= UBLOX_FMT_SZ_MAX);
+            REQUIRE(strtod(buf, NULL) == val);
+            if (val < 0) {
+                val = -val;
+            }
+            if (val == 0) {
+                continue;
+            }
+            n = ublox_fmt_digits(val, digits, &exp10);
+            REQUIRE(n <= 17);
+            if (n > 1) {
+                // one digit less is not read back to the value
+                snprintf(ref, sizeof(ref), "%.*e", (int)n - 2, val);
+                REQUIRE(strtod(ref, NULL) != val);
+            }
+        }
+    }
+}
+#undef UBLOX_FMT_TEST
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,32 @@
+/**
+ * \file    ubloxfmt.h
+ * \brief   The printf-free number formatters of the text output
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_FMT_H
+#define UBLOX_FMT_H 1
+
+#include "osporting.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_FMT_SZ_MAX 32 /**< the max number of characters of a number, without the terminating zero */
+
+char * ublox_fmt_cstr(char * p, const char * cstr);
+char * ublox_fmt_uint(char * p, uint64_t val);
+char * ublox_fmt_int(char * p, int64_t val);
+char * ublox_fmt_hex(char * p, uint64_t val, size_t width);
+size_t ublox_fmt_digits(double val, char * digits, int * exp10);
+char * ublox_fmt_double(char * p, double val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_FMT_H */
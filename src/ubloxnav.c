@@ -0,0 +1,1427 @@
+/**
+ * \file    ubloxnav.c
+ * \brief   The ephemeris decoder of the navigation subframes
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The navigation data are received from RXM-SFRBX, or RXM-SFRB of the
+ * legacy receivers:
+ *  - GPS/QZSS LNAV (IS-GPS-200): the words of RXM-SFRBX are 30 bits, the
+ *    data bits are not inverted by D30* and followed by the 6 parity bits;
+ *    the words of RXM-SFRB are the 24 data bits without the parity.
+ *  - Galileo I/NAV: the even and the odd page of a word, checked by CRC-24Q.
+ *  - BeiDou D1/D2: the 30-bit words of a subframe, the BCH code is checked
+ *    by the receiver.
+ *  - GLONASS: the string of 85 bits, checked by the Hamming code.
+ */
+
+#include <math.h>
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdec.h"
+#include "ubloxnav.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_NAV_SC2RAD 3.1415926535898 /**< semi-circle to radian (IS-GPS) */
+#define UBLOX_NAV_PREAMBLE 0x8B          /**< the preamble of the TLM word of LNAV */
+#define UBLOX_NAV_PREAMBLE_BDS 0x712     /**< the preamble of BeiDou D1/D2, 11 bits */
+
+#define UBLOX_NAV_GNSS_GPS 0
+#define UBLOX_NAV_GNSS_GAL 2
+#define UBLOX_NAV_GNSS_BDS 3
+#define UBLOX_NAV_GNSS_QZS 5
+#define UBLOX_NAV_GNSS_GLO 6
+
+#define UBLOX_NAV_SZ_LNAV 30 /**< the byte size of a LNAV subframe, 10 words of 24 bits */
+#define UBLOX_NAV_SZ_INAV 16 /**< the byte size of a word of Galileo I/NAV, 128 bits */
+#define UBLOX_NAV_SZ_BDS  38 /**< the byte size of a BeiDou subframe, 300 bits */
+#define UBLOX_NAV_SZ_GLO  10 /**< the byte size of a GLONASS string, the first 80 of the 85 bits */
+
+/*****************************************************************************/
+// bit fields, MSB first, see ublox_getbitu()
+
+/* sign extend the two's complement value of len bits */
+static int32_t
+ublox_nav_sext(uint32_t val, size_t len)
+{
+    if ((len < 1) || (len >= 32) || !(val & (1u << (len - 1)))) {
+        return (int32_t)val;
+    }
+    return (int32_t)(val | (~0u << len));
+}
+
+/* get the unsigned value split into two fields, MSB first */
+static uint32_t
+ublox_nav_getbitu2(const uint8_t * buf, size_t pos1, size_t len1, size_t pos2, size_t len2)
+{
+    return (ublox_getbitu(buf, pos1, len1) << len2) | ublox_getbitu(buf, pos2, len2);
+}
+
+/* get the signed value split into two fields, MSB first */
+static int32_t
+ublox_nav_getbits2(const uint8_t * buf, size_t pos1, size_t len1, size_t pos2, size_t len2)
+{
+    return ublox_nav_sext(ublox_nav_getbitu2(buf, pos1, len1, pos2, len2), len1 + len2);
+}
+
+/* get the sign-magnitude bits of GLONASS */
+static double
+ublox_nav_getbitg(const uint8_t * buf, size_t pos, size_t len)
+{
+    double val = ublox_getbitu(buf, pos + 1, len - 1);
+    return ublox_getbitu(buf, pos, 1)?-val:val;
+}
+
+/* copy the bits between the buffers */
+static void
+ublox_nav_copybits(uint8_t * dst, size_t pos_dst, const uint8_t * src, size_t pos_src, size_t len)
+{
+    size_t n;
+    for (; len > 0; len -= n, pos_dst += n, pos_src += n) {
+        n = (len < 8)?len:8;
+        ublox_setbitu(dst, pos_dst, n, ublox_getbitu(src, pos_src, n));
+    }
+}
+
+/* the words of RXM-SFRBX to the bytes, MSB first */
+static void
+ublox_nav_pack_u32(const uint32_t * dwrd, size_t num, uint8_t * buf)
+{
+    size_t i;
+    for (i = 0; i < num; i ++) {
+        buf[i * 4] = (dwrd[i] >> 24) & 0xFF;
+        buf[i * 4 + 1] = (dwrd[i] >> 16) & 0xFF;
+        buf[i * 4 + 2] = (dwrd[i] >> 8) & 0xFF;
+        buf[i * 4 + 3] = dwrd[i] & 0xFF;
+    }
+}
+
+/*****************************************************************************/
+
+/**
+ * \brief setup the empty cache
+ * \param nav: the cache
+ * \param cb_eph: the callback when an ephemeris is changed, can be NULL
+ * \param userdata: the user data passed to the callback
+ */
+void
+ublox_nav_init(ublox_nav_t * nav, ublox_nav_eph_cb_t cb_eph, void * userdata)
+{
+    assert (NULL != nav);
+    memset(nav, 0, sizeof(*nav));
+    nav->cb_eph = cb_eph;
+    nav->userdata = userdata;
+}
+
+/**
+ * \brief get the ephemeris of a satellite
+ * \param nav: the cache
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ *
+ * \return the ephemeris, NULL if it's not received
+ */
+const ublox_eph_t *
+ublox_nav_get_eph(const ublox_nav_t * nav, uint8_t gnssId, uint8_t svId)
+{
+    assert (NULL != nav);
+    if ((gnssId >= UBLOX_NAV_NUM_SYS) || (svId < 1) || (svId > UBLOX_NAV_MAX_SV)) {
+        return NULL;
+    }
+    if (! nav->flg_eph[gnssId][svId - 1]) {
+        return NULL;
+    }
+    return &(nav->eph[gnssId][svId - 1]);
+}
+
+/* the data of the satellite, NULL if the satellite is out of range */
+static ublox_nav_frame_t *
+ublox_nav_frame_of(ublox_nav_t * nav, uint8_t gnssId, uint8_t svId)
+{
+    if ((gnssId >= UBLOX_NAV_NUM_SYS) || (svId < 1) || (svId > UBLOX_NAV_MAX_SV)) {
+        return NULL;
+    }
+    return &(nav->frame[gnssId][svId - 1]);
+}
+
+/**
+ * \brief save a part of the navigation data of a satellite
+ * \param frm: the data of the satellite
+ * \param idx: the index of the part
+ * \param sz: the byte size of the part
+ * \param data: the part
+ *
+ * \return 1 if the part is changed, 0 if it's the same as the saved one
+ */
+static int
+ublox_nav_frame_put(ublox_nav_frame_t * frm, size_t idx, size_t sz, const uint8_t * data)
+{
+    uint8_t * p = frm->data + idx * sz;
+    int ret = 1;
+
+    assert ((idx + 1) * sz <= sizeof(frm->data));
+    if ((frm->mask & (1u << idx)) && (0 == memcmp(p, data, sz))) {
+        ret = 0;
+    }
+    memmove(p, data, sz);
+    frm->mask |= (1u << idx);
+    return ret;
+}
+
+/**
+ * \brief save the decoded ephemeris, and report it if it's changed
+ * \param nav: the cache
+ * \param eph: the decoded ephemeris
+ *
+ * \return 1 if the ephemeris is changed, 0 if the IODE, IODC and toe are the same as the saved one
+ */
+static int
+ublox_nav_update(ublox_nav_t * nav, const ublox_eph_t * eph)
+{
+    ublox_eph_t * cur = &(nav->eph[eph->gnssId][eph->svId - 1]);
+    uint8_t * flg = &(nav->flg_eph[eph->gnssId][eph->svId - 1]);
+
+    if (*flg && (cur->iode == eph->iode) && (cur->iodc == eph->iodc) && (cur->toe == eph->toe)) {
+        return 0;
+    }
+    *cur = *eph;
+    *flg = 1;
+    nav->num_eph ++;
+    if (NULL != nav->cb_eph) {
+        nav->cb_eph(nav->userdata, eph);
+    }
+    return 1;
+}
+
+/*****************************************************************************/
+// GPS/QZSS LNAV
+
+/**
+ * \brief check the parity of a GPS word
+ * \param word: the word, D1-D30 in the bits 29-0, the data bits are not inverted
+ * \param prev: the previous word, D29* and D30* in the bits 1-0, 0 for the first word
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nav_gps_parity(uint32_t word, uint32_t prev)
+{
+    /* the bits of D29*, D30*, d1-d24 in each parity equation */
+    static const uint32_t hamming[6] = {
+        0xBB1F3480, 0x5D8F9A40, 0xAEC7CD00, 0x5763E680, 0x6BB1F340, 0x8B7A89C0
+    };
+    uint32_t w = ((prev & 0x03) << 30) | (word & 0x3FFFFFFF);
+    uint32_t parity = 0;
+    uint32_t v;
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY(hamming); i ++) {
+        v = w & hamming[i];
+        // the parity of the bits
+        v ^= v >> 16;
+        v ^= v >> 8;
+        v ^= v >> 4;
+        v ^= v >> 2;
+        v ^= v >> 1;
+        parity = (parity << 1) | (v & 1);
+    }
+    return (parity == (w & 0x3F))?0:-1;
+}
+
+/* the fields of the subframes 1-3 of LNAV, parity removed */
+static const ublox_bitfield_t g_ublox_nav_lnav_sf1[] = {
+    UBLOX_BITFIELD_U(48, 10),   // week
+    UBLOX_BITFIELD_U(58, 2),    // code
+    UBLOX_BITFIELD_U(60, 4),    // sva
+    UBLOX_BITFIELD_U(64, 6),    // svh
+    UBLOX_BITFIELD_U(70, 2),    // iodc, MSBs
+    UBLOX_BITFIELD_U(72, 1),    // flag
+    UBLOX_BITFIELD_S(160, 8),   // tgd
+    UBLOX_BITFIELD_U(168, 8),   // iodc, LSBs
+    UBLOX_BITFIELD_U(176, 16),  // toc
+    UBLOX_BITFIELD_S(192, 8),   // f2
+    UBLOX_BITFIELD_S(200, 16),  // f1
+    UBLOX_BITFIELD_S(216, 22),  // f0
+};
+static const ublox_bitfield_t g_ublox_nav_lnav_sf2[] = {
+    UBLOX_BITFIELD_U(48, 8),    // iode
+    UBLOX_BITFIELD_S(56, 16),   // crs
+    UBLOX_BITFIELD_S(72, 16),   // deln
+    UBLOX_BITFIELD_S(88, 32),   // M0
+    UBLOX_BITFIELD_S(120, 16),  // cuc
+    UBLOX_BITFIELD_U(136, 32),  // e
+    UBLOX_BITFIELD_S(168, 16),  // cus
+    UBLOX_BITFIELD_U(184, 32),  // sqrtA
+    UBLOX_BITFIELD_U(216, 16),  // toe
+    UBLOX_BITFIELD_U(232, 1),   // fit
+};
+static const ublox_bitfield_t g_ublox_nav_lnav_sf3[] = {
+    UBLOX_BITFIELD_S(48, 16),   // cic
+    UBLOX_BITFIELD_S(64, 32),   // OMG0
+    UBLOX_BITFIELD_S(96, 16),   // cis
+    UBLOX_BITFIELD_S(112, 32),  // i0
+    UBLOX_BITFIELD_S(144, 16),  // crc
+    UBLOX_BITFIELD_S(160, 32),  // omg
+    UBLOX_BITFIELD_S(192, 24),  // OMGd
+    UBLOX_BITFIELD_S(224, 14),  // idot
+};
+
+/**
+ * \brief decode the ephemeris from the subframes 1-3
+ * \param data: the subframes, 30 bytes each
+ * \param eph: the result, gnssId and svId are set by the caller
+ */
+static void
+ublox_nav_decode_lnav(const uint8_t * data, ublox_eph_t * eph)
+{
+    uint32_t v[12];
+
+    // subframe 1
+    ublox_bitfield_extract(data, 3 * UBLOX_NAV_SZ_LNAV, g_ublox_nav_lnav_sf1, NUM_ARRAY(g_ublox_nav_lnav_sf1), v);
+    eph->week = v[0];
+    eph->code = v[1];
+    eph->sva = v[2];
+    eph->svh = v[3];
+    eph->iodc = (v[4] << 8) | v[7];
+    eph->flag = v[5];
+    eph->tgd = ldexp((int32_t)v[6], -31);
+    eph->toc = v[8] * 16.0;
+    eph->f2 = ldexp((int32_t)v[9], -55);
+    eph->f1 = ldexp((int32_t)v[10], -43);
+    eph->f0 = ldexp((int32_t)v[11], -31);
+
+    // subframe 2
+    ublox_bitfield_extract(data + UBLOX_NAV_SZ_LNAV, 2 * UBLOX_NAV_SZ_LNAV, g_ublox_nav_lnav_sf2, NUM_ARRAY(g_ublox_nav_lnav_sf2), v);
+    eph->iode = v[0];
+    eph->crs = ldexp((int32_t)v[1], -5);
+    eph->deln = ldexp((int32_t)v[2], -43) * UBLOX_NAV_SC2RAD;
+    eph->M0 = ldexp((int32_t)v[3], -31) * UBLOX_NAV_SC2RAD;
+    eph->cuc = ldexp((int32_t)v[4], -29);
+    eph->e = ldexp(v[5], -33);
+    eph->cus = ldexp((int32_t)v[6], -29);
+    eph->sqrtA = ldexp(v[7], -19);
+    eph->toe = v[8] * 16.0;
+    eph->fit = v[9];
+
+    // subframe 3
+    ublox_bitfield_extract(data + 2 * UBLOX_NAV_SZ_LNAV, UBLOX_NAV_SZ_LNAV, g_ublox_nav_lnav_sf3, NUM_ARRAY(g_ublox_nav_lnav_sf3), v);
+    eph->cic = ldexp((int32_t)v[0], -29);
+    eph->OMG0 = ldexp((int32_t)v[1], -31) * UBLOX_NAV_SC2RAD;
+    eph->cis = ldexp((int32_t)v[2], -29);
+    eph->i0 = ldexp((int32_t)v[3], -31) * UBLOX_NAV_SC2RAD;
+    eph->crc = ldexp((int32_t)v[4], -5);
+    eph->omg = ldexp((int32_t)v[5], -31) * UBLOX_NAV_SC2RAD;
+    eph->OMGd = ldexp((int32_t)v[6], -43) * UBLOX_NAV_SC2RAD;
+    eph->idot = ldexp((int32_t)v[7], -43) * UBLOX_NAV_SC2RAD;
+}
+
+/**
+ * \brief add a subframe of GPS or QZSS LNAV to the cache
+ * \param nav: the cache
+ * \param gnssId: the gnssId of UBX, GPS(0) or QZSS(5)
+ * \param svId: the svId of UBX
+ * \param words: the 10 words of the subframe, 24 data bits in each word
+ *
+ * \return 1 if the ephemeris of the satellite is changed, 0 on success, <0 on error
+ *
+ * The ephemeris is decoded when the subframes 1-3 have the same IODE/IODC,
+ * and it is reported only if the IODE, IODC or toe is changed.
+ */
+int
+ublox_nav_add_lnav(ublox_nav_t * nav, uint8_t gnssId, uint8_t svId, const uint32_t * words)
+{
+    ublox_nav_frame_t * frm;
+    ublox_eph_t eph;
+    uint8_t buf[UBLOX_NAV_SZ_LNAV];
+    uint32_t iodc;
+    size_t i;
+    int id;
+
+    assert (NULL != nav);
+    frm = ublox_nav_frame_of(nav, gnssId, svId);
+    if (NULL == frm) {
+        return -1;
+    }
+    if (((words[0] >> 16) & 0xFF) != UBLOX_NAV_PREAMBLE) {
+        return -1;
+    }
+    nav->num_subframe ++;
+    id = (words[1] >> 2) & 0x07;
+    if ((id < 1) || (id > 3)) {
+        // the almanac
+        return 0;
+    }
+    for (i = 0; i < 10; i ++) {
+        ublox_setbitu(buf, i * 24, 24, words[i]);
+    }
+    if (0 == ublox_nav_frame_put(frm, id - 1, UBLOX_NAV_SZ_LNAV, buf)) {
+        // the same data as the saved subframe
+        return 0;
+    }
+    if ((frm->mask & 0x07) != 0x07) {
+        return 0;
+    }
+    // the IODC (8 LSBs) of subframe 1, the IODE of subframe 2 and 3
+    iodc = ublox_getbitu(frm->data, 168, 8);
+    if ((iodc != ublox_getbitu(frm->data + UBLOX_NAV_SZ_LNAV, 48, 8))
+        || (iodc != ublox_getbitu(frm->data + 2 * UBLOX_NAV_SZ_LNAV, 216, 8))) {
+        return 0;
+    }
+    memset(&eph, 0, sizeof(eph));
+    eph.gnssId = gnssId;
+    eph.svId = svId;
+    ublox_nav_decode_lnav(frm->data, &eph);
+    return ublox_nav_update(nav, &eph);
+}
+
+/*****************************************************************************/
+// Galileo I/NAV
+
+/* the CRC-24Q of the even and odd pages: 4 bits of 0, 114 bits of the even page, 82 bits of the odd page */
+static uint32_t
+ublox_nav_inav_crc(const uint8_t * buf)
+{
+    uint8_t crc[25];
+    memset(crc, 0, sizeof(crc));
+    ublox_nav_copybits(crc, 4, buf, 0, 114);
+    ublox_nav_copybits(crc, 118, buf + 16, 0, 82);
+    return ublox_crc24q(crc, sizeof(crc));
+}
+
+/**
+ * \brief decode the ephemeris from the word types 1-5 of Galileo I/NAV
+ * \param data: the words, 16 bytes each
+ * \param eph: the result, gnssId and svId are set by the caller
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ublox_nav_decode_inav(const uint8_t * data, ublox_eph_t * eph)
+{
+    size_t i;
+    int hs5, hs1, dvs5, dvs1;
+
+    // word type 1
+    i = 6;
+    eph->iode = ublox_getbitu(data, i, 10); i += 10;
+    eph->toe = ublox_getbitu(data, i, 14) * 60.0; i += 14;
+    eph->M0 = ldexp(ublox_getbits(data, i, 32), -31) * UBLOX_NAV_SC2RAD; i += 32;
+    eph->e = ldexp(ublox_getbitu(data, i, 32), -33); i += 32;
+    eph->sqrtA = ldexp(ublox_getbitu(data, i, 32), -19);
+
+    // word type 2
+    i = 128 + 6 + 10;
+    eph->OMG0 = ldexp(ublox_getbits(data, i, 32), -31) * UBLOX_NAV_SC2RAD; i += 32;
+    eph->i0 = ldexp(ublox_getbits(data, i, 32), -31) * UBLOX_NAV_SC2RAD; i += 32;
+    eph->omg = ldexp(ublox_getbits(data, i, 32), -31) * UBLOX_NAV_SC2RAD; i += 32;
+    eph->idot = ldexp(ublox_getbits(data, i, 14), -43) * UBLOX_NAV_SC2RAD;
+
+    // word type 3
+    i = 256 + 6 + 10;
+    eph->OMGd = ldexp(ublox_getbits(data, i, 24), -43) * UBLOX_NAV_SC2RAD; i += 24;
+    eph->deln = ldexp(ublox_getbits(data, i, 16), -43) * UBLOX_NAV_SC2RAD; i += 16;
+    eph->cuc = ldexp(ublox_getbits(data, i, 16), -29); i += 16;
+    eph->cus = ldexp(ublox_getbits(data, i, 16), -29); i += 16;
+    eph->crc = ldexp(ublox_getbits(data, i, 16), -5); i += 16;
+    eph->crs = ldexp(ublox_getbits(data, i, 16), -5); i += 16;
+    eph->sva = ublox_getbitu(data, i, 8);
+
+    // word type 4
+    i = 384 + 6 + 10;
+    if (ublox_getbitu(data, i, 6) != eph->svId) {
+        return -1;
+    }
+    i += 6;
+    eph->cic = ldexp(ublox_getbits(data, i, 16), -29); i += 16;
+    eph->cis = ldexp(ublox_getbits(data, i, 16), -29); i += 16;
+    eph->toc = ublox_getbitu(data, i, 14) * 60.0; i += 14;
+    eph->f0 = ldexp(ublox_getbits(data, i, 31), -34); i += 31;
+    eph->f1 = ldexp(ublox_getbits(data, i, 21), -46); i += 21;
+    eph->f2 = ldexp(ublox_getbits(data, i, 6), -59);
+
+    // word type 5, skip the ionospheric correction
+    i = 512 + 6 + 41;
+    eph->tgd = ldexp(ublox_getbits(data, i, 10), -32); i += 10;
+    eph->tgd2 = ldexp(ublox_getbits(data, i, 10), -32); i += 10;
+    hs5 = ublox_getbitu(data, i, 2); i += 2;
+    hs1 = ublox_getbitu(data, i, 2); i += 2;
+    dvs5 = ublox_getbitu(data, i, 1); i += 1;
+    dvs1 = ublox_getbitu(data, i, 1); i += 1;
+    eph->week = ublox_getbitu(data, i, 12);
+    eph->svh = (hs5 << 7) | (dvs5 << 6) | (hs1 << 1) | dvs1;
+    eph->iodc = eph->iode;
+    return 0;
+}
+
+/**
+ * \brief add a word of Galileo I/NAV to the cache
+ * \param nav: the cache
+ * \param svId: the svId of UBX
+ * \param dwrd: the 8 words of RXM-SFRBX, the even page and the odd page
+ *
+ * \return 1 if the ephemeris of the satellite is changed, 0 on success, <0 on error
+ *
+ * The ephemeris is decoded when the word types 1-4 have the same IODnav.
+ */
+int
+ublox_nav_add_inav(ublox_nav_t * nav, uint8_t svId, const uint32_t * dwrd)
+{
+    ublox_nav_frame_t * frm;
+    ublox_eph_t eph;
+    uint8_t buf[32];
+    uint8_t word[UBLOX_NAV_SZ_INAV];
+    uint32_t iod;
+    int type;
+    int k;
+
+    assert (NULL != nav);
+    frm = ublox_nav_frame_of(nav, UBLOX_NAV_GNSS_GAL, svId);
+    if (NULL == frm) {
+        return -1;
+    }
+    ublox_nav_pack_u32(dwrd, 8, buf);
+    if (ublox_getbitu(buf, 1, 1) || ublox_getbitu(buf + 16, 1, 1)) {
+        // the alert page
+        return 0;
+    }
+    if ((0 != ublox_getbitu(buf, 0, 1)) || (1 != ublox_getbitu(buf + 16, 0, 1))) {
+        // not the even page followed by the odd page
+        return -1;
+    }
+    nav->num_subframe ++;
+    if (ublox_nav_inav_crc(buf) != ublox_getbitu(buf + 16, 82, 24)) {
+        nav->num_err_parity ++;
+        return -1;
+    }
+    type = ublox_getbitu(buf, 2, 6);
+    if ((type < 1) || (type > 5)) {
+        return 0;
+    }
+    // 112 bits of the even page and 16 bits of the odd page
+    ublox_nav_copybits(word, 0, buf, 2, 112);
+    ublox_nav_copybits(word, 112, buf + 16, 2, 16);
+    if (0 == ublox_nav_frame_put(frm, type - 1, UBLOX_NAV_SZ_INAV, word)) {
+        return 0;
+    }
+    if ((frm->mask & 0x1F) != 0x1F) {
+        return 0;
+    }
+    iod = ublox_getbitu(frm->data, 6, 10);
+    for (k = 1; k < 4; k ++) {
+        if (iod != ublox_getbitu(frm->data + k * UBLOX_NAV_SZ_INAV, 6, 10)) {
+            return 0;
+        }
+    }
+    memset(&eph, 0, sizeof(eph));
+    eph.gnssId = UBLOX_NAV_GNSS_GAL;
+    eph.svId = svId;
+    if (ublox_nav_decode_inav(frm->data, &eph) < 0) {
+        return -1;
+    }
+    return ublox_nav_update(nav, &eph);
+}
+
+/*****************************************************************************/
+// BeiDou D1/D2
+
+/* the SOW in the first two words of a subframe */
+static uint32_t
+ublox_nav_bds_sow(const uint8_t * buf)
+{
+    return ublox_nav_getbitu2(buf, 18, 8, 30, 12);
+}
+
+/* the fields of the subframes 1-3 of BeiDou D1, the words of 30 bits with the parity */
+static const ublox_bitfield_t g_ublox_nav_bds_d1_sf1[] = {
+    UBLOX_BITFIELD_U(42, 1),            // svh
+    UBLOX_BITFIELD_U(43, 5),            // iodc
+    UBLOX_BITFIELD_U(48, 4),            // sva
+    UBLOX_BITFIELD_U(60, 13),           // week
+    UBLOX_BITFIELD_U2(73, 9, 90, 8),    // toc
+    UBLOX_BITFIELD_S(98, 10),           // tgd
+    UBLOX_BITFIELD_S2(108, 4, 120, 6),  // tgd2
+    UBLOX_BITFIELD_S(214, 11),          // f2
+    UBLOX_BITFIELD_S2(225, 7, 240, 17), // f0
+    UBLOX_BITFIELD_S2(257, 5, 270, 17), // f1
+    UBLOX_BITFIELD_U(287, 5),           // iode
+};
+static const ublox_bitfield_t g_ublox_nav_bds_d1_sf2[] = {
+    UBLOX_BITFIELD_S2(42, 10, 60, 6),   // deln
+    UBLOX_BITFIELD_S2(66, 16, 90, 2),   // cuc
+    UBLOX_BITFIELD_S2(92, 20, 120, 12), // M0
+    UBLOX_BITFIELD_U2(132, 10, 150, 22),// e
+    UBLOX_BITFIELD_S(180, 18),          // cus
+    UBLOX_BITFIELD_S2(198, 4, 210, 14), // crc
+    UBLOX_BITFIELD_S2(224, 8, 240, 10), // crs
+    UBLOX_BITFIELD_U2(250, 12, 270, 20),// sqrtA
+    UBLOX_BITFIELD_U(290, 2),           // toe, MSBs
+};
+static const ublox_bitfield_t g_ublox_nav_bds_d1_sf3[] = {
+    UBLOX_BITFIELD_U2(42, 10, 60, 5),   // toe, LSBs
+    UBLOX_BITFIELD_S2(65, 17, 90, 15),  // i0
+    UBLOX_BITFIELD_S2(105, 7, 120, 11), // cic
+    UBLOX_BITFIELD_S2(131, 11, 150, 13),// OMGd
+    UBLOX_BITFIELD_S2(163, 9, 180, 9),  // cis
+    UBLOX_BITFIELD_S2(189, 13, 210, 1), // idot
+    UBLOX_BITFIELD_S2(211, 21, 240, 11),// OMG0
+    UBLOX_BITFIELD_S2(251, 11, 270, 21),// omg
+};
+
+/**
+ * \brief decode the ephemeris from the subframes 1-3 of BeiDou D1
+ * \param data: the subframes, 38 bytes each
+ * \param eph: the result, gnssId and svId are set by the caller
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ublox_nav_decode_bds_d1(const uint8_t * data, ublox_eph_t * eph)
+{
+    uint32_t v[11];
+    uint32_t toe;
+
+    // subframe 1
+    ublox_bitfield_extract(data, 3 * UBLOX_NAV_SZ_BDS, g_ublox_nav_bds_d1_sf1, NUM_ARRAY(g_ublox_nav_bds_d1_sf1), v);
+    eph->svh = v[0];
+    eph->iodc = v[1];
+    eph->sva = v[2];
+    eph->week = v[3];
+    eph->toc = v[4] * 8.0;
+    eph->tgd = (int32_t)v[5] * 0.1E-9;
+    eph->tgd2 = (int32_t)v[6] * 0.1E-9;
+    eph->f2 = ldexp((int32_t)v[7], -66);
+    eph->f0 = ldexp((int32_t)v[8], -33);
+    eph->f1 = ldexp((int32_t)v[9], -50);
+    eph->iode = v[10];
+
+    // subframe 2
+    ublox_bitfield_extract(data + UBLOX_NAV_SZ_BDS, 2 * UBLOX_NAV_SZ_BDS, g_ublox_nav_bds_d1_sf2, NUM_ARRAY(g_ublox_nav_bds_d1_sf2), v);
+    eph->deln = ldexp((int32_t)v[0], -43) * UBLOX_NAV_SC2RAD;
+    eph->cuc = ldexp((int32_t)v[1], -31);
+    eph->M0 = ldexp((int32_t)v[2], -31) * UBLOX_NAV_SC2RAD;
+    eph->e = ldexp(v[3], -33);
+    eph->cus = ldexp((int32_t)v[4], -31);
+    eph->crc = ldexp((int32_t)v[5], -6);
+    eph->crs = ldexp((int32_t)v[6], -6);
+    eph->sqrtA = ldexp(v[7], -19);
+    toe = v[8];
+
+    // subframe 3
+    ublox_bitfield_extract(data + 2 * UBLOX_NAV_SZ_BDS, UBLOX_NAV_SZ_BDS, g_ublox_nav_bds_d1_sf3, NUM_ARRAY(g_ublox_nav_bds_d1_sf3), v);
+    eph->toe = ((toe << 15) | v[0]) * 8.0;
+    eph->i0 = ldexp((int32_t)v[1], -31) * UBLOX_NAV_SC2RAD;
+    eph->cic = ldexp((int32_t)v[2], -31);
+    eph->OMGd = ldexp((int32_t)v[3], -43) * UBLOX_NAV_SC2RAD;
+    eph->cis = ldexp((int32_t)v[4], -31);
+    eph->idot = ldexp((int32_t)v[5], -43) * UBLOX_NAV_SC2RAD;
+    eph->OMG0 = ldexp((int32_t)v[6], -31) * UBLOX_NAV_SC2RAD;
+    eph->omg = ldexp((int32_t)v[7], -31) * UBLOX_NAV_SC2RAD;
+
+    return (eph->toc == eph->toe)?0:-1;
+}
+
+/**
+ * \brief decode the ephemeris from the pages 1-10 of the subframe 1 of BeiDou D2
+ * \param data: the pages, 38 bytes each
+ * \param eph: the result, gnssId and svId are set by the caller
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ublox_nav_decode_bds_d2(const uint8_t * data, ublox_eph_t * eph)
+{
+    const uint8_t * buf;
+    uint32_t msb;
+
+    // page 1
+    buf = data;
+    eph->svh = ublox_getbitu(buf, 46, 1);
+    eph->iodc = ublox_getbitu(buf, 47, 5);
+    eph->sva = ublox_getbitu(buf, 60, 4);
+    eph->week = ublox_getbitu(buf, 64, 13);
+    eph->toc = ublox_nav_getbitu2(buf, 77, 5, 90, 12) * 8.0;
+    eph->tgd = ublox_getbits(buf, 102, 10) * 0.1E-9;
+    eph->tgd2 = ublox_getbits(buf, 120, 10) * 0.1E-9;
+
+    // page 3
+    buf = data + 2 * UBLOX_NAV_SZ_BDS;
+    eph->f0 = ldexp(ublox_nav_getbits2(buf, 100, 12, 120, 12), -33);
+    msb = ublox_getbitu(buf, 132, 4);
+
+    // page 4
+    buf = data + 3 * UBLOX_NAV_SZ_BDS;
+    eph->f1 = ldexp(ublox_nav_sext((msb << 18) | ublox_nav_getbitu2(buf, 46, 6, 60, 12), 22), -50);
+    eph->f2 = ldexp(ublox_nav_getbits2(buf, 72, 10, 90, 1), -66);
+    eph->iode = ublox_getbitu(buf, 91, 5);
+    eph->deln = ldexp(ublox_getbits(buf, 96, 16), -43) * UBLOX_NAV_SC2RAD;
+    msb = ublox_getbitu(buf, 120, 14);
+
+    // page 5
+    buf = data + 4 * UBLOX_NAV_SZ_BDS;
+    eph->cuc = ldexp(ublox_nav_sext((msb << 4) | ublox_getbitu(buf, 46, 4), 18), -31);
+    eph->M0 = ldexp((int32_t)((ublox_getbitu(buf, 50, 2) << 30) | ublox_nav_getbitu2(buf, 60, 22, 90, 8)), -31) * UBLOX_NAV_SC2RAD;
+    eph->cus = ldexp(ublox_nav_getbits2(buf, 98, 14, 120, 4), -31);
+    msb = ublox_getbitu(buf, 124, 10);
+
+    // page 6
+    buf = data + 5 * UBLOX_NAV_SZ_BDS;
+    eph->e = ldexp((msb << 22) | ublox_nav_getbitu2(buf, 46, 6, 60, 16), -33);
+    eph->sqrtA = ldexp((ublox_getbitu(buf, 76, 6) << 26) | ublox_nav_getbitu2(buf, 90, 22, 120, 4), -19);
+    msb = ublox_getbitu(buf, 124, 10);
+
+    // page 7
+    buf = data + 6 * UBLOX_NAV_SZ_BDS;
+    eph->cic = ldexp(ublox_nav_sext((msb << 8) | ublox_nav_getbitu2(buf, 46, 6, 60, 2), 18), -31);
+    eph->cis = ldexp(ublox_getbits(buf, 62, 18), -31);
+    eph->toe = ublox_nav_getbitu2(buf, 80, 2, 90, 15) * 8.0;
+    msb = ublox_nav_getbitu2(buf, 105, 7, 120, 14);
+
+    // page 8
+    buf = data + 7 * UBLOX_NAV_SZ_BDS;
+    eph->i0 = ldexp((int32_t)((msb << 11) | ublox_nav_getbitu2(buf, 46, 6, 60, 5)), -31) * UBLOX_NAV_SC2RAD;
+    eph->crc = ldexp(ublox_nav_getbits2(buf, 65, 17, 90, 1), -6);
+    eph->crs = ldexp(ublox_getbits(buf, 91, 18), -6);
+    msb = ublox_nav_getbitu2(buf, 109, 3, 120, 16);
+
+    // page 9
+    buf = data + 8 * UBLOX_NAV_SZ_BDS;
+    eph->OMGd = ldexp(ublox_nav_sext((msb << 5) | ublox_getbitu(buf, 46, 5), 24), -43) * UBLOX_NAV_SC2RAD;
+    eph->OMG0 = ldexp((int32_t)((ublox_getbitu(buf, 51, 1) << 31) | ublox_nav_getbitu2(buf, 60, 22, 90, 9)), -31) * UBLOX_NAV_SC2RAD;
+    msb = ublox_nav_getbitu2(buf, 99, 13, 120, 14);
+
+    // page 10
+    buf = data + 9 * UBLOX_NAV_SZ_BDS;
+    eph->omg = ldexp((int32_t)((msb << 5) | ublox_getbitu(buf, 46, 5)), -31) * UBLOX_NAV_SC2RAD;
+    eph->idot = ldexp(ublox_nav_getbits2(buf, 51, 1, 60, 13), -43) * UBLOX_NAV_SC2RAD;
+
+    return (eph->toc == eph->toe)?0:-1;
+}
+
+/**
+ * \brief add a subframe of BeiDou D1 or D2 to the cache
+ * \param nav: the cache
+ * \param svId: the svId of UBX, D2 for the GEO satellites (1-5, 59-63)
+ * \param dwrd: the 10 words of RXM-SFRBX, 30 bits each
+ *
+ * \return 1 if the ephemeris of the satellite is changed, 0 on success, <0 on error
+ *
+ * The ephemeris is decoded from the subframes 1-3 of D1, or the pages
+ * 1, 3-10 of the subframe 1 of D2, with the consecutive SOWs.
+ */
+int
+ublox_nav_add_bds(ublox_nav_t * nav, uint8_t svId, const uint32_t * dwrd)
+{
+    ublox_nav_frame_t * frm;
+    ublox_eph_t eph;
+    uint8_t buf[UBLOX_NAV_SZ_BDS];
+    uint32_t sow;
+    size_t i;
+    int id;
+    int ret;
+
+    assert (NULL != nav);
+    frm = ublox_nav_frame_of(nav, UBLOX_NAV_GNSS_BDS, svId);
+    if (NULL == frm) {
+        return -1;
+    }
+    memset(buf, 0, sizeof(buf));
+    for (i = 0; i < 10; i ++) {
+        ublox_setbitu(buf, i * 30, 30, dwrd[i] & 0x3FFFFFFF);
+    }
+    if (ublox_getbitu(buf, 0, 11) != UBLOX_NAV_PREAMBLE_BDS) {
+        return -1;
+    }
+    nav->num_subframe ++;
+    id = ublox_getbitu(buf, 15, 3);
+    memset(&eph, 0, sizeof(eph));
+    eph.gnssId = UBLOX_NAV_GNSS_BDS;
+    eph.svId = svId;
+    if ((svId <= 5) || (svId >= 59)) {
+        // GEO, D2
+        if (id != 1) {
+            return 0;
+        }
+        id = ublox_getbitu(buf, 42, 4);
+        if ((id < 1) || (id > 10)) {
+            return -1;
+        }
+        // the page 2 is not used
+        if ((0 == ublox_nav_frame_put(frm, id - 1, UBLOX_NAV_SZ_BDS, buf)) || (id == 2)) {
+            return 0;
+        }
+        if ((frm->mask & 0x3FD) != 0x3FD) {
+            return 0;
+        }
+        // the pages of the subframe 1 are 3 seconds apart
+        sow = ublox_nav_bds_sow(frm->data);
+        for (i = 2; i < 10; i ++) {
+            if (ublox_nav_bds_sow(frm->data + i * UBLOX_NAV_SZ_BDS) != sow + 3 * i) {
+                return 0;
+            }
+        }
+        ret = ublox_nav_decode_bds_d2(frm->data, &eph);
+    } else {
+        // MEO/IGSO, D1
+        if ((id < 1) || (id > 3)) {
+            // the almanac
+            return 0;
+        }
+        if (0 == ublox_nav_frame_put(frm, id - 1, UBLOX_NAV_SZ_BDS, buf)) {
+            return 0;
+        }
+        if ((frm->mask & 0x07) != 0x07) {
+            return 0;
+        }
+        // the subframes are 6 seconds apart
+        sow = ublox_nav_bds_sow(frm->data);
+        if ((ublox_nav_bds_sow(frm->data + UBLOX_NAV_SZ_BDS) != sow + 6)
+            || (ublox_nav_bds_sow(frm->data + 2 * UBLOX_NAV_SZ_BDS) != sow + 12)) {
+            return 0;
+        }
+        ret = ublox_nav_decode_bds_d1(frm->data, &eph);
+    }
+    if (ret < 0) {
+        return 0;
+    }
+    return ublox_nav_update(nav, &eph);
+}
+
+/*****************************************************************************/
+// GLONASS
+
+/**
+ * \brief check the Hamming code of a GLONASS string
+ * \param str: the 85 bits of the string, MSB first, the bit 85 (idle) is the first bit
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The check bits b1-b7 are at the power-of-two positions of the Hamming
+ * code, the data bits b9-b85 take the other positions in order, and b8
+ * makes the parity of the whole string even.
+ */
+int
+ublox_nav_glo_hamming(const uint8_t * str)
+{
+    uint32_t syndrome = 0;
+    uint32_t sum = 0;
+    uint32_t pos = 2;
+    int k;
+
+    for (k = 1; k <= 85; k ++) {
+        if (k > 8) {
+            // the next position which is not a power of two
+            do {
+                pos ++;
+            } while (0 == (pos & (pos - 1)));
+        }
+        if (0 == ublox_getbitu(str, 85 - k, 1)) {
+            continue;
+        }
+        sum ^= 1;
+        if (k < 8) {
+            syndrome ^= 1u << (k - 1);
+        } else if (k > 8) {
+            syndrome ^= pos;
+        }
+    }
+    return ((0 == syndrome) && (0 == sum))?0:-1;
+}
+
+/**
+ * \brief decode the ephemeris from the strings 1-4 of GLONASS
+ * \param data: the strings, 10 bytes each
+ * \param eph: the result, gnssId and svId are set by the caller
+ *
+ * \return 0 on success, <0 on error
+ */
+static int
+ublox_nav_decode_glo(const uint8_t * data, ublox_eph_t * eph)
+{
+    size_t i;
+
+    // string 1
+    i = 1 + 4 + 2 + 2;
+    eph->toc = ublox_getbitu(data, i, 5) * 3600.0; i += 5;
+    eph->toc += ublox_getbitu(data, i, 6) * 60.0; i += 6;
+    eph->toc += ublox_getbitu(data, i, 1) * 30.0; i += 1;
+    eph->vel[0] = ldexp(ublox_nav_getbitg(data, i, 24), -20) * 1E3; i += 24;
+    eph->acc[0] = ldexp(ublox_nav_getbitg(data, i, 5), -30) * 1E3; i += 5;
+    eph->pos[0] = ldexp(ublox_nav_getbitg(data, i, 27), -11) * 1E3;
+
+    // string 2
+    i = 80 + 1 + 4;
+    eph->svh = ublox_getbitu(data, i, 1); i += 3 + 1;
+    eph->iode = ublox_getbitu(data, i, 7); i += 7 + 5;
+    eph->vel[1] = ldexp(ublox_nav_getbitg(data, i, 24), -20) * 1E3; i += 24;
+    eph->acc[1] = ldexp(ublox_nav_getbitg(data, i, 5), -30) * 1E3; i += 5;
+    eph->pos[1] = ldexp(ublox_nav_getbitg(data, i, 27), -11) * 1E3;
+
+    // string 3
+    i = 160 + 1 + 4 + 1;
+    eph->gamn = ldexp(ublox_nav_getbitg(data, i, 11), -40); i += 11 + 1 + 2 + 1;
+    eph->vel[2] = ldexp(ublox_nav_getbitg(data, i, 24), -20) * 1E3; i += 24;
+    eph->acc[2] = ldexp(ublox_nav_getbitg(data, i, 5), -30) * 1E3; i += 5;
+    eph->pos[2] = ldexp(ublox_nav_getbitg(data, i, 27), -11) * 1E3;
+
+    // string 4
+    i = 240 + 1 + 4;
+    eph->taun = ldexp(ublox_nav_getbitg(data, i, 22), -30); i += 22;
+    eph->dtaun = ldexp(ublox_nav_getbitg(data, i, 5), -30); i += 5;
+    eph->age = ublox_getbitu(data, i, 5); i += 5 + 14 + 1;
+    eph->sva = ublox_getbitu(data, i, 4); i += 4 + 3;
+    eph->nt = ublox_getbitu(data, i, 11); i += 11;
+    if (ublox_getbitu(data, i, 5) != eph->svId) {
+        return -1;
+    }
+    eph->toe = eph->iode * 900.0;
+    return 0;
+}
+
+/**
+ * \brief add a string of GLONASS to the cache
+ * \param nav: the cache
+ * \param svId: the svId of UBX, the slot number
+ * \param freqId: the freqId of UBX, the frequency channel + 7
+ * \param dwrd: the 4 words of RXM-SFRBX
+ *
+ * \return 1 if the ephemeris of the satellite is changed, 0 on success, <0 on error
+ *
+ * The ephemeris is decoded from the strings 1-4 received in order, and it
+ * is reported only if tb is changed.
+ */
+int
+ublox_nav_add_glo(ublox_nav_t * nav, uint8_t svId, uint8_t freqId, const uint32_t * dwrd)
+{
+    ublox_nav_frame_t * frm;
+    ublox_eph_t eph;
+    uint8_t buf[16];
+    int m;
+
+    assert (NULL != nav);
+    ublox_nav_pack_u32(dwrd, 4, buf);
+    nav->num_subframe ++;
+    if (ublox_nav_glo_hamming(buf) < 0) {
+        nav->num_err_parity ++;
+        return -1;
+    }
+    m = ublox_getbitu(buf, 1, 4);
+    frm = ublox_nav_frame_of(nav, UBLOX_NAV_GNSS_GLO, svId);
+    if ((m < 1) || (m > 4) || (NULL == frm)) {
+        // the almanac, or the unknown slot
+        return 0;
+    }
+    // the strings of a frame are sent in order
+    if (m == 1) {
+        frm->mask = 0;
+    } else if (frm->mask != (1u << (m - 1)) - 1) {
+        frm->mask = 0;
+        return 0;
+    }
+    ublox_nav_frame_put(frm, m - 1, UBLOX_NAV_SZ_GLO, buf);
+    if (m != 4) {
+        return 0;
+    }
+    memset(&eph, 0, sizeof(eph));
+    eph.gnssId = UBLOX_NAV_GNSS_GLO;
+    eph.svId = svId;
+    eph.frq = (int)freqId - 7;
+    if (ublox_nav_decode_glo(frm->data, &eph) < 0) {
+        return 0;
+    }
+    return ublox_nav_update(nav, &eph);
+}
+
+/*****************************************************************************/
+
+/**
+ * \brief add the navigation data of RXM-SFRBX to the cache
+ * \param nav: the cache
+ * \param msg: the decoded packet, with the words in msg->dwrd
+ *
+ * \return 1 if an ephemeris is changed, 0 on success or the data is ignored, <0 on error
+ */
+int
+ublox_nav_add_sfrbx(ublox_nav_t * nav, const ublox_rxm_sfrbx_t * msg)
+{
+    uint32_t words[10];
+    size_t i;
+
+    assert (NULL != nav);
+    assert (NULL != msg);
+    switch (msg->gnssId) {
+    case UBLOX_NAV_GNSS_GPS:
+    case UBLOX_NAV_GNSS_QZS:
+        if (msg->num_dwrd < 10) {
+            return -1;
+        }
+        for (i = 0; i < 10; i ++) {
+            if (ublox_nav_gps_parity(msg->dwrd[i], (i > 0)?msg->dwrd[i - 1]:0) < 0) {
+                nav->num_err_parity ++;
+                return -1;
+            }
+            words[i] = (msg->dwrd[i] >> 6) & 0xFFFFFF;
+        }
+        return ublox_nav_add_lnav(nav, msg->gnssId, msg->svId, words);
+    case UBLOX_NAV_GNSS_GAL:
+        if (msg->num_dwrd < 8) {
+            return -1;
+        }
+        return ublox_nav_add_inav(nav, msg->svId, msg->dwrd);
+    case UBLOX_NAV_GNSS_BDS:
+        if (msg->num_dwrd < 10) {
+            return -1;
+        }
+        return ublox_nav_add_bds(nav, msg->svId, msg->dwrd);
+    case UBLOX_NAV_GNSS_GLO:
+        if (msg->num_dwrd < 4) {
+            return -1;
+        }
+        return ublox_nav_add_glo(nav, msg->svId, msg->freqId, msg->dwrd);
+    }
+    return 0;
+}
+
+/**
+ * \brief add the subframe of RXM-SFRB to the cache
+ * \param nav: the cache
+ * \param msg: the decoded packet
+ *
+ * \return 1 if an ephemeris is changed, 0 on success or the subframe is ignored, <0 on error
+ *
+ * The words of RXM-SFRB have no parity bits.
+ */
+int
+ublox_nav_add_sfrb(ublox_nav_t * nav, const ublox_rxm_sfrb_t * msg)
+{
+    uint32_t words[10];
+    size_t i;
+
+    assert (NULL != nav);
+    assert (NULL != msg);
+    if ((msg->svid < 1) || (msg->svid > 32)) {
+        // SBAS
+        return 0;
+    }
+    for (i = 0; i < 10; i ++) {
+        words[i] = msg->dwrd[i] & 0xFFFFFF;
+    }
+    return ublox_nav_add_lnav(nav, UBLOX_NAV_GNSS_GPS, msg->svid, words);
+}
+
+/**
+ * \brief the handler of RXM-SFRBX for the registry
+ * \param userdata: the cache, ublox_nav_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nav_handler_sfrbx(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rxm_sfrbx_t msg;
+    uint32_t dwrd[16];
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.dwrd = dwrd;
+    msg.max_dwrd = NUM_ARRAY(dwrd);
+    if (ublox_decode_rxm_sfrbx(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    return (ublox_nav_add_sfrbx((ublox_nav_t *)userdata, &msg) < 0)?-1:0;
+}
+
+/**
+ * \brief the handler of RXM-SFRB for the registry
+ * \param userdata: the cache, ublox_nav_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nav_handler_sfrb(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rxm_sfrb_t msg;
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    if (ublox_decode_rxm_sfrb(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    return (ublox_nav_add_sfrb((ublox_nav_t *)userdata, &msg) < 0)?-1:0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* set the bits of the 24-bit words of a subframe */
+static void
+ublox_nav_test_setbitu(uint32_t * words, size_t pos, size_t len, uint32_t val)
+{
+    size_t i;
+    for (i = 0; i < len; i ++) {
+        size_t b = pos + i;
+        uint32_t mask = 1u << (23 - b % 24);
+        if ((val >> (len - 1 - i)) & 1) {
+            words[b / 24] |= mask;
+        } else {
+            words[b / 24] &= ~mask;
+        }
+    }
+}
+
+/* create the 30-bit words with the parity bits */
+static void
+ublox_nav_test_parity(const uint32_t * words, uint32_t * dwrd)
+{
+    uint32_t p;
+    size_t i;
+    for (i = 0; i < 10; i ++) {
+        for (p = 0; p < 64; p ++) {
+            dwrd[i] = (words[i] << 6) | p;
+            if (0 == ublox_nav_gps_parity(dwrd[i], (i > 0)?dwrd[i - 1]:0)) {
+                break;
+            }
+        }
+    }
+}
+
+/* create the subframe 1-3 of GPS */
+static void
+ublox_nav_test_lnav(uint32_t words[3][10], int iode)
+{
+    size_t i;
+    memset(words, 0, 3 * 10 * sizeof(uint32_t));
+    for (i = 0; i < 3; i ++) {
+        ublox_nav_test_setbitu(words[i], 0, 8, UBLOX_NAV_PREAMBLE);
+        ublox_nav_test_setbitu(words[i], 24 + 19, 3, i + 1);
+    }
+    ublox_nav_test_setbitu(words[0], 48, 10, 1000 % 1024);  // week
+    ublox_nav_test_setbitu(words[0], 60, 4, 2);             // ura
+    ublox_nav_test_setbitu(words[0], 70, 2, 1);             // iodc msb
+    ublox_nav_test_setbitu(words[0], 160, 8, (uint32_t)-10);// tgd
+    ublox_nav_test_setbitu(words[0], 168, 8, iode);         // iodc lsb
+    ublox_nav_test_setbitu(words[0], 176, 16, 450);         // toc/16
+    ublox_nav_test_setbitu(words[0], 216, 22, (uint32_t)-123456 & 0x3FFFFF); // af0
+    ublox_nav_test_setbitu(words[1], 48, 8, iode);
+    ublox_nav_test_setbitu(words[1], 56, 16, (uint32_t)-400 & 0xFFFF); // crs
+    ublox_nav_test_setbitu(words[1], 136, 32, 0x12345678);  // e
+    ublox_nav_test_setbitu(words[1], 184, 32, 2702000000u); // sqrtA
+    ublox_nav_test_setbitu(words[1], 216, 16, 450);         // toe/16
+    ublox_nav_test_setbitu(words[2], 48 + 16 + 32 + 16 + 32 + 16 + 32 + 24, 8, iode);
+    ublox_nav_test_setbitu(words[2], 48 + 16 + 32 + 16 + 32 + 16 + 32 + 24 + 8, 14, (uint32_t)-5 & 0x3FFF); // idot
+}
+
+/* the bytes to the words of RXM-SFRBX */
+static void
+ublox_nav_test_unpack(const uint8_t * buf, size_t num, uint32_t * dwrd)
+{
+    size_t i;
+    for (i = 0; i < num; i ++) {
+        dwrd[i] = ublox_getbitu(buf, i * 32, 32);
+    }
+}
+
+/* create the even and odd pages of a word of Galileo I/NAV */
+static void
+ublox_nav_test_inav(const uint8_t * word, uint32_t * dwrd)
+{
+    uint8_t buf[32];
+    memset(buf, 0, sizeof(buf));
+    ublox_nav_copybits(buf, 2, word, 0, 112);
+    ublox_setbitu(buf + 16, 0, 1, 1);
+    ublox_nav_copybits(buf + 16, 2, word, 112, 16);
+    ublox_setbitu(buf + 16, 82, 24, ublox_nav_inav_crc(buf));
+    ublox_nav_test_unpack(buf, 8, dwrd);
+}
+
+/* create a subframe of BeiDou D1 */
+static void
+ublox_nav_test_bds(uint8_t * buf, int id, uint32_t sow, uint32_t * dwrd)
+{
+    size_t i;
+    ublox_setbitu(buf, 0, 11, UBLOX_NAV_PREAMBLE_BDS);
+    ublox_setbitu(buf, 15, 3, id);
+    ublox_setbitu(buf, 18, 8, sow >> 12);
+    ublox_setbitu(buf, 30, 12, sow & 0xFFF);
+    for (i = 0; i < 10; i ++) {
+        dwrd[i] = ublox_getbitu(buf, i * 30, 30);
+    }
+}
+
+/* create a string of GLONASS with the Hamming code */
+static void
+ublox_nav_test_glo(uint8_t * buf, uint32_t * dwrd)
+{
+    uint32_t kx;
+    for (kx = 0; kx < 256; kx ++) {
+        ublox_setbitu(buf, 77, 8, kx);
+        if (0 == ublox_nav_glo_hamming(buf)) {
+            break;
+        }
+    }
+    ublox_nav_test_unpack(buf, 4, dwrd);
+}
+
+static void
+ublox_nav_test_cb(void * userdata, const ublox_eph_t * eph)
+{
+    *((int *)userdata) += 1;
+}
+
+TEST_CASE( .name="ublox-nav-gps", .description="Test ublox GPS LNAV ephemeris decoder." ) {
+    static ublox_nav_t nav;
+    uint32_t words[3][10];
+    uint32_t dwrd[10];
+    ublox_rxm_sfrbx_t sfrbx;
+    const ublox_eph_t * eph;
+    int num_cb = 0;
+    size_t i;
+
+    SECTION("test the tables of the bit fields") {
+        REQUIRE(0 == ublox_bitfield_check(g_ublox_nav_lnav_sf1, NUM_ARRAY(g_ublox_nav_lnav_sf1)));
+        REQUIRE(0 == ublox_bitfield_check(g_ublox_nav_lnav_sf2, NUM_ARRAY(g_ublox_nav_lnav_sf2)));
+        REQUIRE(0 == ublox_bitfield_check(g_ublox_nav_lnav_sf3, NUM_ARRAY(g_ublox_nav_lnav_sf3)));
+        REQUIRE(0 == ublox_bitfield_check(g_ublox_nav_bds_d1_sf1, NUM_ARRAY(g_ublox_nav_bds_d1_sf1)));
+        REQUIRE(0 == ublox_bitfield_check(g_ublox_nav_bds_d1_sf2, NUM_ARRAY(g_ublox_nav_bds_d1_sf2)));
+        REQUIRE(0 == ublox_bitfield_check(g_ublox_nav_bds_d1_sf3, NUM_ARRAY(g_ublox_nav_bds_d1_sf3)));
+    }
+
+    SECTION("test ublox_nav_add_sfrbx") {
+        ublox_nav_init(&nav, ublox_nav_test_cb, &num_cb);
+        ublox_nav_test_lnav(words, 77);
+        memset(&sfrbx, 0, sizeof(sfrbx));
+        sfrbx.gnssId = 0;
+        sfrbx.svId = 7;
+        sfrbx.numWords = 10;
+        sfrbx.dwrd = dwrd;
+        sfrbx.num_dwrd = 10;
+        for (i = 0; i < 3; i ++) {
+            ublox_nav_test_parity(words[i], dwrd);
+            REQUIRE(((i < 2)?0:1) == ublox_nav_add_sfrbx(&nav, &sfrbx));
+        }
+        REQUIRE(num_cb == 1);
+        eph = ublox_nav_get_eph(&nav, 0, 7);
+        REQUIRE(NULL != eph);
+        REQUIRE(NULL == ublox_nav_get_eph(&nav, 0, 8));
+        REQUIRE(eph->svId == 7);
+        REQUIRE(eph->week == 1000);
+        REQUIRE(eph->sva == 2);
+        REQUIRE(eph->iodc == 256 + 77);
+        REQUIRE(eph->iode == 77);
+        REQUIRE(eph->toc == 7200.0);
+        REQUIRE(eph->toe == 7200.0);
+        REQUIRE(eph->tgd == ldexp(-10, -31));
+        REQUIRE(eph->f0 == ldexp(-123456, -31));
+        REQUIRE(eph->crs == -12.5);
+        REQUIRE(eph->e == ldexp(0x12345678, -33));
+        REQUIRE(eph->sqrtA == ldexp(2702000000u, -19));
+        REQUIRE(eph->idot == ldexp(-5, -43) * UBLOX_NAV_SC2RAD);
+
+        // the same subframes, no event
+        for (i = 0; i < 3; i ++) {
+            ublox_nav_test_parity(words[i], dwrd);
+            REQUIRE(0 == ublox_nav_add_sfrbx(&nav, &sfrbx));
+        }
+        REQUIRE(num_cb == 1);
+
+        // new IODE, the event after all of the subframes are updated
+        ublox_nav_test_lnav(words, 78);
+        for (i = 0; i < 3; i ++) {
+            ublox_nav_test_parity(words[i], dwrd);
+            REQUIRE(((i < 2)?0:1) == ublox_nav_add_sfrbx(&nav, &sfrbx));
+        }
+        REQUIRE(num_cb == 2);
+        REQUIRE(ublox_nav_get_eph(&nav, 0, 7)->iode == 78);
+
+        // parity error
+        ublox_nav_test_parity(words[0], dwrd);
+        dwrd[4] ^= 0x1000;
+        REQUIRE(0 > ublox_nav_add_sfrbx(&nav, &sfrbx));
+        REQUIRE(nav.num_err_parity == 1);
+        REQUIRE(num_cb == 2);
+
+        // QZSS
+        sfrbx.gnssId = 5;
+        sfrbx.svId = 2;
+        for (i = 0; i < 3; i ++) {
+            ublox_nav_test_parity(words[i], dwrd);
+            REQUIRE(((i < 2)?0:1) == ublox_nav_add_sfrbx(&nav, &sfrbx));
+        }
+        REQUIRE(ublox_nav_get_eph(&nav, 5, 2)->iode == 78);
+    }
+
+    SECTION("test ublox_nav_add_sfrb") {
+        ublox_rxm_sfrb_t sfrb;
+        ublox_nav_init(&nav, NULL, NULL);
+        ublox_nav_test_lnav(words, 5);
+        sfrb.chn = 0;
+        sfrb.svid = 32;
+        for (i = 0; i < 3; i ++) {
+            memmove(sfrb.dwrd, words[i], sizeof(sfrb.dwrd));
+            REQUIRE(((i < 2)?0:1) == ublox_nav_add_sfrb(&nav, &sfrb));
+        }
+        REQUIRE(ublox_nav_get_eph(&nav, 0, 32)->iode == 5);
+        REQUIRE(nav.num_eph == 1);
+    }
+}
+
+TEST_CASE( .name="ublox-nav-gnss", .description="Test ublox Galileo, BeiDou and GLONASS ephemeris decoders." ) {
+    static ublox_nav_t nav;
+    static uint8_t data[5][UBLOX_NAV_SZ_BDS];
+    uint32_t dwrd[10];
+    const ublox_eph_t * eph;
+    int num_cb = 0;
+    int k;
+
+    SECTION("test ublox_nav_add_inav") {
+        num_cb = 0;
+        ublox_nav_init(&nav, ublox_nav_test_cb, &num_cb);
+        memset(data, 0, sizeof(data));
+        for (k = 0; k < 5; k ++) {
+            ublox_setbitu(data[k], 0, 6, k + 1);
+            if (k < 4) {
+                ublox_setbitu(data[k], 6, 10, 100); // IODnav
+            }
+        }
+        ublox_setbitu(data[0], 16, 14, 120);        // toe/60
+        ublox_setbitu(data[0], 126 - 32, 32, 2852000000u); // sqrtA
+        ublox_setbitu(data[3], 16, 6, 11);          // svid
+        ublox_setbitu(data[3], 16 + 6 + 32, 14, 120); // toc/60
+        ublox_setbitu(data[3], 16 + 6 + 32 + 14, 31, (uint32_t)-1000); // af0
+        ublox_setbitu(data[4], 6 + 41, 10, 7);      // BGD E1/E5a
+        ublox_setbitu(data[4], 6 + 41 + 26, 12, 1200); // WN
+
+        for (k = 0; k < 5; k ++) {
+            ublox_nav_test_inav(data[k], dwrd);
+            REQUIRE(((k < 4)?0:1) == ublox_nav_add_inav(&nav, 11, dwrd));
+        }
+        REQUIRE(num_cb == 1);
+        eph = ublox_nav_get_eph(&nav, 2, 11);
+        REQUIRE(NULL != eph);
+        REQUIRE(eph->iode == 100);
+        REQUIRE(eph->toe == 7200.0);
+        REQUIRE(eph->toc == 7200.0);
+        REQUIRE(eph->sqrtA == ldexp(2852000000u, -19));
+        REQUIRE(eph->f0 == ldexp(-1000, -34));
+        REQUIRE(eph->tgd == ldexp(7, -32));
+        REQUIRE(eph->week == 1200);
+
+        // CRC error
+        ublox_nav_test_inav(data[1], dwrd);
+        dwrd[2] ^= 0x100;
+        REQUIRE(0 > ublox_nav_add_inav(&nav, 11, dwrd));
+        REQUIRE(nav.num_err_parity == 1);
+        // the svid is not matched
+        ublox_nav_init(&nav, NULL, NULL);
+        for (k = 0; k < 5; k ++) {
+            ublox_nav_test_inav(data[k], dwrd);
+            REQUIRE(((k < 4)?0:-1) == ublox_nav_add_inav(&nav, 12, dwrd));
+        }
+    }
+
+    SECTION("test ublox_nav_add_bds") {
+        num_cb = 0;
+        ublox_nav_init(&nav, ublox_nav_test_cb, &num_cb);
+        memset(data, 0, sizeof(data));
+        ublox_setbitu(data[0], 43, 5, 3);           // AODC
+        ublox_setbitu(data[0], 60, 13, 800);        // WN
+        ublox_setbitu(data[0], 73, 9, 900 >> 8);    // toc/8
+        ublox_setbitu(data[0], 90, 8, 900 & 0xFF);
+        ublox_setbitu(data[0], 225, 7, 0x7F);       // a0 = -2
+        ublox_setbitu(data[0], 240, 17, 0x1FFFE);
+        ublox_setbitu(data[0], 287, 5, 9);          // AODE
+        ublox_setbitu(data[1], 250, 12, 0xABC);     // sqrtA
+        ublox_setbitu(data[1], 270, 20, 0x12345);
+        ublox_setbitu(data[1], 290, 2, 0);          // toe/8
+        ublox_setbitu(data[2], 42, 10, 900 >> 5);
+        ublox_setbitu(data[2], 60, 5, 900 & 0x1F);
+        ublox_setbitu(data[2], 251, 11, 0x7FF);     // omega = -3
+        ublox_setbitu(data[2], 270, 21, 0x1FFFFD);
+
+        for (k = 0; k < 3; k ++) {
+            ublox_nav_test_bds(data[k], k + 1, 1000 + 6 * k, dwrd);
+            REQUIRE(((k < 2)?0:1) == ublox_nav_add_bds(&nav, 20, dwrd));
+        }
+        REQUIRE(num_cb == 1);
+        eph = ublox_nav_get_eph(&nav, 3, 20);
+        REQUIRE(NULL != eph);
+        REQUIRE(eph->iode == 9);
+        REQUIRE(eph->iodc == 3);
+        REQUIRE(eph->week == 800);
+        REQUIRE(eph->toe == 7200.0);
+        REQUIRE(eph->f0 == ldexp(-2, -33));
+        REQUIRE(eph->sqrtA == ldexp(0xABC12345, -19));
+        REQUIRE(eph->omg == ldexp(-3, -31) * UBLOX_NAV_SC2RAD);
+
+        // the subframes are not consecutive
+        ublox_nav_init(&nav, NULL, NULL);
+        for (k = 0; k < 3; k ++) {
+            ublox_nav_test_bds(data[k], k + 1, 1000 + 7 * k, dwrd);
+            REQUIRE(0 == ublox_nav_add_bds(&nav, 20, dwrd));
+        }
+        REQUIRE(NULL == ublox_nav_get_eph(&nav, 3, 20));
+    }
+
+    SECTION("test ublox_nav_add_glo") {
+        num_cb = 0;
+        ublox_nav_init(&nav, ublox_nav_test_cb, &num_cb);
+        memset(data, 0, sizeof(data));
+        for (k = 0; k < 4; k ++) {
+            ublox_setbitu(data[k], 1, 4, k + 1);
+        }
+        ublox_setbitu(data[0], 9, 5, 1);            // tk hour
+        ublox_setbitu(data[0], 50, 27, (1u << 26) | 1000); // x = -1000 * 2^-11 km
+        ublox_setbitu(data[1], 9, 7, 40);           // tb
+        ublox_setbitu(data[2], 6, 11, (1u << 10) | 3); // gamma = -3 * 2^-40
+        ublox_setbitu(data[3], 5, 22, 12345);       // taun
+        ublox_setbitu(data[3], 59, 11, 1461);       // NT
+        ublox_setbitu(data[3], 70, 5, 17);          // slot
+
+        for (k = 0; k < 4; k ++) {
+            ublox_nav_test_glo(data[k], dwrd);
+            REQUIRE(((k < 3)?0:1) == ublox_nav_add_glo(&nav, 17, 7 + 3, dwrd));
+        }
+        REQUIRE(num_cb == 1);
+        eph = ublox_nav_get_eph(&nav, 6, 17);
+        REQUIRE(NULL != eph);
+        REQUIRE(eph->frq == 3);
+        REQUIRE(eph->iode == 40);
+        REQUIRE(eph->toe == 36000.0);
+        REQUIRE(eph->toc == 3600.0);
+        REQUIRE(eph->pos[0] == ldexp(-1000, -11) * 1E3);
+        REQUIRE(eph->gamn == ldexp(-3, -40));
+        REQUIRE(eph->taun == ldexp(12345, -30));
+        REQUIRE(eph->nt == 1461);
+
+        // the same tb in the next frame, no event
+        for (k = 0; k < 4; k ++) {
+            ublox_nav_test_glo(data[k], dwrd);
+            REQUIRE(0 == ublox_nav_add_glo(&nav, 17, 7 + 3, dwrd));
+        }
+        REQUIRE(num_cb == 1);
+
+        // Hamming error
+        ublox_nav_test_glo(data[1], dwrd);
+        dwrd[1] ^= 0x10000;
+        REQUIRE(0 > ublox_nav_add_glo(&nav, 17, 7 + 3, dwrd));
+        REQUIRE(nav.num_err_parity == 1);
+        // the string 3 is lost
+        ublox_nav_test_glo(data[0], dwrd);
+        REQUIRE(0 == ublox_nav_add_glo(&nav, 17, 7 + 3, dwrd));
+        ublox_nav_test_glo(data[3], dwrd);
+        REQUIRE(0 == ublox_nav_add_glo(&nav, 17, 7 + 3, dwrd));
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,138 @@
+/**
+ * \file    ubloxnav.h
+ * \brief   The ephemeris decoder of the navigation subframes
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_NAV_H
+#define UBLOX_NAV_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxdec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_NAV_NUM_SYS  7   /**< the number of gnssId of UBX */
+#define UBLOX_NAV_MAX_SV   64  /**< the max svId of a constellation (BeiDou 1-63) */
+#define UBLOX_NAV_SZ_FRAME 380 /**< the max byte size of the data of an ephemeris (BeiDou D2, 10 pages of 38 bytes) */
+
+/**
+ * The broadcast ephemeris. The Keplerian elements are used by GPS, QZSS,
+ * Galileo and BeiDou, in the time system of the constellation; the state
+ * vector is used by GLONASS.
+ */
+typedef struct _ublox_eph_t {
+    uint8_t gnssId;
+    uint8_t svId;    /**< the PRN, or the slot of GLONASS */
+    int iode;        /**< IODE, IODnav of Galileo, AODE of BeiDou, tb of GLONASS */
+    int iodc;        /**< IODC, IODnav of Galileo, AODC of BeiDou */
+    int sva;         /**< the URA index, SISA of Galileo, URAI of BeiDou, FT of GLONASS */
+    int svh;         /**< the health */
+    int week;        /**< the week as broadcast: 10 bits of GPS, GST of Galileo, BDT of BeiDou */
+    int code;        /**< the code on L2 */
+    int flag;        /**< the L2 P data flag */
+    int fit;         /**< the fit interval flag */
+    double toe;      /**< the time of ephemeris, seconds of week; tb*900, seconds of the day (Moscow) of GLONASS */
+    double toc;      /**< the time of clock, seconds of week; tk, seconds of the day (Moscow) of GLONASS */
+    double sqrtA;    /**< (m^1/2) */
+    double e;
+    double i0;       /**< (rad) */
+    double OMG0;     /**< (rad) */
+    double omg;      /**< (rad) */
+    double M0;       /**< (rad) */
+    double deln;     /**< (rad/s) */
+    double OMGd;     /**< (rad/s) */
+    double idot;     /**< (rad/s) */
+    double crc;      /**< (m) */
+    double crs;      /**< (m) */
+    double cuc;      /**< (rad) */
+    double cus;      /**< (rad) */
+    double cic;      /**< (rad) */
+    double cis;      /**< (rad) */
+    double f0;       /**< (s) */
+    double f1;       /**< (s/s) */
+    double f2;       /**< (s/s^2) */
+    double tgd;      /**< (s), BGD E1/E5a of Galileo, TGD1 of BeiDou */
+    double tgd2;     /**< (s), BGD E1/E5b of Galileo, TGD2 of BeiDou */
+
+    /* GLONASS */
+    int frq;         /**< the frequency channel, -7 to 6 */
+    int age;         /**< En, the age of the data (days) */
+    int nt;          /**< NT, the day number in the 4-year interval */
+    double pos[3];   /**< the position in PZ-90 (m) */
+    double vel[3];   /**< the velocity (m/s) */
+    double acc[3];   /**< the acceleration of the lunar-solar perturbation (m/s^2) */
+    double taun;     /**< the clock bias (s) */
+    double gamn;     /**< the relative frequency bias */
+    double dtaun;    /**< the delay between L1 and L2 (s) */
+} ublox_eph_t;
+
+/**
+ * The received parts of the navigation data of a satellite: the subframes
+ * 1-3 of LNAV (30 bytes each), the word types 1-5 of Galileo I/NAV
+ * (16 bytes each), the subframes 1-3 of BeiDou D1 or the pages 1-10 of the
+ * subframe 1 of BeiDou D2 (38 bytes each), or the strings 1-4 of GLONASS
+ * (10 bytes each).
+ */
+typedef struct _ublox_nav_frame_t {
+    uint8_t data[UBLOX_NAV_SZ_FRAME];
+    uint16_t mask;   /**< the bit i is set if the part i is received */
+} ublox_nav_frame_t;
+
+struct _ublox_nav_t;
+
+/**
+ * \brief the callback when an ephemeris is changed
+ * \param userdata: the user data of the cache
+ * \param eph: the new ephemeris
+ */
+typedef void (* ublox_nav_eph_cb_t)(void * userdata, const ublox_eph_t * eph);
+
+/**
+ * The cache of the navigation data and the ephemerides, indexed by the
+ * gnssId and svId of UBX. It has no dynamic memory, the parts of the
+ * navigation data of a satellite are kept until all of the parts of an
+ * ephemeris are received. The struct is about 300KB, allocate it
+ * statically or on the heap.
+ */
+typedef struct _ublox_nav_t {
+    ublox_nav_frame_t frame[UBLOX_NAV_NUM_SYS][UBLOX_NAV_MAX_SV];
+    ublox_eph_t eph[UBLOX_NAV_NUM_SYS][UBLOX_NAV_MAX_SV];
+    uint8_t flg_eph[UBLOX_NAV_NUM_SYS][UBLOX_NAV_MAX_SV]; /**< 1 if eph is valid */
+
+    ublox_nav_eph_cb_t cb_eph; /**< called when an ephemeris is changed, can be NULL */
+    void * userdata;
+
+    size_t num_subframe;    /**< the number of subframes, pages or strings received */
+    size_t num_err_parity;  /**< the number of them failed the parity, CRC or Hamming check */
+    size_t num_eph;         /**< the number of ephemeris changes */
+} ublox_nav_t;
+
+void ublox_nav_init(ublox_nav_t * nav, ublox_nav_eph_cb_t cb_eph, void * userdata);
+const ublox_eph_t * ublox_nav_get_eph(const ublox_nav_t * nav, uint8_t gnssId, uint8_t svId);
+
+int ublox_nav_gps_parity(uint32_t word, uint32_t prev);
+int ublox_nav_glo_hamming(const uint8_t * str);
+
+int ublox_nav_add_lnav(ublox_nav_t * nav, uint8_t gnssId, uint8_t svId, const uint32_t * words);
+int ublox_nav_add_inav(ublox_nav_t * nav, uint8_t svId, const uint32_t * dwrd);
+int ublox_nav_add_bds(ublox_nav_t * nav, uint8_t svId, const uint32_t * dwrd);
+int ublox_nav_add_glo(ublox_nav_t * nav, uint8_t svId, uint8_t freqId, const uint32_t * dwrd);
+
+int ublox_nav_add_sfrbx(ublox_nav_t * nav, const ublox_rxm_sfrbx_t * msg);
+int ublox_nav_add_sfrb(ublox_nav_t * nav, const ublox_rxm_sfrb_t * msg);
+
+int ublox_nav_handler_sfrbx(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_nav_handler_sfrb(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_NAV_H */
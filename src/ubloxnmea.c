@@ -0,0 +1,764 @@
+/**
+ * \file    ubloxnmea.c
+ * \brief   The NMEA 0183 sentence tokenizer and the decoders of GGA/RMC/GSA/GSV/GST/ZDA
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The tokenizer computes the checksum and splits the fields in one pass, the
+ * fields are the views of the sentence, nothing is copied. The numbers are
+ * converted from the digits directly without strtod() or sscanf(), and the
+ * latitude and the longitude are converted in the fixed point.
+ */
+
+#include <math.h>
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxnmea.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/** the powers of 10 exactly represented by int64_t */
+static const int64_t g_ublox_nmea_pow10[19] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL,
+    10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL,
+    1000000000000000LL, 10000000000000000LL, 100000000000000000LL, 1000000000000000000LL,
+};
+
+static int
+ublox_nmea_hex2val(uint8_t c)
+{
+    if (('0' <= c) && (c <= '9')) {
+        return c - '0';
+    }
+    if (('A' <= c) && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    if (('a' <= c) && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * \brief split the fields of the sentence and verify the checksum
+ * \param buffer_in: the sentence, from '$' to "*hh", the following "\r\n" is optional
+ * \param sz_in: the byte size of the sentence
+ * \param snt: the fields of the sentence
+ *
+ * \return 0 on success, -1 the sentence is malformed, -2 the checksum is wrong
+ */
+int
+ublox_nmea_tokenize(const uint8_t * buffer_in, size_t sz_in, ublox_nmea_sentence_t * snt)
+{
+    const char * str = (const char *)buffer_in;
+    uint8_t cksum = 0;
+    size_t start = 1;
+    size_t num = 0;
+    size_t i;
+    int h;
+    int l;
+
+    assert (NULL != snt);
+    snt->num_fields = 0;
+    if ((NULL == buffer_in) || (sz_in < 4) || (('$' != buffer_in[0]) && ('!' != buffer_in[0]))) {
+        return -1;
+    }
+    for (i = 1; i < sz_in; i ++) {
+        if ('*' == buffer_in[i]) {
+            break;
+        }
+        cksum ^= buffer_in[i];
+        if (',' == buffer_in[i]) {
+            if (num + 1 >= UBLOX_NMEA_NUM_FIELDS) {
+                return -1;
+            }
+            snt->fields[num].str = str + start;
+            snt->fields[num].len = i - start;
+            num ++;
+            start = i + 1;
+        }
+    }
+    if (i + 3 > sz_in) {
+        return -1;
+    }
+    snt->fields[num].str = str + start;
+    snt->fields[num].len = i - start;
+    snt->num_fields = num + 1;
+    snt->cksum = cksum;
+    h = ublox_nmea_hex2val(buffer_in[i + 1]);
+    l = ublox_nmea_hex2val(buffer_in[i + 2]);
+    if ((h < 0) || (l < 0)) {
+        return -1;
+    }
+    return (((h << 4) | l) == cksum)?0:-2;
+}
+
+/**
+ * \brief get the type of the sentence by the formatter of the address
+ * \param snt: the fields of the sentence
+ *
+ * \return UBLOX_NMEA_xxx, UBLOX_NMEA_UNKNOWN for the proprietary sentences and the other formatters
+ *
+ * The talker is the first two characters of the address, such as "GP" or "GN".
+ */
+int
+ublox_nmea_type(const ublox_nmea_sentence_t * snt)
+{
+    const char * p;
+
+    if ((snt->num_fields < 1) || (5 != snt->fields[0].len) || ('P' == snt->fields[0].str[0])) {
+        return UBLOX_NMEA_UNKNOWN;
+    }
+    p = snt->fields[0].str + 2;
+    switch (p[0]) {
+    case 'G':
+        if (('G' == p[1]) && ('A' == p[2])) {
+            return UBLOX_NMEA_GGA;
+        }
+        if ('S' == p[1]) {
+            switch (p[2]) {
+            case 'A': return UBLOX_NMEA_GSA;
+            case 'V': return UBLOX_NMEA_GSV;
+            case 'T': return UBLOX_NMEA_GST;
+            }
+        }
+        break;
+    case 'R':
+        if (('M' == p[1]) && ('C' == p[2])) {
+            return UBLOX_NMEA_RMC;
+        }
+        break;
+    case 'Z':
+        if (('D' == p[1]) && ('A' == p[2])) {
+            return UBLOX_NMEA_ZDA;
+        }
+        break;
+    }
+    return UBLOX_NMEA_UNKNOWN;
+}
+
+/**
+ * \brief convert the decimal number of the field to the fixed point
+ * \param fld: the field, such as "-12.345"
+ * \param num_digits: the number of the fractional digits of the result, 0 - 9
+ * \param pval: the value times 10^num_digits, the extra fractional digits are rounded half away from zero
+ *
+ * \return 0 on success, 1 the field is empty, -1 the field is not a number
+ */
+int
+ublox_nmea_fixed(const ublox_nmea_field_t * fld, int num_digits, int64_t * pval)
+{
+    const char * p = fld->str;
+    const char * p_end = fld->str + fld->len;
+    int64_t val = 0;
+    int flg_neg = 0;
+    int num_int = 0;
+    int num_frac = 0;
+
+    assert ((0 <= num_digits) && (num_digits <= 9));
+    if (fld->len < 1) {
+        return 1;
+    }
+    if (('-' == *p) || ('+' == *p)) {
+        flg_neg = ('-' == *p);
+        p ++;
+    }
+    for (; (p < p_end) && ('0' <= *p) && (*p <= '9'); p ++, num_int ++) {
+        if (num_int >= 18 - num_digits) {
+            return -1;
+        }
+        val = val * 10 + (*p - '0');
+    }
+    if ((p < p_end) && ('.' == *p)) {
+        for (p ++; (p < p_end) && ('0' <= *p) && (*p <= '9'); p ++, num_frac ++) {
+            if (num_frac < num_digits) {
+                val = val * 10 + (*p - '0');
+            } else if ((num_frac == num_digits) && (*p >= '5')) {
+                val ++; // rounded by the first extra digit
+            }
+        }
+    }
+    if ((p != p_end) || (num_int + num_frac < 1)) {
+        return -1;
+    }
+    if (num_frac < num_digits) {
+        val *= g_ublox_nmea_pow10[num_digits - num_frac];
+    }
+    *pval = flg_neg?-val:val;
+    return 0;
+}
+
+/**
+ * \brief convert the decimal number of the field to double
+ * \param fld: the field
+ *
+ * \return the value, NaN if the field is empty or not a number
+ *
+ * The digits are collected to an integer and divided by the power of 10 once,
+ * so the result is correctly rounded for up to 15 significant digits.
+ */
+double
+ublox_nmea_double(const ublox_nmea_field_t * fld)
+{
+    const char * p = fld->str;
+    const char * p_end = fld->str + fld->len;
+    double ret;
+    int64_t val = 0;
+    int flg_neg = 0;
+    int num_all = 0;
+    int exp10 = 0;
+
+    if (fld->len < 1) {
+        return NAN;
+    }
+    if (('-' == *p) || ('+' == *p)) {
+        flg_neg = ('-' == *p);
+        p ++;
+    }
+    for (; (p < p_end) && ('0' <= *p) && (*p <= '9'); p ++, num_all ++) {
+        if (val < g_ublox_nmea_pow10[17]) {
+            val = val * 10 + (*p - '0');
+        } else {
+            exp10 ++;
+        }
+    }
+    if ((p < p_end) && ('.' == *p)) {
+        for (p ++; (p < p_end) && ('0' <= *p) && (*p <= '9'); p ++, num_all ++) {
+            if (val < g_ublox_nmea_pow10[17]) {
+                val = val * 10 + (*p - '0');
+                exp10 --;
+            }
+        }
+    }
+    if ((p != p_end) || (num_all < 1)) {
+        return NAN;
+    }
+    ret = (double)val;
+    for (; exp10 < -18; exp10 += 18) {
+        ret /= (double)g_ublox_nmea_pow10[18];
+    }
+    for (; exp10 > 18; exp10 -= 18) {
+        ret *= (double)g_ublox_nmea_pow10[18];
+    }
+    if (exp10 < 0) {
+        ret /= (double)g_ublox_nmea_pow10[-exp10];
+    } else {
+        ret *= (double)g_ublox_nmea_pow10[exp10];
+    }
+    return flg_neg?-ret:ret;
+}
+
+/**
+ * \brief convert the latitude or the longitude to the fixed point degrees
+ * \param fld: the field of "ddmm.mmmm" or "dddmm.mmmm"
+ * \param fld_hemi: the field of the hemisphere, 'N', 'S', 'E' or 'W'
+ * \param pval: the degrees times 1e7, south and west are negative
+ *
+ * \return 0 on success, 1 the field is empty, -1 the field is malformed
+ *
+ * The minutes are kept in 1e-7 and divided by 60 in the integer, so no
+ * floating point is used, the error is less than 1e-7 degree (about 1 cm).
+ */
+int
+ublox_nmea_latlon(const ublox_nmea_field_t * fld, const ublox_nmea_field_t * fld_hemi, int32_t * pval)
+{
+    int64_t val;
+    int64_t deg;
+    int64_t min;
+    int ret;
+
+    ret = ublox_nmea_fixed(fld, 7, &val);
+    if (0 != ret) {
+        return ret;
+    }
+    if ((val < 0) || (1 != fld_hemi->len)) {
+        return -1;
+    }
+    deg = val / 1000000000LL;
+    min = val % 1000000000LL;
+    if ((deg > 180) || (min >= 600000000LL)) {
+        return -1;
+    }
+    val = deg * 10000000LL + (min + 30) / 60;
+    switch (fld_hemi->str[0]) {
+    case 'N':
+        if (val > 900000000LL) {
+            return -1;
+        }
+        break;
+    case 'S':
+        if (val > 900000000LL) {
+            return -1;
+        }
+        val = -val;
+        break;
+    case 'E':
+        break;
+    case 'W':
+        val = -val;
+        break;
+    default:
+        return -1;
+    }
+    if ((val > 1800000000LL) || (val < -1800000000LL)) {
+        return -1;
+    }
+    *pval = (int32_t)val;
+    return 0;
+}
+
+/**
+ * \brief convert the time of "hhmmss.ss" to the time of day
+ * \param fld: the field
+ * \param ptod: the time of day (ms)
+ *
+ * \return 0 on success, 1 the field is empty, -1 the field is malformed
+ */
+int
+ublox_nmea_time(const ublox_nmea_field_t * fld, int32_t * ptod)
+{
+    int64_t val;
+    int64_t hh;
+    int64_t mm;
+    int64_t ss;
+    int ret;
+
+    ret = ublox_nmea_fixed(fld, 3, &val);
+    if (0 != ret) {
+        return ret;
+    }
+    hh = val / 10000000LL;
+    mm = (val / 100000LL) % 100;
+    ss = val % 100000LL;
+    if ((val < 0) || (hh >= 24) || (mm >= 60) || (ss >= 61000)) {
+        return -1;
+    }
+    *ptod = (int32_t)(hh * 3600000LL + mm * 60000LL + ss);
+    return 0;
+}
+
+/*****************************************************************************/
+// the decoders, the empty fields are -1 for the integers and NaN for the doubles
+
+/* the field i, or an empty field if the sentence is shorter */
+static const ublox_nmea_field_t *
+ublox_nmea_field(const ublox_nmea_sentence_t * snt, size_t i)
+{
+    static const ublox_nmea_field_t fld_empty = { "", 0 };
+    return (i < snt->num_fields)?(snt->fields + i):&fld_empty;
+}
+
+/* the integer of the field i, -1 if empty */
+static int32_t
+ublox_nmea_int(const ublox_nmea_sentence_t * snt, size_t i, int * perr)
+{
+    int64_t val;
+    int ret = ublox_nmea_fixed(ublox_nmea_field(snt, i), 0, &val);
+    if (ret < 0) {
+        *perr = 1;
+    }
+    return (0 == ret)?(int32_t)val:-1;
+}
+
+/* the character of the field i, 0 if empty */
+static char
+ublox_nmea_char(const ublox_nmea_sentence_t * snt, size_t i)
+{
+    const ublox_nmea_field_t * fld = ublox_nmea_field(snt, i);
+    return (fld->len > 0)?fld->str[0]:0;
+}
+
+/* the time of the field i, -1 if empty */
+static int32_t
+ublox_nmea_tod(const ublox_nmea_sentence_t * snt, size_t i, int * perr)
+{
+    int32_t tod = -1;
+    if (ublox_nmea_time(ublox_nmea_field(snt, i), &tod) < 0) {
+        *perr = 1;
+    }
+    return tod;
+}
+
+/* the position of the fields i to i + 3 */
+static uint8_t
+ublox_nmea_pos(const ublox_nmea_sentence_t * snt, size_t i, int32_t * lat, int32_t * lon, int * perr)
+{
+    int ret1;
+    int ret2;
+
+    *lat = 0;
+    *lon = 0;
+    ret1 = ublox_nmea_latlon(ublox_nmea_field(snt, i), ublox_nmea_field(snt, i + 1), lat);
+    ret2 = ublox_nmea_latlon(ublox_nmea_field(snt, i + 2), ublox_nmea_field(snt, i + 3), lon);
+    if ((ret1 < 0) || (ret2 < 0)) {
+        *perr = 1;
+    }
+    return ((0 == ret1) && (0 == ret2))?1:0;
+}
+
+/**
+ * \brief decode GGA
+ * \param snt: the fields of the sentence
+ * \param msg: the decoded sentence
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nmea_decode_gga(const ublox_nmea_sentence_t * snt, ublox_nmea_gga_t * msg)
+{
+    int err = 0;
+
+    if (snt->num_fields < 15) {
+        return -1;
+    }
+    msg->tod = ublox_nmea_tod(snt, 1, &err);
+    msg->flg_pos = ublox_nmea_pos(snt, 2, &(msg->lat), &(msg->lon), &err);
+    msg->quality = ublox_nmea_int(snt, 6, &err);
+    msg->num_sv = ublox_nmea_int(snt, 7, &err);
+    msg->hdop = ublox_nmea_double(snt->fields + 8);
+    msg->alt = ublox_nmea_double(snt->fields + 9);
+    msg->sep = ublox_nmea_double(snt->fields + 11);
+    msg->age = ublox_nmea_double(snt->fields + 13);
+    msg->station = ublox_nmea_int(snt, 14, &err);
+    return err?-1:0;
+}
+
+/**
+ * \brief decode RMC
+ * \param snt: the fields of the sentence
+ * \param msg: the decoded sentence
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nmea_decode_rmc(const ublox_nmea_sentence_t * snt, ublox_nmea_rmc_t * msg)
+{
+    int32_t date;
+    int err = 0;
+
+    if (snt->num_fields < 12) {
+        return -1;
+    }
+    msg->tod = ublox_nmea_tod(snt, 1, &err);
+    msg->status = ublox_nmea_char(snt, 2);
+    msg->flg_pos = ublox_nmea_pos(snt, 3, &(msg->lat), &(msg->lon), &err);
+    msg->speed = ublox_nmea_double(snt->fields + 7);
+    msg->course = ublox_nmea_double(snt->fields + 8);
+    date = ublox_nmea_int(snt, 9, &err);
+    msg->day = msg->month = msg->year = -1;
+    if (date >= 0) {
+        msg->day = date / 10000;
+        msg->month = (date / 100) % 100;
+        msg->year = date % 100;
+        msg->year += (msg->year < 80)?2000:1900;
+    }
+    msg->magvar = ublox_nmea_double(snt->fields + 10);
+    if ('W' == ublox_nmea_char(snt, 11)) {
+        msg->magvar = -msg->magvar;
+    }
+    msg->mode = ublox_nmea_char(snt, 12);
+    msg->nav_status = ublox_nmea_char(snt, 13);
+    return err?-1:0;
+}
+
+/**
+ * \brief decode GSA
+ * \param snt: the fields of the sentence
+ * \param msg: the decoded sentence
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nmea_decode_gsa(const ublox_nmea_sentence_t * snt, ublox_nmea_gsa_t * msg)
+{
+    int32_t svid;
+    size_t i;
+    int err = 0;
+
+    if (snt->num_fields < 3 + UBLOX_NMEA_NUM_SV_GSA + 3) {
+        return -1;
+    }
+    msg->op_mode = ublox_nmea_char(snt, 1);
+    msg->nav_mode = ublox_nmea_int(snt, 2, &err);
+    msg->num_sv = 0;
+    for (i = 0; i < UBLOX_NMEA_NUM_SV_GSA; i ++) {
+        svid = ublox_nmea_int(snt, 3 + i, &err);
+        if (svid >= 0) {
+            msg->svid[msg->num_sv ++] = svid;
+        }
+    }
+    msg->pdop = ublox_nmea_double(snt->fields + 3 + UBLOX_NMEA_NUM_SV_GSA);
+    msg->hdop = ublox_nmea_double(snt->fields + 4 + UBLOX_NMEA_NUM_SV_GSA);
+    msg->vdop = ublox_nmea_double(snt->fields + 5 + UBLOX_NMEA_NUM_SV_GSA);
+    msg->system = ublox_nmea_int(snt, 6 + UBLOX_NMEA_NUM_SV_GSA, &err);
+    return err?-1:0;
+}
+
+/**
+ * \brief decode GSV
+ * \param snt: the fields of the sentence
+ * \param msg: the decoded sentence
+ * \return 0 on success, <0 on error
+ *
+ * The last sentence of the group may have less than 4 satellites, and the
+ * signal ID of NMEA 4.1 follows the satellites.
+ */
+int
+ublox_nmea_decode_gsv(const ublox_nmea_sentence_t * snt, ublox_nmea_gsv_t * msg)
+{
+    size_t num;
+    size_t i;
+    int err = 0;
+
+    if (snt->num_fields < 4) {
+        return -1;
+    }
+    num = (snt->num_fields - 4) / 4;
+    if (num > UBLOX_NMEA_NUM_SV_GSV) {
+        return -1;
+    }
+    msg->num_msg = ublox_nmea_int(snt, 1, &err);
+    msg->msg_no = ublox_nmea_int(snt, 2, &err);
+    msg->num_view = ublox_nmea_int(snt, 3, &err);
+    msg->num_sat = num;
+    for (i = 0; i < num; i ++) {
+        msg->sat[i].svid = ublox_nmea_int(snt, 4 + i * 4, &err);
+        msg->sat[i].elev = ublox_nmea_int(snt, 5 + i * 4, &err);
+        msg->sat[i].azim = ublox_nmea_int(snt, 6 + i * 4, &err);
+        msg->sat[i].cno = ublox_nmea_int(snt, 7 + i * 4, &err);
+    }
+    msg->signal = -1;
+    if (1 == (snt->num_fields - 4) % 4) {
+        msg->signal = ublox_nmea_int(snt, snt->num_fields - 1, &err);
+    }
+    return err?-1:0;
+}
+
+/**
+ * \brief decode GST
+ * \param snt: the fields of the sentence
+ * \param msg: the decoded sentence
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nmea_decode_gst(const ublox_nmea_sentence_t * snt, ublox_nmea_gst_t * msg)
+{
+    int err = 0;
+
+    if (snt->num_fields < 9) {
+        return -1;
+    }
+    msg->tod = ublox_nmea_tod(snt, 1, &err);
+    msg->rms = ublox_nmea_double(snt->fields + 2);
+    msg->std_major = ublox_nmea_double(snt->fields + 3);
+    msg->std_minor = ublox_nmea_double(snt->fields + 4);
+    msg->orient = ublox_nmea_double(snt->fields + 5);
+    msg->std_lat = ublox_nmea_double(snt->fields + 6);
+    msg->std_lon = ublox_nmea_double(snt->fields + 7);
+    msg->std_alt = ublox_nmea_double(snt->fields + 8);
+    return err?-1:0;
+}
+
+/**
+ * \brief decode ZDA
+ * \param snt: the fields of the sentence
+ * \param msg: the decoded sentence
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_nmea_decode_zda(const ublox_nmea_sentence_t * snt, ublox_nmea_zda_t * msg)
+{
+    int err = 0;
+
+    if (snt->num_fields < 7) {
+        return -1;
+    }
+    msg->tod = ublox_nmea_tod(snt, 1, &err);
+    msg->day = ublox_nmea_int(snt, 2, &err);
+    msg->month = ublox_nmea_int(snt, 3, &err);
+    msg->year = ublox_nmea_int(snt, 4, &err);
+    msg->ltz_hour = ublox_nmea_int(snt, 5, &err);
+    msg->ltz_min = ublox_nmea_int(snt, 6, &err);
+    return err?-1:0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+static const ublox_nmea_field_t *
+ublox_nmea_test_field(ublox_nmea_field_t * fld, const char * cstr)
+{
+    fld->str = cstr;
+    fld->len = strlen(cstr);
+    return fld;
+}
+
+TEST_CASE( .name="ublox-nmea", .description="Test ublox NMEA tokenizer and decoders." ) {
+    static const char * sentences[] = {
+        "$GNGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*45\r\n",
+        "$GNRMC,083559.00,A,4717.11437,N,00833.91522,E,0.004,77.52,091202,,,A,V*33\r\n",
+        "$GNGSA,A,3,23,29,07,08,09,18,26,28,,,,,1.94,1.18,1.54,1*0E\r\n",
+        "$GPGSV,3,1,09,09,,,17,10,72,239,,16,-5,105,27,18,35,072,42,1*4E\r\n",
+        "$GNGST,082356.00,1.8,,,,1.7,1.3,2.2*60\r\n",
+        "$GNZDA,082710.00,16,09,2002,00,00*7A\r\n",
+        "$GPGGA,,,,,,0,00,99.99,,,,,,*48\r\n",
+    };
+    ublox_nmea_sentence_t snt;
+    ublox_nmea_field_t fld;
+    ublox_nmea_field_t hemi;
+    int64_t val;
+    int32_t val32;
+
+    SECTION("test ublox_nmea_fixed and ublox_nmea_double") {
+        REQUIRE(0 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, "12.345"), 2, &val));
+        REQUIRE(1235 == val);
+        REQUIRE(0 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, "-12.344"), 2, &val));
+        REQUIRE(-1234 == val);
+        REQUIRE(0 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, "7"), 3, &val));
+        REQUIRE(7000 == val);
+        REQUIRE(0 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, ".5"), 1, &val));
+        REQUIRE(5 == val);
+        REQUIRE(1 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, ""), 1, &val));
+        REQUIRE(-1 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, "1.2.3"), 1, &val));
+        REQUIRE(-1 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, "-"), 1, &val));
+        REQUIRE(-1 == ublox_nmea_fixed(ublox_nmea_test_field(&fld, "A"), 1, &val));
+
+        REQUIRE(499.6 == ublox_nmea_double(ublox_nmea_test_field(&fld, "499.6")));
+        REQUIRE(-0.004 == ublox_nmea_double(ublox_nmea_test_field(&fld, "-0.004")));
+        REQUIRE(77.52 == ublox_nmea_double(ublox_nmea_test_field(&fld, "77.52")));
+        REQUIRE(123456789012.25 == ublox_nmea_double(ublox_nmea_test_field(&fld, "123456789012.250")));
+        REQUIRE(isnan(ublox_nmea_double(ublox_nmea_test_field(&fld, ""))));
+        REQUIRE(isnan(ublox_nmea_double(ublox_nmea_test_field(&fld, "."))));
+        REQUIRE(isnan(ublox_nmea_double(ublox_nmea_test_field(&fld, "1x"))));
+    }
+
+    SECTION("test ublox_nmea_latlon and ublox_nmea_time") {
+        REQUIRE(0 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, "4717.11399"), ublox_nmea_test_field(&hemi, "N"), &val32));
+        REQUIRE(472852332 == val32);
+        REQUIRE(0 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, "00833.91590"), ublox_nmea_test_field(&hemi, "W"), &val32));
+        REQUIRE(-85652650 == val32);
+        REQUIRE(0 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, "17959.9999999"), ublox_nmea_test_field(&hemi, "E"), &val32));
+        REQUIRE(1800000000 == val32);
+        REQUIRE(-1 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, "4760.0"), ublox_nmea_test_field(&hemi, "N"), &val32));
+        REQUIRE(-1 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, "9100.0"), ublox_nmea_test_field(&hemi, "S"), &val32));
+        REQUIRE(-1 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, "4717.1"), ublox_nmea_test_field(&hemi, "X"), &val32));
+        REQUIRE(1 == ublox_nmea_latlon(ublox_nmea_test_field(&fld, ""), ublox_nmea_test_field(&hemi, ""), &val32));
+
+        REQUIRE(0 == ublox_nmea_time(ublox_nmea_test_field(&fld, "092725.25"), &val32));
+        REQUIRE((9 * 3600 + 27 * 60 + 25) * 1000 + 250 == val32);
+        REQUIRE(-1 == ublox_nmea_time(ublox_nmea_test_field(&fld, "246000"), &val32));
+    }
+
+    SECTION("test ublox_nmea_tokenize") {
+        const char * str = sentences[0];
+        REQUIRE(0 == ublox_nmea_tokenize((const uint8_t *)str, strlen(str), &snt));
+        REQUIRE(15 == snt.num_fields);
+        REQUIRE(str + 1 == snt.fields[0].str);
+        REQUIRE(5 == snt.fields[0].len);
+        REQUIRE(0 == snt.fields[14].len);
+        REQUIRE(0 == strncmp("499.6", snt.fields[9].str, snt.fields[9].len));
+        REQUIRE(0x45 == snt.cksum);
+        REQUIRE(UBLOX_NMEA_GGA == ublox_nmea_type(&snt));
+        // without "\r\n"
+        REQUIRE(0 == ublox_nmea_tokenize((const uint8_t *)str, strlen(str) - 2, &snt));
+        REQUIRE(-1 == ublox_nmea_tokenize((const uint8_t *)str, strlen(str) - 4, &snt));
+        REQUIRE(-1 == ublox_nmea_tokenize((const uint8_t *)sentences[1], 10, &snt));
+        REQUIRE(-2 == ublox_nmea_tokenize((const uint8_t *)"$GPTXT,A*00", 11, &snt));
+        REQUIRE(0 == ublox_nmea_tokenize((const uint8_t *)"$PUBX,00*33", 11, &snt));
+        REQUIRE(UBLOX_NMEA_UNKNOWN == ublox_nmea_type(&snt));
+    }
+
+    SECTION("test the decoders") {
+        ublox_nmea_gga_t gga;
+        ublox_nmea_rmc_t rmc;
+        ublox_nmea_gsa_t gsa;
+        ublox_nmea_gsv_t gsv;
+        ublox_nmea_gst_t gst;
+        ublox_nmea_zda_t zda;
+        size_t i;
+
+        for (i = 0; i < NUM_ARRAY(sentences); i ++) {
+            REQUIRE(0 == ublox_nmea_tokenize((const uint8_t *)sentences[i], strlen(sentences[i]), &snt));
+        }
+
+        ublox_nmea_tokenize((const uint8_t *)sentences[0], strlen(sentences[0]), &snt);
+        REQUIRE(0 == ublox_nmea_decode_gga(&snt, &gga));
+        REQUIRE((9 * 3600 + 27 * 60 + 25) * 1000 == gga.tod);
+        REQUIRE(1 == gga.flg_pos);
+        REQUIRE(472852332 == gga.lat);
+        REQUIRE(85652650 == gga.lon);
+        REQUIRE(1 == gga.quality);
+        REQUIRE(8 == gga.num_sv);
+        REQUIRE(1.01 == gga.hdop);
+        REQUIRE(499.6 == gga.alt);
+        REQUIRE(48.0 == gga.sep);
+        REQUIRE(isnan(gga.age));
+        REQUIRE(-1 == gga.station);
+
+        ublox_nmea_tokenize((const uint8_t *)sentences[1], strlen(sentences[1]), &snt);
+        REQUIRE(UBLOX_NMEA_RMC == ublox_nmea_type(&snt));
+        REQUIRE(0 == ublox_nmea_decode_rmc(&snt, &rmc));
+        REQUIRE('A' == rmc.status);
+        REQUIRE(0.004 == rmc.speed);
+        REQUIRE(77.52 == rmc.course);
+        REQUIRE(2002 == rmc.year);
+        REQUIRE(12 == rmc.month);
+        REQUIRE(9 == rmc.day);
+        REQUIRE(isnan(rmc.magvar));
+        REQUIRE('A' == rmc.mode);
+        REQUIRE('V' == rmc.nav_status);
+
+        ublox_nmea_tokenize((const uint8_t *)sentences[2], strlen(sentences[2]), &snt);
+        REQUIRE(UBLOX_NMEA_GSA == ublox_nmea_type(&snt));
+        REQUIRE(0 == ublox_nmea_decode_gsa(&snt, &gsa));
+        REQUIRE('A' == gsa.op_mode);
+        REQUIRE(3 == gsa.nav_mode);
+        REQUIRE(8 == gsa.num_sv);
+        REQUIRE(7 == gsa.svid[2]);
+        REQUIRE(1.54 == gsa.vdop);
+        REQUIRE(1 == gsa.system);
+
+        ublox_nmea_tokenize((const uint8_t *)sentences[3], strlen(sentences[3]), &snt);
+        REQUIRE(UBLOX_NMEA_GSV == ublox_nmea_type(&snt));
+        REQUIRE(0 == ublox_nmea_decode_gsv(&snt, &gsv));
+        REQUIRE(3 == gsv.num_msg);
+        REQUIRE(9 == gsv.num_view);
+        REQUIRE(4 == gsv.num_sat);
+        REQUIRE(-1 == gsv.sat[0].elev);
+        REQUIRE(17 == gsv.sat[0].cno);
+        REQUIRE(-1 == gsv.sat[1].cno);
+        REQUIRE(-5 == gsv.sat[2].elev);
+        REQUIRE(72 == gsv.sat[3].azim);
+        REQUIRE(1 == gsv.signal);
+
+        ublox_nmea_tokenize((const uint8_t *)sentences[4], strlen(sentences[4]), &snt);
+        REQUIRE(UBLOX_NMEA_GST == ublox_nmea_type(&snt));
+        REQUIRE(0 == ublox_nmea_decode_gst(&snt, &gst));
+        REQUIRE(1.8 == gst.rms);
+        REQUIRE(isnan(gst.orient));
+        REQUIRE(2.2 == gst.std_alt);
+
+        ublox_nmea_tokenize((const uint8_t *)sentences[5], strlen(sentences[5]), &snt);
+        REQUIRE(UBLOX_NMEA_ZDA == ublox_nmea_type(&snt));
+        REQUIRE(0 == ublox_nmea_decode_zda(&snt, &zda));
+        REQUIRE(2002 == zda.year);
+        REQUIRE(9 == zda.month);
+        REQUIRE(16 == zda.day);
+        REQUIRE(0 == zda.ltz_hour);
+
+        // no fix
+        ublox_nmea_tokenize((const uint8_t *)sentences[6], strlen(sentences[6]), &snt);
+        REQUIRE(0 == ublox_nmea_decode_gga(&snt, &gga));
+        REQUIRE(-1 == gga.tod);
+        REQUIRE(0 == gga.flg_pos);
+        REQUIRE(0 == gga.quality);
+        REQUIRE(isnan(gga.alt));
+
+        // the malformed field
+        ublox_nmea_tokenize((const uint8_t *)"$GPZDA,1x,16,09,2002,00,00*00", 29, &snt);
+        REQUIRE(-1 == ublox_nmea_decode_zda(&snt, &zda));
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,157 @@
+/**
+ * \file    ubloxnmea.h
+ * \brief   The NMEA 0183 sentence tokenizer and the decoders of GGA/RMC/GSA/GSV/GST/ZDA
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_NMEA_H
+#define UBLOX_NMEA_H 1
+
+#include "osporting.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_NMEA_NUM_FIELDS 64 /**< the max number of fields of a sentence, including the address */
+
+#define UBLOX_NMEA_UNKNOWN 0
+#define UBLOX_NMEA_GGA 1
+#define UBLOX_NMEA_RMC 2
+#define UBLOX_NMEA_GSA 3
+#define UBLOX_NMEA_GSV 4
+#define UBLOX_NMEA_GST 5
+#define UBLOX_NMEA_ZDA 6
+
+#define UBLOX_NMEA_NUM_SV_GSA 12 /**< the number of satellites in GSA */
+#define UBLOX_NMEA_NUM_SV_GSV 4  /**< the max number of satellites in one GSV */
+
+/** the view of a field in the sentence, not terminated by zero */
+typedef struct _ublox_nmea_field_t {
+    const char * str;
+    size_t len;
+} ublox_nmea_field_t;
+
+/**
+ * The fields of a sentence. The fields point to the original buffer, so the
+ * buffer should be kept until the sentence is decoded.
+ */
+typedef struct _ublox_nmea_sentence_t {
+    ublox_nmea_field_t fields[UBLOX_NMEA_NUM_FIELDS]; /**< fields[0] is the address, such as "GPGGA" */
+    size_t num_fields;
+    uint8_t cksum;    /**< the checksum of the sentence */
+} ublox_nmea_sentence_t;
+
+/*
+ * The empty fields of the decoded sentences are -1 for the integers, NaN
+ * for the floating point numbers and 0 for the characters. The latitude and
+ * the longitude are in the fixed point of 1e-7 degree.
+ */
+
+/** GGA, the fix data */
+typedef struct _ublox_nmea_gga_t {
+    int32_t tod;      /**< the time of day (ms) */
+    int32_t lat;      /**< the latitude (1e-7 deg) */
+    int32_t lon;      /**< the longitude (1e-7 deg) */
+    uint8_t flg_pos;  /**< 1 if lat and lon are valid */
+    int8_t quality;   /**< 0: no fix, 1: autonomous, 2: differential, 4: RTK fixed, 5: RTK float, 6: dead reckoning */
+    int8_t num_sv;    /**< the number of satellites used */
+    double hdop;
+    double alt;       /**< the altitude above the mean sea level (m) */
+    double sep;       /**< the geoid separation (m) */
+    double age;       /**< the age of the differential corrections (s) */
+    int16_t station;  /**< the ID of the differential station */
+} ublox_nmea_gga_t;
+
+/** RMC, the recommended minimum data */
+typedef struct _ublox_nmea_rmc_t {
+    int32_t tod;      /**< the time of day (ms) */
+    int32_t lat;      /**< the latitude (1e-7 deg) */
+    int32_t lon;      /**< the longitude (1e-7 deg) */
+    uint8_t flg_pos;  /**< 1 if lat and lon are valid */
+    char status;      /**< 'A': valid, 'V': warning */
+    double speed;     /**< the speed over ground (knot) */
+    double course;    /**< the course over ground (deg) */
+    double magvar;    /**< the magnetic variation, east is positive (deg) */
+    int16_t year;
+    int8_t month;
+    int8_t day;
+    char mode;        /**< 'N', 'E', 'A', 'D', 'F', 'R', 0 before NMEA 2.3 */
+    char nav_status;  /**< 'V', 0 before NMEA 4.1 */
+} ublox_nmea_rmc_t;
+
+/** GSA, the DOP and the active satellites */
+typedef struct _ublox_nmea_gsa_t {
+    char op_mode;     /**< 'M': manual, 'A': automatic */
+    int8_t nav_mode;  /**< 1: no fix, 2: 2D, 3: 3D */
+    int8_t num_sv;    /**< the number of the satellites in svid */
+    int16_t svid[UBLOX_NMEA_NUM_SV_GSA]; /**< the satellites used, in the order of the sentence */
+    double pdop;
+    double hdop;
+    double vdop;
+    int8_t system;    /**< the GNSS system ID, -1 before NMEA 4.1 */
+} ublox_nmea_gsa_t;
+
+/** a satellite in GSV */
+typedef struct _ublox_nmea_gsv_sat_t {
+    int16_t svid;
+    int16_t elev;     /**< the elevation (deg) */
+    int16_t azim;     /**< the azimuth (deg) */
+    int16_t cno;      /**< the signal strength (dBHz), -1 if not tracked */
+} ublox_nmea_gsv_sat_t;
+
+/** GSV, the satellites in view */
+typedef struct _ublox_nmea_gsv_t {
+    int8_t num_msg;   /**< the number of the sentences of the group */
+    int8_t msg_no;    /**< the number of this sentence, 1 - num_msg */
+    int16_t num_view; /**< the number of the satellites in view */
+    int8_t num_sat;   /**< the number of the satellites in this sentence */
+    ublox_nmea_gsv_sat_t sat[UBLOX_NMEA_NUM_SV_GSV];
+    int8_t signal;    /**< the signal ID, -1 before NMEA 4.1 */
+} ublox_nmea_gsv_t;
+
+/** GST, the pseudorange error statistics */
+typedef struct _ublox_nmea_gst_t {
+    int32_t tod;      /**< the time of day (ms) */
+    double rms;       /**< the RMS of the pseudorange residuals (m) */
+    double std_major; /**< the standard deviation of the semi-major axis (m) */
+    double std_minor; /**< the standard deviation of the semi-minor axis (m) */
+    double orient;    /**< the orientation of the semi-major axis (deg) */
+    double std_lat;   /**< the standard deviation of the latitude (m) */
+    double std_lon;   /**< the standard deviation of the longitude (m) */
+    double std_alt;   /**< the standard deviation of the altitude (m) */
+} ublox_nmea_gst_t;
+
+/** ZDA, the time and date */
+typedef struct _ublox_nmea_zda_t {
+    int32_t tod;      /**< the time of day (ms) */
+    int16_t year;
+    int8_t month;
+    int8_t day;
+    int8_t ltz_hour;  /**< the hours of the local time zone */
+    int8_t ltz_min;   /**< the minutes of the local time zone */
+} ublox_nmea_zda_t;
+
+int ublox_nmea_tokenize(const uint8_t * buffer_in, size_t sz_in, ublox_nmea_sentence_t * snt);
+int ublox_nmea_type(const ublox_nmea_sentence_t * snt);
+
+int ublox_nmea_fixed(const ublox_nmea_field_t * fld, int num_digits, int64_t * pval);
+double ublox_nmea_double(const ublox_nmea_field_t * fld);
+int ublox_nmea_latlon(const ublox_nmea_field_t * fld, const ublox_nmea_field_t * fld_hemi, int32_t * pval);
+int ublox_nmea_time(const ublox_nmea_field_t * fld, int32_t * ptod);
+
+int ublox_nmea_decode_gga(const ublox_nmea_sentence_t * snt, ublox_nmea_gga_t * msg);
+int ublox_nmea_decode_rmc(const ublox_nmea_sentence_t * snt, ublox_nmea_rmc_t * msg);
+int ublox_nmea_decode_gsa(const ublox_nmea_sentence_t * snt, ublox_nmea_gsa_t * msg);
+int ublox_nmea_decode_gsv(const ublox_nmea_sentence_t * snt, ublox_nmea_gsv_t * msg);
+int ublox_nmea_decode_gst(const ublox_nmea_sentence_t * snt, ublox_nmea_gst_t * msg);
+int ublox_nmea_decode_zda(const ublox_nmea_sentence_t * snt, ublox_nmea_zda_t * msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_NMEA_H */
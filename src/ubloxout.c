@@ -0,0 +1,1290 @@
+/**
+ * \file    ubloxout.c
+ * \brief   The buffered writer and the output formats of the decoded packets
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * All of the formats are appended to the buffer of ublox_out_t, the text
+ * printers of ubloxdec.c write to the buffer through a stream of
+ * fopencookie(), so the output of a packet does not call write() or fwrite().
+ * Without fopencookie(), the text printers write to the output stream
+ * directly after the buffer is flushed.
+ */
+
+#include <errno.h>
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdec.h"
+#include "ubloxcstr.h"
+#include "ubloxfmt.h"
+#include "ubloxdmx.h"
+#include "ubloxout.h"
+
+#if defined(UBLOX_OUT_FD_ENABLED)
+#include <unistd.h>
+#endif
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_OUT_SZ_MIN 4096 /**< the min size of the buffer */
+
+/** the output is kept in the memory */
+#define ublox_out_in_memory(out) (((out)->fd < 0) && (NULL == (out)->fp_out))
+
+/* setup the writer to the file descriptor or the stream */
+static int
+ublox_out_setup(ublox_out_t * out, int fd, FILE * fp, int format, uint8_t * buf, size_t sz_buf)
+{
+    assert (NULL != out);
+    memset(out, 0, sizeof(*out));
+    out->fd = fd;
+    out->fp_out = fp;
+    out->format = format;
+    if (sz_buf < UBLOX_OUT_SZ_MIN) {
+        sz_buf = UBLOX_OUT_SZ_MIN;
+        buf = NULL;
+    }
+    if (NULL == buf) {
+        buf = malloc(sz_buf);
+        if (NULL == buf) {
+            return -1;
+        }
+        out->flg_own = 1;
+    } else if (ublox_out_in_memory(out)) {
+        // the buffer of the caller can't grow
+        return -1;
+    }
+    out->buf = buf;
+    out->sz_buf = sz_buf;
+    return 0;
+}
+
+/**
+ * \brief setup the writer
+ * \param out: the writer
+ * \param fd: the output, <0 to keep the output in the memory
+ * \param format: UBLOX_OUT_xxx
+ * \param buf: the buffer, NULL to allocate it
+ * \param sz_buf: the byte size of the buffer, the initial size if fd < 0
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_out_init(ublox_out_t * out, int fd, int format, uint8_t * buf, size_t sz_buf)
+{
+#if ! defined(UBLOX_OUT_FD_ENABLED)
+    if (fd >= 0) {
+        TE("the file descriptor is not supported, use ublox_out_init_fp()\n");
+        return -1;
+    }
+#endif
+    return ublox_out_setup(out, fd, NULL, format, buf, sz_buf);
+}
+
+/**
+ * \brief setup the writer to the stream
+ * \param out: the writer
+ * \param fp: the output stream
+ * \param format: UBLOX_OUT_xxx
+ * \param buf: the buffer, NULL to allocate it
+ * \param sz_buf: the byte size of the buffer
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The buffer is written by fwrite(), it's the output of the platforms without write().
+ */
+int
+ublox_out_init_fp(ublox_out_t * out, FILE * fp, int format, uint8_t * buf, size_t sz_buf)
+{
+    if (NULL == fp) {
+        return -1;
+    }
+    return ublox_out_setup(out, -1, fp, format, buf, sz_buf);
+}
+
+/**
+ * \brief flush and release the writer
+ * \param out: the writer
+ */
+void
+ublox_out_clear(ublox_out_t * out)
+{
+    assert (NULL != out);
+    if (NULL != out->fp) {
+        fclose(out->fp);
+        out->fp = NULL;
+    }
+    ublox_out_flush(out);
+    if (out->flg_fp_own) {
+        fclose(out->fp_out);
+    }
+    out->fp_out = NULL;
+    if (out->flg_own) {
+        free(out->buf);
+    }
+    out->buf = NULL;
+    out->sz_buf = 0;
+    out->sz_data = 0;
+}
+
+/* write all of the data to the file descriptor, or the output stream */
+static int
+ublox_out_write_fd(ublox_out_t * out, const uint8_t * data, size_t sz)
+{
+#if defined(UBLOX_OUT_FD_ENABLED)
+    ssize_t ret;
+#endif
+
+    if (NULL != out->fp_out) {
+        if ((sz > 0) && (sz != fwrite(data, 1, sz, out->fp_out))) {
+            TE("fwrite error\n");
+            out->flg_err = 1;
+            return -1;
+        }
+        out->num_write ++;
+        return 0;
+    }
+#if defined(UBLOX_OUT_FD_ENABLED)
+    while (sz > 0) {
+        ret = write(out->fd, data, sz);
+        if (ret < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            TE("write error: %s\n", strerror(errno));
+            out->flg_err = 1;
+            return -1;
+        }
+        out->num_write ++;
+        data += ret;
+        sz -= ret;
+    }
+    return 0;
+#else
+    out->flg_err = 1;
+    return -1;
+#endif
+}
+
+/**
+ * \brief write the data in the buffer to the file descriptor or the stream
+ * \param out: the writer
+ *
+ * \return 0 on success, <0 on error
+ *
+ * It does nothing if the output is kept in the memory.
+ */
+int
+ublox_out_flush(ublox_out_t * out)
+{
+    int ret;
+
+    assert (NULL != out);
+    if (ublox_out_in_memory(out)) {
+        return 0;
+    }
+    ret = ublox_out_write_fd(out, out->buf, out->sz_data);
+    out->sz_data = 0;
+    if ((NULL != out->fp_out) && (0 != fflush(out->fp_out))) {
+        out->flg_err = 1;
+        ret = -1;
+    }
+    return ret;
+}
+
+/**
+ * \brief get the space for sz bytes at the end of the buffer
+ * \param out: the writer
+ * \param sz: the byte size
+ *
+ * \return the space, NULL on error; the caller appends the data and adds the size to out->sz_data
+ *
+ * The buffer is flushed if it has no space, or grows if the output is kept in the memory.
+ */
+uint8_t *
+ublox_out_reserve(ublox_out_t * out, size_t sz)
+{
+    uint8_t * p;
+    size_t sz_new;
+
+    assert (NULL != out);
+    if (out->sz_data + sz <= out->sz_buf) {
+        return out->buf + out->sz_data;
+    }
+    if (! ublox_out_in_memory(out)) {
+        ublox_out_flush(out);
+        if (sz <= out->sz_buf) {
+            return out->buf;
+        }
+        return NULL;
+    }
+    for (sz_new = out->sz_buf * 2; sz_new < out->sz_data + sz; sz_new *= 2) {
+    }
+    p = realloc(out->buf, sz_new);
+    if (NULL == p) {
+        out->flg_err = 1;
+        return NULL;
+    }
+    out->buf = p;
+    out->sz_buf = sz_new;
+    return out->buf + out->sz_data;
+}
+
+/**
+ * \brief append the data to the buffer
+ * \param out: the writer
+ * \param data: the data
+ * \param sz: the byte size of the data
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The block larger than half of the buffer is written to the file descriptor
+ * directly if it doesn't fit in the buffer.
+ */
+int
+ublox_out_write(ublox_out_t * out, const void * data, size_t sz)
+{
+    uint8_t * p;
+    size_t n;
+
+    if ((! ublox_out_in_memory(out)) && (out->sz_data + sz > out->sz_buf) && (sz >= out->sz_buf / 2)) {
+        // the large block, such as the output of a chunk, is not copied
+        if (ublox_out_flush(out) < 0) {
+            return -1;
+        }
+        return ublox_out_write_fd(out, data, sz);
+    }
+    while (sz > 0) {
+        n = (sz < out->sz_buf)?sz:out->sz_buf;
+        p = ublox_out_reserve(out, n);
+        if (NULL == p) {
+            return -1;
+        }
+        memmove(p, data, n);
+        out->sz_data += n;
+        data = (const uint8_t *)data + n;
+        sz -= n;
+    }
+    return 0;
+}
+
+#if defined(UBLOX_OUT_COOKIE_ENABLED)
+static ssize_t
+ublox_out_cookie_write(void * cookie, const char * buf, size_t size)
+{
+    if (ublox_out_write((ublox_out_t *)cookie, buf, size) < 0) {
+        return -1;
+    }
+    return size;
+}
+#endif
+
+/**
+ * \brief get the stream to append the text to the buffer
+ * \param out: the writer
+ *
+ * \return the stream, NULL on error
+ *
+ * The stream is not buffered, the data is appended to the buffer of the
+ * writer in the order of the other functions. It's closed by ublox_out_clear().
+ * Without fopencookie(), the buffer is flushed and the output stream is
+ * returned, the text of the memory mode is not supported.
+ */
+FILE *
+ublox_out_fp(ublox_out_t * out)
+{
+#if defined(UBLOX_OUT_COOKIE_ENABLED)
+    cookie_io_functions_t fns;
+
+    if (NULL != out->fp) {
+        return out->fp;
+    }
+    memset(&fns, 0, sizeof(fns));
+    fns.write = ublox_out_cookie_write;
+    out->fp = fopencookie(out, "w", fns);
+    if (NULL != out->fp) {
+        setvbuf(out->fp, NULL, _IONBF, 0);
+    }
+    return out->fp;
+#else
+#if defined(UBLOX_OUT_FD_ENABLED)
+    int fd;
+
+    if ((NULL == out->fp_out) && (out->fd >= 0)) {
+        // all of the output goes to the stream of the file descriptor from now on
+        fd = dup(out->fd);
+        out->fp_out = (fd < 0)?NULL:fdopen(fd, "w");
+        if (NULL == out->fp_out) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            return NULL;
+        }
+        out->flg_fp_own = 1;
+    }
+#endif
+    if (NULL == out->fp_out) {
+        return NULL;
+    }
+    if (ublox_out_flush(out) < 0) {
+        return NULL;
+    }
+    return out->fp_out;
+#endif
+}
+
+/*****************************************************************************/
+// the fields
+
+/**
+ * \brief append the string
+ * \param out: the writer
+ * \param cstr: the string
+ */
+void
+ublox_out_put_str(ublox_out_t * out, const char * cstr)
+{
+    ublox_out_write(out, cstr, strlen(cstr));
+}
+
+/**
+ * \brief append the signed integer in decimal
+ * \param out: the writer
+ * \param val: the value
+ */
+void
+ublox_out_put_int(ublox_out_t * out, int64_t val)
+{
+    char * p = (char *)ublox_out_reserve(out, UBLOX_FMT_SZ_MAX);
+    if (NULL != p) {
+        out->sz_data += ublox_fmt_int(p, val) - p;
+    }
+}
+
+/**
+ * \brief append the unsigned integer in decimal
+ * \param out: the writer
+ * \param val: the value
+ */
+void
+ublox_out_put_uint(ublox_out_t * out, uint64_t val)
+{
+    char * p = (char *)ublox_out_reserve(out, UBLOX_FMT_SZ_MAX);
+    if (NULL != p) {
+        out->sz_data += ublox_fmt_uint(p, val) - p;
+    }
+}
+
+/**
+ * \brief append the unsigned integer in upper case hexadecimal
+ * \param out: the writer
+ * \param val: the value
+ * \param width: the min number of digits, padded by '0'
+ */
+void
+ublox_out_put_hex(ublox_out_t * out, uint32_t val, size_t width)
+{
+    char * p = (char *)ublox_out_reserve(out, UBLOX_FMT_SZ_MAX);
+    if (NULL != p) {
+        out->sz_data += ublox_fmt_hex(p, val, width) - p;
+    }
+}
+
+/**
+ * \brief append the double by the shortest digits which can be read back to the same value
+ * \param out: the writer
+ * \param val: the value
+ *
+ * See ublox_fmt_double().
+ */
+void
+ublox_out_put_double(ublox_out_t * out, double val)
+{
+    char * p = (char *)ublox_out_reserve(out, UBLOX_FMT_SZ_MAX);
+    if (NULL != p) {
+        out->sz_data += ublox_fmt_double(p, val) - p;
+    }
+}
+
+/* append the string quoted by q, and the q and the escape character in the string are escaped by esc;
+ * the control characters and the non-ASCII bytes are escaped as \u00XX by JSON's esc '\\' */
+static void
+ublox_out_put_quoted(ublox_out_t * out, const uint8_t * str, size_t sz, uint8_t q, uint8_t esc)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t * p;
+    size_t i;
+
+    p = ublox_out_reserve(out, sz * 6 + 2);
+    if (NULL == p) {
+        return;
+    }
+    *p ++ = q;
+    for (i = 0; i < sz; i ++) {
+        if (('\\' == esc) && ((str[i] < 0x20) || (str[i] >= 0x7F))) {
+            *p ++ = '\\';
+            *p ++ = 'u';
+            *p ++ = '0';
+            *p ++ = '0';
+            *p ++ = hex[str[i] >> 4];
+            *p ++ = hex[str[i] & 0x0F];
+            continue;
+        }
+        if ((q == str[i]) || (esc == str[i])) {
+            *p ++ = esc;
+        }
+        *p ++ = str[i];
+    }
+    *p ++ = q;
+    out->sz_data = p - out->buf;
+}
+
+/**
+ * \brief get the format by the name
+ * \param cstr: the name, "text", "jsonl", "csv" or "bin"
+ *
+ * \return UBLOX_OUT_xxx, <0 if not supported
+ */
+int
+ublox_out_cstr2format(const char * cstr)
+{
+    int i;
+    for (i = UBLOX_OUT_TEXT; i <= UBLOX_OUT_BIN; i ++) {
+        if (0 == strcmp(cstr, ublox_out_format2cstr(i))) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief get the name of the format
+ * \param format: UBLOX_OUT_xxx
+ *
+ * \return the name
+ */
+const char *
+ublox_out_format2cstr(int format)
+{
+    switch (format) {
+    case UBLOX_OUT_TEXT:  return "text";
+    case UBLOX_OUT_JSONL: return "jsonl";
+    case UBLOX_OUT_CSV:   return "csv";
+    case UBLOX_OUT_BIN:   return "bin";
+    }
+    return "unknown";
+}
+
+/*****************************************************************************/
+// JSON Lines, the object begins with the field "msg", the others are prefixed by ','
+
+#define UBLOX_JSON_KEY(out, key) ublox_out_put_str(out, ",\"" key "\":")
+#define UBLOX_JSON_INT(out, key, val) { UBLOX_JSON_KEY(out, key); ublox_out_put_int(out, val); }
+#define UBLOX_JSON_DBL(out, key, val) { UBLOX_JSON_KEY(out, key); ublox_out_put_double(out, val); }
+
+static void
+ublox_json_rxm_rawx(ublox_out_t * out, const uint8_t * payload, size_t count)
+{
+    ublox_rxm_rawx_t msg;
+    ublox_rxm_rawx_meas_t item;
+    size_t i;
+
+    memset(&msg, 0, sizeof(msg));
+    if (ublox_decode_rxm_rawx(payload, count, &msg) < 0) {
+        return;
+    }
+    UBLOX_JSON_DBL(out, "rcvTow", msg.rcvTow);
+    UBLOX_JSON_INT(out, "week", msg.week);
+    UBLOX_JSON_INT(out, "leapS", msg.leapS);
+    UBLOX_JSON_INT(out, "recStat", msg.recStat);
+    ublox_out_put_str(out, ",\"meas\":[");
+    for (i = 0; i < msg.numMeas; i ++) {
+        ublox_decode_rxm_rawx_item(payload, count, i, &item);
+        ublox_out_put_str(out, (i > 0)?",{\"gnssId\":":"{\"gnssId\":");
+        ublox_out_put_int(out, item.gnssId);
+        UBLOX_JSON_INT(out, "svId", item.svId);
+        UBLOX_JSON_INT(out, "freqId", item.freqId);
+        UBLOX_JSON_DBL(out, "prMes", item.prMes);
+        UBLOX_JSON_DBL(out, "cpMes", item.cpMes);
+        UBLOX_JSON_DBL(out, "doMes", item.doMes);
+        UBLOX_JSON_INT(out, "locktime", item.locktime);
+        UBLOX_JSON_INT(out, "cno", item.cno);
+        UBLOX_JSON_INT(out, "prStdev", item.prStdev);
+        UBLOX_JSON_INT(out, "cpStdev", item.cpStdev);
+        UBLOX_JSON_INT(out, "doStdev", item.doStdev);
+        UBLOX_JSON_INT(out, "trkStat", item.trkStat);
+        ublox_out_put_str(out, "}");
+    }
+    ublox_out_put_str(out, "]");
+}
+
+static void
+ublox_json_rxm_raw(ublox_out_t * out, const uint8_t * payload, size_t count)
+{
+    ublox_rxm_raw_t msg;
+    ublox_rxm_raw_sv_t item;
+    size_t i;
+
+    memset(&msg, 0, sizeof(msg));
+    if (ublox_decode_rxm_raw(payload, count, &msg) < 0) {
+        return;
+    }
+    UBLOX_JSON_INT(out, "iTOW", msg.iTOW);
+    UBLOX_JSON_INT(out, "week", msg.week);
+    ublox_out_put_str(out, ",\"sv\":[");
+    for (i = 0; i < msg.numSV; i ++) {
+        ublox_decode_rxm_raw_item(payload, count, i, &item);
+        ublox_out_put_str(out, (i > 0)?",{\"sv\":":"{\"sv\":");
+        ublox_out_put_int(out, item.sv);
+        UBLOX_JSON_DBL(out, "cpMes", item.cpMes);
+        UBLOX_JSON_DBL(out, "prMes", item.prMes);
+        UBLOX_JSON_DBL(out, "doMes", item.doMes);
+        UBLOX_JSON_INT(out, "mesQI", item.mesQI);
+        UBLOX_JSON_INT(out, "cno", item.cno);
+        UBLOX_JSON_INT(out, "lli", item.lli);
+        ublox_out_put_str(out, "}");
+    }
+    ublox_out_put_str(out, "]");
+}
+
+/* the words of RXM-SFRBX and RXM-SFRB */
+static void
+ublox_json_dwrd(ublox_out_t * out, const uint32_t * dwrd, size_t num)
+{
+    size_t i;
+    ublox_out_put_str(out, ",\"dwrd\":[");
+    for (i = 0; i < num; i ++) {
+        if (i > 0) {
+            ublox_out_put_str(out, ",");
+        }
+        ublox_out_put_uint(out, dwrd[i]);
+    }
+    ublox_out_put_str(out, "]");
+}
+
+static void
+ublox_json_rxm_sfrbx(ublox_out_t * out, const uint8_t * payload, size_t count)
+{
+    ublox_rxm_sfrbx_t msg;
+    uint32_t dwrd[UBLOX_PKT_LENGTH_MAX / 4];
+
+    memset(&msg, 0, sizeof(msg));
+    msg.dwrd = dwrd;
+    msg.max_dwrd = NUM_ARRAY(dwrd);
+    if (ublox_decode_rxm_sfrbx(payload, count, &msg) < 0) {
+        return;
+    }
+    UBLOX_JSON_INT(out, "gnssId", msg.gnssId);
+    UBLOX_JSON_INT(out, "svId", msg.svId);
+    UBLOX_JSON_INT(out, "freqId", msg.freqId);
+    UBLOX_JSON_INT(out, "version", msg.version);
+    ublox_json_dwrd(out, msg.dwrd, msg.num_dwrd);
+}
+
+static void
+ublox_json_packet(ublox_out_t * out, const uint8_t * buffer_in)
+{
+    const uint8_t * payload = buffer_in + UBLOX_PKT_LENGTH_HDR;
+    size_t count = UBLOX_PKG_LENGTH(buffer_in);
+
+    ublox_out_put_str(out, "{\"msg\":\"");
+    ublox_out_put_str(out, val2cstr_ublox_classid(buffer_in[2], buffer_in[3]));
+    ublox_out_put_str(out, "\"");
+    UBLOX_JSON_INT(out, "len", count);
+
+    switch (UBLOX_CLASS_ID(buffer_in[2], buffer_in[3])) {
+    case UBX_RXM_RAWX:
+        ublox_json_rxm_rawx(out, payload, count);
+        break;
+    case UBX_RXM_RAW:
+        ublox_json_rxm_raw(out, payload, count);
+        break;
+    case UBX_RXM_SFRBX:
+        ublox_json_rxm_sfrbx(out, payload, count);
+        break;
+    case UBX_RXM_SFRB:
+        {
+            ublox_rxm_sfrb_t msg;
+            if (ublox_decode_rxm_sfrb(payload, count, &msg) >= 0) {
+                UBLOX_JSON_INT(out, "chn", msg.chn);
+                UBLOX_JSON_INT(out, "svid", msg.svid);
+                ublox_json_dwrd(out, msg.dwrd, NUM_ARRAY(msg.dwrd));
+            }
+        }
+        break;
+    case UBX_NAV_TIMEGPS:
+        {
+            ublox_nav_timegps_t msg;
+            if (ublox_decode_nav_timegps(payload, count, &msg) >= 0) {
+                UBLOX_JSON_INT(out, "iTOW", msg.iTOW);
+                UBLOX_JSON_INT(out, "fTOW", msg.fTOW);
+                UBLOX_JSON_INT(out, "week", msg.week);
+                UBLOX_JSON_INT(out, "leapS", msg.leapS);
+                UBLOX_JSON_INT(out, "valid", msg.valid);
+                UBLOX_JSON_INT(out, "tAcc", msg.tAcc);
+            }
+        }
+        break;
+    case UBX_NAV_CLOCK:
+        {
+            ublox_nav_clock_t msg;
+            if (ublox_decode_nav_clock(payload, count, &msg) >= 0) {
+                UBLOX_JSON_INT(out, "iTOW", msg.iTOW);
+                UBLOX_JSON_INT(out, "clkB", msg.clkB);
+                UBLOX_JSON_INT(out, "clkD", msg.clkD);
+                UBLOX_JSON_INT(out, "tAcc", msg.tAcc);
+                UBLOX_JSON_INT(out, "fAcc", msg.fAcc);
+            }
+        }
+        break;
+    case UBX_ACK_ACK:
+    case UBX_ACK_NAK:
+        {
+            ublox_ack_t msg;
+            if (ublox_decode_ack(payload, count, &msg) >= 0) {
+                UBLOX_JSON_INT(out, "clsID", msg.clsID);
+                UBLOX_JSON_INT(out, "msgID", msg.msgID);
+            }
+        }
+        break;
+    case UBX_CFG_RATE:
+        {
+            ublox_cfg_rate_t msg;
+            if ((count > 0) && (ublox_decode_cfg_rate(payload, count, &msg) >= 0)) {
+                UBLOX_JSON_INT(out, "measRate", msg.measRate);
+                UBLOX_JSON_INT(out, "navRate", msg.navRate);
+                UBLOX_JSON_INT(out, "timeRef", msg.timeRef);
+            }
+        }
+        break;
+    case UBX_MON_VER:
+        {
+            ublox_mon_ver_t msg;
+            if ((count > 0) && (ublox_decode_mon_ver(payload, count, &msg) >= 0)) {
+                UBLOX_JSON_KEY(out, "swVersion");
+                ublox_out_put_quoted(out, (const uint8_t *)msg.swVersion, strlen(msg.swVersion), '"', '\\');
+                UBLOX_JSON_KEY(out, "hwVersion");
+                ublox_out_put_quoted(out, (const uint8_t *)msg.hwVersion, strlen(msg.hwVersion), '"', '\\');
+            }
+        }
+        break;
+    }
+    ublox_out_put_str(out, "}\n");
+}
+
+/*****************************************************************************/
+// CSV, the first column is the name of the message
+
+#define UBLOX_CSV_INT(out, val) { ublox_out_put_str(out, ","); ublox_out_put_int(out, val); }
+#define UBLOX_CSV_DBL(out, val) { ublox_out_put_str(out, ","); ublox_out_put_double(out, val); }
+
+/** the columns of the rows, written once by ublox_out_header() */
+static const char * ublox_csv_header[] = {
+    "#UBX_RXM_RAWX,rcvTow,week,leapS,recStat,gnssId,svId,freqId,prMes,cpMes,doMes,locktime,cno,prStdev,cpStdev,doStdev,trkStat",
+    "#UBX_RXM_RAW,iTOW,week,sv,cpMes,prMes,doMes,mesQI,cno,lli",
+    "#UBX_RXM_SFRBX,gnssId,svId,freqId,version,dwrd...",
+    "#UBX_RXM_SFRB,chn,svid,dwrd...",
+    "#UBX_NAV_TIMEGPS,iTOW,fTOW,week,leapS,valid,tAcc",
+    "#UBX_NAV_CLOCK,iTOW,clkB,clkD,tAcc,fAcc",
+    "#UBX_ACK_ACK,clsID,msgID",
+    "#UBX_ACK_NAK,clsID,msgID",
+    "#(others),len",
+    "#NMEA,sentence",
+    "#RTCM3,len,type",
+};
+
+static void
+ublox_csv_rxm_rawx(ublox_out_t * out, const uint8_t * payload, size_t count)
+{
+    ublox_rxm_rawx_t msg;
+    ublox_rxm_rawx_meas_t item;
+    size_t i;
+
+    memset(&msg, 0, sizeof(msg));
+    if (ublox_decode_rxm_rawx(payload, count, &msg) < 0) {
+        return;
+    }
+    for (i = 0; i < msg.numMeas; i ++) {
+        ublox_decode_rxm_rawx_item(payload, count, i, &item);
+        ublox_out_put_str(out, "UBX_RXM_RAWX");
+        UBLOX_CSV_DBL(out, msg.rcvTow);
+        UBLOX_CSV_INT(out, msg.week);
+        UBLOX_CSV_INT(out, msg.leapS);
+        UBLOX_CSV_INT(out, msg.recStat);
+        UBLOX_CSV_INT(out, item.gnssId);
+        UBLOX_CSV_INT(out, item.svId);
+        UBLOX_CSV_INT(out, item.freqId);
+        UBLOX_CSV_DBL(out, item.prMes);
+        UBLOX_CSV_DBL(out, item.cpMes);
+        UBLOX_CSV_DBL(out, item.doMes);
+        UBLOX_CSV_INT(out, item.locktime);
+        UBLOX_CSV_INT(out, item.cno);
+        UBLOX_CSV_INT(out, item.prStdev);
+        UBLOX_CSV_INT(out, item.cpStdev);
+        UBLOX_CSV_INT(out, item.doStdev);
+        UBLOX_CSV_INT(out, item.trkStat);
+        ublox_out_put_str(out, "\n");
+    }
+}
+
+static void
+ublox_csv_rxm_raw(ublox_out_t * out, const uint8_t * payload, size_t count)
+{
+    ublox_rxm_raw_t msg;
+    ublox_rxm_raw_sv_t item;
+    size_t i;
+
+    memset(&msg, 0, sizeof(msg));
+    if (ublox_decode_rxm_raw(payload, count, &msg) < 0) {
+        return;
+    }
+    for (i = 0; i < msg.numSV; i ++) {
+        ublox_decode_rxm_raw_item(payload, count, i, &item);
+        ublox_out_put_str(out, "UBX_RXM_RAW");
+        UBLOX_CSV_INT(out, msg.iTOW);
+        UBLOX_CSV_INT(out, msg.week);
+        UBLOX_CSV_INT(out, item.sv);
+        UBLOX_CSV_DBL(out, item.cpMes);
+        UBLOX_CSV_DBL(out, item.prMes);
+        UBLOX_CSV_DBL(out, item.doMes);
+        UBLOX_CSV_INT(out, item.mesQI);
+        UBLOX_CSV_INT(out, item.cno);
+        UBLOX_CSV_INT(out, item.lli);
+        ublox_out_put_str(out, "\n");
+    }
+}
+
+static void
+ublox_csv_packet(ublox_out_t * out, const uint8_t * buffer_in)
+{
+    const uint8_t * payload = buffer_in + UBLOX_PKT_LENGTH_HDR;
+    size_t count = UBLOX_PKG_LENGTH(buffer_in);
+    size_t i;
+
+    switch (UBLOX_CLASS_ID(buffer_in[2], buffer_in[3])) {
+    case UBX_RXM_RAWX:
+        ublox_csv_rxm_rawx(out, payload, count);
+        return;
+    case UBX_RXM_RAW:
+        ublox_csv_rxm_raw(out, payload, count);
+        return;
+    case UBX_RXM_SFRBX:
+        {
+            ublox_rxm_sfrbx_t msg;
+            uint32_t dwrd[UBLOX_PKT_LENGTH_MAX / 4];
+            memset(&msg, 0, sizeof(msg));
+            msg.dwrd = dwrd;
+            msg.max_dwrd = NUM_ARRAY(dwrd);
+            if (ublox_decode_rxm_sfrbx(payload, count, &msg) < 0) {
+                return;
+            }
+            ublox_out_put_str(out, "UBX_RXM_SFRBX");
+            UBLOX_CSV_INT(out, msg.gnssId);
+            UBLOX_CSV_INT(out, msg.svId);
+            UBLOX_CSV_INT(out, msg.freqId);
+            UBLOX_CSV_INT(out, msg.version);
+            for (i = 0; i < msg.num_dwrd; i ++) {
+                UBLOX_CSV_INT(out, msg.dwrd[i]);
+            }
+        }
+        break;
+    case UBX_RXM_SFRB:
+        {
+            ublox_rxm_sfrb_t msg;
+            if (ublox_decode_rxm_sfrb(payload, count, &msg) < 0) {
+                return;
+            }
+            ublox_out_put_str(out, "UBX_RXM_SFRB");
+            UBLOX_CSV_INT(out, msg.chn);
+            UBLOX_CSV_INT(out, msg.svid);
+            for (i = 0; i < NUM_ARRAY(msg.dwrd); i ++) {
+                UBLOX_CSV_INT(out, msg.dwrd[i]);
+            }
+        }
+        break;
+    case UBX_NAV_TIMEGPS:
+        {
+            ublox_nav_timegps_t msg;
+            if (ublox_decode_nav_timegps(payload, count, &msg) < 0) {
+                return;
+            }
+            ublox_out_put_str(out, "UBX_NAV_TIMEGPS");
+            UBLOX_CSV_INT(out, msg.iTOW);
+            UBLOX_CSV_INT(out, msg.fTOW);
+            UBLOX_CSV_INT(out, msg.week);
+            UBLOX_CSV_INT(out, msg.leapS);
+            UBLOX_CSV_INT(out, msg.valid);
+            UBLOX_CSV_INT(out, msg.tAcc);
+        }
+        break;
+    case UBX_NAV_CLOCK:
+        {
+            ublox_nav_clock_t msg;
+            if (ublox_decode_nav_clock(payload, count, &msg) < 0) {
+                return;
+            }
+            ublox_out_put_str(out, "UBX_NAV_CLOCK");
+            UBLOX_CSV_INT(out, msg.iTOW);
+            UBLOX_CSV_INT(out, msg.clkB);
+            UBLOX_CSV_INT(out, msg.clkD);
+            UBLOX_CSV_INT(out, msg.tAcc);
+            UBLOX_CSV_INT(out, msg.fAcc);
+        }
+        break;
+    case UBX_ACK_ACK:
+    case UBX_ACK_NAK:
+        {
+            ublox_ack_t msg;
+            if (ublox_decode_ack(payload, count, &msg) < 0) {
+                return;
+            }
+            ublox_out_put_str(out, val2cstr_ublox_classid(buffer_in[2], buffer_in[3]));
+            UBLOX_CSV_INT(out, msg.clsID);
+            UBLOX_CSV_INT(out, msg.msgID);
+        }
+        break;
+    default:
+        ublox_out_put_str(out, val2cstr_ublox_classid(buffer_in[2], buffer_in[3]));
+        UBLOX_CSV_INT(out, count);
+        break;
+    }
+    ublox_out_put_str(out, "\n");
+}
+
+/*****************************************************************************/
+
+/**
+ * \brief write the header of the format
+ * \param out: the writer
+ *
+ * \return 0 on success, <0 on error
+ *
+ * Only CSV has the header, the lines of the columns begin with '#'.
+ */
+int
+ublox_out_header(ublox_out_t * out)
+{
+    size_t i;
+    if (UBLOX_OUT_CSV != out->format) {
+        return 0;
+    }
+    for (i = 0; i < NUM_ARRAY(ublox_csv_header); i ++) {
+        ublox_out_put_str(out, ublox_csv_header[i]);
+        ublox_out_put_str(out, "\n");
+    }
+    return out->flg_err?-1:0;
+}
+
+/**
+ * \brief write the packet in the format of the writer
+ * \param out: the writer
+ * \param buffer_in: the verified packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, =2 the packet is not supported by the text printer, <0 on error
+ */
+int
+ublox_out_packet(ublox_out_t * out, const uint8_t * buffer_in, size_t sz_in)
+{
+    FILE * fp;
+
+    assert (NULL != out);
+    if ((NULL == buffer_in) || (sz_in < UBLOX_PKT_LENGTH_MIN) || (sz_in < UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in))) {
+        return -1;
+    }
+    switch (out->format) {
+    case UBLOX_OUT_TEXT:
+        fp = ublox_out_fp(out);
+        if (NULL == fp) {
+            return -1;
+        }
+        return ublox_print_packet(fp, buffer_in, sz_in);
+    case UBLOX_OUT_JSONL:
+        ublox_json_packet(out, buffer_in);
+        break;
+    case UBLOX_OUT_CSV:
+        ublox_csv_packet(out, buffer_in);
+        break;
+    case UBLOX_OUT_BIN:
+        ublox_out_write(out, buffer_in, UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in));
+        break;
+    default:
+        return -1;
+    }
+    return out->flg_err?-1:0;
+}
+
+/**
+ * \brief the handler to write the packet, see ublox_registry_set()
+ * \param userdata: the writer, ublox_out_t
+ * \param buffer_in: the verified packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_out_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    if (ublox_out_packet((ublox_out_t *)userdata, buffer_in, sz_in) != 0) {
+        TE("ublox error: malformed payload in packet: classid=%s(0x%04X), size=%" PRIuSZ "\n", val2cstr_ublox_classid(buffer_in[2], buffer_in[3]), UBLOX_CLASS_ID(buffer_in[2], buffer_in[3]), sz_in);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief register the writer for the packets
+ * \param reg: the registry
+ * \param out: the writer
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The text format has the packets supported by ublox_print_packet(), the
+ * other formats also have the packets of the other class/id by the fallback.
+ */
+int
+ublox_registry_add_writer(ublox_registry_t * reg, ublox_out_t * out)
+{
+    size_t i, j;
+
+    // the same list of the printer, then replace the handlers
+    if (ublox_registry_add_printer(reg, NULL) < 0) {
+        return -1;
+    }
+    for (i = 0; i < NUM_ARRAY(reg->classes); i ++) {
+        if (NULL == reg->classes[i]) {
+            continue;
+        }
+        for (j = 0; j < UBLOX_REG_NUM_ID; j ++) {
+            if (ublox_print_handler == reg->classes[i][j].handler) {
+                reg->classes[i][j].handler = ublox_out_handler;
+                reg->classes[i][j].userdata = out;
+            }
+        }
+    }
+    if (UBLOX_OUT_TEXT != out->format) {
+        ublox_registry_set_fallback(reg, ublox_out_handler, out);
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+// the NMEA sentences and the RTCM 3 frames from the demultiplexer
+
+/**
+ * \brief the handler to write the NMEA sentence, see ublox_demux_set()
+ * \param userdata: the writer, ublox_out_t
+ * \param buffer_in: the verified sentence, from '$' to "\r\n"
+ * \param sz_in: the byte size of the sentence
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_out_nmea_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_out_t * out = (ublox_out_t *)userdata;
+    size_t sz = sz_in - 2; // without "\r\n"
+
+    assert (NULL != out);
+    assert (sz_in > 2);
+    switch (out->format) {
+    case UBLOX_OUT_TEXT:
+        ublox_out_write(out, buffer_in, sz);
+        ublox_out_put_str(out, "\n");
+        break;
+    case UBLOX_OUT_JSONL:
+        ublox_out_put_str(out, "{\"msg\":\"NMEA\"");
+        UBLOX_JSON_INT(out, "len", sz);
+        UBLOX_JSON_KEY(out, "sentence");
+        ublox_out_put_quoted(out, buffer_in, sz, '"', '\\');
+        ublox_out_put_str(out, "}\n");
+        break;
+    case UBLOX_OUT_CSV:
+        ublox_out_put_str(out, "NMEA,");
+        ublox_out_put_quoted(out, buffer_in, sz, '"', '"');
+        ublox_out_put_str(out, "\n");
+        break;
+    case UBLOX_OUT_BIN:
+        ublox_out_write(out, buffer_in, sz_in);
+        break;
+    default:
+        return -1;
+    }
+    return out->flg_err?-1:0;
+}
+
+/**
+ * \brief the handler to write the RTCM 3 frame, see ublox_demux_set()
+ * \param userdata: the writer, ublox_out_t
+ * \param buffer_in: the verified frame
+ * \param sz_in: the byte size of the frame
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The text formats have the message type and the length of the payload.
+ */
+int
+ublox_out_rtcm3_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_out_t * out = (ublox_out_t *)userdata;
+    size_t count = UBLOX_RTCM3_LENGTH(buffer_in);
+    uint32_t type = 0;
+
+    assert (NULL != out);
+    assert (sz_in >= UBLOX_RTCM3_LENGTH_MIN);
+    if (count >= 2) {
+        type = ublox_getbitu(buffer_in + UBLOX_RTCM3_LENGTH_HDR, 0, 12);
+    }
+    switch (out->format) {
+    case UBLOX_OUT_TEXT:
+        ublox_out_put_str(out, "rtcm3 ");
+        ublox_out_put_uint(out, type);
+        ublox_out_put_str(out, ":\n\tlength: ");
+        ublox_out_put_uint(out, count);
+        ublox_out_put_str(out, "\n");
+        break;
+    case UBLOX_OUT_JSONL:
+        ublox_out_put_str(out, "{\"msg\":\"RTCM3\"");
+        UBLOX_JSON_INT(out, "len", count);
+        UBLOX_JSON_INT(out, "type", type);
+        ublox_out_put_str(out, "}\n");
+        break;
+    case UBLOX_OUT_CSV:
+        ublox_out_put_str(out, "RTCM3");
+        UBLOX_CSV_INT(out, count);
+        UBLOX_CSV_INT(out, type);
+        ublox_out_put_str(out, "\n");
+        break;
+    case UBLOX_OUT_BIN:
+        ublox_out_write(out, buffer_in, sz_in);
+        break;
+    default:
+        return -1;
+    }
+    return out->flg_err?-1:0;
+}
+
+/**
+ * \brief set the handlers of the demultiplexer to write all of the frames
+ * \param dmx: the demultiplexer
+ * \param reg: the registry of the UBX packets, see ublox_registry_add_writer()
+ * \param out: the writer of the NMEA sentences and the RTCM 3 frames
+ */
+void
+ublox_demux_add_writer(ublox_demux_t * dmx, ublox_registry_t * reg, ublox_out_t * out)
+{
+    ublox_demux_set(dmx, UBLOX_PROTO_UBX, ublox_registry_handler, reg);
+    ublox_demux_set(dmx, UBLOX_PROTO_NMEA, ublox_out_nmea_handler, out);
+    ublox_demux_set(dmx, UBLOX_PROTO_RTCM3, ublox_out_rtcm3_handler, out);
+}
+
+#undef UBLOX_CSV_DBL
+#undef UBLOX_CSV_INT
+#undef UBLOX_JSON_DBL
+#undef UBLOX_JSON_INT
+#undef UBLOX_JSON_KEY
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+TEST_CASE( .name="ublox-out", .description="Test ublox buffered writer and output formats." ) {
+    uint8_t buffer[8 + 16 + 32 * 2];
+    uint8_t * payload = buffer + UBLOX_PKT_LENGTH_HDR;
+    ublox_out_t out;
+    ublox_registry_t reg;
+    size_t sz_processed;
+    size_t sz_pkt;
+    int fds[2];
+    char line[2048];
+    ssize_t ret;
+
+    // RXM-RAWX with 2 measurements
+    memset(buffer, 0, sizeof(buffer));
+    buffer[0] = 0xB5;
+    buffer[1] = 0x62;
+    buffer[2] = (UBX_RXM_RAWX >> 8) & 0xFF;
+    buffer[3] = UBX_RXM_RAWX & 0xFF;
+    buffer[4] = 16 + 32 * 2;
+    {
+        double tow = 345600.5;
+        double pr = 21000000.25;
+        memmove(payload, &tow, 8);
+        payload[8] = 0x2A; payload[9] = 0x08; // week 2090
+        payload[10] = 18;
+        payload[11] = 2;
+        memmove(payload + 16, &pr, 8);
+        payload[16 + 20] = 0; payload[16 + 21] = 5; // GPS 5
+        payload[16 + 26] = 40;
+        payload[16 + 32 + 20] = 6; payload[16 + 32 + 21] = 3; // GLONASS 3
+    }
+    sz_pkt = sizeof(buffer);
+    {
+        ublox_cksum_t st;
+        ublox_cksum_init(&st);
+        ublox_cksum_update(&st, buffer + 2, sz_pkt - 4);
+        ublox_cksum_final(&st, buffer + sz_pkt - 2);
+    }
+
+    SECTION("test ublox_out_cstr2format") {
+        REQUIRE(UBLOX_OUT_TEXT == ublox_out_cstr2format("text"));
+        REQUIRE(UBLOX_OUT_JSONL == ublox_out_cstr2format("jsonl"));
+        REQUIRE(UBLOX_OUT_CSV == ublox_out_cstr2format("csv"));
+        REQUIRE(UBLOX_OUT_BIN == ublox_out_cstr2format("bin"));
+        REQUIRE(0 > ublox_out_cstr2format("xml"));
+    }
+
+    SECTION("test the memory mode") {
+        size_t i;
+        REQUIRE(0 == ublox_out_init(&out, -1, UBLOX_OUT_JSONL, NULL, 0));
+        for (i = 0; i < 1000; i ++) {
+            REQUIRE(0 == ublox_out_packet(&out, buffer, sz_pkt));
+        }
+        REQUIRE(out.sz_data > out.sz_buf / 2);
+        REQUIRE(0 == out.num_write);
+        REQUIRE(NULL != memmem(out.buf, out.sz_data, "{\"msg\":\"UBX_RXM_RAWX\",\"len\":80,\"rcvTow\":345600.5,\"week\":2090,\"leapS\":18,\"recStat\":0,\"meas\":[{\"gnssId\":0,\"svId\":5,\"freqId\":0,\"prMes\":21000000.25,", 128));
+        ublox_out_clear(&out);
+    }
+
+#if defined(UBLOX_OUT_FD_ENABLED)
+    SECTION("test the formats") {
+        REQUIRE(0 == pipe(fds));
+        REQUIRE(0 == ublox_out_init(&out, fds[1], UBLOX_OUT_CSV, NULL, 0));
+        ublox_registry_init(&reg);
+        REQUIRE(0 == ublox_registry_add_writer(&reg, &out));
+        REQUIRE(0 == ublox_out_header(&out));
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, sz_pkt, &sz_processed));
+        REQUIRE(0 == out.num_write);
+        REQUIRE(0 == ublox_out_flush(&out));
+        REQUIRE(1 == out.num_write);
+        ret = read(fds[0], line, sizeof(line) - 1);
+        REQUIRE(ret > 0);
+        line[ret] = 0;
+        REQUIRE(NULL != strstr(line, "\nUBX_RXM_RAWX,345600.5,2090,18,0,0,5,0,21000000.25,0,0,0,40,0,0,0,0\nUBX_RXM_RAWX,345600.5,2090,18,0,6,3,0,0,"));
+
+        // the text printer writes to the same buffer
+        out.format = UBLOX_OUT_TEXT;
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, sz_pkt, &sz_processed));
+        ublox_out_put_str(&out, "end\n");
+        REQUIRE(0 == ublox_out_flush(&out));
+#if defined(UBLOX_OUT_COOKIE_ENABLED)
+        REQUIRE(2 == out.num_write);
+#endif
+        ret = read(fds[0], line, sizeof(line) - 1);
+        REQUIRE(ret > 0);
+        line[ret] = 0;
+        REQUIRE(0 == strncmp(line, "ublox UBX_RXM_RAWX:\n", 20));
+        REQUIRE(0 == strcmp(line + ret - 4, "end\n"));
+
+        out.format = UBLOX_OUT_BIN;
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, sz_pkt, &sz_processed));
+        REQUIRE(0 == ublox_out_flush(&out));
+        REQUIRE(sz_pkt == (size_t)read(fds[0], line, sizeof(line)));
+        REQUIRE(0 == memcmp(line, buffer, sz_pkt));
+
+        ublox_registry_clear(&reg);
+        ublox_out_clear(&out);
+        close(fds[0]);
+        close(fds[1]);
+    }
+#endif
+
+    SECTION("test the output stream") {
+        FILE * fp = tmpfile();
+        REQUIRE(NULL != fp);
+        REQUIRE(0 > ublox_out_init_fp(&out, NULL, UBLOX_OUT_CSV, NULL, 0));
+        REQUIRE(0 == ublox_out_init_fp(&out, fp, UBLOX_OUT_CSV, NULL, 0));
+        ublox_registry_init(&reg);
+        REQUIRE(0 == ublox_registry_add_writer(&reg, &out));
+        REQUIRE(0 == ublox_out_header(&out));
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, sz_pkt, &sz_processed));
+        REQUIRE(0 == out.num_write);
+        // the text printer and the buffer are in order
+        out.format = UBLOX_OUT_TEXT;
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, sz_pkt, &sz_processed));
+        ublox_out_put_str(&out, "end\n");
+        REQUIRE(0 == ublox_out_flush(&out));
+        REQUIRE(out.num_write > 0);
+        ublox_registry_clear(&reg);
+        ublox_out_clear(&out);
+
+        rewind(fp);
+        ret = fread(line, 1, sizeof(line) - 1, fp);
+        REQUIRE(ret > 0);
+        line[ret] = 0;
+        REQUIRE(NULL != strstr(line, "\nUBX_RXM_RAWX,345600.5,2090,18,0,0,5,0,21000000.25,0,0,0,40,0,0,0,0\nUBX_RXM_RAWX,345600.5,2090,18,0,6,3,0,0,"));
+        REQUIRE(NULL != strstr(line, ",0\nublox UBX_RXM_RAWX:\n"));
+        REQUIRE(0 == strcmp(line + ret - 4, "end\n"));
+        fclose(fp);
+    }
+
+    SECTION("test the strings of MON-VER") {
+        static const char sw[] = "ROM \"CORE\" 3.01\\";
+        static const char hw[] = "0008\0010000";
+        uint8_t pkt[UBLOX_PKT_LENGTH_MIN + UBLOX_MON_VER_LEN_SW + UBLOX_MON_VER_LEN_HW];
+        ublox_cksum_t st;
+
+        memset(pkt, 0, sizeof(pkt));
+        pkt[0] = 0xB5;
+        pkt[1] = 0x62;
+        pkt[2] = UBLOX_2CLASS(UBX_MON_VER);
+        pkt[3] = UBLOX_2ID(UBX_MON_VER);
+        pkt[4] = UBLOX_MON_VER_LEN_SW + UBLOX_MON_VER_LEN_HW;
+        memmove(pkt + UBLOX_PKT_LENGTH_HDR, sw, strlen(sw));
+        memmove(pkt + UBLOX_PKT_LENGTH_HDR + UBLOX_MON_VER_LEN_SW, hw, strlen(hw));
+        ublox_cksum_init(&st);
+        ublox_cksum_update(&st, pkt + 2, sizeof(pkt) - 4);
+        ublox_cksum_final(&st, pkt + sizeof(pkt) - 2);
+
+        REQUIRE(0 == ublox_out_init(&out, -1, UBLOX_OUT_JSONL, NULL, 0));
+        REQUIRE(0 == ublox_out_packet(&out, pkt, sizeof(pkt)));
+        REQUIRE(NULL != memmem(out.buf, out.sz_data, ",\"swVersion\":\"ROM \\\"CORE\\\" 3.01\\\\\",\"hwVersion\":\"0008\\u00010000\"}\n", 65));
+        ublox_out_clear(&out);
+    }
+
+    SECTION("test the NMEA and RTCM 3 writers") {
+        static const char nmea[] = "$GPTXT,01,01,02,\"A\"*0C\r\n";
+        uint8_t rtcm[UBLOX_RTCM3_LENGTH_MIN + 4] = { 0xD3, 0x00, 0x04 };
+        ublox_demux_t dmx;
+        uint8_t data[128];
+        size_t sz_data;
+
+        ublox_setbitu(rtcm + UBLOX_RTCM3_LENGTH_HDR, 0, 12, 1230);
+        ublox_setbitu(rtcm + UBLOX_RTCM3_LENGTH_HDR + 4, 0, 24, ublox_crc24q(rtcm, UBLOX_RTCM3_LENGTH_HDR + 4));
+        sz_data = strlen(nmea);
+        memmove(data, nmea, sz_data);
+        memmove(data + sz_data, rtcm, sizeof(rtcm));
+        sz_data += sizeof(rtcm);
+        memmove(data + sz_data, buffer, 8); // the partial UBX packet is kept
+        sz_data += 8;
+
+        REQUIRE(0 == ublox_out_init(&out, -1, UBLOX_OUT_JSONL, NULL, 0));
+        ublox_registry_init(&reg);
+        REQUIRE(0 == ublox_registry_add_writer(&reg, &out));
+        ublox_demux_init(&dmx);
+        ublox_demux_add_writer(&dmx, &reg, &out);
+        REQUIRE(sz_data - 8 == ublox_demux_process(&dmx, data, sz_data, sz_data));
+        REQUIRE(1 == dmx.num_frames[UBLOX_PROTO_NMEA]);
+        REQUIRE(1 == dmx.num_frames[UBLOX_PROTO_RTCM3]);
+        REQUIRE(NULL != memmem(out.buf, out.sz_data, "{\"msg\":\"NMEA\",\"len\":22,\"sentence\":\"$GPTXT,01,01,02,\\\"A\\\"*0C\"}\n{\"msg\":\"RTCM3\",\"len\":4,\"type\":1230}\n", 98));
+
+        out.sz_data = 0;
+        out.format = UBLOX_OUT_CSV;
+        ublox_demux_process(&dmx, data, sz_data, sz_data);
+        REQUIRE(NULL != memmem(out.buf, out.sz_data, "NMEA,\"$GPTXT,01,01,02,\"\"A\"\"*0C\"\nRTCM3,4,1230\n", 45));
+
+        out.sz_data = 0;
+        out.format = UBLOX_OUT_BIN;
+        ublox_demux_process(&dmx, data, sz_data, sz_data);
+        REQUIRE(sz_data - 8 == out.sz_data);
+        REQUIRE(0 == memcmp(out.buf, data, out.sz_data));
+
+        ublox_registry_clear(&reg);
+        ublox_out_clear(&out);
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,85 @@
+/**
+ * \file    ubloxout.h
+ * \brief   The buffered writer and the output formats of the decoded packets
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_OUT_H
+#define UBLOX_OUT_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxreg.h"
+#include "ubloxdmx.h"
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#define UBLOX_OUT_FD_ENABLED 1 /**< write() is available */
+#endif
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#define UBLOX_OUT_COOKIE_ENABLED 1 /**< fopencookie() is available */
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_OUT_TEXT  0 /**< the text of ublox_print_packet() */
+#define UBLOX_OUT_JSONL 1 /**< one JSON object per line for each packet */
+#define UBLOX_OUT_CSV   2 /**< one row per packet, or per measurement of RXM-RAWX/RXM-RAW */
+#define UBLOX_OUT_BIN   3 /**< the verified frames, unchanged */
+
+/**
+ * The buffered writer. The output is appended to one large buffer and
+ * written to the file descriptor by one write() when the buffer is full or
+ * flushed. If the file descriptor is <0, the buffer grows and keeps all of
+ * the output in the memory, such as the output of a chunk decoded by a thread.
+ * Without write(), such as Arduino or Windows, the output is written to a
+ * stream by fwrite(), see ublox_out_init_fp().
+ */
+typedef struct _ublox_out_t {
+    int fd;          /**< the output, <0 to keep the output in the memory */
+    int format;      /**< UBLOX_OUT_xxx */
+    uint8_t * buf;
+    size_t sz_buf;
+    size_t sz_data;  /**< the bytes in buf */
+    uint8_t flg_own; /**< 1 if buf is allocated by the writer */
+    uint8_t flg_err; /**< 1 if a write() or an allocation failed */
+    FILE * fp;       /**< the stream to the buffer for the text printers, see ublox_out_fp() */
+    FILE * fp_out;   /**< the output stream instead of fd, NULL if not used */
+    uint8_t flg_fp_own; /**< 1 if fp_out is opened by the writer */
+    size_t num_write; /**< the number of write() */
+} ublox_out_t;
+
+int ublox_out_init(ublox_out_t * out, int fd, int format, uint8_t * buf, size_t sz_buf);
+int ublox_out_init_fp(ublox_out_t * out, FILE * fp, int format, uint8_t * buf, size_t sz_buf);
+void ublox_out_clear(ublox_out_t * out);
+int ublox_out_flush(ublox_out_t * out);
+uint8_t * ublox_out_reserve(ublox_out_t * out, size_t sz);
+int ublox_out_write(ublox_out_t * out, const void * data, size_t sz);
+FILE * ublox_out_fp(ublox_out_t * out);
+
+void ublox_out_put_str(ublox_out_t * out, const char * cstr);
+void ublox_out_put_int(ublox_out_t * out, int64_t val);
+void ublox_out_put_uint(ublox_out_t * out, uint64_t val);
+void ublox_out_put_hex(ublox_out_t * out, uint32_t val, size_t width);
+void ublox_out_put_double(ublox_out_t * out, double val);
+
+int ublox_out_cstr2format(const char * cstr);
+const char * ublox_out_format2cstr(int format);
+
+int ublox_out_header(ublox_out_t * out);
+int ublox_out_packet(ublox_out_t * out, const uint8_t * buffer_in, size_t sz_in);
+int ublox_out_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_registry_add_writer(ublox_registry_t * reg, ublox_out_t * out);
+int ublox_out_nmea_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_out_rtcm3_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+void ublox_demux_add_writer(ublox_demux_t * dmx, ublox_registry_t * reg, ublox_out_t * out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_OUT_H */
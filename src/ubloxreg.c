@@ -0,0 +1,227 @@
+/**
+ * \file    ubloxreg.c
+ * \brief   The handlers of UBX packets registered by class/id
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#include <stdlib.h> // free()
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxreg.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/**
+ * \brief setup the empty registry
+ * \param reg: the registry
+ */
+void
+ublox_registry_init(ublox_registry_t * reg)
+{
+    assert (NULL != reg);
+    memset(reg, 0, sizeof(*reg));
+}
+
+/**
+ * \brief remove all of the handlers and free the memory
+ * \param reg: the registry
+ */
+void
+ublox_registry_clear(ublox_registry_t * reg)
+{
+    size_t i;
+    assert (NULL != reg);
+    for (i = 0; i < NUM_ARRAY(reg->classes); i ++) {
+        if (NULL != reg->classes[i]) {
+            free(reg->classes[i]);
+            reg->classes[i] = NULL;
+        }
+    }
+    reg->fallback.handler = NULL;
+    reg->fallback.userdata = NULL;
+}
+
+/**
+ * \brief register the handler of a class/id
+ * \param reg: the registry
+ * \param classid: the class/id, UBLOX_CLASS_ID(class, id)
+ * \param handler: the handler, NULL to remove the handler
+ * \param userdata: the user data passed to the handler
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_registry_set(ublox_registry_t * reg, uint16_t classid, ublox_handler_t handler, void * userdata)
+{
+    ublox_handler_entry_t * row;
+
+    if (NULL == reg) {
+        TE("registry nullptr");
+        return -1;
+    }
+    row = reg->classes[UBLOX_2CLASS(classid)];
+    if (NULL == row) {
+        if (NULL == handler) {
+            return 0;
+        }
+        row = (ublox_handler_entry_t *)calloc(UBLOX_REG_NUM_ID, sizeof(*row));
+        if (NULL == row) {
+            TE("out of memory");
+            return -1;
+        }
+        reg->classes[UBLOX_2CLASS(classid)] = row;
+    }
+    row[UBLOX_2ID(classid)].handler = handler;
+    row[UBLOX_2ID(classid)].userdata = (handler?userdata:NULL);
+    return 0;
+}
+
+/**
+ * \brief set the handler of the packets which have no handler
+ * \param reg: the registry
+ * \param handler: the handler, NULL to skip these packets
+ * \param userdata: the user data passed to the handler
+ */
+void
+ublox_registry_set_fallback(ublox_registry_t * reg, ublox_handler_t handler, void * userdata)
+{
+    assert (NULL != reg);
+    reg->fallback.handler = handler;
+    reg->fallback.userdata = (handler?userdata:NULL);
+}
+
+/**
+ * \brief get the handler of a class/id
+ * \param reg: the registry
+ * \param classid: the class/id
+ *
+ * \return the entry, NULL if not registered
+ */
+const ublox_handler_entry_t *
+ublox_registry_get(const ublox_registry_t * reg, uint16_t classid)
+{
+    const ublox_handler_entry_t * row;
+
+    assert (NULL != reg);
+    row = reg->classes[UBLOX_2CLASS(classid)];
+    if ((NULL == row) || (NULL == row[UBLOX_2ID(classid)].handler)) {
+        return NULL;
+    }
+    return row + UBLOX_2ID(classid);
+}
+
+/**
+ * \brief call the handler of the packet
+ * \param reg: the registry
+ * \param buffer_in: the verified packet
+ * \param sz_in: the byte size of the buffer
+ * \param sz_processed: the byte size of the packet
+ *
+ * \return <0 the packet is incomplete, or the error from the handler;
+ *         =2 no handler, the packet is skipped;
+ *         =0 on success
+ */
+int
+ublox_registry_dispatch(const ublox_registry_t * reg, const uint8_t * buffer_in, size_t sz_in, size_t * sz_processed)
+{
+    const ublox_handler_entry_t * row;
+    const ublox_handler_entry_t * entry;
+    size_t sz;
+
+    assert (NULL != reg);
+    assert (NULL != sz_processed);
+    *sz_processed = 0;
+    if ((NULL == buffer_in) || (sz_in < UBLOX_PKT_LENGTH_MIN)) {
+        return -1;
+    }
+    sz = UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(buffer_in);
+    if (sz > sz_in) {
+        return -1;
+    }
+    *sz_processed = sz;
+
+    row = reg->classes[buffer_in[2]];
+    entry = &(reg->fallback);
+    if ((NULL != row) && (NULL != row[buffer_in[3]].handler)) {
+        entry = row + buffer_in[3];
+    }
+    if (NULL == entry->handler) {
+        return 2;
+    }
+    return entry->handler(entry->userdata, buffer_in, sz);
+}
+
+/**
+ * \brief the handler to dispatch the packet by the registry, such as the UBX handler of ublox_demux_t
+ * \param userdata: the registry, ublox_registry_t
+ * \param buffer_in: the verified packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success or no handler, <0 on error
+ */
+int
+ublox_registry_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    size_t sz_processed;
+    int ret;
+    ret = ublox_registry_dispatch((const ublox_registry_t *)userdata, buffer_in, sz_in, &sz_processed);
+    return (ret < 0)?ret:0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+static int
+ublox_registry_test_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    int * pcnt = (int *)userdata;
+    (*pcnt) += (int)sz_in;
+    return 0;
+}
+
+TEST_CASE( .name="ublox-registry", .description="Test ublox handler registry." ) {
+    ublox_registry_t reg;
+    uint8_t buffer[40];
+    size_t sz_processed;
+    ssize_t ret;
+    int cnt_rate = 0;
+    int cnt_other = 0;
+
+    SECTION("test ublox registry dispatch") {
+        ublox_registry_init(&reg);
+        REQUIRE(NULL == ublox_registry_get(&reg, UBX_CFG_RATE));
+        REQUIRE(0 == ublox_registry_set(&reg, UBX_CFG_RATE, ublox_registry_test_handler, &cnt_rate));
+        REQUIRE(NULL != ublox_registry_get(&reg, UBX_CFG_RATE));
+        REQUIRE(NULL == ublox_registry_get(&reg, UBX_CFG_PRT));
+
+        ret = ublox_pkt_create_set_cfgrate(buffer, sizeof(buffer), 100, 1, 1);
+        REQUIRE(ret > 0);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, sizeof(buffer), &sz_processed));
+        REQUIRE(ret == sz_processed);
+        REQUIRE(ret == cnt_rate);
+        REQUIRE(0 > ublox_registry_dispatch(&reg, buffer, ret - 1, &sz_processed));
+
+        // no handler, skip the packet
+        ret = ublox_pkt_create_get_version(buffer, sizeof(buffer));
+        REQUIRE(ret > 0);
+        REQUIRE(2 == ublox_registry_dispatch(&reg, buffer, ret, &sz_processed));
+        REQUIRE(ret == sz_processed);
+
+        ublox_registry_set_fallback(&reg, ublox_registry_test_handler, &cnt_other);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, buffer, ret, &sz_processed));
+        REQUIRE(ret == cnt_other);
+
+        // remove
+        REQUIRE(0 == ublox_registry_set(&reg, UBX_CFG_RATE, NULL, NULL));
+        REQUIRE(NULL == ublox_registry_get(&reg, UBX_CFG_RATE));
+        ublox_registry_clear(&reg);
+        REQUIRE(2 == ublox_registry_dispatch(&reg, buffer, ret, &sz_processed));
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,58 @@
+/**
+ * \file    ubloxreg.h
+ * \brief   The handlers of UBX packets registered by class/id
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_REG_H
+#define UBLOX_REG_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief the handler of a packet
+ * \param userdata: the user data registered with the handler
+ * \param buffer_in: the verified packet, including the header and the checksum
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+typedef int (* ublox_handler_t)(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+typedef struct _ublox_handler_entry_t {
+    ublox_handler_t handler;
+    void * userdata;
+} ublox_handler_entry_t;
+
+#define UBLOX_REG_NUM_ID 256
+
+/**
+ * The two level table indexed by class and id. The 256 ids of a class are
+ * allocated when the first handler of the class is registered.
+ */
+typedef struct _ublox_registry_t {
+    ublox_handler_entry_t * classes[256];
+    ublox_handler_entry_t fallback; /**< called if no handler of the class/id, can be NULL */
+} ublox_registry_t;
+
+void ublox_registry_init(ublox_registry_t * reg);
+void ublox_registry_clear(ublox_registry_t * reg);
+int ublox_registry_set(ublox_registry_t * reg, uint16_t classid, ublox_handler_t handler, void * userdata);
+void ublox_registry_set_fallback(ublox_registry_t * reg, ublox_handler_t handler, void * userdata);
+const ublox_handler_entry_t * ublox_registry_get(const ublox_registry_t * reg, uint16_t classid);
+int ublox_registry_dispatch(const ublox_registry_t * reg, const uint8_t * buffer_in, size_t sz_in, size_t * sz_processed);
+int ublox_registry_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_REG_H */
@@ -0,0 +1,383 @@
+/**
+ * \file    ubloxring.c
+ * \brief   Ring buffer and UBX framer for the received stream
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#include "ubloxconn.h"
+#include "ubloxring.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_RING_BYTE(ring, off) ((ring)->buffer[((ring)->pos_read + (off)) & ((ring)->sz_buf - 1)])
+
+/**
+ * \brief setup the ring buffer
+ * \param ring: the ring
+ * \param buffer: the storage of the ring
+ * \param sz_buf: the size of the storage, should be power of 2
+ * \param buf_linear: the buffer to store the frame which straddles the wrap point
+ * \param sz_linear: the size of buf_linear, the max frame size at the wrap point
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_ring_init(ublox_ring_t * ring, uint8_t * buffer, size_t sz_buf, uint8_t * buf_linear, size_t sz_linear)
+{
+    if ((NULL == ring) || (NULL == buffer)) {
+        TE("ring nullptr");
+        return -1;
+    }
+    if ((sz_buf < UBLOX_PKT_LENGTH_MIN) || (0 != (sz_buf & (sz_buf - 1)))) {
+        TE("the ring size should be power of 2: %" PRIuSZ, sz_buf);
+        return -1;
+    }
+    if (NULL == buf_linear) {
+        sz_linear = 0;
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->buffer = buffer;
+    ring->sz_buf = sz_buf;
+    ring->buf_linear = buf_linear;
+    ring->sz_linear = sz_linear;
+    return 0;
+}
+
+/**
+ * \brief drop all of the data in the ring
+ * \param ring: the ring
+ */
+void
+ublox_ring_reset(ublox_ring_t * ring)
+{
+    assert (NULL != ring);
+    ring->pos_read = 0;
+    ring->pos_write = 0;
+    ring->pos_frame = 0;
+    ring->pos_cksum = 0;
+}
+
+/**
+ * \brief get the contiguous free space of the ring to be filled by the caller
+ * \param ring: the ring
+ * \param psz_space: return the byte size of the contiguous free space
+ *
+ * \return the pointer to the free space
+ *
+ * The caller fills the data (for example by read()) and then calls ublox_ring_commit().
+ */
+uint8_t *
+ublox_ring_write_ptr(ublox_ring_t * ring, size_t * psz_space)
+{
+    size_t idx;
+    size_t sz;
+
+    assert (NULL != ring);
+    assert (NULL != psz_space);
+    idx = ring->pos_write & (ring->sz_buf - 1);
+    sz = ring->sz_buf - idx;
+    if (sz > ublox_ring_space(ring)) {
+        sz = ublox_ring_space(ring);
+    }
+    *psz_space = sz;
+    return ring->buffer + idx;
+}
+
+/**
+ * \brief append the data filled in the space returned by ublox_ring_write_ptr()
+ * \param ring: the ring
+ * \param sz: the byte size of the data filled
+ */
+void
+ublox_ring_commit(ublox_ring_t * ring, size_t sz)
+{
+    assert (NULL != ring);
+    assert (sz <= ublox_ring_space(ring));
+    ring->pos_write += sz;
+}
+
+/**
+ * \brief copy the data to the ring
+ * \param ring: the ring
+ * \param data: the data
+ * \param sz: the byte size of the data
+ *
+ * \return the byte size of the data stored, it's less than sz if the ring is full
+ */
+size_t
+ublox_ring_write(ublox_ring_t * ring, const uint8_t * data, size_t sz)
+{
+    size_t sz_done = 0;
+    size_t sz_seg;
+    uint8_t * p;
+
+    assert (NULL != ring);
+    while (sz_done < sz) {
+        p = ublox_ring_write_ptr(ring, &sz_seg);
+        if (sz_seg < 1) {
+            break;
+        }
+        if (sz_seg > sz - sz_done) {
+            sz_seg = sz - sz_done;
+        }
+        memmove(p, data + sz_done, sz_seg);
+        ublox_ring_commit(ring, sz_seg);
+        sz_done += sz_seg;
+    }
+    return sz_done;
+}
+
+/**
+ * \brief remove the data from the head of the ring
+ * \param ring: the ring
+ * \param sz: the byte size of data processed
+ */
+void
+ublox_ring_consume(ublox_ring_t * ring, size_t sz)
+{
+    assert (NULL != ring);
+    if (sz > ublox_ring_size(ring)) {
+        sz = ublox_ring_size(ring);
+    }
+    ring->pos_read += sz;
+}
+
+/**
+ * \brief add the data of the packet at the head of the ring to the checksum
+ * \param ring: the ring
+ * \param pos_end: the position of the data summed up to
+ */
+static void
+ublox_ring_cksum_feed(ublox_ring_t * ring, size_t pos_end)
+{
+    size_t idx;
+    size_t sz;
+
+    if ((ring->pos_frame != ring->pos_read) || (ring->pos_cksum < ring->pos_read + 2)) {
+        // a new packet, skip the header 0xB5 0x62
+        ublox_cksum_init(&(ring->cksum));
+        ring->pos_frame = ring->pos_read;
+        ring->pos_cksum = ring->pos_read + 2;
+    }
+    while (ring->pos_cksum < pos_end) {
+        idx = ring->pos_cksum & (ring->sz_buf - 1);
+        sz = ring->sz_buf - idx;
+        if (sz > pos_end - ring->pos_cksum) {
+            sz = pos_end - ring->pos_cksum;
+        }
+        ublox_cksum_update(&(ring->cksum), ring->buffer + idx, sz);
+        ring->pos_cksum += sz;
+    }
+}
+
+/**
+ * \brief skip the data until the header of UBX packet, and get the view of the packet
+ * \param ring: the ring
+ * \param p_frame: return the pointer to the packet
+ * \param psz_frame: return the byte size of the packet
+ * \param psz_needed_in: the bytes size of data need to append to the ring
+ *
+ * \return =2 the packet can't be stored in the ring or the linear buffer, or the checksum is wrong, the header was skipped;
+ *         =1 need more data, the byte size need data is stored in psz_needed_in;
+ *         =0 on successs, the packet is at p_frame
+ *
+ * The data before the header is removed from the ring. The packet is not removed,
+ * the caller should call ublox_ring_consume() with the size processed.
+ * The view is valid until the next write to the ring.
+ */
+int
+ublox_ring_peek_frame(ublox_ring_t * ring, uint8_t ** p_frame, size_t * psz_frame, size_t * psz_needed_in)
+{
+    size_t sz_data;
+    size_t sz_seg;
+    size_t sz_frame;
+    size_t idx;
+    uint8_t * p;
+    uint8_t ck[2];
+
+    assert (NULL != ring);
+    assert (NULL != p_frame);
+    assert (NULL != psz_frame);
+    assert (NULL != psz_needed_in);
+    *p_frame = NULL;
+    *psz_frame = 0;
+    *psz_needed_in = 0;
+
+    for (;;) {
+        sz_data = ublox_ring_size(ring);
+        if (sz_data < 1) {
+            *psz_needed_in = UBLOX_PKT_LENGTH_MIN;
+            return 1;
+        }
+        idx = ring->pos_read & (ring->sz_buf - 1);
+        sz_seg = ring->sz_buf - idx;
+        if (sz_seg > sz_data) {
+            sz_seg = sz_data;
+        }
+        p = ring->buffer + idx + ublox_pkt_find_sync(ring->buffer + idx, sz_seg);
+        if (p >= ring->buffer + idx + sz_seg) {
+            ring->pos_read += sz_seg;
+            continue;
+        }
+        ring->pos_read += p - (ring->buffer + idx);
+        sz_data -= p - (ring->buffer + idx);
+        if (sz_data < 2) {
+            *psz_needed_in = UBLOX_PKT_LENGTH_MIN - sz_data;
+            return 1;
+        }
+        if (0x62 == UBLOX_RING_BYTE(ring, 1)) {
+            break;
+        }
+        // search again
+        ring->pos_read ++;
+    }
+
+    if (sz_data < UBLOX_PKT_LENGTH_HDR) {
+        *psz_needed_in = UBLOX_PKT_LENGTH_MIN - sz_data;
+        return 1;
+    }
+    sz_frame = UBLOX_PKT_LENGTH_MIN + ((size_t)UBLOX_RING_BYTE(ring, 4) | ((size_t)UBLOX_RING_BYTE(ring, 5) << 8));
+    if (sz_frame > ring->sz_buf) {
+        TW("ublox ring: packet size %" PRIuSZ " > ring size %" PRIuSZ ", skip", sz_frame, ring->sz_buf);
+        ring->pos_read ++;
+        return 2;
+    }
+    // the checksum covers the bytes between the header and the checksum
+    ublox_ring_cksum_feed(ring, ring->pos_read + ((sz_data < sz_frame - 2)?sz_data:(sz_frame - 2)));
+    if (sz_data < sz_frame) {
+        *psz_needed_in = sz_frame - sz_data;
+        return 1;
+    }
+    ublox_cksum_final(&(ring->cksum), ck);
+    if ((ck[0] != UBLOX_RING_BYTE(ring, sz_frame - 2)) || (ck[1] != UBLOX_RING_BYTE(ring, sz_frame - 1))) {
+        TW("ublox ring: checksum error, size %" PRIuSZ ", skip", sz_frame);
+        ring->pos_read ++;
+        return 2;
+    }
+
+    idx = ring->pos_read & (ring->sz_buf - 1);
+    if (idx + sz_frame <= ring->sz_buf) {
+        *p_frame = ring->buffer + idx;
+    } else {
+        // the packet straddles the wrap point
+        if (sz_frame > ring->sz_linear) {
+            TW("ublox ring: packet size %" PRIuSZ " > linear buffer size %" PRIuSZ ", skip", sz_frame, ring->sz_linear);
+            ring->pos_read ++;
+            return 2;
+        }
+        sz_seg = ring->sz_buf - idx;
+        memmove(ring->buf_linear, ring->buffer + idx, sz_seg);
+        memmove(ring->buf_linear + sz_seg, ring->buffer, sz_frame - sz_seg);
+        *p_frame = ring->buf_linear;
+    }
+    *psz_frame = sz_frame;
+    return 0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+TEST_CASE( .name="ublox-ring", .description="Test ublox ring buffer and framer." ) {
+    uint8_t buf_ring[64];
+    uint8_t buf_linear[64];
+    uint8_t stream[400];
+    uint8_t * p_frame;
+    size_t sz_frame;
+    size_t sz_needed_in;
+    size_t sz_stream = 0;
+    size_t pos_in = 0;
+    size_t num_frames = 0;
+    ssize_t ret;
+    ublox_ring_t ring;
+    int i;
+
+    SECTION("test ublox ring parameters") {
+        REQUIRE(0 > ublox_ring_init(NULL, buf_ring, sizeof(buf_ring), NULL, 0));
+        REQUIRE(0 > ublox_ring_init(&ring, NULL, sizeof(buf_ring), NULL, 0));
+        REQUIRE(0 > ublox_ring_init(&ring, buf_ring, 60, NULL, 0));
+        REQUIRE(0 == ublox_ring_init(&ring, buf_ring, sizeof(buf_ring), NULL, 0));
+        REQUIRE(0 == ublox_ring_size(&ring));
+        REQUIRE(sizeof(buf_ring) == ublox_ring_space(&ring));
+        REQUIRE(1 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed_in));
+        REQUIRE(UBLOX_PKT_LENGTH_MIN == sz_needed_in);
+    }
+
+    SECTION("test ublox ring header") {
+        REQUIRE(0 == ublox_ring_init(&ring, buf_ring, sizeof(buf_ring), buf_linear, sizeof(buf_linear)));
+        stream[0] = 0x00; stream[1] = 0xB5; stream[2] = 0x00; stream[3] = 0xB5;
+        REQUIRE(4 == ublox_ring_write(&ring, stream, 4));
+        REQUIRE(1 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed_in));
+        REQUIRE(7 == sz_needed_in);
+        REQUIRE(1 == ublox_ring_size(&ring));
+        stream[0] = 0x62; stream[1] = 0x0A; stream[2] = 0x04; stream[3] = 0x00;
+        REQUIRE(4 == ublox_ring_write(&ring, stream, 4));
+        REQUIRE(1 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed_in));
+        REQUIRE(3 == sz_needed_in);
+        // the packet larger than the ring
+        stream[0] = 0xFF;
+        REQUIRE(1 == ublox_ring_write(&ring, stream, 1));
+        REQUIRE(2 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed_in));
+    }
+
+    SECTION("test ublox ring frames at the wrap point") {
+        REQUIRE(0 == ublox_ring_init(&ring, buf_ring, sizeof(buf_ring), buf_linear, sizeof(buf_linear)));
+        // a stream of packets and garbage
+        for (i = 0; sz_stream + 40 < sizeof(stream); i ++) {
+            stream[sz_stream ++] = 0xB5; // fake header
+            switch (i % 3) {
+            case 0: ret = ublox_pkt_create_get_version(stream + sz_stream, sizeof(stream) - sz_stream); break;
+            case 1: ret = ublox_pkt_create_set_cfgprt(stream + sz_stream, sizeof(stream) - sz_stream, 0x01, 0x00, 0x000008D0, 115200, 0x0027, 0x0023); break;
+            default: ret = ublox_pkt_create_set_cfgrate(stream + sz_stream, sizeof(stream) - sz_stream, 100, 1, 1); break;
+            }
+            REQUIRE(ret > 0);
+            sz_stream += ret;
+        }
+        // feed the ring with odd size of blocks
+        for (i = 0; pos_in < sz_stream; i ++) {
+            size_t sz = 1 + (i * 7) % 13;
+            if (sz > sz_stream - pos_in) {
+                sz = sz_stream - pos_in;
+            }
+            pos_in += ublox_ring_write(&ring, stream + pos_in, sz);
+            while (0 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed_in)) {
+                REQUIRE(0 == ublox_pkt_verify(p_frame, sz_frame));
+                REQUIRE(sz_frame == UBLOX_PKT_LENGTH_MIN + UBLOX_PKG_LENGTH(p_frame));
+                ublox_ring_consume(&ring, sz_frame);
+                num_frames ++;
+            }
+        }
+        CIUT_LOG("got %d frames", (int)num_frames);
+        REQUIRE(num_frames > 10);
+        REQUIRE(0 == ublox_ring_size(&ring));
+    }
+
+    SECTION("test ublox ring checksum") {
+        REQUIRE(0 == ublox_ring_init(&ring, buf_ring, sizeof(buf_ring), buf_linear, sizeof(buf_linear)));
+        ret = ublox_pkt_create_set_cfgrate(stream, sizeof(stream), 100, 1, 1);
+        REQUIRE(ret > 0);
+        sz_stream = ret;
+        memmove(stream + sz_stream, stream, sz_stream);
+        stream[sz_stream - 1] ^= 0x01; // break the first one
+        sz_stream *= 2;
+        // byte by byte, the checksum is updated at each read
+        for (pos_in = 0; pos_in < sz_stream; pos_in ++) {
+            REQUIRE(1 == ublox_ring_write(&ring, stream + pos_in, 1));
+            ret = ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed_in);
+            if (pos_in + 1 < sz_stream / 2) {
+                REQUIRE(1 == ret);
+            } else if (pos_in + 1 == sz_stream / 2) {
+                REQUIRE(2 == ret);
+            } else if (pos_in + 1 == sz_stream) {
+                REQUIRE(0 == ret);
+                REQUIRE(sz_frame == sz_stream / 2);
+                REQUIRE(0 == memcmp(p_frame, stream + sz_frame, sz_frame));
+            }
+        }
+    }
+}
+#endif /* CIUT_ENABLED */
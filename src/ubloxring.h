@@ -0,0 +1,57 @@
+/**
+ * \file    ubloxring.h
+ * \brief   Ring buffer and UBX framer for the received stream
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_RING_H
+#define UBLOX_RING_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The ring keeps the received bytes in place, the positions are free running
+ * counters and the capacity is a power of 2, so the index is (pos & mask).
+ * A frame is handed out as a (pointer, length) view into the ring; it is only
+ * copied to the linear buffer when it straddles the wrap point.
+ * The checksum of a partial frame is kept between the reads, so the bytes of a
+ * frame are summed only once.
+ */
+typedef struct _ublox_ring_t {
+    uint8_t * buffer;     /**< the storage of the ring */
+    size_t sz_buf;        /**< the capacity of the ring, power of 2 */
+    size_t pos_read;      /**< the read position (free running) */
+    size_t pos_write;     /**< the write position (free running) */
+    uint8_t * buf_linear; /**< the buffer to linearize a frame at the wrap point */
+    size_t sz_linear;     /**< the size of buf_linear */
+    ublox_cksum_t cksum;  /**< the checksum of the partial packet at pos_frame */
+    size_t pos_frame;     /**< the position of the packet which the checksum belongs to */
+    size_t pos_cksum;     /**< the position of the data summed up to */
+} ublox_ring_t;
+
+int ublox_ring_init(ublox_ring_t * ring, uint8_t * buffer, size_t sz_buf, uint8_t * buf_linear, size_t sz_linear);
+void ublox_ring_reset(ublox_ring_t * ring);
+
+#define ublox_ring_size(ring) ((size_t)((ring)->pos_write - (ring)->pos_read))
+#define ublox_ring_space(ring) ((ring)->sz_buf - ublox_ring_size(ring))
+
+uint8_t * ublox_ring_write_ptr(ublox_ring_t * ring, size_t * psz_space);
+void ublox_ring_commit(ublox_ring_t * ring, size_t sz);
+size_t ublox_ring_write(ublox_ring_t * ring, const uint8_t * data, size_t sz);
+void ublox_ring_consume(ublox_ring_t * ring, size_t sz);
+
+int ublox_ring_peek_frame(ublox_ring_t * ring, uint8_t ** p_frame, size_t * psz_frame, size_t * psz_needed_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_RING_H */
@@ -0,0 +1,775 @@
+/**
+ * \file    ubloxrnx.c
+ * \brief   RINEX 3 observation writer for RXM-RAWX and RXM-RAW
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The fields are formatted by the integer arithmetic into the buffer, no
+ * printf is called for the epochs.
+ */
+
+#include <math.h>
+#include <time.h>
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdec.h"
+#include "ubloxrnx.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_RNX_SEC_WEEK 604800
+#define UBLOX_RNX_DAYS_GPS0 3657 /**< the days from 1970-01-01 to 1980-01-06 */
+
+/** the systems in the order of the header */
+static const struct _ublox_rnx_sys_t {
+    uint8_t gnssId;
+    char sys;            /**< the system identifier of RINEX */
+    const char * types;  /**< the observation types */
+    uint8_t sigIds;      /**< the bits of the sigId of the observation types */
+} ublox_rnx_sys[] = {
+    {0, 'G', "C1C L1C D1C S1C", 0x01}, // L1C/A
+    {6, 'R', "C1C L1C D1C S1C", 0x01}, // L1OF
+    {2, 'E', "C1C L1C D1C S1C", 0x01}, // E1C
+    {3, 'C', "C2I L2I D2I S2I", 0x03}, // B1I D1 and D2
+    {5, 'J', "C1C L1C D1C S1C", 0x01}, // L1C/A
+    {1, 'S', "C1C L1C D1C S1C", 0x01}, // L1C/A
+};
+
+/**
+ * \brief check if the signal is the one of the observation types
+ * \param gnssId: the gnssId of UBX
+ * \param sigId: the sigId of UBX, 0 before the protocol version 27
+ * \return 1 if the signal is written, 0 if not
+ */
+static int
+ublox_rnx_sig(uint8_t gnssId, uint8_t sigId)
+{
+    size_t i;
+    for (i = 0; i < NUM_ARRAY(ublox_rnx_sys); i ++) {
+        if (ublox_rnx_sys[i].gnssId == gnssId) {
+            return (sigId < 8) && (0 != (ublox_rnx_sys[i].sigIds & (1 << sigId)));
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief get the RINEX identifier of a satellite
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ * \param psys: the system identifier
+ * \return the PRN of RINEX, <0 if not supported
+ */
+static int
+ublox_rnx_sat(uint8_t gnssId, uint8_t svId, char * psys)
+{
+    size_t i;
+    for (i = 0; i < NUM_ARRAY(ublox_rnx_sys); i ++) {
+        if (ublox_rnx_sys[i].gnssId == gnssId) {
+            break;
+        }
+    }
+    if (i >= NUM_ARRAY(ublox_rnx_sys)) {
+        return -1;
+    }
+    *psys = ublox_rnx_sys[i].sys;
+    switch (gnssId) {
+    case 1: // SBAS PRN 120-158
+        if ((svId < 120) || (svId > 158)) {
+            return -1;
+        }
+        return svId - 100;
+    case 5: // QZSS
+        if (svId > 192) {
+            svId -= 192;
+        }
+        break;
+    case 6: // GLONASS, 255 if the slot is unknown
+        if (svId > 32) {
+            return -1;
+        }
+        break;
+    }
+    if ((svId < 1) || (svId > 99)) {
+        return -1;
+    }
+    return svId;
+}
+
+/*****************************************************************************/
+// the formatters, return the position after the field
+
+static char *
+ublox_rnx_put_str(char * p, const char * str, size_t width)
+{
+    size_t i;
+    for (i = 0; (NULL != str) && (str[i] != 0) && (i < width); i ++) {
+        p[i] = str[i];
+    }
+    for (; i < width; i ++) {
+        p[i] = ' ';
+    }
+    return p + width;
+}
+
+/* the unsigned integer, right aligned, padded by pad; filled by '*' if overflow */
+static char *
+ublox_rnx_put_uint(char * p, uint64_t val, size_t width, char pad)
+{
+    size_t i = width;
+    do {
+        p[-- i] = '0' + (val % 10);
+        val /= 10;
+    } while ((val > 0) && (i > 0));
+    if (val > 0) {
+        memset(p, '*', width);
+        return p + width;
+    }
+    while (i > 0) {
+        p[-- i] = pad;
+    }
+    return p + width;
+}
+
+/* the fixed point number, Fortran Fw.d; filled by blanks if it is not valid or overflow */
+static char *
+ublox_rnx_put_fixed(char * p, double val, size_t width, size_t dec)
+{
+    static const double scale[] = {1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7};
+    uint64_t v;
+    int flg_neg = 0;
+    size_t i = width;
+
+    assert (dec < NUM_ARRAY(scale));
+    assert (width > dec + 2);
+    if (val < 0) {
+        flg_neg = 1;
+        val = -val;
+    }
+    val = val * scale[dec] + 0.5;
+    if (!(val < 1e17)) { // also NaN
+        memset(p, ' ', width);
+        return p + width;
+    }
+    v = (uint64_t)val;
+    for (; i > width - dec; v /= 10) {
+        p[-- i] = '0' + (v % 10);
+    }
+    p[-- i] = '.';
+    do {
+        p[-- i] = '0' + (v % 10);
+        v /= 10;
+    } while ((v > 0) && (i > 0));
+    if ((v > 0) || (flg_neg && (i < 1))) {
+        memset(p, ' ', width);
+        return p + width;
+    }
+    if (flg_neg) {
+        p[-- i] = '-';
+    }
+    while (i > 0) {
+        p[-- i] = ' ';
+    }
+    return p + width;
+}
+
+/* the header line, the content is padded to 60 characters */
+static char *
+ublox_rnx_put_header(char * p, const char * content, size_t sz_content, const char * label)
+{
+    if (sz_content > 60) {
+        sz_content = 60;
+    }
+    memmove(p, content, sz_content);
+    memset(p + sz_content, ' ', 60 - sz_content);
+    p = ublox_rnx_put_str(p + 60, label, strlen(label));
+    *p ++ = '\n';
+    return p;
+}
+
+/**
+ * \brief convert the GPS time to the calendar
+ * \param week: the GPS week
+ * \param tow: the time of week, in 1e-7 seconds
+ * \param ymdhms: the year, month, day, hour, minute and the 1e-7 seconds
+ */
+static void
+ublox_rnx_gpst2cal(int week, int64_t tow, int64_t ymdhms[6])
+{
+    int64_t t = (int64_t)week * UBLOX_RNX_SEC_WEEK * 10000000 + tow;
+    int64_t days = t / (86400LL * 10000000);
+    int64_t sec = t - days * 86400LL * 10000000;
+    int64_t era;
+    int64_t doe;
+    int64_t yoe;
+    int64_t doy;
+    int64_t mp;
+
+    // days to the civil date, from 1970-01-01
+    days += UBLOX_RNX_DAYS_GPS0 + 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    ymdhms[2] = doy - (153 * mp + 2) / 5 + 1;
+    ymdhms[1] = mp < 10 ? mp + 3 : mp - 9;
+    ymdhms[0] = yoe + era * 400 + (ymdhms[1] <= 2);
+    ymdhms[3] = sec / (3600LL * 10000000);
+    ymdhms[4] = sec / (60LL * 10000000) % 60;
+    ymdhms[5] = sec % (60LL * 10000000);
+}
+
+/*****************************************************************************/
+
+/**
+ * \brief setup the writer
+ * \param rnx: the writer
+ * \param fp: the output file
+ * \param buffer: the output buffer
+ * \param sz_buf: the size of the buffer, >= UBLOX_RNX_SZ_BUF_MIN
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_init(ublox_rnx_t * rnx, FILE * fp, char * buffer, size_t sz_buf)
+{
+    assert (NULL != rnx);
+    if ((NULL == buffer) || (sz_buf < UBLOX_RNX_SZ_BUF_MIN)) {
+        TE("no enough buffer size");
+        return -1;
+    }
+    memset(rnx, 0, sizeof(*rnx) - sizeof(rnx->meas) - sizeof(rnx->sv));
+    rnx->fp = fp;
+    rnx->buffer = buffer;
+    rnx->sz_buf = sz_buf;
+    return 0;
+}
+
+/**
+ * \brief write the data in the buffer to the file
+ * \param rnx: the writer
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_flush(ublox_rnx_t * rnx)
+{
+    assert (NULL != rnx);
+    if (rnx->pos < 1) {
+        return 0;
+    }
+    if (fwrite(rnx->buffer, 1, rnx->pos, rnx->fp) != rnx->pos) {
+        TE("write RINEX error");
+        return -1;
+    }
+    rnx->pos = 0;
+    return 0;
+}
+
+/* write the header, tow is in 1e-7 seconds */
+static void
+ublox_rnx_write_header(ublox_rnx_t * rnx, int week, int64_t tow)
+{
+    char line[81];
+    char * p0 = rnx->buffer + rnx->pos;
+    char * p = p0;
+    char * q;
+    int64_t ymdhms[6];
+    time_t now;
+    struct tm * tm_now;
+    size_t i;
+    size_t j;
+
+    q = ublox_rnx_put_fixed(line, 3.03, 9, 2);
+    q = ublox_rnx_put_str(q, "", 11);
+    q = ublox_rnx_put_str(q, "OBSERVATION DATA", 20);
+    q = ublox_rnx_put_str(q, "M (MIXED)", 20);
+    p = ublox_rnx_put_header(p, line, q - line, "RINEX VERSION / TYPE");
+
+    q = ublox_rnx_put_str(line, "ubloxconf", 20);
+    q = ublox_rnx_put_str(q, "", 20);
+    now = time(NULL);
+    tm_now = gmtime(&now);
+    if (NULL != tm_now) {
+        q = ublox_rnx_put_uint(q, tm_now->tm_year + 1900, 4, '0');
+        q = ublox_rnx_put_uint(q, tm_now->tm_mon + 1, 2, '0');
+        q = ublox_rnx_put_uint(q, tm_now->tm_mday, 2, '0');
+        *q ++ = ' ';
+        q = ublox_rnx_put_uint(q, tm_now->tm_hour, 2, '0');
+        q = ublox_rnx_put_uint(q, tm_now->tm_min, 2, '0');
+        q = ublox_rnx_put_uint(q, tm_now->tm_sec, 2, '0');
+        q = ublox_rnx_put_str(q, " UTC", 4);
+    }
+    p = ublox_rnx_put_header(p, line, q - line, "PGM / RUN BY / DATE");
+
+    q = ublox_rnx_put_str(line, (NULL == rnx->marker)?"UNKNOWN":rnx->marker, 60);
+    p = ublox_rnx_put_header(p, line, q - line, "MARKER NAME");
+    q = ublox_rnx_put_str(line, "NON_GEODETIC", 20);
+    p = ublox_rnx_put_header(p, line, q - line, "MARKER TYPE");
+    p = ublox_rnx_put_header(p, line, 0, "OBSERVER / AGENCY");
+    q = ublox_rnx_put_str(line, "", 20);
+    q = ublox_rnx_put_str(q, (NULL == rnx->receiver)?"U-BLOX":rnx->receiver, 20);
+    p = ublox_rnx_put_header(p, line, q - line, "REC # / TYPE / VERS");
+    p = ublox_rnx_put_header(p, line, 0, "ANT # / TYPE");
+    for (q = line, i = 0; i < 3; i ++) {
+        q = ublox_rnx_put_fixed(q, 0.0, 14, 4);
+    }
+    p = ublox_rnx_put_header(p, line, q - line, "APPROX POSITION XYZ");
+    p = ublox_rnx_put_header(p, line, q - line, "ANTENNA: DELTA H/E/N");
+
+    for (i = 0; i < NUM_ARRAY(ublox_rnx_sys); i ++) {
+        line[0] = ublox_rnx_sys[i].sys;
+        q = ublox_rnx_put_str(line + 1, "", 2);
+        q = ublox_rnx_put_uint(q, (strlen(ublox_rnx_sys[i].types) + 1) / 4, 3, ' ');
+        *q ++ = ' ';
+        q = ublox_rnx_put_str(q, ublox_rnx_sys[i].types, strlen(ublox_rnx_sys[i].types));
+        p = ublox_rnx_put_header(p, line, q - line, "SYS / # / OBS TYPES");
+    }
+    q = ublox_rnx_put_str(line, "DBHZ", 20);
+    p = ublox_rnx_put_header(p, line, q - line, "SIGNAL STRENGTH UNIT");
+
+    ublox_rnx_gpst2cal(week, tow, ymdhms);
+    for (q = line, i = 0; i < 5; i ++) {
+        q = ublox_rnx_put_uint(q, ymdhms[i], 6, ' ');
+    }
+    q = ublox_rnx_put_uint(q, ymdhms[5] / 10000000, 5, ' ');
+    *q ++ = '.';
+    q = ublox_rnx_put_uint(q, ymdhms[5] % 10000000, 7, '0');
+    q = ublox_rnx_put_str(q, "", 5);
+    q = ublox_rnx_put_str(q, "GPS", 3);
+    p = ublox_rnx_put_header(p, line, q - line, "TIME OF FIRST OBS");
+
+    for (i = 0; i < NUM_ARRAY(ublox_rnx_sys); i ++) {
+        line[0] = ublox_rnx_sys[i].sys;
+        line[1] = ' ';
+        for (j = 0; j < 3; j ++) {
+            line[2 + j] = ublox_rnx_sys[i].types[4 + j]; // the phase type
+        }
+        line[5] = ' ';
+        q = ublox_rnx_put_fixed(line + 6, 0.0, 8, 5);
+        p = ublox_rnx_put_header(p, line, q - line, "SYS / PHASE SHIFT");
+    }
+    q = ublox_rnx_put_uint(line, 0, 3, ' ');
+    p = ublox_rnx_put_header(p, line, q - line, "GLONASS SLOT / FRQ #");
+    q = ublox_rnx_put_str(line, " C1C    0.000 C1P    0.000 C2C    0.000 C2P    0.000", 52);
+    p = ublox_rnx_put_header(p, line, q - line, "GLONASS COD/PHS/BIS");
+    p = ublox_rnx_put_header(p, line, 0, "END OF HEADER");
+
+    assert (p - p0 <= UBLOX_RNX_SZ_HEADER);
+    rnx->pos += p - p0;
+}
+
+/**
+ * \brief start an epoch
+ * \param rnx: the writer
+ * \param week: the GPS week
+ * \param tow: the GPS time of week, in seconds
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_epoch_begin(ublox_rnx_t * rnx, int week, double tow)
+{
+    int64_t ymdhms[6];
+    int64_t tow7;
+    char * p;
+    size_t i;
+
+    assert (NULL != rnx);
+    if ((tow < 0) || (tow > UBLOX_RNX_SEC_WEEK) || (week < 0)) {
+        TE("invalid epoch time: week=%d, tow=%f", week, tow);
+        return -1;
+    }
+    if (rnx->sz_buf - rnx->pos < UBLOX_RNX_SZ_BUF_MIN) {
+        if (ublox_rnx_flush(rnx) < 0) {
+            return -1;
+        }
+    }
+    tow7 = (int64_t)(tow * 1e7 + 0.5);
+    if (rnx->num_epoch < 1) {
+        ublox_rnx_write_header(rnx, week, tow7);
+    }
+    rnx->pos_epoch = rnx->pos;
+    rnx->num_sat = 0;
+    memset(rnx->flg_sat, 0, sizeof(rnx->flg_sat));
+
+    // > yyyy mm dd hh mm ss.sssssss  0 nnn
+    ublox_rnx_gpst2cal(week, tow7, ymdhms);
+    p = rnx->buffer + rnx->pos;
+    *p ++ = '>';
+    *p ++ = ' ';
+    p = ublox_rnx_put_uint(p, ymdhms[0], 4, '0');
+    for (i = 1; i < 5; i ++) {
+        *p ++ = ' ';
+        p = ublox_rnx_put_uint(p, ymdhms[i], 2, '0');
+    }
+    p = ublox_rnx_put_uint(p, ymdhms[5] / 10000000, 3, ' ');
+    *p ++ = '.';
+    p = ublox_rnx_put_uint(p, ymdhms[5] % 10000000, 7, '0');
+    p = ublox_rnx_put_str(p, "  0", 3);
+    p = ublox_rnx_put_uint(p, 0, 3, ' '); // the number of satellites, set in ublox_rnx_epoch_end()
+    *p ++ = '\n';
+    rnx->pos = p - rnx->buffer;
+    return 0;
+}
+
+/**
+ * \brief add the observations of a satellite to the epoch
+ * \param rnx: the writer
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ * \param prMes: the pseudorange (m), 0 if not valid
+ * \param cpMes: the carrier phase (cycles), 0 if not valid
+ * \param doMes: the doppler (Hz)
+ * \param cno: the carrier-to-noise density ratio (dB-Hz)
+ * \param flg_slip: 1 if the carrier phase lost the lock
+ * \param flg_halfcyc: 1 if the half cycle ambiguity is not resolved
+ *
+ * \return 0 on success, 1 if the satellite is ignored, <0 on error
+ */
+int
+ublox_rnx_epoch_sat(ublox_rnx_t * rnx, uint8_t gnssId, uint8_t svId, double prMes, double cpMes, double doMes, double cno, int flg_slip, int flg_halfcyc)
+{
+    char * p;
+    char sys;
+    int prn;
+    char ssi;
+
+    assert (NULL != rnx);
+    prn = ublox_rnx_sat(gnssId, svId, &sys);
+    if (prn < 0) {
+        return 1;
+    }
+    if (rnx->flg_sat[gnssId][svId / 8] & (1 << (svId % 8))) {
+        // one signal per satellite
+        return 1;
+    }
+    if (rnx->num_sat >= UBLOX_RNX_NUM_SAT) {
+        return -1;
+    }
+    rnx->flg_sat[gnssId][svId / 8] |= (1 << (svId % 8));
+    rnx->num_sat ++;
+
+    ssi = ' ';
+    if (cno > 0) {
+        int val = (int)(cno / 6);
+        ssi = '0' + ((val < 1)?1:((val > 9)?9:val));
+    }
+    p = rnx->buffer + rnx->pos;
+    *p ++ = sys;
+    p = ublox_rnx_put_uint(p, prn, 2, '0');
+    if (prMes != 0) {
+        p = ublox_rnx_put_fixed(p, prMes, 14, 3);
+        *p ++ = ' ';
+        *p ++ = ssi;
+    } else {
+        p = ublox_rnx_put_str(p, "", 16);
+    }
+    if (cpMes != 0) {
+        p = ublox_rnx_put_fixed(p, cpMes, 14, 3);
+        *p ++ = (flg_slip || flg_halfcyc)?('0' + (flg_slip?1:0) + (flg_halfcyc?2:0)):' ';
+        *p ++ = ssi;
+    } else {
+        p = ublox_rnx_put_str(p, "", 16);
+    }
+    p = ublox_rnx_put_fixed(p, doMes, 14, 3);
+    p = ublox_rnx_put_str(p, "", 2);
+    p = ublox_rnx_put_fixed(p, cno, 14, 3);
+    p = ublox_rnx_put_str(p, "", 2);
+    *p ++ = '\n';
+    rnx->pos = p - rnx->buffer;
+    return 0;
+}
+
+/**
+ * \brief finish the epoch
+ * \param rnx: the writer
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_epoch_end(ublox_rnx_t * rnx)
+{
+    assert (NULL != rnx);
+    // the number of satellites is the last field of the epoch line
+    ublox_rnx_put_uint(rnx->buffer + rnx->pos_epoch + 32, rnx->num_sat, 3, ' ');
+    rnx->num_epoch ++;
+    return 0;
+}
+
+/**
+ * \brief write the epoch of RXM-RAWX
+ * \param rnx: the writer
+ * \param msg: the decoded packet, with the measurements in msg->meas
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_write_rawx(ublox_rnx_t * rnx, const ublox_rxm_rawx_t * msg)
+{
+    const ublox_rxm_rawx_meas_t * meas;
+    uint16_t * plock;
+    int flg_slip;
+    size_t i;
+
+    if (ublox_rnx_epoch_begin(rnx, msg->week, msg->rcvTow) < 0) {
+        return -1;
+    }
+    for (i = 0; i < msg->num_meas; i ++) {
+        meas = msg->meas + i;
+        if ((meas->gnssId >= UBLOX_RNX_NUM_SYS) || (! ublox_rnx_sig(meas->gnssId, meas->sigId))) {
+            // the other bands have their own lock time
+            continue;
+        }
+        // the lock time decreased if the lock was lost
+        plock = &(rnx->locktime[meas->gnssId][meas->svId]);
+        flg_slip = (meas->locktime < *plock);
+        *plock = meas->locktime;
+        ublox_rnx_epoch_sat(rnx, meas->gnssId, meas->svId,
+            (meas->trkStat & 0x01)?meas->prMes:0,
+            (meas->trkStat & 0x02)?meas->cpMes:0,
+            meas->doMes, meas->cno, flg_slip, !(meas->trkStat & 0x04));
+    }
+    return ublox_rnx_epoch_end(rnx);
+}
+
+/**
+ * \brief write the epoch of RXM-RAW
+ * \param rnx: the writer
+ * \param msg: the decoded packet, with the satellites in msg->sv
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_write_raw(ublox_rnx_t * rnx, const ublox_rxm_raw_t * msg)
+{
+    const ublox_rxm_raw_sv_t * sv;
+    size_t i;
+
+    if (ublox_rnx_epoch_begin(rnx, msg->week, msg->iTOW / 1000.0) < 0) {
+        return -1;
+    }
+    for (i = 0; i < msg->num_sv; i ++) {
+        sv = msg->sv + i;
+        ublox_rnx_epoch_sat(rnx, (sv->sv >= 120)?1:0, sv->sv,
+            (sv->mesQI >= 4)?sv->prMes:0,
+            (sv->mesQI >= 5)?sv->cpMes:0,
+            sv->doMes, sv->cno, sv->lli & 0x01, 0);
+    }
+    return ublox_rnx_epoch_end(rnx);
+}
+
+/**
+ * \brief the handler of RXM-RAWX for the registry
+ * \param userdata: the writer, ublox_rnx_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_handler_rawx(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rnx_t * rnx = (ublox_rnx_t *)userdata;
+    ublox_rxm_rawx_t msg;
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.meas = rnx->meas;
+    msg.max_meas = NUM_ARRAY(rnx->meas);
+    if (ublox_decode_rxm_rawx(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    return ublox_rnx_write_rawx(rnx, &msg);
+}
+
+/**
+ * \brief the handler of RXM-RAW for the registry
+ * \param userdata: the writer, ublox_rnx_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rnx_handler_raw(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rnx_t * rnx = (ublox_rnx_t *)userdata;
+    ublox_rxm_raw_t msg;
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.sv = rnx->sv;
+    msg.max_sv = NUM_ARRAY(rnx->sv);
+    if (ublox_decode_rxm_raw(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    return ublox_rnx_write_raw(rnx, &msg);
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+TEST_CASE( .name="ublox-rinex", .description="Test ublox RINEX writer." ) {
+    static char buffer[UBLOX_RNX_SZ_BUF_MIN];
+    static ublox_rnx_t rnx;
+    ublox_rxm_rawx_meas_t meas[3];
+    ublox_rxm_rawx_t rawx;
+    char out[4096];
+    char * p;
+    size_t sz;
+    FILE * fp;
+
+    SECTION("test ublox_rnx_put_fixed") {
+        char tmp[16];
+        tmp[14] = 0;
+        ublox_rnx_put_fixed(tmp, 20000000.1234, 14, 3);
+        REQUIRE(0 == strcmp(tmp, "  20000000.123"));
+        ublox_rnx_put_fixed(tmp, -1234.5678, 14, 3);
+        REQUIRE(0 == strcmp(tmp, "     -1234.568"));
+        ublox_rnx_put_fixed(tmp, -0.0004, 14, 3);
+        REQUIRE(0 == strcmp(tmp, "        -0.000"));
+        ublox_rnx_put_fixed(tmp, 0.5, 14, 3);
+        REQUIRE(0 == strcmp(tmp, "         0.500"));
+        ublox_rnx_put_fixed(tmp, 1e12, 14, 3);
+        REQUIRE(0 == strcmp(tmp, "              "));
+        ublox_rnx_put_uint(tmp, 7, 3, '0');
+        tmp[3] = 0;
+        REQUIRE(0 == strcmp(tmp, "007"));
+    }
+
+    SECTION("test ublox_rnx_gpst2cal") {
+        int64_t ymdhms[6];
+        // 2018-11-06 12:34:56.5 is week 2026, tow 2*86400+12*3600+34*60+56.5
+        ublox_rnx_gpst2cal(2026, (int64_t)(218096.5 * 1e7), ymdhms);
+        REQUIRE(ymdhms[0] == 2018);
+        REQUIRE(ymdhms[1] == 11);
+        REQUIRE(ymdhms[2] == 6);
+        REQUIRE(ymdhms[3] == 12);
+        REQUIRE(ymdhms[4] == 34);
+        REQUIRE(ymdhms[5] == 565000000);
+    }
+
+    SECTION("test ublox_rnx_write_rawx") {
+        memset(meas, 0, sizeof(meas));
+        meas[0].prMes = 21000000.125;
+        meas[0].cpMes = 110355123.456;
+        meas[0].doMes = -1234.5;
+        meas[0].gnssId = 0;
+        meas[0].svId = 5;
+        meas[0].cno = 45;
+        meas[0].locktime = 1000;
+        meas[0].trkStat = 0x07;
+        meas[1] = meas[0];
+        meas[1].gnssId = 6;
+        meas[1].svId = 3;
+        meas[1].trkStat = 0x03;
+        meas[2] = meas[0];
+        meas[2].gnssId = 6;
+        meas[2].svId = 255; // unknown slot
+
+        memset(&rawx, 0, sizeof(rawx));
+        rawx.rcvTow = 218096.5;
+        rawx.week = 2026;
+        rawx.meas = meas;
+        rawx.num_meas = 3;
+
+        fp = tmpfile();
+        REQUIRE(NULL != fp);
+        REQUIRE(0 == ublox_rnx_init(&rnx, fp, buffer, sizeof(buffer)));
+        REQUIRE(0 == ublox_rnx_write_rawx(&rnx, &rawx));
+        rawx.rcvTow += 1;
+        meas[0].locktime = 10;
+        REQUIRE(0 == ublox_rnx_write_rawx(&rnx, &rawx));
+        REQUIRE(0 == ublox_rnx_flush(&rnx));
+        rewind(fp);
+        sz = fread(out, 1, sizeof(out) - 1, fp);
+        fclose(fp);
+        out[sz] = 0;
+        CIUT_LOG("RINEX:\n%s", out);
+
+        REQUIRE(0 == strncmp(out, "     3.03           OBSERVATION DATA    M (MIXED)           RINEX VERSION / TYPE\n", 81));
+        REQUIRE(NULL != strstr(out, "G    4 C1C L1C D1C S1C                                      SYS / # / OBS TYPES\n"));
+        REQUIRE(NULL != strstr(out, "  2018    11     6    12    34   56.5000000     GPS         TIME OF FIRST OBS\n"));
+        p = strstr(out, "END OF HEADER\n");
+        REQUIRE(NULL != p);
+        p += 14;
+        REQUIRE(0 == strncmp(p, "> 2018 11 06 12 34 56.5000000  0  2\n", 36));
+        p += 36;
+        REQUIRE(0 == strncmp(p, "G05  21000000.125 7 110355123.456 7     -1234.500          45.000  \n", 68));
+        p += 68;
+        REQUIRE(0 == strncmp(p, "R03  21000000.125 7 110355123.45627     -1234.500          45.000  \n", 68));
+        p += 68;
+        REQUIRE(0 == strncmp(p, "> 2018 11 06 12 34 57.5000000  0  2\n", 36));
+        p += 36;
+        REQUIRE(0 == strncmp(p, "G05  21000000.125 7 110355123.45617", 35));
+    }
+
+    SECTION("test the signals of the observation types") {
+        size_t i;
+        memset(meas, 0, sizeof(meas));
+        // L2 CL is before L1C/A, with a shorter lock time
+        meas[0].prMes = 21000005.5;
+        meas[0].cpMes = 86000000.5;
+        meas[0].gnssId = 0;
+        meas[0].svId = 5;
+        meas[0].sigId = 4;
+        meas[0].cno = 30;
+        meas[0].locktime = 100;
+        meas[0].trkStat = 0x07;
+        meas[1] = meas[0];
+        meas[1].prMes = 21000000.125;
+        meas[1].cpMes = 110355123.456;
+        meas[1].sigId = 0;
+        meas[1].cno = 45;
+        meas[1].locktime = 5000;
+        // E5b only
+        meas[2] = meas[0];
+        meas[2].gnssId = 2;
+        meas[2].sigId = 6;
+
+        memset(&rawx, 0, sizeof(rawx));
+        rawx.rcvTow = 218096.5;
+        rawx.week = 2026;
+        rawx.meas = meas;
+        rawx.num_meas = 3;
+
+        fp = tmpfile();
+        REQUIRE(NULL != fp);
+        REQUIRE(0 == ublox_rnx_init(&rnx, fp, buffer, sizeof(buffer)));
+        for (i = 0; i < 3; i ++) {
+            REQUIRE(0 == ublox_rnx_write_rawx(&rnx, &rawx));
+            rawx.rcvTow += 1;
+            meas[0].locktime += 1000;
+            meas[1].locktime += 1000;
+        }
+        REQUIRE(0 == ublox_rnx_flush(&rnx));
+        rewind(fp);
+        sz = fread(out, 1, sizeof(out) - 1, fp);
+        fclose(fp);
+        out[sz] = 0;
+
+        p = strstr(out, "END OF HEADER\n");
+        REQUIRE(NULL != p);
+        p += 14;
+        for (i = 0; i < 3; i ++) {
+            // L1C/A only, without the cycle slip
+            REQUIRE(0 == strncmp(p + 32, "  1\n", 4));
+            p += 36;
+            REQUIRE(0 == strncmp(p, "G05  21000000.125 7 110355123.456 7", 35));
+            p += 68;
+        }
+        REQUIRE(0 == *p);
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,73 @@
+/**
+ * \file    ubloxrnx.h
+ * \brief   RINEX 3 observation writer for RXM-RAWX and RXM-RAW
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_RNX_H
+#define UBLOX_RNX_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxdec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_RNX_NUM_SYS  7   /**< the number of gnssId of UBX */
+#define UBLOX_RNX_NUM_SAT  256 /**< the max number of measurements in an epoch */
+#define UBLOX_RNX_SZ_LINE  (3 + 4 * 16 + 1) /**< the byte size of the line of a satellite */
+#define UBLOX_RNX_SZ_EPOCH (64 + UBLOX_RNX_NUM_SAT * UBLOX_RNX_SZ_LINE) /**< the max byte size of an epoch */
+#define UBLOX_RNX_SZ_HEADER (40 * 81) /**< the max byte size of the header */
+#define UBLOX_RNX_SZ_BUF_MIN (UBLOX_RNX_SZ_HEADER + UBLOX_RNX_SZ_EPOCH) /**< the min size of the output buffer */
+
+/**
+ * The writer formats the epochs into the buffer from the caller and writes
+ * the buffer to the file when it is nearly full. The header is written
+ * before the first epoch, since it contains the time of the first epoch.
+ * The observations are C/L/D/S of the L1 band (B1I for BeiDou), the
+ * measurements of the other signals are skipped.
+ */
+typedef struct _ublox_rnx_t {
+    FILE * fp;              /**< the output file */
+    char * buffer;          /**< the output buffer */
+    size_t sz_buf;          /**< the size of the buffer */
+    size_t pos;             /**< the byte size of data in the buffer */
+    const char * marker;    /**< MARKER NAME, can be NULL */
+    const char * receiver;  /**< the receiver type in REC # / TYPE / VERS, can be NULL */
+    size_t num_epoch;       /**< the number of epochs written */
+
+    /* the epoch being written */
+    size_t pos_epoch;       /**< the position of the epoch line in the buffer */
+    size_t num_sat;         /**< the number of satellites in the epoch */
+    uint8_t flg_sat[UBLOX_RNX_NUM_SYS][UBLOX_RNX_NUM_SAT / 8]; /**< the satellites in the epoch */
+
+    uint16_t locktime[UBLOX_RNX_NUM_SYS][UBLOX_RNX_NUM_SAT]; /**< the lock time of the signal written in the previous epoch, to detect the cycle slips */
+
+    /* the storage to decode the packets in the handlers */
+    ublox_rxm_rawx_meas_t meas[UBLOX_RNX_NUM_SAT];
+    ublox_rxm_raw_sv_t sv[UBLOX_RNX_NUM_SAT];
+} ublox_rnx_t;
+
+int ublox_rnx_init(ublox_rnx_t * rnx, FILE * fp, char * buffer, size_t sz_buf);
+int ublox_rnx_flush(ublox_rnx_t * rnx);
+
+int ublox_rnx_epoch_begin(ublox_rnx_t * rnx, int week, double tow);
+int ublox_rnx_epoch_sat(ublox_rnx_t * rnx, uint8_t gnssId, uint8_t svId, double prMes, double cpMes, double doMes, double cno, int flg_slip, int flg_halfcyc);
+int ublox_rnx_epoch_end(ublox_rnx_t * rnx);
+
+int ublox_rnx_write_rawx(ublox_rnx_t * rnx, const ublox_rxm_rawx_t * msg);
+int ublox_rnx_write_raw(ublox_rnx_t * rnx, const ublox_rxm_raw_t * msg);
+
+int ublox_rnx_handler_rawx(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_rnx_handler_raw(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_RNX_H */
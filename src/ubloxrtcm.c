@@ -0,0 +1,1629 @@
+/**
+ * \file    ubloxrtcm.c
+ * \brief   The RTCM 3 decoder of MSM4-7 and the station messages 1005/1006/1230
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The fields of MSM are grouped by the type, such as the rough ranges of all
+ * of the satellites and then the fine pseudoranges of all of the cells, so
+ * each group is read by one ublox_bitreader_array_xxx() of the same width.
+ * The observations are converted to the units of RXM-RAWX (m, cycle, Hz) and
+ * appended to the columnar store with the UBX gnssId/svId/sigId.
+ */
+
+#include <math.h>
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdmx.h"
+#include "ubloxrtcm.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_RTCM_FREQ_L1  1575.42e6
+#define UBLOX_RTCM_FREQ_L2  1227.60e6
+#define UBLOX_RTCM_FREQ_L5  1176.45e6
+#define UBLOX_RTCM_FREQ_E5B 1207.14e6
+#define UBLOX_RTCM_FREQ_B1I 1561.098e6
+#define UBLOX_RTCM_FREQ_G1  1602.0e6
+#define UBLOX_RTCM_FREQ_G1K 0.5625e6 /**< the step of the GLONASS G1 channels */
+#define UBLOX_RTCM_FREQ_G2  1246.0e6
+#define UBLOX_RTCM_FREQ_G2K 0.4375e6 /**< the step of the GLONASS G2 channels */
+
+/** the size of the fields of MSM4-7 */
+static const struct _ublox_rtcm_msm_fmt_t {
+    uint8_t ext;      /**< the extended satellite info */
+    uint8_t rrate;    /**< the rough phaserange rate */
+    uint8_t fpr;      /**< the fine pseudorange */
+    uint8_t fcp;      /**< the fine phaserange */
+    uint8_t lock;     /**< the lock time indicator */
+    uint8_t cnr;
+    uint8_t frate;    /**< the fine phaserange rate */
+    double sc_fpr;    /**< the scale of the fine pseudorange (ms) */
+    double sc_fcp;    /**< the scale of the fine phaserange (ms) */
+    double sc_cnr;    /**< the scale of CNR (dBHz) */
+} g_ublox_rtcm_msm_fmt[4] = {
+    /* MSM4 */ { 0,  0, 15, 22,  4,  6,  0, 0x1p-24, 0x1p-29, 1.0 },
+    /* MSM5 */ { 4, 14, 15, 22,  4,  6, 15, 0x1p-24, 0x1p-29, 1.0 },
+    /* MSM6 */ { 0,  0, 20, 24, 10, 10,  0, 0x1p-29, 0x1p-31, 0x1p-4 },
+    /* MSM7 */ { 4, 14, 20, 24, 10, 10, 15, 0x1p-29, 0x1p-31, 0x1p-4 },
+};
+
+/**
+ * \brief decode 1005 or 1006, the antenna reference point of the station
+ * \param payload: the payload of the frame, without the header and the CRC
+ * \param sz_payload: the byte size of the payload
+ * \param sta: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rtcm_decode_sta(const uint8_t * payload, size_t sz_payload, ublox_rtcm_sta_t * sta)
+{
+    ublox_bitreader_t br;
+    uint32_t type;
+
+    assert (NULL != sta);
+    ublox_bitreader_init(&br, payload, sz_payload);
+    type = ublox_bitreader_u(&br, 12);
+    if ((1005 != type) && (1006 != type)) {
+        return -1;
+    }
+    sta->staid = ublox_bitreader_u(&br, 12);
+    sta->itrf = ublox_bitreader_u(&br, 6);
+    sta->flg_gps = ublox_bitreader_u(&br, 1);
+    sta->flg_glo = ublox_bitreader_u(&br, 1);
+    sta->flg_gal = ublox_bitreader_u(&br, 1);
+    sta->flg_ref = ublox_bitreader_u(&br, 1);
+    sta->pos[0] = ublox_bitreader_s64(&br, 38) * 0.0001;
+    sta->flg_osc = ublox_bitreader_u(&br, 1);
+    ublox_bitreader_u(&br, 1); // reserved
+    sta->pos[1] = ublox_bitreader_s64(&br, 38) * 0.0001;
+    sta->quarter = ublox_bitreader_u(&br, 2);
+    sta->pos[2] = ublox_bitreader_s64(&br, 38) * 0.0001;
+    sta->height = 0;
+    if (1006 == type) {
+        sta->height = ublox_bitreader_u(&br, 16) * 0.0001;
+    }
+    return br.flg_err?-1:0;
+}
+
+/**
+ * \brief decode 1230, the GLONASS code-phase biases
+ * \param payload: the payload of the frame, without the header and the CRC
+ * \param sz_payload: the byte size of the payload
+ * \param bias: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rtcm_decode_glo_bias(const uint8_t * payload, size_t sz_payload, ublox_rtcm_glo_bias_t * bias)
+{
+    ublox_bitreader_t br;
+    size_t i;
+
+    assert (NULL != bias);
+    ublox_bitreader_init(&br, payload, sz_payload);
+    if (1230 != ublox_bitreader_u(&br, 12)) {
+        return -1;
+    }
+    bias->staid = ublox_bitreader_u(&br, 12);
+    bias->flg_aligned = ublox_bitreader_u(&br, 1);
+    ublox_bitreader_u(&br, 3); // reserved
+    bias->mask = ublox_bitreader_u(&br, 4);
+    for (i = 0; i < NUM_ARRAY(bias->bias); i ++) {
+        bias->bias[i] = 0;
+        if (bias->mask & (0x08 >> i)) {
+            bias->bias[i] = ublox_bitreader_s(&br, 16) * 0.02;
+        }
+    }
+    return br.flg_err?-1:0;
+}
+
+/* the minimum lock time (ms) of the 4-bit indicator of MSM4/5 */
+static double
+ublox_rtcm_lock_msm4(uint32_t ind)
+{
+    return (ind > 0)?(double)(16U << ind):0.0;
+}
+
+/* the minimum lock time (ms) of the 10-bit extended indicator of MSM6/7 */
+static double
+ublox_rtcm_lock_msm7(uint32_t ind)
+{
+    uint32_t k;
+
+    if (ind < 64) {
+        return ind;
+    }
+    if (ind > 704) {
+        return 0; // reserved
+    }
+    // 2^k ms per step in [32 * (k + 1), 32 * (k + 2))
+    k = ind / 32 - 1;
+    return ldexp((double)(ind - 32 * k), k);
+}
+
+/* the IDs of the bits set in the mask of num bits, MSB is 1 */
+static size_t
+ublox_rtcm_mask2id(uint64_t mask, size_t num, uint8_t * id)
+{
+    size_t n = 0;
+    size_t i;
+
+    for (i = 0; i < num; i ++) {
+        if (mask & (1ULL << (num - 1 - i))) {
+            id[n ++] = i + 1;
+        }
+    }
+    return n;
+}
+
+/**
+ * \brief decode MSM4, MSM5, MSM6 or MSM7 of any GNSS
+ * \param payload: the payload of the frame, without the header and the CRC
+ * \param sz_payload: the byte size of the payload
+ * \param msm: the result
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rtcm_decode_msm(const uint8_t * payload, size_t sz_payload, ublox_rtcm_msm_t * msm)
+{
+    const struct _ublox_rtcm_msm_fmt_t * fmt;
+    ublox_bitreader_t br;
+    uint32_t uval[UBLOX_RTCM_MSM_NUM_CELL];
+    int32_t sval[UBLOX_RTCM_MSM_NUM_CELL];
+    uint64_t mask;
+    double rr;
+    size_t num;
+    size_t i;
+    size_t j;
+
+    assert (NULL != msm);
+    ublox_bitreader_init(&br, payload, sz_payload);
+    msm->type = ublox_bitreader_u(&br, 12);
+    if ((msm->type < 1071) || (msm->type > 1137) || (msm->type % 10 < 4) || (msm->type % 10 > 7)) {
+        return -1;
+    }
+    fmt = g_ublox_rtcm_msm_fmt + (msm->type % 10 - 4);
+    msm->staid = ublox_bitreader_u(&br, 12);
+    msm->epoch = ublox_bitreader_u(&br, 30);
+    msm->flg_more = ublox_bitreader_u(&br, 1);
+    msm->iods = ublox_bitreader_u(&br, 3);
+    ublox_bitreader_u(&br, 7); // reserved
+    msm->clk_steer = ublox_bitreader_u(&br, 2);
+    msm->clk_ext = ublox_bitreader_u(&br, 2);
+    msm->flg_smooth = ublox_bitreader_u(&br, 1);
+    msm->smooth_int = ublox_bitreader_u(&br, 3);
+    msm->num_sat = ublox_rtcm_mask2id(ublox_bitreader_u64(&br, 64), UBLOX_RTCM_MSM_NUM_SAT, msm->sat);
+    msm->num_sig = ublox_rtcm_mask2id(ublox_bitreader_u(&br, 32), UBLOX_RTCM_MSM_NUM_SIG, msm->sig);
+    num = msm->num_sat * msm->num_sig;
+    if (br.flg_err || (num > UBLOX_RTCM_MSM_NUM_CELL)) {
+        return -1;
+    }
+    mask = ublox_bitreader_u64(&br, num);
+    msm->num_cell = 0;
+    for (i = 0; i < msm->num_sat; i ++) {
+        for (j = 0; j < msm->num_sig; j ++) {
+            if (mask & (1ULL << (num - 1 - (i * msm->num_sig + j)))) {
+                msm->cell_sat[msm->num_cell] = i;
+                msm->cell_sig[msm->num_cell] = j;
+                msm->num_cell ++;
+            }
+        }
+    }
+
+    // the satellite data
+    num = msm->num_sat;
+    if (ublox_bitreader_array_u(&br, 8, num, uval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        msm->rrange[i] = (255 == uval[i])?-1.0:uval[i];
+        msm->ext[i] = 15;
+        msm->rrate[i] = 0;
+    }
+    if (fmt->ext && (ublox_bitreader_array_u(&br, fmt->ext, num, uval) == 0)) {
+        for (i = 0; i < num; i ++) {
+            msm->ext[i] = uval[i];
+        }
+    }
+    if (ublox_bitreader_array_u(&br, 10, num, uval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        if (msm->rrange[i] >= 0) {
+            msm->rrange[i] += uval[i] * 0x1p-10;
+        }
+    }
+    if (fmt->rrate && (ublox_bitreader_array_s(&br, fmt->rrate, num, sval) == 0)) {
+        for (i = 0; i < num; i ++) {
+            // -8192 is invalid
+            msm->rrate[i] = (-8192 == sval[i])?NAN:sval[i];
+        }
+    }
+
+    // the signal data
+    num = msm->num_cell;
+    if (ublox_bitreader_array_s(&br, fmt->fpr, num, sval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        rr = msm->rrange[msm->cell_sat[i]];
+        msm->flg[i] = 0;
+        msm->pr[i] = 0;
+        if ((rr >= 0) && (sval[i] != -(1 << (fmt->fpr - 1)))) {
+            msm->pr[i] = (rr + sval[i] * fmt->sc_fpr) * UBLOX_RTCM_RANGE_MS;
+            msm->flg[i] |= UBLOX_RTCM_MSM_PR;
+        }
+    }
+    if (ublox_bitreader_array_s(&br, fmt->fcp, num, sval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        rr = msm->rrange[msm->cell_sat[i]];
+        msm->cp[i] = 0;
+        if ((rr >= 0) && (sval[i] != -(1 << (fmt->fcp - 1)))) {
+            msm->cp[i] = (rr + sval[i] * fmt->sc_fcp) * UBLOX_RTCM_RANGE_MS;
+            msm->flg[i] |= UBLOX_RTCM_MSM_CP;
+        }
+    }
+    if (ublox_bitreader_array_u(&br, fmt->lock, num, uval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        msm->lock[i] = (4 == fmt->lock)?ublox_rtcm_lock_msm4(uval[i]):ublox_rtcm_lock_msm7(uval[i]);
+    }
+    if (ublox_bitreader_array_u(&br, 1, num, uval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        msm->half[i] = uval[i];
+    }
+    if (ublox_bitreader_array_u(&br, fmt->cnr, num, uval) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        msm->cnr[i] = uval[i] * fmt->sc_cnr;
+    }
+    for (i = 0; i < num; i ++) {
+        msm->rate[i] = 0;
+    }
+    if (fmt->frate) {
+        if (ublox_bitreader_array_s(&br, fmt->frate, num, sval) < 0) {
+            return -1;
+        }
+        for (i = 0; i < num; i ++) {
+            rr = msm->rrate[msm->cell_sat[i]];
+            if (! isnan(rr) && (-16384 != sval[i])) {
+                msm->rate[i] = rr + sval[i] * 0.0001;
+                msm->flg[i] |= UBLOX_RTCM_MSM_RATE;
+            }
+        }
+    }
+    return br.flg_err?-1:0;
+}
+
+/**
+ * \brief get the GNSS of the MSM
+ * \param type: the message type
+ * \param pgnssId: the gnssId of UBX
+ *
+ * \return the MSM number (1-7), <0 if not a MSM
+ */
+int
+ublox_rtcm_msm_sys(uint16_t type, uint8_t * pgnssId)
+{
+    static const uint8_t gnss[7] = {
+        0, // 107x GPS
+        6, // 108x GLONASS
+        2, // 109x Galileo
+        1, // 110x SBAS
+        5, // 111x QZSS
+        3, // 112x BeiDou
+        4, // 113x NavIC/IRNSS
+    };
+    if ((type < 1071) || (type > 1137) || (0 == type % 10) || (type % 10 > 7)) {
+        return -1;
+    }
+    *pgnssId = gnss[(type - 1070) / 10];
+    return type % 10;
+}
+
+/** the UBX sigId and the carrier of the RTCM signal ID 1-32 */
+typedef struct _ublox_rtcm_sig_t {
+    uint8_t sig;      /**< the signal ID of RTCM */
+    uint8_t sigId;    /**< the signal ID of UBX */
+    double freq;      /**< the carrier frequency (Hz), 0 for GLONASS */
+    uint8_t band;     /**< the band of GLONASS, 1 or 2 */
+} ublox_rtcm_sig_t;
+
+static const ublox_rtcm_sig_t g_ublox_rtcm_sig_gps[] = {
+    {  2, 0, UBLOX_RTCM_FREQ_L1, 0 }, // 1C
+    { 15, 4, UBLOX_RTCM_FREQ_L2, 0 }, // 2S, L2 CM
+    { 16, 3, UBLOX_RTCM_FREQ_L2, 0 }, // 2L, L2 CL
+    { 17, 3, UBLOX_RTCM_FREQ_L2, 0 }, // 2X
+    { 22, 6, UBLOX_RTCM_FREQ_L5, 0 }, // 5I
+    { 23, 7, UBLOX_RTCM_FREQ_L5, 0 }, // 5Q
+    { 24, 7, UBLOX_RTCM_FREQ_L5, 0 }, // 5X
+};
+static const ublox_rtcm_sig_t g_ublox_rtcm_sig_glo[] = {
+    {  2, 0, 0, 1 }, // 1C
+    {  8, 2, 0, 2 }, // 2C
+};
+static const ublox_rtcm_sig_t g_ublox_rtcm_sig_gal[] = {
+    {  2, 0, UBLOX_RTCM_FREQ_L1, 0 },  // 1C
+    {  4, 1, UBLOX_RTCM_FREQ_L1, 0 },  // 1B
+    {  5, 0, UBLOX_RTCM_FREQ_L1, 0 },  // 1X
+    { 14, 5, UBLOX_RTCM_FREQ_E5B, 0 }, // 7I
+    { 15, 6, UBLOX_RTCM_FREQ_E5B, 0 }, // 7Q
+    { 16, 6, UBLOX_RTCM_FREQ_E5B, 0 }, // 7X
+    { 22, 3, UBLOX_RTCM_FREQ_L5, 0 },  // 5I
+    { 23, 4, UBLOX_RTCM_FREQ_L5, 0 },  // 5Q
+    { 24, 4, UBLOX_RTCM_FREQ_L5, 0 },  // 5X
+};
+static const ublox_rtcm_sig_t g_ublox_rtcm_sig_bds[] = {
+    {  2, 0, UBLOX_RTCM_FREQ_B1I, 0 }, // 2I, B1I D1, +1 for D2
+    { 14, 2, UBLOX_RTCM_FREQ_E5B, 0 }, // 7I, B2I D1, +1 for D2
+};
+static const ublox_rtcm_sig_t g_ublox_rtcm_sig_qzss[] = {
+    {  2, 0, UBLOX_RTCM_FREQ_L1, 0 }, // 1C
+    { 15, 4, UBLOX_RTCM_FREQ_L2, 0 }, // 2S
+    { 16, 5, UBLOX_RTCM_FREQ_L2, 0 }, // 2L
+};
+static const ublox_rtcm_sig_t g_ublox_rtcm_sig_sbas[] = {
+    {  2, 0, UBLOX_RTCM_FREQ_L1, 0 }, // 1C
+};
+
+/* the signals of the GNSS */
+static const ublox_rtcm_sig_t *
+ublox_rtcm_sig_table(uint8_t gnssId, size_t * pnum)
+{
+    switch (gnssId) {
+    case 0: *pnum = NUM_ARRAY(g_ublox_rtcm_sig_gps);  return g_ublox_rtcm_sig_gps;
+    case 1: *pnum = NUM_ARRAY(g_ublox_rtcm_sig_sbas); return g_ublox_rtcm_sig_sbas;
+    case 2: *pnum = NUM_ARRAY(g_ublox_rtcm_sig_gal);  return g_ublox_rtcm_sig_gal;
+    case 3: *pnum = NUM_ARRAY(g_ublox_rtcm_sig_bds);  return g_ublox_rtcm_sig_bds;
+    case 5: *pnum = NUM_ARRAY(g_ublox_rtcm_sig_qzss); return g_ublox_rtcm_sig_qzss;
+    case 6: *pnum = NUM_ARRAY(g_ublox_rtcm_sig_glo);  return g_ublox_rtcm_sig_glo;
+    }
+    *pnum = 0;
+    return NULL;
+}
+
+/**
+ * \brief map the satellite and the signal of MSM to UBX
+ * \param gnssId: the gnssId of UBX, see ublox_rtcm_msm_sys()
+ * \param svId: the satellite ID of the MSM (1-64)
+ * \param sig: the signal ID of the MSM (1-32)
+ * \param fcn: the frequency channel number of GLONASS (-7 - 6), <-7 if unknown
+ * \param psigId: the sigId of UBX
+ * \param pfreq: the carrier frequency (Hz), 0 if unknown
+ *
+ * \return 0 on success, <0 if the signal is not supported by UBX
+ */
+int
+ublox_rtcm_msm_sig(uint8_t gnssId, uint8_t svId, uint8_t sig, int fcn, uint8_t * psigId, double * pfreq)
+{
+    const ublox_rtcm_sig_t * tbl;
+    size_t num;
+    size_t i;
+
+    tbl = ublox_rtcm_sig_table(gnssId, &num);
+    for (i = 0; (i < num) && (tbl[i].sig != sig); i ++) {
+    }
+    if (i >= num) {
+        return -1;
+    }
+    *psigId = tbl[i].sigId;
+    *pfreq = tbl[i].freq;
+    if ((3 == gnssId) && ((svId <= 5) || (svId >= 59))) {
+        // the GEO of BeiDou broadcast D2
+        *psigId += 1;
+    }
+    if (6 == gnssId) {
+        *pfreq = 0;
+        if ((-7 <= fcn) && (fcn <= 6)) {
+            *pfreq = (1 == tbl[i].band)?(UBLOX_RTCM_FREQ_G1 + fcn * UBLOX_RTCM_FREQ_G1K):(UBLOX_RTCM_FREQ_G2 + fcn * UBLOX_RTCM_FREQ_G2K);
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief setup the decoder
+ * \param rtcm: the decoder
+ * \param col: the store of the observations, can be NULL
+ */
+void
+ublox_rtcm_init(ublox_rtcm_t * rtcm, ublox_rawx_col_t * col)
+{
+    assert (NULL != rtcm);
+    memset(rtcm, 0, sizeof(*rtcm));
+    rtcm->col = col;
+    rtcm->leapS = 18;
+    rtcm->tow_last = -1;
+    memset(rtcm->glo_fcn, -1, sizeof(rtcm->glo_fcn));
+}
+
+/* the GPS time of week (s) of the epoch time of MSM */
+static double
+ublox_rtcm_msm_tow(const ublox_rtcm_t * rtcm, uint8_t gnssId, uint32_t epoch)
+{
+    double tow = epoch * 0.001;
+    double tod;
+    uint32_t dow;
+
+    if (3 == gnssId) {
+        tow += 14.0; // BDT
+    } else if (6 == gnssId) {
+        // GLONASS time is UTC(SU) + 3h
+        dow = epoch >> 27;
+        tod = (epoch & 0x7FFFFFF) * 0.001 - 10800.0 + rtcm->leapS;
+        if (dow < 7) {
+            tow = dow * 86400.0 + tod;
+        } else if (rtcm->tow_last >= 0) {
+            // the day is unknown, use the day nearest to the last epoch
+            tow = floor(rtcm->tow_last / 86400.0) * 86400.0 + tod;
+            if (tow < rtcm->tow_last - 43200.0) {
+                tow += 86400.0;
+            } else if (tow > rtcm->tow_last + 43200.0) {
+                tow -= 86400.0;
+            }
+        } else {
+            tow = tod;
+        }
+    }
+    if (tow < 0) {
+        tow += 604800.0;
+    } else if (tow >= 604800.0) {
+        tow -= 604800.0;
+    }
+    return tow;
+}
+
+/**
+ * \brief append the observations of MSM to the columnar store
+ * \param rtcm: the decoder
+ * \param msm: the decoded MSM
+ *
+ * \return 0 on success, <0 on error
+ *
+ * The phaserange and the phaserange rate are converted to the carrier cycles
+ * and the Doppler (Hz) of RXM-RAWX, they are invalid for the GLONASS satellites
+ * of which the frequency channel is unknown. The signals not supported by
+ * UBX are skipped.
+ */
+int
+ublox_rtcm_msm_append(ublox_rtcm_t * rtcm, const ublox_rtcm_msm_t * msm)
+{
+    ublox_rawx_col_t * col = rtcm->col;
+    uint8_t gnssId;
+    uint8_t svId;
+    uint8_t sigId;
+    uint8_t sat;
+    uint8_t flg;
+    double freq;
+    double tow;
+    size_t idx;
+    size_t i;
+    int fcn;
+
+    if (ublox_rtcm_msm_sys(msm->type, &gnssId) < 4) {
+        return -1;
+    }
+    tow = ublox_rtcm_msm_tow(rtcm, gnssId, msm->epoch);
+    if (6 == gnssId) {
+        // learn the frequency channels
+        for (i = 0; i < msm->num_sat; i ++) {
+            if ((msm->sat[i] <= NUM_ARRAY(rtcm->glo_fcn)) && (msm->ext[i] <= 13)) {
+                rtcm->glo_fcn[msm->sat[i] - 1] = msm->ext[i];
+            }
+        }
+    }
+    if (NULL == col) {
+        rtcm->flg_more = msm->flg_more;
+        rtcm->tow_last = tow;
+        return 0;
+    }
+    if (ublox_rawx_col_reserve(col, col->num_epoch + 1, col->num_meas + msm->num_cell) < 0) {
+        return -1;
+    }
+    if (! (rtcm->flg_more && (col->num_epoch > 0) && (fabs(tow - rtcm->tow_last) < 0.0005))) {
+        idx = col->num_epoch;
+        col->rcvTow[idx] = tow;
+        col->week[idx] = rtcm->week;
+        col->leapS[idx] = rtcm->leapS;
+        col->recStat[idx] = 0;
+        col->meas_start[idx] = col->num_meas;
+        col->num_epoch ++;
+    }
+    for (i = 0; i < msm->num_cell; i ++) {
+        sat = msm->sat[msm->cell_sat[i]];
+        fcn = -8;
+        if ((6 == gnssId) && (sat <= NUM_ARRAY(rtcm->glo_fcn)) && (rtcm->glo_fcn[sat - 1] >= 0)) {
+            fcn = rtcm->glo_fcn[sat - 1] - 7;
+        }
+        if (ublox_rtcm_msm_sig(gnssId, sat, msm->sig[msm->cell_sig[i]], fcn, &sigId, &freq) < 0) {
+            rtcm->num_skip ++;
+            continue;
+        }
+        svId = sat;
+        if (1 == gnssId) {
+            svId = sat + 119; // the PRN of SBAS
+        }
+        flg = msm->flg[i];
+        if (freq <= 0) {
+            flg &= UBLOX_RTCM_MSM_PR;
+        }
+        idx = col->num_meas;
+        col->prMes[idx] = (flg & UBLOX_RTCM_MSM_PR)?msm->pr[i]:0;
+        col->cpMes[idx] = (flg & UBLOX_RTCM_MSM_CP)?(msm->cp[i] * freq / UBLOX_RTCM_CLIGHT):0;
+        col->doMes[idx] = (flg & UBLOX_RTCM_MSM_RATE)?(float)(-msm->rate[i] * freq / UBLOX_RTCM_CLIGHT):0;
+        col->gnssId[idx] = gnssId;
+        col->svId[idx] = svId;
+        col->sigId[idx] = sigId;
+        col->freqId[idx] = (fcn >= -7)?(fcn + 7):0;
+        col->locktime[idx] = (msm->lock[i] > 64500)?64500:(uint16_t)msm->lock[i];
+        col->cno[idx] = (msm->cnr[i] > 255)?255:(uint8_t)(msm->cnr[i] + 0.5);
+        col->prStdev[idx] = 0;
+        col->cpStdev[idx] = 0;
+        col->doStdev[idx] = 0;
+        // prValid, cpValid, halfCyc
+        col->trkStat[idx] = ((flg & UBLOX_RTCM_MSM_PR)?0x01:0) | ((flg & UBLOX_RTCM_MSM_CP)?0x02:0)
+            | (((flg & UBLOX_RTCM_MSM_CP) && ! msm->half[i])?0x04:0);
+        col->num_meas ++;
+    }
+    col->meas_start[col->num_epoch] = col->num_meas;
+    rtcm->flg_more = msm->flg_more;
+    rtcm->tow_last = tow;
+    return 0;
+}
+
+/**
+ * \brief decode the verified RTCM 3 frame
+ * \param rtcm: the decoder
+ * \param buffer_in: the frame, from 0xD3 to the CRC
+ * \param sz_in: the byte size of the frame
+ *
+ * \return the message type on success, 0 if the message is not supported, <0 on error
+ */
+int
+ublox_rtcm_add_frame(ublox_rtcm_t * rtcm, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rtcm_msm_t msm;
+    const uint8_t * payload = buffer_in + UBLOX_RTCM3_LENGTH_HDR;
+    size_t sz_payload;
+    uint8_t gnssId;
+    uint16_t type;
+
+    assert (NULL != rtcm);
+    if ((sz_in < UBLOX_RTCM3_LENGTH_MIN + 2) || (sz_in < UBLOX_RTCM3_LENGTH_MIN + UBLOX_RTCM3_LENGTH(buffer_in))) {
+        return -1;
+    }
+    sz_payload = UBLOX_RTCM3_LENGTH(buffer_in);
+    type = UBLOX_RTCM_TYPE(buffer_in);
+    switch (type) {
+    case 1005:
+    case 1006:
+        if (ublox_rtcm_decode_sta(payload, sz_payload, &(rtcm->sta)) < 0) {
+            return -1;
+        }
+        rtcm->num_sta ++;
+        return type;
+    case 1230:
+        if (ublox_rtcm_decode_glo_bias(payload, sz_payload, &(rtcm->glo_bias)) < 0) {
+            return -1;
+        }
+        rtcm->num_glo_bias ++;
+        return type;
+    }
+    if (ublox_rtcm_msm_sys(type, &gnssId) >= 4) {
+        if ((ublox_rtcm_decode_msm(payload, sz_payload, &msm) < 0) || (ublox_rtcm_msm_append(rtcm, &msm) < 0)) {
+            TE("malformed RTCM3 MSM, type=%d, size=%" PRIuSZ "\n", type, sz_payload);
+            return -1;
+        }
+        rtcm->num_msm ++;
+        return type;
+    }
+    rtcm->num_unknown ++;
+    return 0;
+}
+
+/**
+ * \brief the handler of the RTCM 3 frames for the demultiplexer, see ublox_demux_set()
+ * \param userdata: the decoder, ublox_rtcm_t
+ * \param buffer_in: the verified frame
+ * \param sz_in: the byte size of the frame
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rtcm_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    return (ublox_rtcm_add_frame((ublox_rtcm_t *)userdata, buffer_in, sz_in) < 0)?-1:0;
+}
+
+/* setup the writer of the payload of the frame */
+static int
+ublox_rtcm_frame_start(ublox_bitwriter_t * bw, uint8_t * frame, size_t sz_frame)
+{
+    if (sz_frame < UBLOX_RTCM3_LENGTH_MIN) {
+        return -1;
+    }
+    if (sz_frame > UBLOX_RTCM_SZ_FRAME_MAX) {
+        sz_frame = UBLOX_RTCM_SZ_FRAME_MAX;
+    }
+    memset(frame, 0, sz_frame);
+    ublox_bitwriter_init(bw, frame + UBLOX_RTCM3_LENGTH_HDR, sz_frame - UBLOX_RTCM3_LENGTH_MIN);
+    return 0;
+}
+
+/* add the header and the CRC of the frame */
+static int
+ublox_rtcm_frame_finish(ublox_bitwriter_t * bw, uint8_t * frame)
+{
+    size_t sz_payload;
+    uint32_t crc;
+
+    if (bw->flg_err) {
+        return -1;
+    }
+    sz_payload = ublox_bitwriter_flush(bw);
+    frame[0] = 0xD3;
+    frame[1] = (sz_payload >> 8) & 0x03;
+    frame[2] = sz_payload & 0xFF;
+    crc = ublox_crc24q(frame, UBLOX_RTCM3_LENGTH_HDR + sz_payload);
+    frame[UBLOX_RTCM3_LENGTH_HDR + sz_payload] = (crc >> 16) & 0xFF;
+    frame[UBLOX_RTCM3_LENGTH_HDR + sz_payload + 1] = (crc >> 8) & 0xFF;
+    frame[UBLOX_RTCM3_LENGTH_HDR + sz_payload + 2] = crc & 0xFF;
+    return UBLOX_RTCM3_LENGTH_MIN + sz_payload;
+}
+
+/**
+ * \brief encode 1005, or 1006 if the antenna height is not 0
+ * \param sta: the antenna reference point
+ * \param frame: the buffer of the frame
+ * \param sz_frame: the byte size of the buffer
+ *
+ * \return the byte size of the frame on success, <0 on error
+ */
+int
+ublox_rtcm_encode_sta(const ublox_rtcm_sta_t * sta, uint8_t * frame, size_t sz_frame)
+{
+    ublox_bitwriter_t bw;
+
+    assert (NULL != sta);
+    if (ublox_rtcm_frame_start(&bw, frame, sz_frame) < 0) {
+        return -1;
+    }
+    ublox_bitwriter_u(&bw, 12, (0 != sta->height)?1006:1005);
+    ublox_bitwriter_u(&bw, 12, sta->staid);
+    ublox_bitwriter_u(&bw, 6, sta->itrf);
+    ublox_bitwriter_u(&bw, 1, sta->flg_gps);
+    ublox_bitwriter_u(&bw, 1, sta->flg_glo);
+    ublox_bitwriter_u(&bw, 1, sta->flg_gal);
+    ublox_bitwriter_u(&bw, 1, sta->flg_ref);
+    ublox_bitwriter_s64(&bw, 38, llround(sta->pos[0] / 0.0001));
+    ublox_bitwriter_u(&bw, 1, sta->flg_osc);
+    ublox_bitwriter_u(&bw, 1, 0); // reserved
+    ublox_bitwriter_s64(&bw, 38, llround(sta->pos[1] / 0.0001));
+    ublox_bitwriter_u(&bw, 2, sta->quarter);
+    ublox_bitwriter_s64(&bw, 38, llround(sta->pos[2] / 0.0001));
+    if (0 != sta->height) {
+        ublox_bitwriter_u(&bw, 16, lround(sta->height / 0.0001));
+    }
+    return ublox_rtcm_frame_finish(&bw, frame);
+}
+
+/**
+ * \brief encode 1230, the GLONASS code-phase biases
+ * \param bias: the biases
+ * \param frame: the buffer of the frame
+ * \param sz_frame: the byte size of the buffer
+ *
+ * \return the byte size of the frame on success, <0 on error
+ */
+int
+ublox_rtcm_encode_glo_bias(const ublox_rtcm_glo_bias_t * bias, uint8_t * frame, size_t sz_frame)
+{
+    ublox_bitwriter_t bw;
+    size_t i;
+
+    assert (NULL != bias);
+    if (ublox_rtcm_frame_start(&bw, frame, sz_frame) < 0) {
+        return -1;
+    }
+    ublox_bitwriter_u(&bw, 12, 1230);
+    ublox_bitwriter_u(&bw, 12, bias->staid);
+    ublox_bitwriter_u(&bw, 1, bias->flg_aligned);
+    ublox_bitwriter_u(&bw, 3, 0); // reserved
+    ublox_bitwriter_u(&bw, 4, bias->mask);
+    for (i = 0; i < NUM_ARRAY(bias->bias); i ++) {
+        if (bias->mask & (0x08 >> i)) {
+            ublox_bitwriter_s(&bw, 16, lround(bias->bias[i] / 0.02));
+        }
+    }
+    return ublox_rtcm_frame_finish(&bw, frame);
+}
+
+/* the 4-bit lock time indicator of MSM4/5 of the lock time (ms) */
+static uint32_t
+ublox_rtcm_lock_ind_msm4(double lock)
+{
+    uint32_t ind = 0;
+
+    while ((ind < 15) && ((double)(16U << (ind + 1)) <= lock)) {
+        ind ++;
+    }
+    return ind;
+}
+
+/* the 10-bit extended lock time indicator of MSM6/7 of the lock time (ms) */
+static uint32_t
+ublox_rtcm_lock_ind_msm7(double lock)
+{
+    uint32_t k = 1;
+
+    if (lock < 64) {
+        return (lock > 0)?(uint32_t)lock:0;
+    }
+    // 2^k ms per step in [32 * 2^k, 64 * 2^k)
+    while ((k < 20) && (ldexp(64, k) <= lock)) {
+        k ++;
+    }
+    if (ldexp(64, k) <= lock) {
+        return 704;
+    }
+    return (uint32_t)ldexp(lock, -(int)k) + 32 * k;
+}
+
+/* the fine value of len bits, the invalid value -2^(len-1) if out of the range */
+static int32_t
+ublox_rtcm_fine(double val, size_t len)
+{
+    int32_t lim = 1 << (len - 1);
+    double v = round(val);
+
+    if ((v <= -lim) || (v >= lim)) {
+        return -lim;
+    }
+    return (int32_t)v;
+}
+
+/**
+ * \brief encode MSM4, MSM5, MSM6 or MSM7, the inverse of ublox_rtcm_decode_msm()
+ * \param msm: the message, the rough ranges should be in the step of 1/1024 ms
+ * \param frame: the buffer of the frame
+ * \param sz_frame: the byte size of the buffer
+ *
+ * \return the byte size of the frame on success, <0 on error
+ *
+ * The fine values out of the range of the fields are sent as invalid.
+ */
+int
+ublox_rtcm_encode_msm(const ublox_rtcm_msm_t * msm, uint8_t * frame, size_t sz_frame)
+{
+    const struct _ublox_rtcm_msm_fmt_t * fmt;
+    ublox_bitwriter_t bw;
+    uint32_t uval[UBLOX_RTCM_MSM_NUM_CELL];
+    int32_t sval[UBLOX_RTCM_MSM_NUM_CELL];
+    uint64_t mask;
+    double rr;
+    size_t num;
+    size_t i;
+
+    assert (NULL != msm);
+    if ((msm->type < 1071) || (msm->type > 1137) || (msm->type % 10 < 4) || (msm->type % 10 > 7)
+        || (msm->num_sat * msm->num_sig > UBLOX_RTCM_MSM_NUM_CELL)) {
+        return -1;
+    }
+    fmt = g_ublox_rtcm_msm_fmt + (msm->type % 10 - 4);
+    if (ublox_rtcm_frame_start(&bw, frame, sz_frame) < 0) {
+        return -1;
+    }
+    ublox_bitwriter_u(&bw, 12, msm->type);
+    ublox_bitwriter_u(&bw, 12, msm->staid);
+    ublox_bitwriter_u(&bw, 30, msm->epoch);
+    ublox_bitwriter_u(&bw, 1, msm->flg_more);
+    ublox_bitwriter_u(&bw, 3, msm->iods);
+    ublox_bitwriter_u(&bw, 7, 0); // reserved
+    ublox_bitwriter_u(&bw, 2, msm->clk_steer);
+    ublox_bitwriter_u(&bw, 2, msm->clk_ext);
+    ublox_bitwriter_u(&bw, 1, msm->flg_smooth);
+    ublox_bitwriter_u(&bw, 3, msm->smooth_int);
+    mask = 0;
+    for (i = 0; i < msm->num_sat; i ++) {
+        mask |= 1ULL << (UBLOX_RTCM_MSM_NUM_SAT - msm->sat[i]);
+    }
+    ublox_bitwriter_u64(&bw, 64, mask);
+    mask = 0;
+    for (i = 0; i < msm->num_sig; i ++) {
+        mask |= 1ULL << (UBLOX_RTCM_MSM_NUM_SIG - msm->sig[i]);
+    }
+    ublox_bitwriter_u(&bw, 32, (uint32_t)mask);
+    num = msm->num_sat * msm->num_sig;
+    mask = 0;
+    for (i = 0; i < msm->num_cell; i ++) {
+        mask |= 1ULL << (num - 1 - (msm->cell_sat[i] * msm->num_sig + msm->cell_sig[i]));
+    }
+    ublox_bitwriter_u64(&bw, num, mask);
+
+    // the satellite data
+    num = msm->num_sat;
+    for (i = 0; i < num; i ++) {
+        uval[i] = ((msm->rrange[i] < 0) || (msm->rrange[i] >= 255))?255:(uint32_t)msm->rrange[i];
+    }
+    ublox_bitwriter_array_u(&bw, 8, num, uval);
+    if (fmt->ext) {
+        for (i = 0; i < num; i ++) {
+            uval[i] = msm->ext[i];
+        }
+        ublox_bitwriter_array_u(&bw, fmt->ext, num, uval);
+    }
+    for (i = 0; i < num; i ++) {
+        uval[i] = (255 == uval[i])?0:((uint32_t)lround((msm->rrange[i] - floor(msm->rrange[i])) * 1024) & 0x3FF);
+    }
+    ublox_bitwriter_array_u(&bw, 10, num, uval);
+    if (fmt->rrate) {
+        for (i = 0; i < num; i ++) {
+            sval[i] = isnan(msm->rrate[i])?-8192:ublox_rtcm_fine(msm->rrate[i], 14);
+        }
+        ublox_bitwriter_array_s(&bw, fmt->rrate, num, sval);
+    }
+
+    // the signal data
+    num = msm->num_cell;
+    for (i = 0; i < num; i ++) {
+        rr = msm->rrange[msm->cell_sat[i]];
+        sval[i] = -(1 << (fmt->fpr - 1));
+        if ((rr >= 0) && (msm->flg[i] & UBLOX_RTCM_MSM_PR)) {
+            sval[i] = ublox_rtcm_fine((msm->pr[i] / UBLOX_RTCM_RANGE_MS - rr) / fmt->sc_fpr, fmt->fpr);
+        }
+    }
+    ublox_bitwriter_array_s(&bw, fmt->fpr, num, sval);
+    for (i = 0; i < num; i ++) {
+        rr = msm->rrange[msm->cell_sat[i]];
+        sval[i] = -(1 << (fmt->fcp - 1));
+        if ((rr >= 0) && (msm->flg[i] & UBLOX_RTCM_MSM_CP)) {
+            sval[i] = ublox_rtcm_fine((msm->cp[i] / UBLOX_RTCM_RANGE_MS - rr) / fmt->sc_fcp, fmt->fcp);
+        }
+    }
+    ublox_bitwriter_array_s(&bw, fmt->fcp, num, sval);
+    for (i = 0; i < num; i ++) {
+        uval[i] = (4 == fmt->lock)?ublox_rtcm_lock_ind_msm4(msm->lock[i]):ublox_rtcm_lock_ind_msm7(msm->lock[i]);
+    }
+    ublox_bitwriter_array_u(&bw, fmt->lock, num, uval);
+    for (i = 0; i < num; i ++) {
+        uval[i] = msm->half[i];
+    }
+    ublox_bitwriter_array_u(&bw, 1, num, uval);
+    for (i = 0; i < num; i ++) {
+        uval[i] = (msm->cnr[i] > 0)?(uint32_t)lround(msm->cnr[i] / fmt->sc_cnr):0;
+        if (uval[i] >= (1U << fmt->cnr)) {
+            uval[i] = (1U << fmt->cnr) - 1;
+        }
+    }
+    ublox_bitwriter_array_u(&bw, fmt->cnr, num, uval);
+    if (fmt->frate) {
+        for (i = 0; i < num; i ++) {
+            rr = msm->rrate[msm->cell_sat[i]];
+            sval[i] = -16384;
+            if (! isnan(rr) && (msm->flg[i] & UBLOX_RTCM_MSM_RATE)) {
+                sval[i] = ublox_rtcm_fine((msm->rate[i] - rr) / 0.0001, fmt->frate);
+            }
+        }
+        ublox_bitwriter_array_s(&bw, fmt->frate, num, sval);
+    }
+    return ublox_rtcm_frame_finish(&bw, frame);
+}
+
+/* the satellite ID and the signal ID of MSM of the measurement of the store */
+static int
+ublox_rtcm_col_sig(const ublox_rawx_col_t * col, size_t idx, uint8_t * psat, uint8_t * psig)
+{
+    const ublox_rtcm_sig_t * tbl;
+    uint8_t sigId = col->sigId[idx];
+    int sat = col->svId[idx];
+    size_t num;
+    size_t i;
+
+    if (1 == col->gnssId[idx]) {
+        sat -= 119; // the PRN of SBAS
+    }
+    if ((sat < 1) || (sat > UBLOX_RTCM_MSM_NUM_SAT)) {
+        return -1;
+    }
+    if (3 == col->gnssId[idx]) {
+        sigId &= ~1; // D1 and D2 of BeiDou
+    }
+    tbl = ublox_rtcm_sig_table(col->gnssId[idx], &num);
+    for (i = 0; (i < num) && (tbl[i].sigId != sigId); i ++) {
+    }
+    if (i >= num) {
+        return -1;
+    }
+    *psat = sat;
+    *psig = tbl[i].sig;
+    return 0;
+}
+
+/* the epoch time of MSM of the GPS time of week (s) */
+static uint32_t
+ublox_rtcm_msm_epoch(uint8_t gnssId, double tow, int leapS)
+{
+    int64_t ms = llround(tow * 1000.0);
+
+    if (3 == gnssId) {
+        ms -= 14000; // BDT
+    } else if (6 == gnssId) {
+        // GLONASS time is UTC(SU) + 3h, day of week and ms of day
+        ms += 10800000 - leapS * 1000;
+        ms = ((ms % 604800000) + 604800000) % 604800000;
+        return (uint32_t)(((ms / 86400000) << 27) | (ms % 86400000));
+    }
+    return (uint32_t)(((ms % 604800000) + 604800000) % 604800000);
+}
+
+/**
+ * \brief convert the measurements of a GNSS of an epoch of the store to MSM
+ * \param col: the store
+ * \param idx_epoch: the epoch
+ * \param type: the type of MSM, such as 1077
+ * \param psat_mask: in: the satellites to be converted, out: the satellites
+ *        not in the message because of the limit of 64 cells; bit 63 is the
+ *        satellite 1 as the mask of MSM
+ * \param msm: the result, the station ID and the multiple message bit are 0
+ *
+ * \return the number of the cells, <0 on error
+ *
+ * The measurements of the signals not supported by MSM are skipped.
+ */
+int
+ublox_rtcm_msm_from_col(const ublox_rawx_col_t * col, size_t idx_epoch, uint16_t type, uint64_t * psat_mask, ublox_rtcm_msm_t * msm)
+{
+    uint32_t sig_sat[UBLOX_RTCM_MSM_NUM_SAT];
+    int16_t cell[UBLOX_RTCM_MSM_NUM_CELL];
+    uint8_t idx_sat[UBLOX_RTCM_MSM_NUM_SAT + 1];
+    uint8_t idx_sig[UBLOX_RTCM_MSM_NUM_SIG + 1];
+    uint64_t mask_sat = 0;
+    uint64_t mask_in = 0;
+    uint32_t mask_sig = 0;
+    uint8_t gnssId;
+    uint8_t sigId;
+    uint8_t sat;
+    uint8_t sig;
+    uint8_t flg;
+    double freq;
+    size_t num;
+    size_t i;
+    size_t j;
+    int fcn;
+
+    assert ((NULL != col) && (NULL != msm));
+    if ((idx_epoch >= col->num_epoch) || (ublox_rtcm_msm_sys(type, &gnssId) < 4)) {
+        return -1;
+    }
+    memset(sig_sat, 0, sizeof(sig_sat));
+    for (j = col->meas_start[idx_epoch]; j < col->meas_start[idx_epoch + 1]; j ++) {
+        if ((col->gnssId[j] == gnssId) && (ublox_rtcm_col_sig(col, j, &sat, &sig) == 0)
+            && (*psat_mask & (1ULL << (UBLOX_RTCM_MSM_NUM_SAT - sat)))) {
+            sig_sat[sat - 1] |= 1U << (UBLOX_RTCM_MSM_NUM_SIG - sig);
+            mask_sat |= 1ULL << (UBLOX_RTCM_MSM_NUM_SAT - sat);
+        }
+    }
+    // the satellites in the order of ID until the cells are full
+    for (i = 0, num = 0; i < UBLOX_RTCM_MSM_NUM_SAT; i ++) {
+        if (0 == sig_sat[i]) {
+            continue;
+        }
+        if ((num + 1) * __builtin_popcount(mask_sig | sig_sat[i]) > UBLOX_RTCM_MSM_NUM_CELL) {
+            break;
+        }
+        mask_sig |= sig_sat[i];
+        mask_in |= 1ULL << (UBLOX_RTCM_MSM_NUM_SAT - 1 - i);
+        num ++;
+    }
+    *psat_mask = mask_sat & ~mask_in;
+
+    memset(msm, 0, sizeof(*msm));
+    msm->type = type;
+    msm->epoch = ublox_rtcm_msm_epoch(gnssId, col->rcvTow[idx_epoch], col->leapS[idx_epoch]);
+    msm->num_sat = ublox_rtcm_mask2id(mask_in, UBLOX_RTCM_MSM_NUM_SAT, msm->sat);
+    msm->num_sig = ublox_rtcm_mask2id(mask_sig, UBLOX_RTCM_MSM_NUM_SIG, msm->sig);
+    for (i = 0; i < msm->num_sat; i ++) {
+        idx_sat[msm->sat[i]] = i;
+        msm->rrange[i] = -1;
+        msm->rrate[i] = NAN;
+        msm->ext[i] = 0;
+    }
+    for (i = 0; i < msm->num_sig; i ++) {
+        idx_sig[msm->sig[i]] = i;
+    }
+    num = msm->num_sat * msm->num_sig;
+    for (i = 0; i < num; i ++) {
+        cell[i] = -1;
+    }
+    for (j = col->meas_start[idx_epoch]; j < col->meas_start[idx_epoch + 1]; j ++) {
+        if ((col->gnssId[j] == gnssId) && (ublox_rtcm_col_sig(col, j, &sat, &sig) == 0)
+            && (mask_in & (1ULL << (UBLOX_RTCM_MSM_NUM_SAT - sat)))) {
+            cell[idx_sat[sat] * msm->num_sig + idx_sig[sig]] = j;
+        }
+    }
+
+    for (i = 0; i < num; i ++) {
+        if (cell[i] < 0) {
+            continue;
+        }
+        j = cell[i];
+        msm->cell_sat[msm->num_cell] = i / msm->num_sig;
+        msm->cell_sig[msm->num_cell] = i % msm->num_sig;
+        sat = msm->sat[i / msm->num_sig];
+        fcn = (6 == gnssId)?(col->freqId[j] - 7):-8;
+        if (6 == gnssId) {
+            msm->ext[i / msm->num_sig] = (col->freqId[j] <= 13)?col->freqId[j]:15;
+        }
+        ublox_rtcm_msm_sig(gnssId, sat, msm->sig[i % msm->num_sig], fcn, &sigId, &freq);
+        flg = 0;
+        if (col->trkStat[j] & 0x01) {
+            flg |= UBLOX_RTCM_MSM_PR;
+        }
+        if (freq > 0) {
+            flg |= UBLOX_RTCM_MSM_RATE | ((col->trkStat[j] & 0x02)?UBLOX_RTCM_MSM_CP:0);
+        }
+        msm->flg[msm->num_cell] = flg;
+        msm->pr[msm->num_cell] = col->prMes[j];
+        msm->cp[msm->num_cell] = (flg & UBLOX_RTCM_MSM_CP)?(col->cpMes[j] * UBLOX_RTCM_CLIGHT / freq):0;
+        msm->rate[msm->num_cell] = (flg & UBLOX_RTCM_MSM_RATE)?(-col->doMes[j] * UBLOX_RTCM_CLIGHT / freq):0;
+        msm->lock[msm->num_cell] = col->locktime[j];
+        msm->cnr[msm->num_cell] = col->cno[j];
+        // halfCyc of trkStat is set if the half cycle is resolved
+        msm->half[msm->num_cell] = ((flg & UBLOX_RTCM_MSM_CP) && ! (col->trkStat[j] & 0x04))?1:0;
+        msm->num_cell ++;
+    }
+
+    // the rough values of the satellites from the first valid signal
+    for (i = 0; i < msm->num_cell; i ++) {
+        j = msm->cell_sat[i];
+        if ((msm->rrange[j] < 0) && (msm->flg[i] & (UBLOX_RTCM_MSM_PR | UBLOX_RTCM_MSM_CP))) {
+            msm->rrange[j] = round(((msm->flg[i] & UBLOX_RTCM_MSM_PR)?msm->pr[i]:msm->cp[i]) / UBLOX_RTCM_RANGE_MS * 1024) / 1024;
+            if (msm->rrange[j] >= 255) {
+                msm->rrange[j] = -1;
+            }
+        }
+        if (isnan(msm->rrate[j]) && (msm->flg[i] & UBLOX_RTCM_MSM_RATE)) {
+            msm->rrate[j] = round(msm->rate[i]);
+        }
+    }
+    return msm->num_cell;
+}
+
+/**
+ * \brief setup the encoder
+ * \param enc: the encoder
+ * \param staid: the reference station ID
+ * \param msm_no: the MSM number of the output, 4-7
+ * \param handler: the function to send a frame
+ * \param userdata: the user data of the handler
+ */
+void
+ublox_rtcm_enc_init(ublox_rtcm_enc_t * enc, uint16_t staid, uint8_t msm_no, ublox_handler_t handler, void * userdata)
+{
+    assert (NULL != enc);
+    assert ((4 <= msm_no) && (msm_no <= 7));
+    memset(enc, 0, sizeof(*enc));
+    enc->staid = staid;
+    enc->msm_no = msm_no;
+    enc->handler = handler;
+    enc->userdata = userdata;
+    enc->sta.staid = staid;
+    enc->glo_bias.staid = staid;
+    ublox_rawx_col_init(&(enc->col));
+}
+
+/**
+ * \brief release the memory of the encoder
+ * \param enc: the encoder
+ */
+void
+ublox_rtcm_enc_clear(ublox_rtcm_enc_t * enc)
+{
+    ublox_rawx_col_clear(&(enc->col));
+}
+
+/**
+ * \brief set the antenna reference point of 1005
+ * \param enc: the encoder
+ * \param pos: the ECEF position (m)
+ */
+void
+ublox_rtcm_enc_set_sta(ublox_rtcm_enc_t * enc, const double pos[3])
+{
+    enc->sta.staid = enc->staid;
+    enc->sta.flg_gps = 1;
+    enc->sta.flg_glo = 1;
+    enc->sta.flg_gal = 1;
+    enc->sta.pos[0] = pos[0];
+    enc->sta.pos[1] = pos[1];
+    enc->sta.pos[2] = pos[2];
+    enc->flg_sta = 1;
+}
+
+/* send the frame in enc->frame */
+static int
+ublox_rtcm_enc_send(ublox_rtcm_enc_t * enc, int sz_frame)
+{
+    if (sz_frame < 0) {
+        return -1;
+    }
+    enc->num_frames ++;
+    if (NULL == enc->handler) {
+        return 0;
+    }
+    return enc->handler(enc->userdata, enc->frame, sz_frame);
+}
+
+/**
+ * \brief encode an epoch of the store to MSMs, and 1005/1230 at the interval
+ * \param enc: the encoder
+ * \param col: the store
+ * \param idx_epoch: the epoch
+ *
+ * \return the number of the frames sent, <0 on error
+ */
+int
+ublox_rtcm_enc_epoch(ublox_rtcm_enc_t * enc, const ublox_rawx_col_t * col, size_t idx_epoch)
+{
+    // the order of the GNSS in the stream, 107x, 108x, ...
+    static const uint8_t gnss[6] = { 0, 6, 2, 1, 5, 3 };
+    uint64_t sat_mask[NUM_ARRAY(gnss)];
+    uint64_t mask;
+    uint8_t sat;
+    uint8_t sig;
+    size_t num_frames = enc->num_frames;
+    size_t i;
+    size_t j;
+    int last = -1;
+
+    assert ((NULL != enc) && (NULL != col));
+    if (idx_epoch >= col->num_epoch) {
+        return -1;
+    }
+    if (enc->flg_sta && ((0 == enc->num_epoch) || ((enc->interval_sta > 0) && (0 == enc->num_epoch % enc->interval_sta)))) {
+        if (ublox_rtcm_enc_send(enc, ublox_rtcm_encode_sta(&(enc->sta), enc->frame, sizeof(enc->frame))) < 0) {
+            return -1;
+        }
+        if (enc->sta.flg_glo && (ublox_rtcm_enc_send(enc, ublox_rtcm_encode_glo_bias(&(enc->glo_bias), enc->frame, sizeof(enc->frame))) < 0)) {
+            return -1;
+        }
+    }
+    enc->num_epoch ++;
+
+    // the satellites of each GNSS, to find the last message of the epoch
+    memset(sat_mask, 0, sizeof(sat_mask));
+    for (j = col->meas_start[idx_epoch]; j < col->meas_start[idx_epoch + 1]; j ++) {
+        for (i = 0; (i < NUM_ARRAY(gnss)) && (gnss[i] != col->gnssId[j]); i ++) {
+        }
+        if ((i < NUM_ARRAY(gnss)) && (ublox_rtcm_col_sig(col, j, &sat, &sig) == 0)) {
+            sat_mask[i] |= 1ULL << (UBLOX_RTCM_MSM_NUM_SAT - sat);
+            last = ((int)i > last)?(int)i:last;
+        }
+    }
+    for (i = 0; (int)i <= last; i ++) {
+        mask = sat_mask[i];
+        while (0 != mask) {
+            if (ublox_rtcm_msm_from_col(col, idx_epoch, 1070 + i * 10 + enc->msm_no, &mask, &(enc->msm)) <= 0) {
+                return -1;
+            }
+            enc->msm.staid = enc->staid;
+            enc->msm.iods = enc->iods;
+            enc->msm.flg_more = ((0 != mask) || ((int)i < last))?1:0;
+            if (ublox_rtcm_enc_send(enc, ublox_rtcm_encode_msm(&(enc->msm), enc->frame, sizeof(enc->frame))) < 0) {
+                return -1;
+            }
+        }
+    }
+    return enc->num_frames - num_frames;
+}
+
+/**
+ * \brief the handler of RXM-RAWX to send the MSMs of the epoch, see ublox_registry_set()
+ * \param userdata: the encoder, ublox_rtcm_enc_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_rtcm_enc_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rtcm_enc_t * enc = (ublox_rtcm_enc_t *)userdata;
+
+    ublox_rawx_col_reset(&(enc->col));
+    if (ublox_rawx_col_handler(&(enc->col), buffer_in, sz_in) < 0) {
+        return -1;
+    }
+    return (ublox_rtcm_enc_epoch(enc, &(enc->col), 0) < 0)?-1:0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* append the value of len bits (<= 64) at *ppos */
+static void
+ublox_rtcm_test_put(uint8_t * buf, size_t * ppos, size_t len, int64_t val)
+{
+    if (len > 32) {
+        ublox_setbitu(buf, *ppos, len - 32, (uint32_t)((uint64_t)val >> 32));
+        *ppos += len - 32;
+        len = 32;
+    }
+    ublox_setbitu(buf, *ppos, len, (uint32_t)((uint64_t)val & ((len < 32)?((1ULL << len) - 1):0xFFFFFFFFULL)));
+    *ppos += len;
+}
+
+/* wrap the payload of the bits into a frame */
+static size_t
+ublox_rtcm_test_frame(uint8_t * frame, size_t num_bits)
+{
+    size_t sz_payload = (num_bits + 7) / 8;
+    uint32_t crc;
+
+    frame[0] = 0xD3;
+    frame[1] = (sz_payload >> 8) & 0x03;
+    frame[2] = sz_payload & 0xFF;
+    crc = ublox_crc24q(frame, 3 + sz_payload);
+    ublox_setbitu(frame + 3 + sz_payload, 0, 24, crc);
+    return 3 + sz_payload + 3;
+}
+
+/*
+ * create a MSM of the satellites 5 and 12, the signals sig1 and sig2, the
+ * cells (5, sig1), (5, sig2), (12, sig1); the pseudorange of the last cell is
+ * invalid
+ */
+static size_t
+ublox_rtcm_test_msm(uint8_t * frame, size_t sz_frame, uint16_t type, uint32_t epoch, uint8_t more, uint8_t ext, uint8_t sig1, uint8_t sig2)
+{
+    const struct _ublox_rtcm_msm_fmt_t * fmt = g_ublox_rtcm_msm_fmt + (type % 10 - 4);
+    static const uint8_t int_ms[2] = { 70, 75 };
+    static const uint16_t mod_ms[2] = { 512, 0 };
+    static const int16_t rrate[2] = { -100, 200 };
+    uint8_t * p = frame + 3;
+    size_t pos = 0;
+    size_t i;
+
+    memset(frame, 0, sz_frame);
+    ublox_rtcm_test_put(p, &pos, 12, type);
+    ublox_rtcm_test_put(p, &pos, 12, 2002);
+    ublox_rtcm_test_put(p, &pos, 30, epoch);
+    ublox_rtcm_test_put(p, &pos, 1, more);
+    ublox_rtcm_test_put(p, &pos, 3 + 7 + 2 + 2 + 1 + 3, 0);
+    ublox_rtcm_test_put(p, &pos, 64, (1ULL << (64 - 5)) | (1ULL << (64 - 12)));
+    ublox_rtcm_test_put(p, &pos, 32, (1ULL << (32 - sig1)) | (1ULL << (32 - sig2)));
+    ublox_rtcm_test_put(p, &pos, 4, 0x0E);
+    for (i = 0; i < 2; i ++) {
+        ublox_rtcm_test_put(p, &pos, 8, int_ms[i]);
+    }
+    for (i = 0; fmt->ext && (i < 2); i ++) {
+        ublox_rtcm_test_put(p, &pos, fmt->ext, ext + i);
+    }
+    for (i = 0; i < 2; i ++) {
+        ublox_rtcm_test_put(p, &pos, 10, mod_ms[i]);
+    }
+    for (i = 0; fmt->rrate && (i < 2); i ++) {
+        ublox_rtcm_test_put(p, &pos, fmt->rrate, rrate[i]);
+    }
+    ublox_rtcm_test_put(p, &pos, fmt->fpr, 1000);
+    ublox_rtcm_test_put(p, &pos, fmt->fpr, -1000);
+    ublox_rtcm_test_put(p, &pos, fmt->fpr, -(1 << (fmt->fpr - 1)));
+    for (i = 0; i < 3; i ++) {
+        ublox_rtcm_test_put(p, &pos, fmt->fcp, 2000);
+    }
+    for (i = 0; i < 3; i ++) {
+        ublox_rtcm_test_put(p, &pos, fmt->lock, (4 == fmt->lock)?2:100);
+    }
+    for (i = 0; i < 3; i ++) {
+        ublox_rtcm_test_put(p, &pos, 1, (1 == i));
+    }
+    for (i = 0; i < 3; i ++) {
+        ublox_rtcm_test_put(p, &pos, fmt->cnr, (6 == fmt->cnr)?45:(45 * 16 + 8));
+    }
+    for (i = 0; fmt->frate && (i < 3); i ++) {
+        ublox_rtcm_test_put(p, &pos, fmt->frate, 50);
+    }
+    return ublox_rtcm_test_frame(frame, pos);
+}
+
+TEST_CASE( .name="ublox-rtcm", .description="Test ublox RTCM 3 decoder." ) {
+    uint8_t frame[1024];
+    ublox_rtcm_msm_t msm;
+    ublox_rtcm_t rtcm;
+    ublox_rawx_col_t col;
+    size_t sz_frame;
+    size_t pos;
+    uint8_t gnssId;
+    uint8_t sigId;
+    double freq;
+    double pr;
+
+    SECTION("test ublox_rtcm_decode_sta and ublox_rtcm_decode_glo_bias") {
+        memset(frame, 0, sizeof(frame));
+        pos = 0;
+        ublox_rtcm_test_put(frame + 3, &pos, 12, 1005);
+        ublox_rtcm_test_put(frame + 3, &pos, 12, 2002);
+        ublox_rtcm_test_put(frame + 3, &pos, 6, 0);
+        ublox_rtcm_test_put(frame + 3, &pos, 4, 0x0D);
+        ublox_rtcm_test_put(frame + 3, &pos, 38, -12345678901LL);
+        ublox_rtcm_test_put(frame + 3, &pos, 2, 0);
+        ublox_rtcm_test_put(frame + 3, &pos, 38, 45678901234LL);
+        ublox_rtcm_test_put(frame + 3, &pos, 2, 0);
+        ublox_rtcm_test_put(frame + 3, &pos, 38, 40000000001LL);
+        REQUIRE(152 == pos);
+        sz_frame = ublox_rtcm_test_frame(frame, pos);
+        REQUIRE(25 == sz_frame);
+
+        ublox_rtcm_init(&rtcm, NULL);
+        REQUIRE(1005 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(1 == rtcm.num_sta);
+        REQUIRE(2002 == rtcm.sta.staid);
+        REQUIRE(1 == rtcm.sta.flg_gps);
+        REQUIRE(1 == rtcm.sta.flg_glo);
+        REQUIRE(0 == rtcm.sta.flg_gal);
+        REQUIRE(1 == rtcm.sta.flg_ref);
+        REQUIRE(fabs(rtcm.sta.pos[0] + 1234567.8901) < 1e-6);
+        REQUIRE(fabs(rtcm.sta.pos[1] - 4567890.1234) < 1e-6);
+        REQUIRE(fabs(rtcm.sta.pos[2] - 4000000.0001) < 1e-6);
+        REQUIRE(-1 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame - 1));
+
+        memset(frame, 0, sizeof(frame));
+        pos = 0;
+        ublox_rtcm_test_put(frame + 3, &pos, 12, 1230);
+        ublox_rtcm_test_put(frame + 3, &pos, 12, 2002);
+        ublox_rtcm_test_put(frame + 3, &pos, 4, 0x08);
+        ublox_rtcm_test_put(frame + 3, &pos, 4, 0x0A);
+        ublox_rtcm_test_put(frame + 3, &pos, 16, -150);
+        ublox_rtcm_test_put(frame + 3, &pos, 16, 250);
+        sz_frame = ublox_rtcm_test_frame(frame, pos);
+        REQUIRE(1230 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(1 == rtcm.glo_bias.flg_aligned);
+        REQUIRE(0x0A == rtcm.glo_bias.mask);
+        REQUIRE(fabs(rtcm.glo_bias.bias[0] + 3.0) < 1e-9);
+        REQUIRE(0 == rtcm.glo_bias.bias[1]);
+        REQUIRE(fabs(rtcm.glo_bias.bias[2] - 5.0) < 1e-9);
+
+        ublox_setbitu(frame + 3, 0, 12, 1019);
+        sz_frame = ublox_rtcm_test_frame(frame, pos);
+        REQUIRE(0 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(1 == rtcm.num_unknown);
+    }
+
+    SECTION("test ublox_rtcm_decode_msm") {
+        REQUIRE(0 == ublox_rtcm_lock_msm7(0));
+        REQUIRE(63 == ublox_rtcm_lock_msm7(63));
+        REQUIRE(64 == ublox_rtcm_lock_msm7(64));
+        REQUIRE(144 == ublox_rtcm_lock_msm7(100));
+        REQUIRE(2048 * 400 - 720896 == ublox_rtcm_lock_msm7(400));
+        REQUIRE(67108864 == ublox_rtcm_lock_msm7(704));
+        REQUIRE(32 == ublox_rtcm_lock_msm4(1));
+
+        REQUIRE(7 == ublox_rtcm_msm_sys(1077, &gnssId));
+        REQUIRE(0 == gnssId);
+        REQUIRE(4 == ublox_rtcm_msm_sys(1084, &gnssId));
+        REQUIRE(6 == gnssId);
+        REQUIRE(7 == ublox_rtcm_msm_sys(1127, &gnssId));
+        REQUIRE(3 == gnssId);
+        REQUIRE(-1 == ublox_rtcm_msm_sys(1005, &gnssId));
+        REQUIRE(0 == ublox_rtcm_msm_sig(3, 3, 2, 0, &sigId, &freq));
+        REQUIRE(1 == sigId);
+        REQUIRE(0 == ublox_rtcm_msm_sig(6, 3, 2, -7, &sigId, &freq));
+        REQUIRE(fabs(freq - 1598.0625e6) < 1.0);
+        REQUIRE(-1 == ublox_rtcm_msm_sig(0, 3, 3, 0, &sigId, &freq));
+
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1077, 345600000, 0, 0, 2, 15);
+        REQUIRE(0 == ublox_rtcm_decode_msm(frame + 3, UBLOX_RTCM3_LENGTH(frame), &msm));
+        REQUIRE(1077 == msm.type);
+        REQUIRE(2002 == msm.staid);
+        REQUIRE(345600000 == msm.epoch);
+        REQUIRE(2 == msm.num_sat);
+        REQUIRE(5 == msm.sat[0]);
+        REQUIRE(12 == msm.sat[1]);
+        REQUIRE(2 == msm.num_sig);
+        REQUIRE(15 == msm.sig[1]);
+        REQUIRE(3 == msm.num_cell);
+        REQUIRE(1 == msm.cell_sat[2]);
+        REQUIRE(0 == msm.cell_sig[2]);
+        REQUIRE(fabs(msm.rrange[0] - 70.5) < 1e-12);
+        REQUIRE(fabs(msm.rrate[1] - 200) < 1e-12);
+        pr = (70.5 - 1000 * 0x1p-29) * UBLOX_RTCM_RANGE_MS;
+        REQUIRE(fabs(msm.pr[1] - pr) < 1e-6);
+        REQUIRE((UBLOX_RTCM_MSM_PR | UBLOX_RTCM_MSM_CP | UBLOX_RTCM_MSM_RATE) == msm.flg[0]);
+        REQUIRE((UBLOX_RTCM_MSM_CP | UBLOX_RTCM_MSM_RATE) == msm.flg[2]);
+        REQUIRE(144 == msm.lock[0]);
+        REQUIRE(1 == msm.half[1]);
+        REQUIRE(fabs(msm.cnr[0] - 45.5) < 1e-6);
+        REQUIRE(fabs(msm.rate[2] - 200.005) < 1e-9);
+        REQUIRE(-1 == ublox_rtcm_decode_msm(frame + 3, UBLOX_RTCM3_LENGTH(frame) - 1, &msm));
+
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1084, 0, 0, 0, 2, 8);
+        REQUIRE(0 == ublox_rtcm_decode_msm(frame + 3, UBLOX_RTCM3_LENGTH(frame), &msm));
+        REQUIRE(15 == msm.ext[0]);
+        REQUIRE(64 == msm.lock[2]);
+        REQUIRE(fabs(msm.cnr[1] - 45) < 1e-6);
+        REQUIRE(UBLOX_RTCM_MSM_CP == msm.flg[2]);
+    }
+
+    SECTION("test ublox_rtcm_add_frame to the columnar store") {
+        ublox_rawx_col_init(&col);
+        ublox_rtcm_init(&rtcm, &col);
+        rtcm.week = 2300;
+
+        // GPS and Galileo of the same epoch, GPS L2 CM is mapped, Galileo 2C is skipped
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1077, 345600000, 1, 0, 2, 15);
+        REQUIRE(1077 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1097, 345600000, 0, 0, 2, 9);
+        REQUIRE(1097 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(2 == rtcm.num_msm);
+        REQUIRE(1 == rtcm.num_skip);
+        REQUIRE(1 == col.num_epoch);
+        REQUIRE(5 == col.num_meas);
+        REQUIRE(345600.0 == col.rcvTow[0]);
+        REQUIRE(2300 == col.week[0]);
+        REQUIRE(0 == col.gnssId[1]);
+        REQUIRE(4 == col.sigId[1]);
+        REQUIRE(12 == col.svId[2]);
+        REQUIRE(2 == col.gnssId[3]);
+        REQUIRE(fabs(col.prMes[1] - pr) < 1e-6);
+        REQUIRE(fabs(col.cpMes[0] - (70.5 + 2000 * 0x1p-31) * 0.001 * UBLOX_RTCM_FREQ_L1) < 1e-4);
+        REQUIRE(fabs(col.doMes[0] - (-(-100 + 0.005) * UBLOX_RTCM_FREQ_L1 / UBLOX_RTCM_CLIGHT)) < 1e-3);
+        REQUIRE(144 == col.locktime[0]);
+        REQUIRE(46 == col.cno[0]);
+        REQUIRE(0x07 == col.trkStat[0]);
+        REQUIRE(0x03 == col.trkStat[1]);
+        REQUIRE(0x06 == col.trkStat[2]);
+        REQUIRE(5 == col.meas_start[1]);
+
+        // GLONASS MSM4 before MSM7: the channel is unknown, the carrier phase is invalid
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1084, (10800000 + 1000), 0, 0, 2, 8);
+        REQUIRE(1084 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(2 == col.num_epoch);
+        REQUIRE(19.0 == col.rcvTow[1]);
+        REQUIRE(8 == col.num_meas);
+        REQUIRE(6 == col.gnssId[5]);
+        REQUIRE(0 == col.cpMes[5]);
+        REQUIRE(0x01 == col.trkStat[5]);
+
+        // the channels of the slots 5 and 12 are learned from MSM7
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1087, (10800000 + 2000), 0, 3, 2, 8);
+        REQUIRE(1087 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(3 == rtcm.glo_fcn[4]);
+        REQUIRE(4 == rtcm.glo_fcn[11]);
+        REQUIRE(3 == col.num_epoch);
+        REQUIRE(3 == col.freqId[8]);
+        REQUIRE(2 == col.sigId[9]);
+        REQUIRE(4 == col.freqId[10]);
+        REQUIRE(fabs(col.cpMes[8] - (70.5 + 2000 * 0x1p-31) * 0.001 * (UBLOX_RTCM_FREQ_G1 - 4 * UBLOX_RTCM_FREQ_G1K)) < 1e-4);
+        REQUIRE(0x07 == col.trkStat[8]);
+        REQUIRE(11 == col.meas_start[3]);
+        ublox_rawx_col_clear(&col);
+    }
+
+    SECTION("test ublox_rtcm_encode_msm") {
+        uint8_t frame2[1024];
+        static const uint16_t types[] = { 1074, 1077, 1084, 1087, 1095, 1126 };
+        size_t i;
+
+        for (i = 0; i < NUM_ARRAY(types); i ++) {
+            sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), types[i], 345600000, i % 2, 3, 2, 15);
+            REQUIRE(0 == ublox_rtcm_decode_msm(frame + 3, UBLOX_RTCM3_LENGTH(frame), &msm));
+            REQUIRE((int)sz_frame == ublox_rtcm_encode_msm(&msm, frame2, sizeof(frame2)));
+            REQUIRE(0 == memcmp(frame, frame2, sz_frame));
+        }
+        REQUIRE(-1 == ublox_rtcm_encode_msm(&msm, frame2, 20));
+
+        REQUIRE(0 == ublox_rtcm_lock_ind_msm7(0));
+        REQUIRE(63 == ublox_rtcm_lock_ind_msm7(63.5));
+        REQUIRE(100 == ublox_rtcm_lock_ind_msm7(144));
+        REQUIRE(100 == ublox_rtcm_lock_ind_msm7(147));
+        REQUIRE(703 == ublox_rtcm_lock_ind_msm7(67108863));
+        REQUIRE(704 == ublox_rtcm_lock_ind_msm7(67108864));
+        REQUIRE(704 == ublox_rtcm_lock_ind_msm7(1e8));
+        REQUIRE(704 == ublox_rtcm_lock_ind_msm7(1e9));
+        REQUIRE(0 == ublox_rtcm_lock_ind_msm4(31));
+        REQUIRE(5 == ublox_rtcm_lock_ind_msm4(600));
+        REQUIRE(11 == ublox_rtcm_lock_ind_msm4(64500));
+        REQUIRE(15 == ublox_rtcm_lock_ind_msm4(1e9));
+    }
+
+    SECTION("test ublox_rtcm_enc_epoch") {
+        ublox_rawx_col_t col2;
+        ublox_rtcm_t rtcm2;
+        ublox_rtcm_enc_t * enc;
+        static const double pos_sta[3] = { -1234567.8901, 4567890.1234, 4000000.0001 };
+        size_t i;
+
+        // the measurements decoded from MSMs
+        ublox_rawx_col_init(&col);
+        ublox_rtcm_init(&rtcm, &col);
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1077, 345600000, 1, 0, 2, 15);
+        REQUIRE(1077 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1097, 345600000, 0, 0, 2, 15);
+        REQUIRE(1097 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        sz_frame = ublox_rtcm_test_msm(frame, sizeof(frame), 1087, (10800000 + 2000), 0, 3, 2, 8);
+        REQUIRE(1087 == ublox_rtcm_add_frame(&rtcm, frame, sz_frame));
+        REQUIRE(2 == col.num_epoch);
+        REQUIRE(9 == col.num_meas);
+
+        // encode and decode again
+        enc = malloc(sizeof(*enc));
+        REQUIRE(NULL != enc);
+        ublox_rawx_col_init(&col2);
+        ublox_rtcm_init(&rtcm2, &col2);
+        ublox_rtcm_enc_init(enc, 2002, 7, ublox_rtcm_handler, &rtcm2);
+        ublox_rtcm_enc_set_sta(enc, pos_sta);
+        REQUIRE(4 == ublox_rtcm_enc_epoch(enc, &col, 0));
+        REQUIRE(1 == ublox_rtcm_enc_epoch(enc, &col, 1));
+        REQUIRE(-1 == ublox_rtcm_enc_epoch(enc, &col, 2));
+        REQUIRE(1 == rtcm2.num_sta);
+        REQUIRE(1 == rtcm2.num_glo_bias);
+        REQUIRE(fabs(rtcm2.sta.pos[0] - pos_sta[0]) < 1e-6);
+        REQUIRE(3 == rtcm2.num_msm);
+        REQUIRE(2 == col2.num_epoch);
+        REQUIRE(col.num_meas == col2.num_meas);
+        REQUIRE(col.rcvTow[1] == col2.rcvTow[1]);
+        for (i = 0; i < col.num_meas; i ++) {
+            REQUIRE(col.gnssId[i] == col2.gnssId[i]);
+            REQUIRE(col.svId[i] == col2.svId[i]);
+            REQUIRE(col.sigId[i] == col2.sigId[i]);
+            REQUIRE(col.freqId[i] == col2.freqId[i]);
+            REQUIRE(fabs(col.prMes[i] - col2.prMes[i]) < 1e-6);
+            REQUIRE(fabs(col.cpMes[i] - col2.cpMes[i]) < 1e-6);
+            REQUIRE(fabs(col.doMes[i] - col2.doMes[i]) < 1e-3);
+            REQUIRE(col.locktime[i] == col2.locktime[i]);
+            REQUIRE(col.cno[i] == col2.cno[i]);
+            REQUIRE(col.trkStat[i] == col2.trkStat[i]);
+        }
+
+        // 40 satellites of 2 signals are split to 2 messages
+        ublox_rawx_col_reset(&col);
+        REQUIRE(0 == ublox_rawx_col_reserve(&col, 1, 80));
+        col.rcvTow[0] = 1000.0;
+        col.meas_start[0] = 0;
+        for (i = 0; i < 80; i ++) {
+            col.prMes[i] = 2.0e7 + (i / 2) * 1000.0 + (i % 2) * 3.0;
+            col.cpMes[i] = col.prMes[i] / UBLOX_RTCM_CLIGHT * ((i % 2)?UBLOX_RTCM_FREQ_L2:UBLOX_RTCM_FREQ_L1);
+            col.doMes[i] = (i / 2) * 100.0 * ((i % 2)?UBLOX_RTCM_FREQ_L2:UBLOX_RTCM_FREQ_L1) / UBLOX_RTCM_FREQ_L1;
+            col.gnssId[i] = 0;
+            col.svId[i] = i / 2 + 1;
+            col.sigId[i] = (i % 2)?3:0;
+            col.freqId[i] = 0;
+            col.locktime[i] = 1000;
+            col.cno[i] = 40;
+            col.trkStat[i] = 0x07;
+        }
+        col.num_epoch = 1;
+        col.num_meas = 80;
+        col.meas_start[1] = 80;
+        ublox_rawx_col_reset(&col2);
+        enc->flg_sta = 0;
+        REQUIRE(2 == ublox_rtcm_enc_epoch(enc, &col, 0));
+        REQUIRE(1 == col2.num_epoch);
+        REQUIRE(80 == col2.num_meas);
+        REQUIRE(40 == col2.svId[79]);
+        REQUIRE(3 == col2.sigId[79]);
+        REQUIRE(fabs(col.prMes[79] - col2.prMes[79]) < 1e-3);
+        REQUIRE(fabs(col.cpMes[79] - col2.cpMes[79]) < 1e-2);
+        REQUIRE(fabs(col.doMes[79] - col2.doMes[79]) < 1e-3);
+
+        ublox_rtcm_enc_clear(enc);
+        free(enc);
+        ublox_rawx_col_clear(&col2);
+        ublox_rawx_col_clear(&col);
+    }
+}
+#endif /* CIUT_ENABLED */
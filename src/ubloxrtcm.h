@@ -0,0 +1,172 @@
+/**
+ * \file    ubloxrtcm.h
+ * \brief   The RTCM 3 decoder of MSM4-7 and the station messages 1005/1006/1230
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_RTCM_H
+#define UBLOX_RTCM_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxreg.h"
+#include "ubloxcol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_RTCM_CLIGHT 299792458.0 /**< the speed of light (m/s) */
+#define UBLOX_RTCM_RANGE_MS (UBLOX_RTCM_CLIGHT * 0.001) /**< the range of 1 ms (m) */
+
+#define UBLOX_RTCM_MSM_NUM_SAT  64 /**< the bits of the satellite mask */
+#define UBLOX_RTCM_MSM_NUM_SIG  32 /**< the bits of the signal mask */
+#define UBLOX_RTCM_MSM_NUM_CELL 64 /**< the max number of cells of a message */
+
+#define UBLOX_RTCM_MSM_PR   0x01 /**< the pseudorange of the cell is valid */
+#define UBLOX_RTCM_MSM_CP   0x02 /**< the phaserange of the cell is valid */
+#define UBLOX_RTCM_MSM_RATE 0x04 /**< the phaserange rate of the cell is valid */
+
+#define UBLOX_RTCM_SZ_FRAME_MAX (3 + 1023 + 3) /**< the max byte size of a frame */
+
+/** the type of the message in the RTCM 3 frame */
+#define UBLOX_RTCM_TYPE(p) ublox_getbitu((p) + 3, 0, 12)
+
+/** 1005/1006, the antenna reference point of the station */
+typedef struct _ublox_rtcm_sta_t {
+    uint16_t staid;
+    uint8_t itrf;         /**< the ITRF realization year */
+    uint8_t flg_gps;      /**< 1 if the station provides GPS */
+    uint8_t flg_glo;      /**< 1 if the station provides GLONASS */
+    uint8_t flg_gal;      /**< 1 if the station provides Galileo */
+    uint8_t flg_ref;      /**< 0: real station, 1: non-physical station */
+    uint8_t flg_osc;      /**< 1 if all of the measurements are from a single receiver oscillator */
+    uint8_t quarter;      /**< the quarter cycle indicator */
+    double pos[3];        /**< the ECEF position of the antenna reference point (m) */
+    double height;        /**< the antenna height of 1006 (m), 0 for 1005 */
+} ublox_rtcm_sta_t;
+
+/** 1230, the GLONASS code-phase biases */
+typedef struct _ublox_rtcm_glo_bias_t {
+    uint16_t staid;
+    uint8_t flg_aligned;  /**< 1 if the L1 and L2 phaseranges are aligned */
+    uint8_t mask;         /**< bit 3-0: L1 C/A, L1 P, L2 C/A, L2 P */
+    double bias[4];       /**< the biases in the order of the mask (m), 0 if not set */
+} ublox_rtcm_glo_bias_t;
+
+/**
+ * The multiple signal message (MSM) 4-7. The satellite data is indexed by
+ * the satellites in the mask, the signal data by the cells, in the order of
+ * the message.
+ */
+typedef struct _ublox_rtcm_msm_t {
+    uint16_t type;
+    uint16_t staid;
+    uint32_t epoch;       /**< the epoch time, the ms of the week, or day(3 bits) and ms of the day(27 bits) of GLONASS */
+    uint8_t flg_more;     /**< 1 if more MSMs of the same epoch follow */
+    uint8_t iods;
+    uint8_t clk_steer;
+    uint8_t clk_ext;
+    uint8_t flg_smooth;
+    uint8_t smooth_int;
+
+    size_t num_sat;
+    size_t num_sig;
+    size_t num_cell;
+    uint8_t sat[UBLOX_RTCM_MSM_NUM_SAT];  /**< the satellite IDs, 1-64 */
+    uint8_t sig[UBLOX_RTCM_MSM_NUM_SIG];  /**< the signal IDs, 1-32 */
+    uint8_t ext[UBLOX_RTCM_MSM_NUM_SAT];  /**< the extended satellite info of MSM5/7, the channel number + 7 of GLONASS; 15 if not available */
+    double rrange[UBLOX_RTCM_MSM_NUM_SAT]; /**< the rough range (ms), <0 if not valid */
+    double rrate[UBLOX_RTCM_MSM_NUM_SAT];  /**< the rough phaserange rate of MSM5/7 (m/s) */
+
+    uint8_t cell_sat[UBLOX_RTCM_MSM_NUM_CELL]; /**< the index of the satellite in sat[] */
+    uint8_t cell_sig[UBLOX_RTCM_MSM_NUM_CELL]; /**< the index of the signal in sig[] */
+    uint8_t flg[UBLOX_RTCM_MSM_NUM_CELL];      /**< UBLOX_RTCM_MSM_xxx */
+    double pr[UBLOX_RTCM_MSM_NUM_CELL];        /**< the pseudorange (m) */
+    double cp[UBLOX_RTCM_MSM_NUM_CELL];        /**< the phaserange (m) */
+    double rate[UBLOX_RTCM_MSM_NUM_CELL];      /**< the phaserange rate (m/s) */
+    double lock[UBLOX_RTCM_MSM_NUM_CELL];      /**< the minimum lock time (ms) */
+    float cnr[UBLOX_RTCM_MSM_NUM_CELL];        /**< the carrier to noise ratio (dBHz) */
+    uint8_t half[UBLOX_RTCM_MSM_NUM_CELL];     /**< 1 if the half-cycle ambiguity is not resolved */
+} ublox_rtcm_msm_t;
+
+/**
+ * The decoder of the RTCM 3 stream of a base station. The MSMs are appended to
+ * the columnar store of RXM-RAWX, the MSMs of one epoch (the multiple message
+ * bit is set except the last one) are in one epoch of the store.
+ */
+typedef struct _ublox_rtcm_t {
+    ublox_rawx_col_t * col;   /**< the observations, can be NULL */
+    uint16_t week;            /**< the GPS week of the observations, set by the caller */
+    int8_t leapS;             /**< the GPS leap seconds to convert the time of GLONASS, set by the caller */
+    int8_t glo_fcn[32];       /**< the frequency channel + 7 of the GLONASS slots 1-32 learned from MSM5/7, <0 unknown */
+
+    uint8_t flg_more;         /**< the multiple message bit of the last MSM */
+    double tow_last;          /**< the GPS time of week of the last MSM (s), <0 if none */
+
+    ublox_rtcm_sta_t sta;     /**< the last 1005/1006 */
+    ublox_rtcm_glo_bias_t glo_bias; /**< the last 1230 */
+    size_t num_sta;           /**< the number of 1005/1006 received */
+    size_t num_glo_bias;      /**< the number of 1230 received */
+    size_t num_msm;           /**< the number of MSMs appended */
+    size_t num_skip;          /**< the number of cells without the UBX signal ID */
+    size_t num_unknown;       /**< the number of the messages not decoded */
+} ublox_rtcm_t;
+
+/**
+ * The encoder of the RTCM 3 stream of a base station from RXM-RAWX. The MSMs
+ * of an epoch are sent by the GNSS (and split if more than 64 cells), the
+ * multiple message bit is set except the last one. The frames are built in
+ * the preallocated buffer and passed to the handler one by one.
+ */
+typedef struct _ublox_rtcm_enc_t {
+    uint16_t staid;
+    uint8_t msm_no;           /**< the MSM number of the output, 4-7 */
+    uint8_t iods;             /**< the issue of data station */
+    uint8_t flg_sta;          /**< 1 if sta is set, 1005 (and 1230 if sta.flg_glo) are sent */
+    size_t interval_sta;      /**< send 1005/1230 every interval_sta epochs, 0 for the first epoch only */
+    ublox_rtcm_sta_t sta;     /**< the antenna reference point of 1005 */
+    ublox_rtcm_glo_bias_t glo_bias; /**< the biases of 1230 */
+
+    ublox_handler_t handler;  /**< called with each frame */
+    void * userdata;          /**< the user data of the handler */
+
+    ublox_rawx_col_t col;     /**< the last RXM-RAWX of ublox_rtcm_enc_handler() */
+    ublox_rtcm_msm_t msm;     /**< the message being encoded */
+    uint8_t frame[UBLOX_RTCM_SZ_FRAME_MAX]; /**< the frame being encoded */
+
+    size_t num_epoch;         /**< the number of epochs encoded */
+    size_t num_frames;        /**< the number of frames sent */
+} ublox_rtcm_enc_t;
+
+int ublox_rtcm_decode_sta(const uint8_t * payload, size_t sz_payload, ublox_rtcm_sta_t * sta);
+int ublox_rtcm_decode_glo_bias(const uint8_t * payload, size_t sz_payload, ublox_rtcm_glo_bias_t * bias);
+int ublox_rtcm_decode_msm(const uint8_t * payload, size_t sz_payload, ublox_rtcm_msm_t * msm);
+
+int ublox_rtcm_msm_sys(uint16_t type, uint8_t * pgnssId);
+int ublox_rtcm_msm_sig(uint8_t gnssId, uint8_t svId, uint8_t sig, int fcn, uint8_t * psigId, double * pfreq);
+
+void ublox_rtcm_init(ublox_rtcm_t * rtcm, ublox_rawx_col_t * col);
+int ublox_rtcm_msm_append(ublox_rtcm_t * rtcm, const ublox_rtcm_msm_t * msm);
+int ublox_rtcm_add_frame(ublox_rtcm_t * rtcm, const uint8_t * buffer_in, size_t sz_in);
+int ublox_rtcm_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+int ublox_rtcm_encode_sta(const ublox_rtcm_sta_t * sta, uint8_t * frame, size_t sz_frame);
+int ublox_rtcm_encode_glo_bias(const ublox_rtcm_glo_bias_t * bias, uint8_t * frame, size_t sz_frame);
+int ublox_rtcm_encode_msm(const ublox_rtcm_msm_t * msm, uint8_t * frame, size_t sz_frame);
+int ublox_rtcm_msm_from_col(const ublox_rawx_col_t * col, size_t idx_epoch, uint16_t type, uint64_t * psat_mask, ublox_rtcm_msm_t * msm);
+
+void ublox_rtcm_enc_init(ublox_rtcm_enc_t * enc, uint16_t staid, uint8_t msm_no, ublox_handler_t handler, void * userdata);
+void ublox_rtcm_enc_clear(ublox_rtcm_enc_t * enc);
+void ublox_rtcm_enc_set_sta(ublox_rtcm_enc_t * enc, const double pos[3]);
+int ublox_rtcm_enc_epoch(ublox_rtcm_enc_t * enc, const ublox_rawx_col_t * col, size_t idx_epoch);
+int ublox_rtcm_enc_handler(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_RTCM_H */
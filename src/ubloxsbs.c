@@ -0,0 +1,782 @@
+/**
+ * \file    ubloxsbs.c
+ * \brief   The SBAS message decoder and the correction tables
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The SBAS messages (RTCA DO-229) are received from RXM-SFRBX with
+ * gnssId 1, or RXM-SFRB of the legacy receivers. The 8 words contain the
+ * first 226 bits of the 250-bit message: the preamble, the message type
+ * and the data; the CRC is checked by the receiver.
+ *
+ * The supported message types:
+ *  - 0: do not use
+ *  - 1: PRN mask
+ *  - 2-5: fast corrections
+ *  - 6: integrity information
+ *  - 7: fast correction degradation factor
+ *  - 24: mixed fast/long-term corrections
+ *  - 25: long-term corrections
+ */
+
+#include <math.h>
+
+#include "ubloxconn.h"
+#include "ubloxutils.h"
+#include "ubloxdec.h"
+#include "ubloxsbs.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/**
+ * \brief setup the empty tables
+ * \param sbs: the tables
+ * \param prn: the PRN of the GEO, 0 to use the first one received
+ */
+void
+ublox_sbs_init(ublox_sbs_t * sbs, uint8_t prn)
+{
+    assert (NULL != sbs);
+    memset(sbs, 0, sizeof(*sbs));
+    sbs->prn = prn;
+    sbs->iodp = -1;
+}
+
+/**
+ * \brief get the satellite of a PRN mask number
+ * \param no: the PRN mask number, 1-210
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ *
+ * \return 0 on success, <0 if the number is reserved
+ */
+int
+ublox_sbs_mask2sat(int no, uint8_t * gnssId, uint8_t * svId)
+{
+    if ((no >= 1) && (no <= 37)) {
+        *gnssId = 0; *svId = no;
+    } else if ((no >= 38) && (no <= 61)) {
+        *gnssId = 6; *svId = no - 37;
+    } else if ((no >= 120) && (no <= 158)) {
+        *gnssId = 1; *svId = no;
+    } else if ((no >= 193) && (no <= 202)) {
+        *gnssId = 5; *svId = no - 192;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * \brief get the PRN mask number of a satellite
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ *
+ * \return the PRN mask number, 1-210, <0 if the satellite is not in the mask
+ */
+int
+ublox_sbs_sat2mask(uint8_t gnssId, uint8_t svId)
+{
+    switch (gnssId) {
+    case 0:
+        return ((svId >= 1) && (svId <= 37))?svId:-1;
+    case 1:
+        return ((svId >= 120) && (svId <= 158))?svId:-1;
+    case 5:
+        return ((svId >= 1) && (svId <= 10))?(svId + 192):-1;
+    case 6:
+        return ((svId >= 1) && (svId <= 24))?(svId + 37):-1;
+    }
+    return -1;
+}
+
+/**
+ * \brief get the fast correction of a satellite
+ * \param sbs: the tables
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ *
+ * \return the correction, NULL if it's not received
+ */
+const ublox_sbs_fcorr_t *
+ublox_sbs_get_fcorr(const ublox_sbs_t * sbs, uint8_t gnssId, uint8_t svId)
+{
+    int no = ublox_sbs_sat2mask(gnssId, svId);
+    if ((no < 1) || (! sbs->fcorr[no - 1].flg)) {
+        return NULL;
+    }
+    return &(sbs->fcorr[no - 1]);
+}
+
+/**
+ * \brief get the long-term correction of a satellite
+ * \param sbs: the tables
+ * \param gnssId: the gnssId of UBX
+ * \param svId: the svId of UBX
+ *
+ * \return the correction, NULL if it's not received
+ */
+const ublox_sbs_lcorr_t *
+ublox_sbs_get_lcorr(const ublox_sbs_t * sbs, uint8_t gnssId, uint8_t svId)
+{
+    int no = ublox_sbs_sat2mask(gnssId, svId);
+    if ((no < 1) || (! sbs->lcorr[no - 1].flg)) {
+        return NULL;
+    }
+    return &(sbs->lcorr[no - 1]);
+}
+
+/*****************************************************************************/
+
+/* message type 1, the PRN mask */
+static int
+ublox_sbs_decode_mask(ublox_sbs_t * sbs, const uint8_t * msg)
+{
+    size_t n = 0;
+    int i;
+
+    for (i = 1; i <= UBLOX_SBS_NUM_PRN; i ++) {
+        if (0 == ublox_getbitu(msg, 13 + i, 1)) {
+            continue;
+        }
+        if (n >= UBLOX_SBS_NUM_SLOT) {
+            return -1;
+        }
+        sbs->slot[n ++] = i;
+    }
+    sbs->num_slot = n;
+    sbs->iodp = ublox_getbitu(msg, 224, 2);
+    return 1;
+}
+
+/**
+ * \brief save the fast correction of a slot in the mask
+ * \param sbs: the tables
+ * \param idx: the index of the slot
+ * \param prc: the pseudorange correction
+ * \param udrei: the UDREI
+ * \param iodf: the IODF
+ */
+static void
+ublox_sbs_put_fcorr(ublox_sbs_t * sbs, size_t idx, double prc, int udrei, int iodf)
+{
+    ublox_sbs_fcorr_t * fc = &(sbs->fcorr[sbs->slot[idx] - 1]);
+    double dt = sbs->tow - fc->t0;
+
+    // the range-rate from the previous correction
+    if (fc->flg && (dt > 0.0) && (dt <= 18.0) && (fc->ai != 0)) {
+        fc->rrc = (prc - fc->prc) / dt;
+        fc->dt = dt;
+    } else {
+        fc->rrc = 0.0;
+        fc->dt = 0.0;
+    }
+    fc->t0 = sbs->tow;
+    fc->prc = prc;
+    fc->udrei = udrei;
+    fc->iodf = iodf;
+    fc->flg = 1;
+}
+
+/* message type 2-5, the fast corrections */
+static int
+ublox_sbs_decode_fast(ublox_sbs_t * sbs, const uint8_t * msg, int type)
+{
+    size_t i, n;
+    int iodf;
+
+    if (sbs->iodp != (int)ublox_getbitu(msg, 16, 2)) {
+        return 0;
+    }
+    iodf = ublox_getbitu(msg, 14, 2);
+    for (i = 0; i < 13; i ++) {
+        n = 13 * (type - 2) + i;
+        if (n >= sbs->num_slot) {
+            break;
+        }
+        ublox_sbs_put_fcorr(sbs, n, ublox_getbits(msg, 18 + i * 12, 12) * 0.125, ublox_getbitu(msg, 174 + i * 4, 4), iodf);
+    }
+    return 1;
+}
+
+/* message type 6, the integrity information */
+static int
+ublox_sbs_decode_integ(ublox_sbs_t * sbs, const uint8_t * msg)
+{
+    int iodf[4];
+    size_t i;
+
+    for (i = 0; i < 4; i ++) {
+        iodf[i] = ublox_getbitu(msg, 14 + i * 2, 2);
+    }
+    for (i = 0; i < sbs->num_slot; i ++) {
+        ublox_sbs_fcorr_t * fc = &(sbs->fcorr[sbs->slot[i] - 1]);
+        // IODF 3 is the alert, applied to any fast correction
+        if ((iodf[i / 13] != 3) && (fc->iodf != iodf[i / 13])) {
+            continue;
+        }
+        fc->udrei = ublox_getbitu(msg, 22 + i * 4, 4);
+    }
+    return 1;
+}
+
+/* message type 7, the fast correction degradation factor */
+static int
+ublox_sbs_decode_degr(ublox_sbs_t * sbs, const uint8_t * msg)
+{
+    size_t i;
+
+    if (sbs->iodp != (int)ublox_getbitu(msg, 18, 2)) {
+        return 0;
+    }
+    sbs->tlat = ublox_getbitu(msg, 14, 4);
+    for (i = 0; i < sbs->num_slot; i ++) {
+        sbs->fcorr[sbs->slot[i] - 1].ai = ublox_getbitu(msg, 22 + i * 4, 4);
+    }
+    return 1;
+}
+
+/* the long-term correction of a satellite, velocity code 0 */
+static void
+ublox_sbs_decode_lcorr0(ublox_sbs_t * sbs, const uint8_t * msg, size_t pos)
+{
+    ublox_sbs_lcorr_t * lc;
+    size_t n = ublox_getbitu(msg, pos, 6);
+    size_t i;
+
+    if ((n < 1) || (n > sbs->num_slot)) {
+        return;
+    }
+    lc = &(sbs->lcorr[sbs->slot[n - 1] - 1]);
+    lc->iode = ublox_getbitu(msg, pos + 6, 8);
+    for (i = 0; i < 3; i ++) {
+        lc->dpos[i] = ublox_getbits(msg, pos + 14 + i * 9, 9) * 0.125;
+        lc->dvel[i] = 0.0;
+    }
+    lc->daf0 = ldexp(ublox_getbits(msg, pos + 41, 10), -31);
+    lc->daf1 = 0.0;
+    lc->t0 = sbs->tow;
+    lc->vel = 0;
+    lc->flg = 1;
+}
+
+/* the long-term correction of a satellite, velocity code 1 */
+static void
+ublox_sbs_decode_lcorr1(ublox_sbs_t * sbs, const uint8_t * msg, size_t pos)
+{
+    ublox_sbs_lcorr_t * lc;
+    size_t n = ublox_getbitu(msg, pos, 6);
+    size_t i;
+
+    if ((n < 1) || (n > sbs->num_slot)) {
+        return;
+    }
+    lc = &(sbs->lcorr[sbs->slot[n - 1] - 1]);
+    lc->iode = ublox_getbitu(msg, pos + 6, 8);
+    for (i = 0; i < 3; i ++) {
+        lc->dpos[i] = ublox_getbits(msg, pos + 14 + i * 11, 11) * 0.125;
+        lc->dvel[i] = ldexp(ublox_getbits(msg, pos + 47 + i * 8, 8), -11);
+    }
+    lc->daf0 = ldexp(ublox_getbits(msg, pos + 71, 11), -31);
+    lc->daf1 = ldexp(ublox_getbits(msg, pos + 82, 8), -39);
+    lc->t0 = ublox_getbitu(msg, pos + 90, 13) * 16.0;
+    lc->vel = 1;
+    lc->flg = 1;
+}
+
+/* the half message of the long-term corrections, 106 bits */
+static int
+ublox_sbs_decode_lcorr(ublox_sbs_t * sbs, const uint8_t * msg, size_t pos)
+{
+    if (0 == ublox_getbitu(msg, pos, 1)) {
+        if (sbs->iodp != (int)ublox_getbitu(msg, pos + 103, 2)) {
+            return 0;
+        }
+        ublox_sbs_decode_lcorr0(sbs, msg, pos + 1);
+        ublox_sbs_decode_lcorr0(sbs, msg, pos + 52);
+    } else {
+        if (sbs->iodp != (int)ublox_getbitu(msg, pos + 104, 2)) {
+            return 0;
+        }
+        ublox_sbs_decode_lcorr1(sbs, msg, pos + 1);
+    }
+    return 1;
+}
+
+/* message type 24, the mixed fast/long-term corrections */
+static int
+ublox_sbs_decode_mixed(ublox_sbs_t * sbs, const uint8_t * msg)
+{
+    size_t i, n;
+    int blk, iodf;
+
+    if (sbs->iodp != (int)ublox_getbitu(msg, 110, 2)) {
+        return 0;
+    }
+    blk = ublox_getbitu(msg, 112, 2);
+    iodf = ublox_getbitu(msg, 114, 2);
+    for (i = 0; i < 6; i ++) {
+        n = 13 * blk + i;
+        if (n >= sbs->num_slot) {
+            break;
+        }
+        ublox_sbs_put_fcorr(sbs, n, ublox_getbits(msg, 14 + i * 12, 12) * 0.125, ublox_getbitu(msg, 86 + i * 4, 4), iodf);
+    }
+    return ublox_sbs_decode_lcorr(sbs, msg, 120);
+}
+
+/**
+ * \brief apply a SBAS message to the tables
+ * \param sbs: the tables
+ * \param prn: the PRN of the GEO
+ * \param msg: the message, 226 bits, MSB first
+ *
+ * \return 1 if the tables are updated, 0 if the message is ignored, <0 on error
+ *
+ * The corrections of the types 2-5, 7, 24 and 25 are ignored until the
+ * mask of the same IODP is received.
+ */
+int
+ublox_sbs_add_msg(ublox_sbs_t * sbs, uint8_t prn, const uint8_t * msg)
+{
+    int type;
+    int ret = 0;
+
+    assert (NULL != sbs);
+    assert (NULL != msg);
+    if (0 == sbs->prn) {
+        sbs->prn = prn;
+    }
+    if (prn != sbs->prn) {
+        return 0;
+    }
+    switch (msg[0]) {
+    case 0x53: case 0x9A: case 0xC6:
+        break;
+    default:
+        return -1;
+    }
+    sbs->num_msg ++;
+    type = ublox_getbitu(msg, 8, 6);
+    switch (type) {
+    case 0:
+        sbs->flg_dontuse = 1;
+        ret = 1;
+        break;
+    case 1:
+        ret = ublox_sbs_decode_mask(sbs, msg);
+        break;
+    case 2: case 3: case 4: case 5:
+        ret = ublox_sbs_decode_fast(sbs, msg, type);
+        break;
+    case 6:
+        ret = ublox_sbs_decode_integ(sbs, msg);
+        break;
+    case 7:
+        ret = ublox_sbs_decode_degr(sbs, msg);
+        break;
+    case 24:
+        ret = ublox_sbs_decode_mixed(sbs, msg);
+        break;
+    case 25:
+        ret = ublox_sbs_decode_lcorr(sbs, msg, 14);
+        ret = (ublox_sbs_decode_lcorr(sbs, msg, 120) > 0)?1:ret;
+        break;
+    }
+    if (ret > 0) {
+        sbs->num_type[type] ++;
+    }
+    return ret;
+}
+
+/* the words of RXM-SFRBX/RXM-SFRB to the message */
+static void
+ublox_sbs_pack_msg(const uint32_t * dwrd, uint8_t * msg)
+{
+    uint8_t buf[32];
+    size_t i;
+    for (i = 0; i < 8; i ++) {
+        ublox_setbitu(buf, i * 32, 32, dwrd[i]);
+    }
+    memmove(msg, buf, UBLOX_SBS_SZ_MSG);
+    msg[UBLOX_SBS_SZ_MSG - 1] &= 0xC0;
+}
+
+/**
+ * \brief apply the SBAS message of RXM-SFRBX to the tables
+ * \param sbs: the tables
+ * \param msg: the decoded packet, with the words in msg->dwrd
+ *
+ * \return 1 if the tables are updated, 0 if the message is ignored, <0 on error
+ */
+int
+ublox_sbs_add_sfrbx(ublox_sbs_t * sbs, const ublox_rxm_sfrbx_t * msg)
+{
+    uint8_t buf[UBLOX_SBS_SZ_MSG];
+
+    assert (NULL != msg);
+    if (1 != msg->gnssId) {
+        return 0;
+    }
+    if (msg->num_dwrd < 8) {
+        return -1;
+    }
+    ublox_sbs_pack_msg(msg->dwrd, buf);
+    return ublox_sbs_add_msg(sbs, msg->svId, buf);
+}
+
+/**
+ * \brief apply the SBAS message of RXM-SFRB to the tables
+ * \param sbs: the tables
+ * \param msg: the decoded packet
+ *
+ * \return 1 if the tables are updated, 0 if the message is ignored, <0 on error
+ */
+int
+ublox_sbs_add_sfrb(ublox_sbs_t * sbs, const ublox_rxm_sfrb_t * msg)
+{
+    uint8_t buf[UBLOX_SBS_SZ_MSG];
+
+    assert (NULL != msg);
+    if (msg->svid < 120) {
+        return 0;
+    }
+    ublox_sbs_pack_msg(msg->dwrd, buf);
+    return ublox_sbs_add_msg(sbs, msg->svid, buf);
+}
+
+/**
+ * \brief the handler of RXM-SFRBX for the registry
+ * \param userdata: the tables, ublox_sbs_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_sbs_handler_sfrbx(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rxm_sfrbx_t msg;
+    uint32_t dwrd[16];
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.dwrd = dwrd;
+    msg.max_dwrd = NUM_ARRAY(dwrd);
+    if (ublox_decode_rxm_sfrbx(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    return (ublox_sbs_add_sfrbx((ublox_sbs_t *)userdata, &msg) < 0)?-1:0;
+}
+
+/**
+ * \brief the handler of RXM-SFRB for the registry
+ * \param userdata: the tables, ublox_sbs_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_sbs_handler_sfrb(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rxm_sfrb_t msg;
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    if (ublox_decode_rxm_sfrb(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    return (ublox_sbs_add_sfrb((ublox_sbs_t *)userdata, &msg) < 0)?-1:0;
+}
+
+/**
+ * \brief the handler of RXM-RAWX for the registry, the time of the messages received after the epoch
+ * \param userdata: the tables, ublox_sbs_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_sbs_handler_rawx(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rxm_rawx_t msg;
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    if (ublox_decode_rxm_rawx(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    ((ublox_sbs_t *)userdata)->tow = msg.rcvTow;
+    return 0;
+}
+
+/**
+ * \brief the handler of RXM-RAW for the registry, the time of the messages received after the epoch
+ * \param userdata: the tables, ublox_sbs_t
+ * \param buffer_in: the packet
+ * \param sz_in: the byte size of the packet
+ *
+ * \return 0 on success, <0 on error
+ */
+int
+ublox_sbs_handler_raw(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    ublox_rxm_raw_t msg;
+
+    if (sz_in < UBLOX_PKT_LENGTH_MIN) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    if (ublox_decode_rxm_raw(buffer_in + UBLOX_PKT_LENGTH_HDR, sz_in - UBLOX_PKT_LENGTH_MIN, &msg) < 0) {
+        return -1;
+    }
+    ((ublox_sbs_t *)userdata)->tow = msg.iTOW * 0.001;
+    return 0;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* create the header of a message */
+static void
+ublox_sbs_test_msg(uint8_t * msg, int type)
+{
+    memset(msg, 0, UBLOX_SBS_SZ_MSG);
+    msg[0] = 0x9A;
+    ublox_setbitu(msg, 8, 6, type);
+}
+
+/* create the packet of RXM-SFRBX of the message, or RXM-RAWX of the time if msg is NULL */
+static size_t
+ublox_sbs_test_pkt(uint8_t * buffer, const uint8_t * msg, double tow)
+{
+    uint8_t buf[32];
+    uint8_t * p = buffer + UBLOX_PKT_LENGTH_HDR;
+    uint32_t val;
+    size_t sz;
+    size_t i;
+
+    buffer[0] = 0xB5;
+    buffer[1] = 0x62;
+    if (NULL == msg) {
+        buffer[2] = UBLOX_2CLASS(UBX_RXM_RAWX);
+        buffer[3] = UBLOX_2ID(UBX_RXM_RAWX);
+        sz = 16;
+        memset(p, 0, sz);
+        memmove(p, &tow, sizeof(tow));
+    } else {
+        buffer[2] = UBLOX_2CLASS(UBX_RXM_SFRBX);
+        buffer[3] = UBLOX_2ID(UBX_RXM_SFRBX);
+        sz = 8 + 8 * 4;
+        memset(p, 0, 8);
+        p[0] = 1;   // gnssId
+        p[1] = 131; // svId
+        p[4] = 8;   // numWords
+        memset(buf, 0, sizeof(buf));
+        memmove(buf, msg, UBLOX_SBS_SZ_MSG);
+        for (i = 0; i < 8 * 4; i ++) {
+            val = ublox_getbitu(buf, (i / 4) * 32, 32);
+            p[8 + i] = (val >> ((i % 4) * 8)) & 0xFF;
+        }
+    }
+    buffer[4] = sz & 0xFF;
+    buffer[5] = (sz >> 8) & 0xFF;
+    ublox_pkt_checksum(buffer + 2, 4 + sz, p + sz);
+    return UBLOX_PKT_LENGTH_MIN + sz;
+}
+
+TEST_CASE( .name="ublox-sbas", .description="Test ublox SBAS decoder." ) {
+    static ublox_sbs_t sbs;
+    uint8_t msg[UBLOX_SBS_SZ_MSG];
+    const ublox_sbs_fcorr_t * fc;
+    const ublox_sbs_lcorr_t * lc;
+    uint8_t gnssId, svId;
+
+    SECTION("test ublox_sbs_mask2sat") {
+        REQUIRE(0 == ublox_sbs_mask2sat(3, &gnssId, &svId));
+        REQUIRE((gnssId == 0) && (svId == 3));
+        REQUIRE(0 == ublox_sbs_mask2sat(39, &gnssId, &svId));
+        REQUIRE((gnssId == 6) && (svId == 2));
+        REQUIRE(0 == ublox_sbs_mask2sat(131, &gnssId, &svId));
+        REQUIRE((gnssId == 1) && (svId == 131));
+        REQUIRE(0 > ublox_sbs_mask2sat(100, &gnssId, &svId));
+        REQUIRE(39 == ublox_sbs_sat2mask(6, 2));
+        REQUIRE(195 == ublox_sbs_sat2mask(5, 3));
+        REQUIRE(0 > ublox_sbs_sat2mask(2, 3));
+    }
+
+    SECTION("test ublox_sbs_add_msg") {
+        ublox_sbs_init(&sbs, 0);
+
+        // fast corrections before the mask
+        ublox_sbs_test_msg(msg, 2);
+        REQUIRE(0 == ublox_sbs_add_msg(&sbs, 131, msg));
+        REQUIRE(sbs.prn == 131);
+
+        // mask: GPS 3, GPS 5, GLONASS 2
+        ublox_sbs_test_msg(msg, 1);
+        ublox_setbitu(msg, 13 + 3, 1, 1);
+        ublox_setbitu(msg, 13 + 5, 1, 1);
+        ublox_setbitu(msg, 13 + 39, 1, 1);
+        ublox_setbitu(msg, 224, 2, 1);
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        REQUIRE(sbs.num_slot == 3);
+        REQUIRE(sbs.iodp == 1);
+        REQUIRE(sbs.slot[2] == 39);
+
+        // the other GEO
+        REQUIRE(0 == ublox_sbs_add_msg(&sbs, 133, msg));
+
+        // degradation factor
+        ublox_sbs_test_msg(msg, 7);
+        ublox_setbitu(msg, 14, 4, 2);
+        ublox_setbitu(msg, 18, 2, 1);
+        ublox_setbitu(msg, 22 + 4, 4, 5);
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        REQUIRE(sbs.tlat == 2);
+
+        // fast corrections
+        ublox_sbs_test_msg(msg, 2);
+        ublox_setbitu(msg, 14, 2, 2);                   // IODF
+        ublox_setbitu(msg, 16, 2, 1);                   // IODP
+        ublox_setbitu(msg, 18 + 12, 12, (uint32_t)-20); // PRC of GPS 5
+        ublox_setbitu(msg, 18 + 24, 12, 40);            // PRC of GLONASS 2
+        ublox_setbitu(msg, 174 + 4, 4, 6);
+        sbs.tow = 100.0;
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        fc = ublox_sbs_get_fcorr(&sbs, 0, 5);
+        REQUIRE(NULL != fc);
+        REQUIRE(fc->prc == -2.5);
+        REQUIRE(fc->udrei == 6);
+        REQUIRE(fc->iodf == 2);
+        REQUIRE(fc->ai == 5);
+        REQUIRE(fc->rrc == 0.0);
+        REQUIRE(ublox_sbs_get_fcorr(&sbs, 6, 2)->prc == 5.0);
+        REQUIRE(NULL == ublox_sbs_get_fcorr(&sbs, 0, 4));
+
+        // the range-rate from the next correction
+        ublox_setbitu(msg, 18 + 12, 12, (uint32_t)-12);
+        sbs.tow = 104.0;
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        REQUIRE(fc->prc == -1.5);
+        REQUIRE(fc->rrc == 0.25);
+        REQUIRE(fc->dt == 4.0);
+
+        // integrity, the IODF of the block 0 is matched
+        ublox_sbs_test_msg(msg, 6);
+        ublox_setbitu(msg, 14, 2, 2);
+        ublox_setbitu(msg, 22 + 4, 4, 15);
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        REQUIRE(fc->udrei == 15);
+
+        // long-term corrections, velocity code 1 for GLONASS 2, code 0 for GPS 3 and 5
+        ublox_sbs_test_msg(msg, 25);
+        ublox_setbitu(msg, 14, 1, 1);
+        ublox_setbitu(msg, 15, 6, 3);                   // the slot
+        ublox_setbitu(msg, 21, 8, 40);                  // IODE
+        ublox_setbitu(msg, 29, 11, (uint32_t)-8);       // dx
+        ublox_setbitu(msg, 62, 8, 4);                   // dvx
+        ublox_setbitu(msg, 15 + 90, 13, 100);           // t0
+        ublox_setbitu(msg, 14 + 104, 2, 1);             // IODP
+        ublox_setbitu(msg, 120, 1, 0);
+        ublox_setbitu(msg, 121, 6, 1);
+        ublox_setbitu(msg, 127, 8, 7);
+        ublox_setbitu(msg, 135 + 18, 9, 16);            // dz
+        ublox_setbitu(msg, 172, 6, 2);
+        ublox_setbitu(msg, 178, 8, 9);
+        ublox_setbitu(msg, 120 + 103, 2, 1);            // IODP
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        lc = ublox_sbs_get_lcorr(&sbs, 6, 2);
+        REQUIRE(NULL != lc);
+        REQUIRE(lc->vel == 1);
+        REQUIRE(lc->iode == 40);
+        REQUIRE(lc->dpos[0] == -1.0);
+        REQUIRE(lc->dvel[0] == ldexp(4, -11));
+        REQUIRE(lc->t0 == 1600.0);
+        lc = ublox_sbs_get_lcorr(&sbs, 0, 3);
+        REQUIRE(NULL != lc);
+        REQUIRE(lc->iode == 7);
+        REQUIRE(lc->dpos[2] == 2.0);
+        REQUIRE(ublox_sbs_get_lcorr(&sbs, 0, 5)->iode == 9);
+        REQUIRE(sbs.num_type[25] == 1);
+
+        // the new IODP, the corrections of the old mask are ignored
+        ublox_sbs_test_msg(msg, 1);
+        ublox_setbitu(msg, 13 + 3, 1, 1);
+        ublox_setbitu(msg, 224, 2, 2);
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        ublox_sbs_test_msg(msg, 2);
+        ublox_setbitu(msg, 16, 2, 1);
+        REQUIRE(0 == ublox_sbs_add_msg(&sbs, 131, msg));
+
+        ublox_sbs_test_msg(msg, 0);
+        REQUIRE(1 == ublox_sbs_add_msg(&sbs, 131, msg));
+        REQUIRE(sbs.flg_dontuse == 1);
+
+        msg[0] = 0x55;
+        REQUIRE(0 > ublox_sbs_add_msg(&sbs, 131, msg));
+    }
+
+    SECTION("test the time of the handlers") {
+        ublox_registry_t reg;
+        uint8_t pkt[UBLOX_PKT_LENGTH_MIN + 40];
+        size_t sz;
+        size_t sz_processed;
+
+        ublox_sbs_init(&sbs, 0);
+        ublox_registry_init(&reg);
+        REQUIRE(0 == ublox_registry_set(&reg, UBX_RXM_SFRBX, ublox_sbs_handler_sfrbx, &sbs));
+        REQUIRE(0 == ublox_registry_set(&reg, UBX_RXM_RAWX, ublox_sbs_handler_rawx, &sbs));
+
+        // mask of GPS 5, and the degradation factor
+        ublox_sbs_test_msg(msg, 1);
+        ublox_setbitu(msg, 13 + 5, 1, 1);
+        ublox_setbitu(msg, 224, 2, 1);
+        sz = ublox_sbs_test_pkt(pkt, msg, 0);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, pkt, sz, &sz_processed));
+        ublox_sbs_test_msg(msg, 7);
+        ublox_setbitu(msg, 18, 2, 1);
+        ublox_setbitu(msg, 22, 4, 5);
+        sz = ublox_sbs_test_pkt(pkt, msg, 0);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, pkt, sz, &sz_processed));
+        REQUIRE(sbs.num_type[1] == 1);
+        REQUIRE(sbs.num_type[7] == 1);
+
+        // the fast corrections after the epochs of RXM-RAWX
+        ublox_sbs_test_msg(msg, 2);
+        ublox_setbitu(msg, 16, 2, 1);
+        ublox_setbitu(msg, 18, 12, (uint32_t)-20);
+        sz = ublox_sbs_test_pkt(pkt, NULL, 345600.5);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, pkt, sz, &sz_processed));
+        REQUIRE(sbs.tow == 345600.5);
+        sz = ublox_sbs_test_pkt(pkt, msg, 0);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, pkt, sz, &sz_processed));
+        fc = ublox_sbs_get_fcorr(&sbs, 0, 5);
+        REQUIRE(NULL != fc);
+        REQUIRE(fc->t0 == 345600.5);
+        REQUIRE(fc->rrc == 0.0);
+
+        ublox_setbitu(msg, 18, 12, (uint32_t)-12);
+        sz = ublox_sbs_test_pkt(pkt, NULL, 345604.5);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, pkt, sz, &sz_processed));
+        sz = ublox_sbs_test_pkt(pkt, msg, 0);
+        REQUIRE(0 == ublox_registry_dispatch(&reg, pkt, sz, &sz_processed));
+        REQUIRE(fc->t0 == 345604.5);
+        REQUIRE(fc->prc == -1.5);
+        REQUIRE(fc->rrc == 0.25);
+        REQUIRE(fc->dt == 4.0);
+        ublox_registry_clear(&reg);
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,96 @@
+/**
+ * \file    ubloxsbs.h
+ * \brief   The SBAS message decoder and the correction tables
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_SBS_H
+#define UBLOX_SBS_H 1
+
+#include "osporting.h"
+#include "ubloxconn.h"
+#include "ubloxdec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_SBS_NUM_PRN  210 /**< the number of PRN in the mask of the message type 1 */
+#define UBLOX_SBS_NUM_SLOT 51  /**< the max number of satellites set in the mask */
+#define UBLOX_SBS_SZ_MSG   29  /**< the byte size of a message: preamble, type and data, 226 bits */
+
+/** the fast correction and the integrity of a satellite */
+typedef struct _ublox_sbs_fcorr_t {
+    double t0;       /**< the time of the correction, see ublox_sbs_t.tow (s) */
+    double prc;      /**< the pseudorange correction (m) */
+    double rrc;      /**< the range-rate correction (m/s), 0 if the previous correction is not usable */
+    double dt;       /**< the interval of the corrections used by rrc (s) */
+    uint8_t iodf;
+    uint8_t udrei;   /**< UDREI, 0-15, 14: not monitored, 15: do not use */
+    uint8_t ai;      /**< the degradation factor indicator of message type 7, 0-15 */
+    uint8_t flg;     /**< 1 if the correction is received */
+} ublox_sbs_fcorr_t;
+
+/** the long-term correction of a satellite */
+typedef struct _ublox_sbs_lcorr_t {
+    double t0;       /**< the time of applicability (s of day), or the time of the message if vel is 0 */
+    double dpos[3];  /**< the correction of the position in ECEF (m) */
+    double dvel[3];  /**< the correction of the velocity in ECEF (m/s) */
+    double daf0;     /**< the correction of the clock bias (s) */
+    double daf1;     /**< the correction of the clock drift (s/s) */
+    uint8_t iode;
+    uint8_t vel;     /**< the velocity code */
+    uint8_t flg;     /**< 1 if the correction is received */
+} ublox_sbs_lcorr_t;
+
+/**
+ * The correction tables of a SBAS GEO. The fast and long-term corrections
+ * are kept per PRN mask number (1-210), so they survive the changes of the
+ * mask; the messages of the other GEOs are ignored, use one table for each
+ * GEO. It has no dynamic memory.
+ *
+ * The messages carry no time, the range-rate corrections need tow. Register
+ * ublox_sbs_handler_rawx (or ublox_sbs_handler_raw) with the handler of the
+ * messages, or call it from the handler of the epochs, to take tow from the
+ * receiver; otherwise rrc is 0.
+ */
+typedef struct _ublox_sbs_t {
+    uint8_t prn;            /**< the PRN of the GEO, 0 to use the first one received */
+    double tow;             /**< the time of the next message, the last epoch of RXM-RAWX/RXM-RAW, or set by the caller (s) */
+    int iodp;               /**< the IODP of the mask, -1 before the mask is received */
+    int tlat;               /**< the system latency of message type 7 (s) */
+    uint8_t flg_dontuse;    /**< 1 if message type 0 is received */
+    size_t num_slot;        /**< the number of satellites in the mask */
+    uint8_t slot[UBLOX_SBS_NUM_SLOT]; /**< the PRN mask number of the satellites */
+
+    ublox_sbs_fcorr_t fcorr[UBLOX_SBS_NUM_PRN];
+    ublox_sbs_lcorr_t lcorr[UBLOX_SBS_NUM_PRN];
+
+    size_t num_msg;         /**< the number of messages received */
+    size_t num_type[64];    /**< the number of messages of each type applied */
+} ublox_sbs_t;
+
+void ublox_sbs_init(ublox_sbs_t * sbs, uint8_t prn);
+
+int ublox_sbs_mask2sat(int no, uint8_t * gnssId, uint8_t * svId);
+int ublox_sbs_sat2mask(uint8_t gnssId, uint8_t svId);
+const ublox_sbs_fcorr_t * ublox_sbs_get_fcorr(const ublox_sbs_t * sbs, uint8_t gnssId, uint8_t svId);
+const ublox_sbs_lcorr_t * ublox_sbs_get_lcorr(const ublox_sbs_t * sbs, uint8_t gnssId, uint8_t svId);
+
+int ublox_sbs_add_msg(ublox_sbs_t * sbs, uint8_t prn, const uint8_t * msg);
+int ublox_sbs_add_sfrbx(ublox_sbs_t * sbs, const ublox_rxm_sfrbx_t * msg);
+int ublox_sbs_add_sfrb(ublox_sbs_t * sbs, const ublox_rxm_sfrb_t * msg);
+
+int ublox_sbs_handler_sfrbx(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_sbs_handler_sfrb(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_sbs_handler_rawx(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+int ublox_sbs_handler_raw(void * userdata, const uint8_t * buffer_in, size_t sz_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_SBS_H */
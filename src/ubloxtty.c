@@ -0,0 +1,422 @@
+/**
+ * \file    ubloxtty.c
+ * \brief   The serial port (UART/USB-CDC) in raw non-blocking mode
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ *
+ * The port is set to 8N1 raw mode without flow control, echo or the line
+ * discipline, and the reads return immediately (VMIN = VTIME = 0), so the fd
+ * can be driven by poll()/uv_poll_t like a socket.
+ */
+
+#include "ubloxconn.h"
+#include "ubloxtty.h"
+
+#if defined(UBLOX_TTY_ENABLED)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+/* the termios speed of the baud rate, B0 if not supported */
+static speed_t
+ublox_tty_speed(int baud)
+{
+    static const struct {
+        int baud;
+        speed_t speed;
+    } speeds[] = {
+        { 4800, B4800 },
+        { 9600, B9600 },
+        { 19200, B19200 },
+        { 38400, B38400 },
+        { 57600, B57600 },
+        { 115200, B115200 },
+        { 230400, B230400 },
+#if defined(B460800)
+        { 460800, B460800 },
+#endif
+#if defined(B921600)
+        { 921600, B921600 },
+#endif
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i ++) {
+        if (speeds[i].baud == baud) {
+            return speeds[i].speed;
+        }
+    }
+    return B0;
+}
+
+/**
+ * \brief set the serial port to raw non-blocking mode
+ * \param fd: the file descriptor of the port
+ * \param baud: the baud rate
+ *
+ * \return 0 on success, -errno on error
+ */
+int
+ublox_tty_setup(int fd, int baud)
+{
+    struct termios tio;
+    speed_t speed;
+    int flags;
+
+    speed = ublox_tty_speed(baud);
+    if (B0 == speed) {
+        TE("unsupported baud rate: %d\n", baud);
+        return -EINVAL;
+    }
+    if (0 != tcgetattr(fd, &tio)) {
+        return -errno;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag &= ~(CSTOPB | PARENB | CSIZE);
+    tio.c_cflag |= CS8 | CLOCAL | CREAD;
+#if defined(CRTSCTS)
+    tio.c_cflag &= ~CRTSCTS;
+#endif
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (0 != tcsetattr(fd, TCSANOW, &tio)) {
+        return -errno;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    flags = fcntl(fd, F_GETFL);
+    if ((flags < 0) || (0 != fcntl(fd, F_SETFL, flags | O_NONBLOCK))) {
+        return -errno;
+    }
+    return 0;
+}
+
+/**
+ * \brief open the serial port in raw non-blocking mode
+ * \param path: the device, such as /dev/ttyACM0
+ * \param baud: the baud rate
+ *
+ * \return the file descriptor, -errno on error
+ */
+int
+ublox_tty_open(const char * path, int baud)
+{
+    int fd;
+    int ret;
+
+    assert (NULL != path);
+    fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        ret = -errno;
+        TE("unable to open %s: %s\n", path, strerror(errno));
+        return ret;
+    }
+    if (! isatty(fd)) {
+        close(fd);
+        TE("not a tty: %s\n", path);
+        return -ENOTTY;
+    }
+    ret = ublox_tty_setup(fd, baud);
+    if (ret < 0) {
+        close(fd);
+        return ret;
+    }
+    return fd;
+}
+
+/* the device is gone, such as the USB is unplugged or the pty master is closed */
+static int
+ublox_tty_hangup(int fd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 0) < 0) {
+        return 0;
+    }
+    return (0 != (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)));
+}
+
+/**
+ * \brief read all of the available data of the port to the ring buffer
+ * \param fd: the file descriptor of the port
+ * \param ring: the ring buffer
+ *
+ * \return the byte size read, 0 if no data or the ring is full, -errno on error (-EIO if the device is gone)
+ *
+ * The data is read in place to the free space of the ring until the port
+ * is drained, so a burst is read in a few system calls.
+ */
+ssize_t
+ublox_tty_read_ring(int fd, ublox_ring_t * ring)
+{
+    uint8_t * p;
+    size_t sz_space;
+    ssize_t sz = 0;
+    ssize_t ret;
+
+    assert (NULL != ring);
+    while (1) {
+        p = ublox_ring_write_ptr(ring, &sz_space);
+        if (sz_space < 1) {
+            break;
+        }
+        ret = read(fd, p, sz_space);
+        if (ret > 0) {
+            ublox_ring_commit(ring, ret);
+            sz += ret;
+            continue;
+        }
+        if (0 == ret) {
+            // drained, read() returns 0 rather than EAGAIN when VMIN = VTIME = 0
+            if ((sz < 1) && ublox_tty_hangup(fd)) {
+                return -EIO;
+            }
+            break;
+        }
+        if (EINTR == errno) {
+            continue;
+        }
+        if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) {
+            break;
+        }
+        return (sz > 0)?sz:-errno;
+    }
+    return sz;
+}
+
+/**
+ * \brief write the data to the port without blocking
+ * \param fd: the file descriptor of the port
+ * \param buffer_in: the data
+ * \param sz_in: the byte size of the data
+ *
+ * \return the byte size written, less than sz_in if the output buffer of the port is full; -errno on error
+ */
+ssize_t
+ublox_tty_write(int fd, const uint8_t * buffer_in, size_t sz_in)
+{
+    size_t sz = 0;
+    ssize_t ret;
+
+    while (sz < sz_in) {
+        ret = write(fd, buffer_in + sz, sz_in - sz);
+        if (ret > 0) {
+            sz += ret;
+            continue;
+        }
+        if ((ret < 0) && (EINTR == errno)) {
+            continue;
+        }
+        if ((ret < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno)) {
+            return (sz > 0)?(ssize_t)sz:-errno;
+        }
+        break;
+    }
+    return sz;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* open a pseudo-terminal as the stand-in receiver, return the master and set the slave */
+static int
+ublox_tty_test_pty(int baud, int * pfd_slave)
+{
+    int fd;
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return -1;
+    }
+    if ((0 != grantpt(fd)) || (0 != unlockpt(fd))) {
+        close(fd);
+        return -1;
+    }
+    *pfd_slave = ublox_tty_open(ptsname(fd), baud);
+    if (*pfd_slave < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+/* wait for the data of the fd */
+static void
+ublox_tty_test_wait(int fd)
+{
+    fd_set fds;
+    struct timeval tv;
+
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    tv.tv_sec = 1;
+    tv.tv_usec = 0;
+    select(fd + 1, &fds, NULL, NULL, &tv);
+}
+
+/* the send function of the command queue */
+static int
+ublox_tty_test_send(void * userdata, const uint8_t * buffer_in, size_t sz_in)
+{
+    return (ublox_tty_write(*(int *)userdata, buffer_in, sz_in) == (ssize_t)sz_in)?0:-1;
+}
+
+TEST_CASE( .name="ublox-tty", .description="Test the serial port by a pseudo-terminal." ) {
+    uint8_t buffer[4096];
+    uint8_t buf_linear[1024];
+    uint8_t data[512];
+    uint8_t pkt[600];
+    ublox_ring_t ring;
+    struct termios tio;
+    uint8_t * p_frame;
+    size_t sz_frame;
+    size_t sz_needed;
+    size_t sz_pkt;
+    size_t sz_sent;
+    size_t num;
+    ssize_t ret;
+    int fd_master;
+    int fd;
+    size_t i;
+
+    SECTION("test the raw mode") {
+        REQUIRE(-EINVAL == ublox_tty_setup(0, 12345));
+        REQUIRE(-ENOENT == ublox_tty_open("/dev/ublox-tty-not-exist", 9600));
+        fd_master = ublox_tty_test_pty(115200, &fd);
+        REQUIRE(fd_master >= 0);
+        REQUIRE(0 == tcgetattr(fd, &tio));
+        REQUIRE(0 == (tio.c_lflag & (ICANON | ECHO | ISIG)));
+        REQUIRE(0 == (tio.c_iflag & (ICRNL | IXON)));
+        REQUIRE(0 == (tio.c_oflag & OPOST));
+        REQUIRE(B115200 == cfgetispeed(&tio));
+        REQUIRE(0 != (fcntl(fd, F_GETFL) & O_NONBLOCK));
+
+        REQUIRE(0 == ublox_ring_init(&ring, buffer, sizeof(buffer), buf_linear, sizeof(buf_linear)));
+        // no data, not blocked
+        REQUIRE(0 == ublox_tty_read_ring(fd, &ring));
+        // the control characters are not translated
+        memcpy(data, "\xB5\x62\r\n\x11\x13\x03\x04\x7F\x00", 10);
+        REQUIRE(10 == write(fd_master, data, 10));
+        ublox_tty_test_wait(fd);
+        REQUIRE(10 == ublox_tty_read_ring(fd, &ring));
+        REQUIRE(10 == ublox_ring_size(&ring));
+        REQUIRE(0 == memcmp(buffer, data, 10));
+
+        REQUIRE(10 == ublox_tty_write(fd, data, 10));
+        ublox_tty_test_wait(fd_master);
+        REQUIRE(10 == read(fd_master, pkt, sizeof(pkt)));
+        REQUIRE(0 == memcmp(pkt, data, 10));
+
+        // hang up of the receiver
+        close(fd_master);
+        REQUIRE(0 > ublox_tty_read_ring(fd, &ring));
+        close(fd);
+    }
+
+    SECTION("test the large reads") {
+        fd_master = ublox_tty_test_pty(921600, &fd);
+        REQUIRE(fd_master >= 0);
+        REQUIRE(0 == ublox_ring_init(&ring, buffer, sizeof(buffer), buf_linear, sizeof(buf_linear)));
+        for (i = 0; i < sizeof(data); i ++) {
+            data[i] = (uint8_t)i;
+        }
+        sz_pkt = ublox_pkt_create_upd_downl(pkt, sizeof(pkt), 0, 0, data, sizeof(data));
+        REQUIRE(sz_pkt > sizeof(data));
+        // 256 KB through the pty, much more than the ring and the buffer of the pty
+        num = 0;
+        for (i = 0; i < 512; ) {
+            ret = ublox_tty_write(fd_master, pkt, sz_pkt);
+            REQUIRE(ret >= 0);
+            if (ret > 0) {
+                // the rest of the packet
+                for (sz_sent = ret; sz_sent < sz_pkt; ) {
+                    ret = ublox_tty_write(fd_master, pkt + sz_sent, sz_pkt - sz_sent);
+                    REQUIRE(ret >= 0);
+                    sz_sent += ret;
+                    if (0 == ret) {
+                        ublox_tty_read_ring(fd, &ring);
+                    }
+                }
+                i ++;
+            }
+            REQUIRE(ublox_tty_read_ring(fd, &ring) >= 0);
+            while (0 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed)) {
+                REQUIRE(sz_frame == sz_pkt);
+                REQUIRE(0 == memcmp(p_frame, pkt, sz_pkt));
+                ublox_ring_consume(&ring, sz_frame);
+                num ++;
+            }
+        }
+        while (num < 512) {
+            ublox_tty_test_wait(fd);
+            ret = ublox_tty_read_ring(fd, &ring);
+            REQUIRE(ret > 0);
+            while (0 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed)) {
+                ublox_ring_consume(&ring, sz_frame);
+                num ++;
+            }
+        }
+        REQUIRE(512 == num);
+        REQUIRE(0 == ublox_ring_size(&ring));
+        close(fd_master);
+        close(fd);
+    }
+
+    SECTION("test the commands with the stand-in receiver") {
+        ublox_cmdq_t q;
+
+        fd_master = ublox_tty_test_pty(38400, &fd);
+        REQUIRE(fd_master >= 0);
+        REQUIRE(0 == ublox_ring_init(&ring, buffer, sizeof(buffer), buf_linear, sizeof(buf_linear)));
+        ublox_cmdq_init(&q, 4, 1000, ublox_tty_test_send, &fd);
+        sz_pkt = ublox_pkt_create_set_cfgrate(pkt, sizeof(pkt), 1000, 1, 0);
+        REQUIRE(0 == ublox_cmdq_add(&q, pkt, sz_pkt, 0));
+        REQUIRE(1 == ublox_cmdq_pump(&q, 0));
+
+        // the receiver gets the command and replies UBX-ACK-ACK
+        ublox_tty_test_wait(fd_master);
+        REQUIRE((ssize_t)sz_pkt == read(fd_master, data, sizeof(data)));
+        REQUIRE(0 == memcmp(data, pkt, sz_pkt));
+        pkt[0] = 0xB5;
+        pkt[1] = 0x62;
+        pkt[2] = UBLOX_2CLASS(UBX_ACK_ACK);
+        pkt[3] = UBLOX_2ID(UBX_ACK_ACK);
+        pkt[4] = 2;
+        pkt[5] = 0;
+        pkt[6] = UBLOX_2CLASS(UBX_CFG_RATE);
+        pkt[7] = UBLOX_2ID(UBX_CFG_RATE);
+        ublox_pkt_checksum(pkt + 2, 4 + 2, pkt + 8);
+        sz_pkt = UBLOX_PKT_LENGTH_MIN + 2;
+        REQUIRE((ssize_t)sz_pkt == ublox_tty_write(fd_master, pkt, sz_pkt));
+
+        ublox_tty_test_wait(fd);
+        REQUIRE((ssize_t)sz_pkt == ublox_tty_read_ring(fd, &ring));
+        REQUIRE(0 == ublox_ring_peek_frame(&ring, &p_frame, &sz_frame, &sz_needed));
+        REQUIRE(1 == ublox_cmdq_on_packet(&q, p_frame, sz_frame, 5));
+        ublox_ring_consume(&ring, sz_frame);
+        REQUIRE(ublox_cmdq_done(&q));
+        REQUIRE(1 == q.num_ok);
+        ublox_cmdq_clear(&q);
+        close(fd_master);
+        close(fd);
+    }
+}
+#endif /* CIUT_ENABLED */
+
+#endif /* UBLOX_TTY_ENABLED */
@@ -0,0 +1,37 @@
+/**
+ * \file    ubloxtty.h
+ * \brief   The serial port (UART/USB-CDC) in raw non-blocking mode
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_TTY_H
+#define UBLOX_TTY_H 1
+
+#include "osporting.h"
+#include "ubloxring.h"
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#define UBLOX_TTY_ENABLED 1 /**< termios is available */
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_TTY_BAUD_DEFAULT 9600 /**< the default baud rate of the UART of the receiver */
+
+#if defined(UBLOX_TTY_ENABLED)
+int ublox_tty_setup(int fd, int baud);
+int ublox_tty_open(const char * path, int baud);
+ssize_t ublox_tty_read_ring(int fd, ublox_ring_t * ring);
+ssize_t ublox_tty_write(int fd, const uint8_t * buffer_in, size_t sz_in);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_TTY_H */
@@ -668,3 +668,1163 @@ TEST_CASE( .description="test hex string.", .skip=0 ) {
 }
 
 #endif /* CIUT_ENABLED */
+
+/**
+ * \brief get the unsigned bits from the buffer
+ * \param buf: the buffer, MSB first
+ * \param pos: the position of the first bit
+ * \param len: the number of bits, <= 32
+ *
+ * \return the value
+ */
+uint32_t
+ublox_getbitu(const uint8_t * buf, size_t pos, size_t len)
+{
+    uint64_t val = 0;
+    size_t i;
+    if (len < 1) {
+        return 0;
+    }
+    // the bytes of the field, at most 5
+    for (i = pos / 8; i <= (pos + len - 1) / 8; i ++) {
+        val = (val << 8) | buf[i];
+    }
+    return (uint32_t)((val >> (7 - (pos + len - 1) % 8)) & UBLOX_BITFIELD_LMASK(len));
+}
+
+/**
+ * \brief get the signed (two's complement) bits from the buffer
+ * \param buf: the buffer, MSB first
+ * \param pos: the position of the first bit
+ * \param len: the number of bits, <= 32
+ *
+ * \return the value
+ */
+int32_t
+ublox_getbits(const uint8_t * buf, size_t pos, size_t len)
+{
+    uint32_t val = ublox_getbitu(buf, pos, len);
+    if ((len < 1) || (len >= 32) || !(val & (1u << (len - 1)))) {
+        return (int32_t)val;
+    }
+    return (int32_t)(val | (~0u << len));
+}
+
+/**
+ * \brief set the bits in the buffer
+ * \param buf: the buffer, MSB first
+ * \param pos: the position of the first bit
+ * \param len: the number of bits, <= 32
+ * \param val: the value, the LSBs are used
+ */
+void
+ublox_setbitu(uint8_t * buf, size_t pos, size_t len, uint32_t val)
+{
+    size_t i;
+    for (i = pos; i < pos + len; i ++) {
+        uint8_t mask = 1u << (7 - i % 8);
+        if ((val >> (len - 1 - (i - pos))) & 1) {
+            buf[i / 8] |= mask;
+        } else {
+            buf[i / 8] &= ~mask;
+        }
+    }
+}
+
+/*****************************************************************************/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UBLOX_BITFIELD_USE_BMI2 1
+#include <immintrin.h>
+#endif
+
+typedef int (* ublox_bitfield_extract_t)(const uint8_t * buf, size_t sz, const ublox_bitfield_t * tbl, size_t num, uint32_t * val);
+
+/* the bit after the end of the field */
+static inline size_t
+ublox_bitfield_end(const ublox_bitfield_t * fld)
+{
+    return fld->off * 8 + 64 - ((fld->sh1 < fld->sh2)?fld->sh1:fld->sh2);
+}
+
+/* load the 64-bit window at the byte off, MSB first, the bytes after the buffer are 0 */
+static inline uint64_t
+ublox_bitfield_load(const uint8_t * buf, size_t sz, size_t off)
+{
+    uint64_t w = 0;
+    size_t i;
+
+    if (off + 8 <= sz) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        memcpy(&w, buf + off, 8);
+        return __builtin_bswap64(w);
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        memcpy(&w, buf + off, 8);
+        return w;
+#endif
+    }
+    for (i = off; i < off + 8; i ++) {
+        w = (w << 8) | ((i < sz)?buf[i]:0);
+    }
+    return w;
+}
+
+/* sign extend the two's complement value of len bits */
+static inline uint32_t
+ublox_bitfield_sext(uint64_t v, size_t len)
+{
+    return (uint32_t)(int32_t)((int64_t)(v << (64 - len)) >> (64 - len));
+}
+
+static int
+ublox_bitfield_extract_scalar(const uint8_t * buf, size_t sz, const ublox_bitfield_t * tbl, size_t num, uint32_t * val)
+{
+    uint64_t w;
+    uint64_t v;
+    size_t i;
+
+    for (i = 0; i < num; i ++) {
+        if (ublox_bitfield_end(tbl + i) > sz * 8) {
+            return -1;
+        }
+        w = ublox_bitfield_load(buf, sz, tbl[i].off);
+        v = (((w >> tbl[i].sh1) & UBLOX_BITFIELD_LMASK(tbl[i].len1)) << tbl[i].len2)
+            | ((w >> tbl[i].sh2) & UBLOX_BITFIELD_LMASK(tbl[i].len2));
+        val[i] = tbl[i].sign?ublox_bitfield_sext(v, tbl[i].len1 + tbl[i].len2):(uint32_t)v;
+    }
+    return 0;
+}
+
+#if defined(UBLOX_BITFIELD_USE_BMI2)
+/*
+ * pext gathers both parts of a split field at once; the fields which are
+ * not split use bzhi, pext is slow on the CPUs implementing it in microcode.
+ */
+__attribute__((target("bmi2")))
+static int
+ublox_bitfield_extract_bmi2(const uint8_t * buf, size_t sz, const ublox_bitfield_t * tbl, size_t num, uint32_t * val)
+{
+    uint64_t w;
+    uint64_t v;
+    size_t i;
+
+    for (i = 0; i < num; i ++) {
+        if (ublox_bitfield_end(tbl + i) > sz * 8) {
+            return -1;
+        }
+        w = ublox_bitfield_load(buf, sz, tbl[i].off);
+        if (tbl[i].len2) {
+            v = _pext_u64(w, tbl[i].mask);
+        } else {
+            v = _bzhi_u64(w >> tbl[i].sh1, tbl[i].len1);
+        }
+        val[i] = tbl[i].sign?ublox_bitfield_sext(v, tbl[i].len1 + tbl[i].len2):(uint32_t)v;
+    }
+    return 0;
+}
+#endif /* UBLOX_BITFIELD_USE_BMI2 */
+
+static ublox_bitfield_extract_t g_ublox_bitfield_extract = NULL;
+
+/**
+ * \brief the name of the implementation of the bit field extraction
+ * \param impl: UBLOX_BITFIELD_IMPL_xxx
+ *
+ * \return the name
+ */
+const char *
+ublox_bitfield_impl_name(int impl)
+{
+    switch (impl) {
+    case UBLOX_BITFIELD_IMPL_AUTO:   return "auto";
+    case UBLOX_BITFIELD_IMPL_SCALAR: return "scalar";
+    case UBLOX_BITFIELD_IMPL_BMI2:   return "bmi2";
+    }
+    return "unknown";
+}
+
+/**
+ * \brief select the implementation of the bit field extraction
+ * \param impl: UBLOX_BITFIELD_IMPL_xxx, UBLOX_BITFIELD_IMPL_AUTO to select the best one supported by the CPU
+ *
+ * \return the implementation selected, <0 if the implementation is not supported by this CPU
+ */
+int
+ublox_bitfield_impl_select(int impl)
+{
+    if (UBLOX_BITFIELD_IMPL_AUTO == impl) {
+        impl = UBLOX_BITFIELD_IMPL_SCALAR;
+#if defined(UBLOX_BITFIELD_USE_BMI2)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("bmi2")) {
+            impl = UBLOX_BITFIELD_IMPL_BMI2;
+        }
+#endif
+    }
+    switch (impl) {
+    case UBLOX_BITFIELD_IMPL_SCALAR:
+        g_ublox_bitfield_extract = ublox_bitfield_extract_scalar;
+        break;
+#if defined(UBLOX_BITFIELD_USE_BMI2)
+    case UBLOX_BITFIELD_IMPL_BMI2:
+        __builtin_cpu_init();
+        if (! __builtin_cpu_supports("bmi2")) {
+            return -1;
+        }
+        g_ublox_bitfield_extract = ublox_bitfield_extract_bmi2;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    return impl;
+}
+
+/**
+ * \brief check the items of the table
+ * \param tbl: the table
+ * \param num: the number of items
+ *
+ * \return 0 on success, the index + 1 of the first bad item
+ *
+ * The items created by the macros UBLOX_BITFIELD_xxx are bad if the field
+ * is longer than 32 bits, or the parts are not in the 64-bit window.
+ */
+int
+ublox_bitfield_check(const ublox_bitfield_t * tbl, size_t num)
+{
+    uint64_t m;
+    size_t i;
+    size_t n;
+
+    for (i = 0; i < num; i ++) {
+        const ublox_bitfield_t * fld = tbl + i;
+        if ((fld->len1 < 1) || (fld->len1 + fld->len2 > 32)
+            || (fld->sh1 + fld->len1 > 64) || (fld->sh2 + fld->len2 > 64)
+            || ((fld->len2 > 0) && (fld->sh1 < fld->sh2 + fld->len2))) {
+            return i + 1;
+        }
+        for (m = fld->mask, n = 0; m; m &= m - 1) {
+            n ++;
+        }
+        if (n != (size_t)(fld->len1 + fld->len2)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief get the bit fields of the table from the buffer
+ * \param buf: the buffer, MSB first
+ * \param sz: the byte size of the buffer
+ * \param tbl: the table of the fields
+ * \param num: the number of items in the table
+ * \param val: the values of the fields, the signed values are in two's complement, cast them to int32_t
+ *
+ * \return 0 on success, <0 if a field is out of the buffer
+ *
+ * The implementation (BMI2/scalar) is selected at the first call.
+ */
+int
+ublox_bitfield_extract(const uint8_t * buf, size_t sz, const ublox_bitfield_t * tbl, size_t num, uint32_t * val)
+{
+    if (NULL == g_ublox_bitfield_extract) {
+        ublox_bitfield_impl_select(UBLOX_BITFIELD_IMPL_AUTO);
+    }
+    return g_ublox_bitfield_extract(buf, sz, tbl, num, val);
+}
+
+/*****************************************************************************/
+
+/**
+ * \brief setup the reader
+ * \param br: the reader
+ * \param buf: the buffer, MSB first
+ * \param sz: the byte size of the buffer
+ */
+void
+ublox_bitreader_init(ublox_bitreader_t * br, const uint8_t * buf, size_t sz)
+{
+    assert (NULL != br);
+    br->buf = buf;
+    br->sz = sz;
+    br->pos = 0;
+    br->flg_err = 0;
+}
+
+/* the field of len (1-57) bits at pos, the caller checks the range */
+static inline uint64_t
+ublox_bitreader_peek(const ublox_bitreader_t * br, size_t pos, size_t len)
+{
+    return (ublox_bitfield_load(br->buf, br->sz, pos / 8) << (pos % 8)) >> (64 - len);
+}
+
+/**
+ * \brief read the unsigned field
+ * \param br: the reader
+ * \param len: the number of bits, <= 32
+ *
+ * \return the value, 0 if the field is out of the buffer
+ */
+uint32_t
+ublox_bitreader_u(ublox_bitreader_t * br, size_t len)
+{
+    uint64_t v = 0;
+
+    assert (len <= 32);
+    if (br->pos + len > br->sz * 8) {
+        br->flg_err = 1;
+    } else if (len > 0) {
+        v = ublox_bitreader_peek(br, br->pos, len);
+    }
+    br->pos += len;
+    return (uint32_t)v;
+}
+
+/**
+ * \brief read the signed (two's complement) field
+ * \param br: the reader
+ * \param len: the number of bits, 1 - 32
+ *
+ * \return the value, 0 if the field is out of the buffer
+ */
+int32_t
+ublox_bitreader_s(ublox_bitreader_t * br, size_t len)
+{
+    assert ((0 < len) && (len <= 32));
+    return (int32_t)ublox_bitfield_sext(ublox_bitreader_u(br, len), len);
+}
+
+/**
+ * \brief read the unsigned field of up to 64 bits, such as the satellite mask of RTCM 3 MSM
+ * \param br: the reader
+ * \param len: the number of bits, <= 64
+ *
+ * \return the value, 0 if the field is out of the buffer
+ */
+uint64_t
+ublox_bitreader_u64(ublox_bitreader_t * br, size_t len)
+{
+    uint64_t v;
+
+    assert (len <= 64);
+    if (len <= 32) {
+        return ublox_bitreader_u(br, len);
+    }
+    v = (uint64_t)ublox_bitreader_u(br, len - 32) << 32;
+    return v | ublox_bitreader_u(br, 32);
+}
+
+/**
+ * \brief read the signed field of up to 64 bits, such as the 38-bit coordinates of RTCM 3
+ * \param br: the reader
+ * \param len: the number of bits, 1 - 64
+ *
+ * \return the value, 0 if the field is out of the buffer
+ */
+int64_t
+ublox_bitreader_s64(ublox_bitreader_t * br, size_t len)
+{
+    uint64_t v;
+
+    assert ((0 < len) && (len <= 64));
+    v = ublox_bitreader_u64(br, len);
+    if (len < 64) {
+        v = (uint64_t)((int64_t)(v << (64 - len)) >> (64 - len));
+    }
+    return (int64_t)v;
+}
+
+/**
+ * \brief read the array of the unsigned fields of the same size
+ * \param br: the reader
+ * \param len: the number of bits of a field, 1 - 32
+ * \param num: the number of fields
+ * \param val: the values
+ *
+ * \return 0 on success, <0 if the fields are out of the buffer, the reader is not changed
+ *
+ * The range is checked once for all of the fields.
+ */
+int
+ublox_bitreader_array_u(ublox_bitreader_t * br, size_t len, size_t num, uint32_t * val)
+{
+    size_t pos = br->pos;
+    size_t i;
+
+    assert ((0 < len) && (len <= 32));
+    if (pos + len * num > br->sz * 8) {
+        br->flg_err = 1;
+        return -1;
+    }
+    for (i = 0; i < num; i ++, pos += len) {
+        val[i] = (uint32_t)ublox_bitreader_peek(br, pos, len);
+    }
+    br->pos = pos;
+    return 0;
+}
+
+/**
+ * \brief read the array of the signed fields of the same size
+ * \param br: the reader
+ * \param len: the number of bits of a field, 1 - 32
+ * \param num: the number of fields
+ * \param val: the values
+ *
+ * \return 0 on success, <0 if the fields are out of the buffer, the reader is not changed
+ */
+int
+ublox_bitreader_array_s(ublox_bitreader_t * br, size_t len, size_t num, int32_t * val)
+{
+    size_t i;
+
+    if (ublox_bitreader_array_u(br, len, num, (uint32_t *)val) < 0) {
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        val[i] = (int32_t)ublox_bitfield_sext((uint32_t)val[i], len);
+    }
+    return 0;
+}
+
+/**
+ * \brief setup the writer
+ * \param bw: the writer
+ * \param buf: the buffer, MSB first
+ * \param sz: the byte size of the buffer
+ */
+void
+ublox_bitwriter_init(ublox_bitwriter_t * bw, uint8_t * buf, size_t sz)
+{
+    assert (NULL != bw);
+    bw->buf = buf;
+    bw->sz = sz;
+    bw->pos = 0;
+    bw->acc = 0;
+    bw->flg_err = 0;
+}
+
+/* append len (0-32) bits, the caller checks the range */
+static inline void
+ublox_bitwriter_put(ublox_bitwriter_t * bw, size_t len, uint32_t val)
+{
+    uint8_t * p = bw->buf + bw->pos / 8;
+    size_t num = bw->pos % 8 + len;
+    uint64_t acc;
+
+    // at most 7 + 32 bits in the register
+    acc = (bw->acc << len) | (val & ((1ULL << len) - 1));
+    while (num >= 8) {
+        num -= 8;
+        *p ++ = (uint8_t)(acc >> num);
+    }
+    bw->acc = acc & ((1U << num) - 1);
+    bw->pos += len;
+}
+
+/**
+ * \brief write the unsigned field
+ * \param bw: the writer
+ * \param len: the number of bits, <= 32
+ * \param val: the value, the bits higher than len are ignored
+ */
+void
+ublox_bitwriter_u(ublox_bitwriter_t * bw, size_t len, uint32_t val)
+{
+    assert (len <= 32);
+    if (bw->pos + len > bw->sz * 8) {
+        bw->flg_err = 1;
+        return;
+    }
+    ublox_bitwriter_put(bw, len, val);
+}
+
+/**
+ * \brief write the signed (two's complement) field
+ * \param bw: the writer
+ * \param len: the number of bits, <= 32
+ * \param val: the value
+ */
+void
+ublox_bitwriter_s(ublox_bitwriter_t * bw, size_t len, int32_t val)
+{
+    ublox_bitwriter_u(bw, len, (uint32_t)val);
+}
+
+/**
+ * \brief write the unsigned field of up to 64 bits
+ * \param bw: the writer
+ * \param len: the number of bits, <= 64
+ * \param val: the value, the bits higher than len are ignored
+ */
+void
+ublox_bitwriter_u64(ublox_bitwriter_t * bw, size_t len, uint64_t val)
+{
+    assert (len <= 64);
+    if (bw->pos + len > bw->sz * 8) {
+        bw->flg_err = 1;
+        return;
+    }
+    if (len > 32) {
+        ublox_bitwriter_put(bw, len - 32, (uint32_t)(val >> 32));
+        len = 32;
+    }
+    ublox_bitwriter_put(bw, len, (uint32_t)val);
+}
+
+/**
+ * \brief write the signed (two's complement) field of up to 64 bits, such as the coordinates of RTCM 3 1005
+ * \param bw: the writer
+ * \param len: the number of bits, <= 64
+ * \param val: the value
+ */
+void
+ublox_bitwriter_s64(ublox_bitwriter_t * bw, size_t len, int64_t val)
+{
+    ublox_bitwriter_u64(bw, len, (uint64_t)val);
+}
+
+/**
+ * \brief write the array of the unsigned fields of the same size
+ * \param bw: the writer
+ * \param len: the number of bits of a field, <= 32
+ * \param num: the number of fields
+ * \param val: the values
+ *
+ * \return 0 on success, <0 if the fields are out of the buffer, the writer is not changed
+ */
+int
+ublox_bitwriter_array_u(ublox_bitwriter_t * bw, size_t len, size_t num, const uint32_t * val)
+{
+    size_t i;
+
+    assert (len <= 32);
+    if (bw->pos + len * num > bw->sz * 8) {
+        bw->flg_err = 1;
+        return -1;
+    }
+    for (i = 0; i < num; i ++) {
+        ublox_bitwriter_put(bw, len, val[i]);
+    }
+    return 0;
+}
+
+/**
+ * \brief write the array of the signed fields of the same size
+ * \param bw: the writer
+ * \param len: the number of bits of a field, <= 32
+ * \param num: the number of fields
+ * \param val: the values
+ *
+ * \return 0 on success, <0 if the fields are out of the buffer, the writer is not changed
+ */
+int
+ublox_bitwriter_array_s(ublox_bitwriter_t * bw, size_t len, size_t num, const int32_t * val)
+{
+    return ublox_bitwriter_array_u(bw, len, num, (const uint32_t *)val);
+}
+
+/**
+ * \brief store the pending bits, the last byte is padded by 0
+ * \param bw: the writer
+ *
+ * \return the byte size of the data written
+ */
+size_t
+ublox_bitwriter_flush(ublox_bitwriter_t * bw)
+{
+    if (bw->pos % 8) {
+        bw->buf[bw->pos / 8] = (uint8_t)(bw->acc << (8 - bw->pos % 8));
+    }
+    return (bw->pos + 7) / 8;
+}
+
+#define UBLOX_CRC24Q_POLY 0x1864CFB
+
+/**
+ * The tables of slicing-by-8, the CRC is kept in the high 24 bits of the
+ * 32-bit register. g_ublox_crc24q_tbl[k][b] is the CRC of the byte b
+ * followed by k bytes of 0, generated by UBLOX_CRC24Q_POLY.
+ * It's constant, so the decoders of the threads can share it.
+ */
+static const uint32_t g_ublox_crc24q_tbl[8][256] = {
+    {
+        0x00000000, 0x864CFB00, 0x8AD50D00, 0x0C99F600, 0x93E6E100, 0x15AA1A00,
+        0x1933EC00, 0x9F7F1700, 0xA1813900, 0x27CDC200, 0x2B543400, 0xAD18CF00,
+        0x3267D800, 0xB42B2300, 0xB8B2D500, 0x3EFE2E00, 0xC54E8900, 0x43027200,
+        0x4F9B8400, 0xC9D77F00, 0x56A86800, 0xD0E49300, 0xDC7D6500, 0x5A319E00,
+        0x64CFB000, 0xE2834B00, 0xEE1ABD00, 0x68564600, 0xF7295100, 0x7165AA00,
+        0x7DFC5C00, 0xFBB0A700, 0x0CD1E900, 0x8A9D1200, 0x8604E400, 0x00481F00,
+        0x9F370800, 0x197BF300, 0x15E20500, 0x93AEFE00, 0xAD50D000, 0x2B1C2B00,
+        0x2785DD00, 0xA1C92600, 0x3EB63100, 0xB8FACA00, 0xB4633C00, 0x322FC700,
+        0xC99F6000, 0x4FD39B00, 0x434A6D00, 0xC5069600, 0x5A798100, 0xDC357A00,
+        0xD0AC8C00, 0x56E07700, 0x681E5900, 0xEE52A200, 0xE2CB5400, 0x6487AF00,
+        0xFBF8B800, 0x7DB44300, 0x712DB500, 0xF7614E00, 0x19A3D200, 0x9FEF2900,
+        0x9376DF00, 0x153A2400, 0x8A453300, 0x0C09C800, 0x00903E00, 0x86DCC500,
+        0xB822EB00, 0x3E6E1000, 0x32F7E600, 0xB4BB1D00, 0x2BC40A00, 0xAD88F100,
+        0xA1110700, 0x275DFC00, 0xDCED5B00, 0x5AA1A000, 0x56385600, 0xD074AD00,
+        0x4F0BBA00, 0xC9474100, 0xC5DEB700, 0x43924C00, 0x7D6C6200, 0xFB209900,
+        0xF7B96F00, 0x71F59400, 0xEE8A8300, 0x68C67800, 0x645F8E00, 0xE2137500,
+        0x15723B00, 0x933EC000, 0x9FA73600, 0x19EBCD00, 0x8694DA00, 0x00D82100,
+        0x0C41D700, 0x8A0D2C00, 0xB4F30200, 0x32BFF900, 0x3E260F00, 0xB86AF400,
+        0x2715E300, 0xA1591800, 0xADC0EE00, 0x2B8C1500, 0xD03CB200, 0x56704900,
+        0x5AE9BF00, 0xDCA54400, 0x43DA5300, 0xC596A800, 0xC90F5E00, 0x4F43A500,
+        0x71BD8B00, 0xF7F17000, 0xFB688600, 0x7D247D00, 0xE25B6A00, 0x64179100,
+        0x688E6700, 0xEEC29C00, 0x3347A400, 0xB50B5F00, 0xB992A900, 0x3FDE5200,
+        0xA0A14500, 0x26EDBE00, 0x2A744800, 0xAC38B300, 0x92C69D00, 0x148A6600,
+        0x18139000, 0x9E5F6B00, 0x01207C00, 0x876C8700, 0x8BF57100, 0x0DB98A00,
+        0xF6092D00, 0x7045D600, 0x7CDC2000, 0xFA90DB00, 0x65EFCC00, 0xE3A33700,
+        0xEF3AC100, 0x69763A00, 0x57881400, 0xD1C4EF00, 0xDD5D1900, 0x5B11E200,
+        0xC46EF500, 0x42220E00, 0x4EBBF800, 0xC8F70300, 0x3F964D00, 0xB9DAB600,
+        0xB5434000, 0x330FBB00, 0xAC70AC00, 0x2A3C5700, 0x26A5A100, 0xA0E95A00,
+        0x9E177400, 0x185B8F00, 0x14C27900, 0x928E8200, 0x0DF19500, 0x8BBD6E00,
+        0x87249800, 0x01686300, 0xFAD8C400, 0x7C943F00, 0x700DC900, 0xF6413200,
+        0x693E2500, 0xEF72DE00, 0xE3EB2800, 0x65A7D300, 0x5B59FD00, 0xDD150600,
+        0xD18CF000, 0x57C00B00, 0xC8BF1C00, 0x4EF3E700, 0x426A1100, 0xC426EA00,
+        0x2AE47600, 0xACA88D00, 0xA0317B00, 0x267D8000, 0xB9029700, 0x3F4E6C00,
+        0x33D79A00, 0xB59B6100, 0x8B654F00, 0x0D29B400, 0x01B04200, 0x87FCB900,
+        0x1883AE00, 0x9ECF5500, 0x9256A300, 0x141A5800, 0xEFAAFF00, 0x69E60400,
+        0x657FF200, 0xE3330900, 0x7C4C1E00, 0xFA00E500, 0xF6991300, 0x70D5E800,
+        0x4E2BC600, 0xC8673D00, 0xC4FECB00, 0x42B23000, 0xDDCD2700, 0x5B81DC00,
+        0x57182A00, 0xD154D100, 0x26359F00, 0xA0796400, 0xACE09200, 0x2AAC6900,
+        0xB5D37E00, 0x339F8500, 0x3F067300, 0xB94A8800, 0x87B4A600, 0x01F85D00,
+        0x0D61AB00, 0x8B2D5000, 0x14524700, 0x921EBC00, 0x9E874A00, 0x18CBB100,
+        0xE37B1600, 0x6537ED00, 0x69AE1B00, 0xEFE2E000, 0x709DF700, 0xF6D10C00,
+        0xFA48FA00, 0x7C040100, 0x42FA2F00, 0xC4B6D400, 0xC82F2200, 0x4E63D900,
+        0xD11CCE00, 0x57503500, 0x5BC9C300, 0xDD853800,
+    },
+    {
+        0x00000000, 0x668F4800, 0xCD1E9000, 0xAB91D800, 0x1C71DB00, 0x7AFE9300,
+        0xD16F4B00, 0xB7E00300, 0x38E3B600, 0x5E6CFE00, 0xF5FD2600, 0x93726E00,
+        0x24926D00, 0x421D2500, 0xE98CFD00, 0x8F03B500, 0x71C76C00, 0x17482400,
+        0xBCD9FC00, 0xDA56B400, 0x6DB6B700, 0x0B39FF00, 0xA0A82700, 0xC6276F00,
+        0x4924DA00, 0x2FAB9200, 0x843A4A00, 0xE2B50200, 0x55550100, 0x33DA4900,
+        0x984B9100, 0xFEC4D900, 0xE38ED800, 0x85019000, 0x2E904800, 0x481F0000,
+        0xFFFF0300, 0x99704B00, 0x32E19300, 0x546EDB00, 0xDB6D6E00, 0xBDE22600,
+        0x1673FE00, 0x70FCB600, 0xC71CB500, 0xA193FD00, 0x0A022500, 0x6C8D6D00,
+        0x9249B400, 0xF4C6FC00, 0x5F572400, 0x39D86C00, 0x8E386F00, 0xE8B72700,
+        0x4326FF00, 0x25A9B700, 0xAAAA0200, 0xCC254A00, 0x67B49200, 0x013BDA00,
+        0xB6DBD900, 0xD0549100, 0x7BC54900, 0x1D4A0100, 0x41514B00, 0x27DE0300,
+        0x8C4FDB00, 0xEAC09300, 0x5D209000, 0x3BAFD800, 0x903E0000, 0xF6B14800,
+        0x79B2FD00, 0x1F3DB500, 0xB4AC6D00, 0xD2232500, 0x65C32600, 0x034C6E00,
+        0xA8DDB600, 0xCE52FE00, 0x30962700, 0x56196F00, 0xFD88B700, 0x9B07FF00,
+        0x2CE7FC00, 0x4A68B400, 0xE1F96C00, 0x87762400, 0x08759100, 0x6EFAD900,
+        0xC56B0100, 0xA3E44900, 0x14044A00, 0x728B0200, 0xD91ADA00, 0xBF959200,
+        0xA2DF9300, 0xC450DB00, 0x6FC10300, 0x094E4B00, 0xBEAE4800, 0xD8210000,
+        0x73B0D800, 0x153F9000, 0x9A3C2500, 0xFCB36D00, 0x5722B500, 0x31ADFD00,
+        0x864DFE00, 0xE0C2B600, 0x4B536E00, 0x2DDC2600, 0xD318FF00, 0xB597B700,
+        0x1E066F00, 0x78892700, 0xCF692400, 0xA9E66C00, 0x0277B400, 0x64F8FC00,
+        0xEBFB4900, 0x8D740100, 0x26E5D900, 0x406A9100, 0xF78A9200, 0x9105DA00,
+        0x3A940200, 0x5C1B4A00, 0x82A29600, 0xE42DDE00, 0x4FBC0600, 0x29334E00,
+        0x9ED34D00, 0xF85C0500, 0x53CDDD00, 0x35429500, 0xBA412000, 0xDCCE6800,
+        0x775FB000, 0x11D0F800, 0xA630FB00, 0xC0BFB300, 0x6B2E6B00, 0x0DA12300,
+        0xF365FA00, 0x95EAB200, 0x3E7B6A00, 0x58F42200, 0xEF142100, 0x899B6900,
+        0x220AB100, 0x4485F900, 0xCB864C00, 0xAD090400, 0x0698DC00, 0x60179400,
+        0xD7F79700, 0xB178DF00, 0x1AE90700, 0x7C664F00, 0x612C4E00, 0x07A30600,
+        0xAC32DE00, 0xCABD9600, 0x7D5D9500, 0x1BD2DD00, 0xB0430500, 0xD6CC4D00,
+        0x59CFF800, 0x3F40B000, 0x94D16800, 0xF25E2000, 0x45BE2300, 0x23316B00,
+        0x88A0B300, 0xEE2FFB00, 0x10EB2200, 0x76646A00, 0xDDF5B200, 0xBB7AFA00,
+        0x0C9AF900, 0x6A15B100, 0xC1846900, 0xA70B2100, 0x28089400, 0x4E87DC00,
+        0xE5160400, 0x83994C00, 0x34794F00, 0x52F60700, 0xF967DF00, 0x9FE89700,
+        0xC3F3DD00, 0xA57C9500, 0x0EED4D00, 0x68620500, 0xDF820600, 0xB90D4E00,
+        0x129C9600, 0x7413DE00, 0xFB106B00, 0x9D9F2300, 0x360EFB00, 0x5081B300,
+        0xE761B000, 0x81EEF800, 0x2A7F2000, 0x4CF06800, 0xB234B100, 0xD4BBF900,
+        0x7F2A2100, 0x19A56900, 0xAE456A00, 0xC8CA2200, 0x635BFA00, 0x05D4B200,
+        0x8AD70700, 0xEC584F00, 0x47C99700, 0x2146DF00, 0x96A6DC00, 0xF0299400,
+        0x5BB84C00, 0x3D370400, 0x207D0500, 0x46F24D00, 0xED639500, 0x8BECDD00,
+        0x3C0CDE00, 0x5A839600, 0xF1124E00, 0x979D0600, 0x189EB300, 0x7E11FB00,
+        0xD5802300, 0xB30F6B00, 0x04EF6800, 0x62602000, 0xC9F1F800, 0xAF7EB000,
+        0x51BA6900, 0x37352100, 0x9CA4F900, 0xFA2BB100, 0x4DCBB200, 0x2B44FA00,
+        0x80D52200, 0xE65A6A00, 0x6959DF00, 0x0FD69700, 0xA4474F00, 0xC2C80700,
+        0x75280400, 0x13A74C00, 0xB8369400, 0xDEB9DC00,
+    },
+    {
+        0x00000000, 0x8309D700, 0x805F5500, 0x03568200, 0x86F25100, 0x05FB8600,
+        0x06AD0400, 0x85A4D300, 0x8BA85900, 0x08A18E00, 0x0BF70C00, 0x88FEDB00,
+        0x0D5A0800, 0x8E53DF00, 0x8D055D00, 0x0E0C8A00, 0x911C4900, 0x12159E00,
+        0x11431C00, 0x924ACB00, 0x17EE1800, 0x94E7CF00, 0x97B14D00, 0x14B89A00,
+        0x1AB41000, 0x99BDC700, 0x9AEB4500, 0x19E29200, 0x9C464100, 0x1F4F9600,
+        0x1C191400, 0x9F10C300, 0xA4746900, 0x277DBE00, 0x242B3C00, 0xA722EB00,
+        0x22863800, 0xA18FEF00, 0xA2D96D00, 0x21D0BA00, 0x2FDC3000, 0xACD5E700,
+        0xAF836500, 0x2C8AB200, 0xA92E6100, 0x2A27B600, 0x29713400, 0xAA78E300,
+        0x35682000, 0xB661F700, 0xB5377500, 0x363EA200, 0xB39A7100, 0x3093A600,
+        0x33C52400, 0xB0CCF300, 0xBEC07900, 0x3DC9AE00, 0x3E9F2C00, 0xBD96FB00,
+        0x38322800, 0xBB3BFF00, 0xB86D7D00, 0x3B64AA00, 0xCEA42900, 0x4DADFE00,
+        0x4EFB7C00, 0xCDF2AB00, 0x48567800, 0xCB5FAF00, 0xC8092D00, 0x4B00FA00,
+        0x450C7000, 0xC605A700, 0xC5532500, 0x465AF200, 0xC3FE2100, 0x40F7F600,
+        0x43A17400, 0xC0A8A300, 0x5FB86000, 0xDCB1B700, 0xDFE73500, 0x5CEEE200,
+        0xD94A3100, 0x5A43E600, 0x59156400, 0xDA1CB300, 0xD4103900, 0x5719EE00,
+        0x544F6C00, 0xD746BB00, 0x52E26800, 0xD1EBBF00, 0xD2BD3D00, 0x51B4EA00,
+        0x6AD04000, 0xE9D99700, 0xEA8F1500, 0x6986C200, 0xEC221100, 0x6F2BC600,
+        0x6C7D4400, 0xEF749300, 0xE1781900, 0x6271CE00, 0x61274C00, 0xE22E9B00,
+        0x678A4800, 0xE4839F00, 0xE7D51D00, 0x64DCCA00, 0xFBCC0900, 0x78C5DE00,
+        0x7B935C00, 0xF89A8B00, 0x7D3E5800, 0xFE378F00, 0xFD610D00, 0x7E68DA00,
+        0x70645000, 0xF36D8700, 0xF03B0500, 0x7332D200, 0xF6960100, 0x759FD600,
+        0x76C95400, 0xF5C08300, 0x1B04A900, 0x980D7E00, 0x9B5BFC00, 0x18522B00,
+        0x9DF6F800, 0x1EFF2F00, 0x1DA9AD00, 0x9EA07A00, 0x90ACF000, 0x13A52700,
+        0x10F3A500, 0x93FA7200, 0x165EA100, 0x95577600, 0x9601F400, 0x15082300,
+        0x8A18E000, 0x09113700, 0x0A47B500, 0x894E6200, 0x0CEAB100, 0x8FE36600,
+        0x8CB5E400, 0x0FBC3300, 0x01B0B900, 0x82B96E00, 0x81EFEC00, 0x02E63B00,
+        0x8742E800, 0x044B3F00, 0x071DBD00, 0x84146A00, 0xBF70C000, 0x3C791700,
+        0x3F2F9500, 0xBC264200, 0x39829100, 0xBA8B4600, 0xB9DDC400, 0x3AD41300,
+        0x34D89900, 0xB7D14E00, 0xB487CC00, 0x378E1B00, 0xB22AC800, 0x31231F00,
+        0x32759D00, 0xB17C4A00, 0x2E6C8900, 0xAD655E00, 0xAE33DC00, 0x2D3A0B00,
+        0xA89ED800, 0x2B970F00, 0x28C18D00, 0xABC85A00, 0xA5C4D000, 0x26CD0700,
+        0x259B8500, 0xA6925200, 0x23368100, 0xA03F5600, 0xA369D400, 0x20600300,
+        0xD5A08000, 0x56A95700, 0x55FFD500, 0xD6F60200, 0x5352D100, 0xD05B0600,
+        0xD30D8400, 0x50045300, 0x5E08D900, 0xDD010E00, 0xDE578C00, 0x5D5E5B00,
+        0xD8FA8800, 0x5BF35F00, 0x58A5DD00, 0xDBAC0A00, 0x44BCC900, 0xC7B51E00,
+        0xC4E39C00, 0x47EA4B00, 0xC24E9800, 0x41474F00, 0x4211CD00, 0xC1181A00,
+        0xCF149000, 0x4C1D4700, 0x4F4BC500, 0xCC421200, 0x49E6C100, 0xCAEF1600,
+        0xC9B99400, 0x4AB04300, 0x71D4E900, 0xF2DD3E00, 0xF18BBC00, 0x72826B00,
+        0xF726B800, 0x742F6F00, 0x7779ED00, 0xF4703A00, 0xFA7CB000, 0x79756700,
+        0x7A23E500, 0xF92A3200, 0x7C8EE100, 0xFF873600, 0xFCD1B400, 0x7FD86300,
+        0xE0C8A000, 0x63C17700, 0x6097F500, 0xE39E2200, 0x663AF100, 0xE5332600,
+        0xE665A400, 0x656C7300, 0x6B60F900, 0xE8692E00, 0xEB3FAC00, 0x68367B00,
+        0xED92A800, 0x6E9B7F00, 0x6DCDFD00, 0xEEC42A00,
+    },
+    {
+        0x00000000, 0x36095200, 0x6C12A400, 0x5A1BF600, 0xD8254800, 0xEE2C1A00,
+        0xB437EC00, 0x823EBE00, 0x36066B00, 0x000F3900, 0x5A14CF00, 0x6C1D9D00,
+        0xEE232300, 0xD82A7100, 0x82318700, 0xB438D500, 0x6C0CD600, 0x5A058400,
+        0x001E7200, 0x36172000, 0xB4299E00, 0x8220CC00, 0xD83B3A00, 0xEE326800,
+        0x5A0ABD00, 0x6C03EF00, 0x36181900, 0x00114B00, 0x822FF500, 0xB426A700,
+        0xEE3D5100, 0xD8340300, 0xD819AC00, 0xEE10FE00, 0xB40B0800, 0x82025A00,
+        0x003CE400, 0x3635B600, 0x6C2E4000, 0x5A271200, 0xEE1FC700, 0xD8169500,
+        0x820D6300, 0xB4043100, 0x363A8F00, 0x0033DD00, 0x5A282B00, 0x6C217900,
+        0xB4157A00, 0x821C2800, 0xD807DE00, 0xEE0E8C00, 0x6C303200, 0x5A396000,
+        0x00229600, 0x362BC400, 0x82131100, 0xB41A4300, 0xEE01B500, 0xD808E700,
+        0x5A365900, 0x6C3F0B00, 0x3624FD00, 0x002DAF00, 0x367FA300, 0x0076F100,
+        0x5A6D0700, 0x6C645500, 0xEE5AEB00, 0xD853B900, 0x82484F00, 0xB4411D00,
+        0x0079C800, 0x36709A00, 0x6C6B6C00, 0x5A623E00, 0xD85C8000, 0xEE55D200,
+        0xB44E2400, 0x82477600, 0x5A737500, 0x6C7A2700, 0x3661D100, 0x00688300,
+        0x82563D00, 0xB45F6F00, 0xEE449900, 0xD84DCB00, 0x6C751E00, 0x5A7C4C00,
+        0x0067BA00, 0x366EE800, 0xB4505600, 0x82590400, 0xD842F200, 0xEE4BA000,
+        0xEE660F00, 0xD86F5D00, 0x8274AB00, 0xB47DF900, 0x36434700, 0x004A1500,
+        0x5A51E300, 0x6C58B100, 0xD8606400, 0xEE693600, 0xB472C000, 0x827B9200,
+        0x00452C00, 0x364C7E00, 0x6C578800, 0x5A5EDA00, 0x826AD900, 0xB4638B00,
+        0xEE787D00, 0xD8712F00, 0x5A4F9100, 0x6C46C300, 0x365D3500, 0x00546700,
+        0xB46CB200, 0x8265E000, 0xD87E1600, 0xEE774400, 0x6C49FA00, 0x5A40A800,
+        0x005B5E00, 0x36520C00, 0x6CFF4600, 0x5AF61400, 0x00EDE200, 0x36E4B000,
+        0xB4DA0E00, 0x82D35C00, 0xD8C8AA00, 0xEEC1F800, 0x5AF92D00, 0x6CF07F00,
+        0x36EB8900, 0x00E2DB00, 0x82DC6500, 0xB4D53700, 0xEECEC100, 0xD8C79300,
+        0x00F39000, 0x36FAC200, 0x6CE13400, 0x5AE86600, 0xD8D6D800, 0xEEDF8A00,
+        0xB4C47C00, 0x82CD2E00, 0x36F5FB00, 0x00FCA900, 0x5AE75F00, 0x6CEE0D00,
+        0xEED0B300, 0xD8D9E100, 0x82C21700, 0xB4CB4500, 0xB4E6EA00, 0x82EFB800,
+        0xD8F44E00, 0xEEFD1C00, 0x6CC3A200, 0x5ACAF000, 0x00D10600, 0x36D85400,
+        0x82E08100, 0xB4E9D300, 0xEEF22500, 0xD8FB7700, 0x5AC5C900, 0x6CCC9B00,
+        0x36D76D00, 0x00DE3F00, 0xD8EA3C00, 0xEEE36E00, 0xB4F89800, 0x82F1CA00,
+        0x00CF7400, 0x36C62600, 0x6CDDD000, 0x5AD48200, 0xEEEC5700, 0xD8E50500,
+        0x82FEF300, 0xB4F7A100, 0x36C91F00, 0x00C04D00, 0x5ADBBB00, 0x6CD2E900,
+        0x5A80E500, 0x6C89B700, 0x36924100, 0x009B1300, 0x82A5AD00, 0xB4ACFF00,
+        0xEEB70900, 0xD8BE5B00, 0x6C868E00, 0x5A8FDC00, 0x00942A00, 0x369D7800,
+        0xB4A3C600, 0x82AA9400, 0xD8B16200, 0xEEB83000, 0x368C3300, 0x00856100,
+        0x5A9E9700, 0x6C97C500, 0xEEA97B00, 0xD8A02900, 0x82BBDF00, 0xB4B28D00,
+        0x008A5800, 0x36830A00, 0x6C98FC00, 0x5A91AE00, 0xD8AF1000, 0xEEA64200,
+        0xB4BDB400, 0x82B4E600, 0x82994900, 0xB4901B00, 0xEE8BED00, 0xD882BF00,
+        0x5ABC0100, 0x6CB55300, 0x36AEA500, 0x00A7F700, 0xB49F2200, 0x82967000,
+        0xD88D8600, 0xEE84D400, 0x6CBA6A00, 0x5AB33800, 0x00A8CE00, 0x36A19C00,
+        0xEE959F00, 0xD89CCD00, 0x82873B00, 0xB48E6900, 0x36B0D700, 0x00B98500,
+        0x5AA27300, 0x6CAB2100, 0xD893F400, 0xEE9AA600, 0xB4815000, 0x82880200,
+        0x00B6BC00, 0x36BFEE00, 0x6CA41800, 0x5AAD4A00,
+    },
+    {
+        0x00000000, 0xD9FE8C00, 0x35B1E300, 0xEC4F6F00, 0x6B63C600, 0xB29D4A00,
+        0x5ED22500, 0x872CA900, 0xD6C78C00, 0x0F390000, 0xE3766F00, 0x3A88E300,
+        0xBDA44A00, 0x645AC600, 0x8815A900, 0x51EB2500, 0x2BC3E300, 0xF23D6F00,
+        0x1E720000, 0xC78C8C00, 0x40A02500, 0x995EA900, 0x7511C600, 0xACEF4A00,
+        0xFD046F00, 0x24FAE300, 0xC8B58C00, 0x114B0000, 0x9667A900, 0x4F992500,
+        0xA3D64A00, 0x7A28C600, 0x5787C600, 0x8E794A00, 0x62362500, 0xBBC8A900,
+        0x3CE40000, 0xE51A8C00, 0x0955E300, 0xD0AB6F00, 0x81404A00, 0x58BEC600,
+        0xB4F1A900, 0x6D0F2500, 0xEA238C00, 0x33DD0000, 0xDF926F00, 0x066CE300,
+        0x7C442500, 0xA5BAA900, 0x49F5C600, 0x900B4A00, 0x1727E300, 0xCED96F00,
+        0x22960000, 0xFB688C00, 0xAA83A900, 0x737D2500, 0x9F324A00, 0x46CCC600,
+        0xC1E06F00, 0x181EE300, 0xF4518C00, 0x2DAF0000, 0xAF0F8C00, 0x76F10000,
+        0x9ABE6F00, 0x4340E300, 0xC46C4A00, 0x1D92C600, 0xF1DDA900, 0x28232500,
+        0x79C80000, 0xA0368C00, 0x4C79E300, 0x95876F00, 0x12ABC600, 0xCB554A00,
+        0x271A2500, 0xFEE4A900, 0x84CC6F00, 0x5D32E300, 0xB17D8C00, 0x68830000,
+        0xEFAFA900, 0x36512500, 0xDA1E4A00, 0x03E0C600, 0x520BE300, 0x8BF56F00,
+        0x67BA0000, 0xBE448C00, 0x39682500, 0xE096A900, 0x0CD9C600, 0xD5274A00,
+        0xF8884A00, 0x2176C600, 0xCD39A900, 0x14C72500, 0x93EB8C00, 0x4A150000,
+        0xA65A6F00, 0x7FA4E300, 0x2E4FC600, 0xF7B14A00, 0x1BFE2500, 0xC200A900,
+        0x452C0000, 0x9CD28C00, 0x709DE300, 0xA9636F00, 0xD34BA900, 0x0AB52500,
+        0xE6FA4A00, 0x3F04C600, 0xB8286F00, 0x61D6E300, 0x8D998C00, 0x54670000,
+        0x058C2500, 0xDC72A900, 0x303DC600, 0xE9C34A00, 0x6EEFE300, 0xB7116F00,
+        0x5B5E0000, 0x82A08C00, 0xD853E300, 0x01AD6F00, 0xEDE20000, 0x341C8C00,
+        0xB3302500, 0x6ACEA900, 0x8681C600, 0x5F7F4A00, 0x0E946F00, 0xD76AE300,
+        0x3B258C00, 0xE2DB0000, 0x65F7A900, 0xBC092500, 0x50464A00, 0x89B8C600,
+        0xF3900000, 0x2A6E8C00, 0xC621E300, 0x1FDF6F00, 0x98F3C600, 0x410D4A00,
+        0xAD422500, 0x74BCA900, 0x25578C00, 0xFCA90000, 0x10E66F00, 0xC918E300,
+        0x4E344A00, 0x97CAC600, 0x7B85A900, 0xA27B2500, 0x8FD42500, 0x562AA900,
+        0xBA65C600, 0x639B4A00, 0xE4B7E300, 0x3D496F00, 0xD1060000, 0x08F88C00,
+        0x5913A900, 0x80ED2500, 0x6CA24A00, 0xB55CC600, 0x32706F00, 0xEB8EE300,
+        0x07C18C00, 0xDE3F0000, 0xA417C600, 0x7DE94A00, 0x91A62500, 0x4858A900,
+        0xCF740000, 0x168A8C00, 0xFAC5E300, 0x233B6F00, 0x72D04A00, 0xAB2EC600,
+        0x4761A900, 0x9E9F2500, 0x19B38C00, 0xC04D0000, 0x2C026F00, 0xF5FCE300,
+        0x775C6F00, 0xAEA2E300, 0x42ED8C00, 0x9B130000, 0x1C3FA900, 0xC5C12500,
+        0x298E4A00, 0xF070C600, 0xA19BE300, 0x78656F00, 0x942A0000, 0x4DD48C00,
+        0xCAF82500, 0x1306A900, 0xFF49C600, 0x26B74A00, 0x5C9F8C00, 0x85610000,
+        0x692E6F00, 0xB0D0E300, 0x37FC4A00, 0xEE02C600, 0x024DA900, 0xDBB32500,
+        0x8A580000, 0x53A68C00, 0xBFE9E300, 0x66176F00, 0xE13BC600, 0x38C54A00,
+        0xD48A2500, 0x0D74A900, 0x20DBA900, 0xF9252500, 0x156A4A00, 0xCC94C600,
+        0x4BB86F00, 0x9246E300, 0x7E098C00, 0xA7F70000, 0xF61C2500, 0x2FE2A900,
+        0xC3ADC600, 0x1A534A00, 0x9D7FE300, 0x44816F00, 0xA8CE0000, 0x71308C00,
+        0x0B184A00, 0xD2E6C600, 0x3EA9A900, 0xE7572500, 0x607B8C00, 0xB9850000,
+        0x55CA6F00, 0x8C34E300, 0xDDDFC600, 0x04214A00, 0xE86E2500, 0x3190A900,
+        0xB6BC0000, 0x6F428C00, 0x830DE300, 0x5AF36F00,
+    },
+    {
+        0x00000000, 0x36EB3D00, 0x6DD67A00, 0x5B3D4700, 0xDBACF400, 0xED47C900,
+        0xB67A8E00, 0x8091B300, 0x31151300, 0x07FE2E00, 0x5CC36900, 0x6A285400,
+        0xEAB9E700, 0xDC52DA00, 0x876F9D00, 0xB184A000, 0x622A2600, 0x54C11B00,
+        0x0FFC5C00, 0x39176100, 0xB986D200, 0x8F6DEF00, 0xD450A800, 0xE2BB9500,
+        0x533F3500, 0x65D40800, 0x3EE94F00, 0x08027200, 0x8893C100, 0xBE78FC00,
+        0xE545BB00, 0xD3AE8600, 0xC4544C00, 0xF2BF7100, 0xA9823600, 0x9F690B00,
+        0x1FF8B800, 0x29138500, 0x722EC200, 0x44C5FF00, 0xF5415F00, 0xC3AA6200,
+        0x98972500, 0xAE7C1800, 0x2EEDAB00, 0x18069600, 0x433BD100, 0x75D0EC00,
+        0xA67E6A00, 0x90955700, 0xCBA81000, 0xFD432D00, 0x7DD29E00, 0x4B39A300,
+        0x1004E400, 0x26EFD900, 0x976B7900, 0xA1804400, 0xFABD0300, 0xCC563E00,
+        0x4CC78D00, 0x7A2CB000, 0x2111F700, 0x17FACA00, 0x0EE46300, 0x380F5E00,
+        0x63321900, 0x55D92400, 0xD5489700, 0xE3A3AA00, 0xB89EED00, 0x8E75D000,
+        0x3FF17000, 0x091A4D00, 0x52270A00, 0x64CC3700, 0xE45D8400, 0xD2B6B900,
+        0x898BFE00, 0xBF60C300, 0x6CCE4500, 0x5A257800, 0x01183F00, 0x37F30200,
+        0xB762B100, 0x81898C00, 0xDAB4CB00, 0xEC5FF600, 0x5DDB5600, 0x6B306B00,
+        0x300D2C00, 0x06E61100, 0x8677A200, 0xB09C9F00, 0xEBA1D800, 0xDD4AE500,
+        0xCAB02F00, 0xFC5B1200, 0xA7665500, 0x918D6800, 0x111CDB00, 0x27F7E600,
+        0x7CCAA100, 0x4A219C00, 0xFBA53C00, 0xCD4E0100, 0x96734600, 0xA0987B00,
+        0x2009C800, 0x16E2F500, 0x4DDFB200, 0x7B348F00, 0xA89A0900, 0x9E713400,
+        0xC54C7300, 0xF3A74E00, 0x7336FD00, 0x45DDC000, 0x1EE08700, 0x280BBA00,
+        0x998F1A00, 0xAF642700, 0xF4596000, 0xC2B25D00, 0x4223EE00, 0x74C8D300,
+        0x2FF59400, 0x191EA900, 0x1DC8C600, 0x2B23FB00, 0x701EBC00, 0x46F58100,
+        0xC6643200, 0xF08F0F00, 0xABB24800, 0x9D597500, 0x2CDDD500, 0x1A36E800,
+        0x410BAF00, 0x77E09200, 0xF7712100, 0xC19A1C00, 0x9AA75B00, 0xAC4C6600,
+        0x7FE2E000, 0x4909DD00, 0x12349A00, 0x24DFA700, 0xA44E1400, 0x92A52900,
+        0xC9986E00, 0xFF735300, 0x4EF7F300, 0x781CCE00, 0x23218900, 0x15CAB400,
+        0x955B0700, 0xA3B03A00, 0xF88D7D00, 0xCE664000, 0xD99C8A00, 0xEF77B700,
+        0xB44AF000, 0x82A1CD00, 0x02307E00, 0x34DB4300, 0x6FE60400, 0x590D3900,
+        0xE8899900, 0xDE62A400, 0x855FE300, 0xB3B4DE00, 0x33256D00, 0x05CE5000,
+        0x5EF31700, 0x68182A00, 0xBBB6AC00, 0x8D5D9100, 0xD660D600, 0xE08BEB00,
+        0x601A5800, 0x56F16500, 0x0DCC2200, 0x3B271F00, 0x8AA3BF00, 0xBC488200,
+        0xE775C500, 0xD19EF800, 0x510F4B00, 0x67E47600, 0x3CD93100, 0x0A320C00,
+        0x132CA500, 0x25C79800, 0x7EFADF00, 0x4811E200, 0xC8805100, 0xFE6B6C00,
+        0xA5562B00, 0x93BD1600, 0x2239B600, 0x14D28B00, 0x4FEFCC00, 0x7904F100,
+        0xF9954200, 0xCF7E7F00, 0x94433800, 0xA2A80500, 0x71068300, 0x47EDBE00,
+        0x1CD0F900, 0x2A3BC400, 0xAAAA7700, 0x9C414A00, 0xC77C0D00, 0xF1973000,
+        0x40139000, 0x76F8AD00, 0x2DC5EA00, 0x1B2ED700, 0x9BBF6400, 0xAD545900,
+        0xF6691E00, 0xC0822300, 0xD778E900, 0xE193D400, 0xBAAE9300, 0x8C45AE00,
+        0x0CD41D00, 0x3A3F2000, 0x61026700, 0x57E95A00, 0xE66DFA00, 0xD086C700,
+        0x8BBB8000, 0xBD50BD00, 0x3DC10E00, 0x0B2A3300, 0x50177400, 0x66FC4900,
+        0xB552CF00, 0x83B9F200, 0xD884B500, 0xEE6F8800, 0x6EFE3B00, 0x58150600,
+        0x03284100, 0x35C37C00, 0x8447DC00, 0xB2ACE100, 0xE991A600, 0xDF7A9B00,
+        0x5FEB2800, 0x69001500, 0x323D5200, 0x04D66F00,
+    },
+    {
+        0x00000000, 0x3B918C00, 0x77231800, 0x4CB29400, 0xEE463000, 0xD5D7BC00,
+        0x99652800, 0xA2F4A400, 0x5AC09B00, 0x61511700, 0x2DE38300, 0x16720F00,
+        0xB486AB00, 0x8F172700, 0xC3A5B300, 0xF8343F00, 0xB5813600, 0x8E10BA00,
+        0xC2A22E00, 0xF933A200, 0x5BC70600, 0x60568A00, 0x2CE41E00, 0x17759200,
+        0xEF41AD00, 0xD4D02100, 0x9862B500, 0xA3F33900, 0x01079D00, 0x3A961100,
+        0x76248500, 0x4DB50900, 0xED4E9700, 0xD6DF1B00, 0x9A6D8F00, 0xA1FC0300,
+        0x0308A700, 0x38992B00, 0x742BBF00, 0x4FBA3300, 0xB78E0C00, 0x8C1F8000,
+        0xC0AD1400, 0xFB3C9800, 0x59C83C00, 0x6259B000, 0x2EEB2400, 0x157AA800,
+        0x58CFA100, 0x635E2D00, 0x2FECB900, 0x147D3500, 0xB6899100, 0x8D181D00,
+        0xC1AA8900, 0xFA3B0500, 0x020F3A00, 0x399EB600, 0x752C2200, 0x4EBDAE00,
+        0xEC490A00, 0xD7D88600, 0x9B6A1200, 0xA0FB9E00, 0x5CD1D500, 0x67405900,
+        0x2BF2CD00, 0x10634100, 0xB297E500, 0x89066900, 0xC5B4FD00, 0xFE257100,
+        0x06114E00, 0x3D80C200, 0x71325600, 0x4AA3DA00, 0xE8577E00, 0xD3C6F200,
+        0x9F746600, 0xA4E5EA00, 0xE950E300, 0xD2C16F00, 0x9E73FB00, 0xA5E27700,
+        0x0716D300, 0x3C875F00, 0x7035CB00, 0x4BA44700, 0xB3907800, 0x8801F400,
+        0xC4B36000, 0xFF22EC00, 0x5DD64800, 0x6647C400, 0x2AF55000, 0x1164DC00,
+        0xB19F4200, 0x8A0ECE00, 0xC6BC5A00, 0xFD2DD600, 0x5FD97200, 0x6448FE00,
+        0x28FA6A00, 0x136BE600, 0xEB5FD900, 0xD0CE5500, 0x9C7CC100, 0xA7ED4D00,
+        0x0519E900, 0x3E886500, 0x723AF100, 0x49AB7D00, 0x041E7400, 0x3F8FF800,
+        0x733D6C00, 0x48ACE000, 0xEA584400, 0xD1C9C800, 0x9D7B5C00, 0xA6EAD000,
+        0x5EDEEF00, 0x654F6300, 0x29FDF700, 0x126C7B00, 0xB098DF00, 0x8B095300,
+        0xC7BBC700, 0xFC2A4B00, 0xB9A3AA00, 0x82322600, 0xCE80B200, 0xF5113E00,
+        0x57E59A00, 0x6C741600, 0x20C68200, 0x1B570E00, 0xE3633100, 0xD8F2BD00,
+        0x94402900, 0xAFD1A500, 0x0D250100, 0x36B48D00, 0x7A061900, 0x41979500,
+        0x0C229C00, 0x37B31000, 0x7B018400, 0x40900800, 0xE264AC00, 0xD9F52000,
+        0x9547B400, 0xAED63800, 0x56E20700, 0x6D738B00, 0x21C11F00, 0x1A509300,
+        0xB8A43700, 0x8335BB00, 0xCF872F00, 0xF416A300, 0x54ED3D00, 0x6F7CB100,
+        0x23CE2500, 0x185FA900, 0xBAAB0D00, 0x813A8100, 0xCD881500, 0xF6199900,
+        0x0E2DA600, 0x35BC2A00, 0x790EBE00, 0x429F3200, 0xE06B9600, 0xDBFA1A00,
+        0x97488E00, 0xACD90200, 0xE16C0B00, 0xDAFD8700, 0x964F1300, 0xADDE9F00,
+        0x0F2A3B00, 0x34BBB700, 0x78092300, 0x4398AF00, 0xBBAC9000, 0x803D1C00,
+        0xCC8F8800, 0xF71E0400, 0x55EAA000, 0x6E7B2C00, 0x22C9B800, 0x19583400,
+        0xE5727F00, 0xDEE3F300, 0x92516700, 0xA9C0EB00, 0x0B344F00, 0x30A5C300,
+        0x7C175700, 0x4786DB00, 0xBFB2E400, 0x84236800, 0xC891FC00, 0xF3007000,
+        0x51F4D400, 0x6A655800, 0x26D7CC00, 0x1D464000, 0x50F34900, 0x6B62C500,
+        0x27D05100, 0x1C41DD00, 0xBEB57900, 0x8524F500, 0xC9966100, 0xF207ED00,
+        0x0A33D200, 0x31A25E00, 0x7D10CA00, 0x46814600, 0xE475E200, 0xDFE46E00,
+        0x9356FA00, 0xA8C77600, 0x083CE800, 0x33AD6400, 0x7F1FF000, 0x448E7C00,
+        0xE67AD800, 0xDDEB5400, 0x9159C000, 0xAAC84C00, 0x52FC7300, 0x696DFF00,
+        0x25DF6B00, 0x1E4EE700, 0xBCBA4300, 0x872BCF00, 0xCB995B00, 0xF008D700,
+        0xBDBDDE00, 0x862C5200, 0xCA9EC600, 0xF10F4A00, 0x53FBEE00, 0x686A6200,
+        0x24D8F600, 0x1F497A00, 0xE77D4500, 0xDCECC900, 0x905E5D00, 0xABCFD100,
+        0x093B7500, 0x32AAF900, 0x7E186D00, 0x4589E100,
+    },
+    {
+        0x00000000, 0xF50BAF00, 0x6C5BA500, 0x99500A00, 0xD8B74A00, 0x2DBCE500,
+        0xB4ECEF00, 0x41E74000, 0x37226F00, 0xC229C000, 0x5B79CA00, 0xAE726500,
+        0xEF952500, 0x1A9E8A00, 0x83CE8000, 0x76C52F00, 0x6E44DE00, 0x9B4F7100,
+        0x021F7B00, 0xF714D400, 0xB6F39400, 0x43F83B00, 0xDAA83100, 0x2FA39E00,
+        0x5966B100, 0xAC6D1E00, 0x353D1400, 0xC036BB00, 0x81D1FB00, 0x74DA5400,
+        0xED8A5E00, 0x1881F100, 0xDC89BC00, 0x29821300, 0xB0D21900, 0x45D9B600,
+        0x043EF600, 0xF1355900, 0x68655300, 0x9D6EFC00, 0xEBABD300, 0x1EA07C00,
+        0x87F07600, 0x72FBD900, 0x331C9900, 0xC6173600, 0x5F473C00, 0xAA4C9300,
+        0xB2CD6200, 0x47C6CD00, 0xDE96C700, 0x2B9D6800, 0x6A7A2800, 0x9F718700,
+        0x06218D00, 0xF32A2200, 0x85EF0D00, 0x70E4A200, 0xE9B4A800, 0x1CBF0700,
+        0x5D584700, 0xA853E800, 0x3103E200, 0xC4084D00, 0x3F5F8300, 0xCA542C00,
+        0x53042600, 0xA60F8900, 0xE7E8C900, 0x12E36600, 0x8BB36C00, 0x7EB8C300,
+        0x087DEC00, 0xFD764300, 0x64264900, 0x912DE600, 0xD0CAA600, 0x25C10900,
+        0xBC910300, 0x499AAC00, 0x511B5D00, 0xA410F200, 0x3D40F800, 0xC84B5700,
+        0x89AC1700, 0x7CA7B800, 0xE5F7B200, 0x10FC1D00, 0x66393200, 0x93329D00,
+        0x0A629700, 0xFF693800, 0xBE8E7800, 0x4B85D700, 0xD2D5DD00, 0x27DE7200,
+        0xE3D63F00, 0x16DD9000, 0x8F8D9A00, 0x7A863500, 0x3B617500, 0xCE6ADA00,
+        0x573AD000, 0xA2317F00, 0xD4F45000, 0x21FFFF00, 0xB8AFF500, 0x4DA45A00,
+        0x0C431A00, 0xF948B500, 0x6018BF00, 0x95131000, 0x8D92E100, 0x78994E00,
+        0xE1C94400, 0x14C2EB00, 0x5525AB00, 0xA02E0400, 0x397E0E00, 0xCC75A100,
+        0xBAB08E00, 0x4FBB2100, 0xD6EB2B00, 0x23E08400, 0x6207C400, 0x970C6B00,
+        0x0E5C6100, 0xFB57CE00, 0x7EBF0600, 0x8BB4A900, 0x12E4A300, 0xE7EF0C00,
+        0xA6084C00, 0x5303E300, 0xCA53E900, 0x3F584600, 0x499D6900, 0xBC96C600,
+        0x25C6CC00, 0xD0CD6300, 0x912A2300, 0x64218C00, 0xFD718600, 0x087A2900,
+        0x10FBD800, 0xE5F07700, 0x7CA07D00, 0x89ABD200, 0xC84C9200, 0x3D473D00,
+        0xA4173700, 0x511C9800, 0x27D9B700, 0xD2D21800, 0x4B821200, 0xBE89BD00,
+        0xFF6EFD00, 0x0A655200, 0x93355800, 0x663EF700, 0xA236BA00, 0x573D1500,
+        0xCE6D1F00, 0x3B66B000, 0x7A81F000, 0x8F8A5F00, 0x16DA5500, 0xE3D1FA00,
+        0x9514D500, 0x601F7A00, 0xF94F7000, 0x0C44DF00, 0x4DA39F00, 0xB8A83000,
+        0x21F83A00, 0xD4F39500, 0xCC726400, 0x3979CB00, 0xA029C100, 0x55226E00,
+        0x14C52E00, 0xE1CE8100, 0x789E8B00, 0x8D952400, 0xFB500B00, 0x0E5BA400,
+        0x970BAE00, 0x62000100, 0x23E74100, 0xD6ECEE00, 0x4FBCE400, 0xBAB74B00,
+        0x41E08500, 0xB4EB2A00, 0x2DBB2000, 0xD8B08F00, 0x9957CF00, 0x6C5C6000,
+        0xF50C6A00, 0x0007C500, 0x76C2EA00, 0x83C94500, 0x1A994F00, 0xEF92E000,
+        0xAE75A000, 0x5B7E0F00, 0xC22E0500, 0x3725AA00, 0x2FA45B00, 0xDAAFF400,
+        0x43FFFE00, 0xB6F45100, 0xF7131100, 0x0218BE00, 0x9B48B400, 0x6E431B00,
+        0x18863400, 0xED8D9B00, 0x74DD9100, 0x81D63E00, 0xC0317E00, 0x353AD100,
+        0xAC6ADB00, 0x59617400, 0x9D693900, 0x68629600, 0xF1329C00, 0x04393300,
+        0x45DE7300, 0xB0D5DC00, 0x2985D600, 0xDC8E7900, 0xAA4B5600, 0x5F40F900,
+        0xC610F300, 0x331B5C00, 0x72FC1C00, 0x87F7B300, 0x1EA7B900, 0xEBAC1600,
+        0xF32DE700, 0x06264800, 0x9F764200, 0x6A7DED00, 0x2B9AAD00, 0xDE910200,
+        0x47C10800, 0xB2CAA700, 0xC40F8800, 0x31042700, 0xA8542D00, 0x5D5F8200,
+        0x1CB8C200, 0xE9B36D00, 0x70E36700, 0x85E8C800,
+    },
+};
+
+/**
+ * \brief the CRC-24Q of the data, used by Galileo I/NAV, SBAS and RTCM 3
+ * \param buf: the data
+ * \param sz: the byte size of the data
+ *
+ * \return the 24-bit CRC
+ *
+ * The data is processed by 8 bytes per step with the tables of slicing-by-8.
+ */
+uint32_t
+ublox_crc24q(const uint8_t * buf, size_t sz)
+{
+    const uint32_t (* tbl)[256] = g_ublox_crc24q_tbl;
+    uint32_t crc = 0;
+    uint32_t a;
+    uint32_t b;
+
+    for (; sz >= 8; sz -= 8, buf += 8) {
+        a = crc ^ (((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3]);
+        b = ((uint32_t)buf[4] << 24) | ((uint32_t)buf[5] << 16) | ((uint32_t)buf[6] << 8) | buf[7];
+        crc = tbl[7][a >> 24] ^ tbl[6][(a >> 16) & 0xFF] ^ tbl[5][(a >> 8) & 0xFF] ^ tbl[4][a & 0xFF]
+            ^ tbl[3][b >> 24] ^ tbl[2][(b >> 16) & 0xFF] ^ tbl[1][(b >> 8) & 0xFF] ^ tbl[0][b & 0xFF];
+    }
+    for (; sz > 0; sz --, buf ++) {
+        crc = (crc << 8) ^ tbl[0][(crc >> 24) ^ *buf];
+    }
+    return crc >> 8;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+TEST_CASE( .name="bit-fields", .description="test bit fields.", .skip=0 ) {
+    SECTION("test ublox_getbitu") {
+        uint8_t buf[8] = { 0x8B, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE };
+        REQUIRE (0x8B == ublox_getbitu(buf, 0, 8));
+        REQUIRE (0x1 == ublox_getbitu(buf, 0, 1));
+        REQUIRE (0xB12 == ublox_getbitu(buf, 4, 12));
+        REQUIRE (0x23456789 == ublox_getbitu(buf, 12, 32));
+        REQUIRE (-117 == ublox_getbits(buf, 0, 8));
+        REQUIRE (-10 == ublox_getbits(buf, 4, 5));
+        REQUIRE (0 == ublox_getbitu(buf, 3, 0));
+    }
+    SECTION("test ublox_setbitu") {
+        uint8_t buf[8];
+        memset(buf, 0xFF, sizeof(buf));
+        ublox_setbitu(buf, 3, 10, 0);
+        REQUIRE (0xE0 == buf[0]);
+        REQUIRE (0x07 == buf[1]);
+        ublox_setbitu(buf, 20, 32, 0x12345678);
+        REQUIRE (0x12345678 == ublox_getbitu(buf, 20, 32));
+        ublox_setbitu(buf, 5, 7, (uint32_t)-3);
+        REQUIRE (-3 == ublox_getbits(buf, 5, 7));
+    }
+    SECTION("test ublox_bitfield_extract") {
+        static const ublox_bitfield_t tbl[] = {
+            UBLOX_BITFIELD_U(0, 8),
+            UBLOX_BITFIELD_U(4, 12),
+            UBLOX_BITFIELD_U(12, 32),
+            UBLOX_BITFIELD_S(4, 5),
+            UBLOX_BITFIELD_U2(7, 9, 40, 23),
+            UBLOX_BITFIELD_S2(73, 9, 90, 8),
+            UBLOX_BITFIELD_U(80, 16),
+            UBLOX_BITFIELD_S(255, 1),
+        };
+        uint8_t buf[32];
+        uint32_t val[NUM_ARRAY(tbl)];
+        int impl;
+        size_t i;
+
+        for (i = 0; i < sizeof(buf); i ++) {
+            buf[i] = (uint8_t)(i * 37 + 0x8B);
+        }
+        REQUIRE (0 == ublox_bitfield_check(tbl, NUM_ARRAY(tbl)));
+        for (impl = UBLOX_BITFIELD_IMPL_SCALAR; impl <= UBLOX_BITFIELD_IMPL_BMI2; impl ++) {
+            if (0 > ublox_bitfield_impl_select(impl)) {
+                continue;
+            }
+            memset(val, 0, sizeof(val));
+            REQUIRE (0 == ublox_bitfield_extract(buf, sizeof(buf), tbl, NUM_ARRAY(tbl), val));
+            REQUIRE (val[0] == ublox_getbitu(buf, 0, 8));
+            REQUIRE (val[1] == ublox_getbitu(buf, 4, 12));
+            REQUIRE (val[2] == ublox_getbitu(buf, 12, 32));
+            REQUIRE ((int32_t)val[3] == ublox_getbits(buf, 4, 5));
+            REQUIRE (val[4] == ((ublox_getbitu(buf, 7, 9) << 23) | ublox_getbitu(buf, 40, 23)));
+            REQUIRE ((int32_t)val[5] == ((int32_t)(((ublox_getbitu(buf, 73, 9) << 8) | ublox_getbitu(buf, 90, 8)) << 15) >> 15));
+            REQUIRE (val[6] == ublox_getbitu(buf, 80, 16));
+            REQUIRE ((int32_t)val[7] == ublox_getbits(buf, 255, 1));
+            // the field out of the buffer
+            REQUIRE (0 > ublox_bitfield_extract(buf, 31, tbl, NUM_ARRAY(tbl), val));
+            REQUIRE (0 == ublox_bitfield_extract(buf, 12, tbl + 6, 1, val));
+            REQUIRE (val[0] == ublox_getbitu(buf, 80, 16));
+        }
+        ublox_bitfield_impl_select(UBLOX_BITFIELD_IMPL_AUTO);
+    }
+    SECTION("test ublox_bitfield_check") {
+        ublox_bitfield_t fld = UBLOX_BITFIELD_U(8, 8);
+        REQUIRE (0 == ublox_bitfield_check(&fld, 1));
+        fld.len2 = 30;
+        REQUIRE (1 == ublox_bitfield_check(&fld, 1));
+    }
+    SECTION("test ublox_bitreader") {
+        uint8_t buf[32];
+        uint32_t val[8];
+        int32_t sval[4];
+        ublox_bitreader_t br;
+        size_t i;
+
+        for (i = 0; i < sizeof(buf); i ++) {
+            buf[i] = (uint8_t)(i * 37 + 11);
+        }
+        ublox_bitreader_init(&br, buf, sizeof(buf));
+        REQUIRE (ublox_getbitu(buf, 0, 12) == ublox_bitreader_u(&br, 12));
+        REQUIRE (ublox_getbits(buf, 12, 7) == ublox_bitreader_s(&br, 7));
+        REQUIRE (0 == ublox_bitreader_u(&br, 0));
+        REQUIRE (((uint64_t)ublox_getbitu(buf, 19, 6) << 32 | ublox_getbitu(buf, 25, 32)) == ublox_bitreader_u64(&br, 38));
+        REQUIRE (((int64_t)ublox_getbits(buf, 57, 6) * 4294967296LL + ublox_getbitu(buf, 63, 32)) == ublox_bitreader_s64(&br, 38));
+        REQUIRE (0 == ublox_bitreader_array_u(&br, 10, 8, val));
+        for (i = 0; i < 8; i ++) {
+            REQUIRE (ublox_getbitu(buf, 95 + i * 10, 10) == val[i]);
+        }
+        REQUIRE (0 == ublox_bitreader_array_s(&br, 15, 4, sval));
+        for (i = 0; i < 4; i ++) {
+            REQUIRE (ublox_getbits(buf, 175 + i * 15, 15) == sval[i]);
+        }
+        REQUIRE (235 == br.pos);
+        REQUIRE (0 == br.flg_err);
+        // the last bits
+        REQUIRE (ublox_getbitu(buf, 235, 21) == ublox_bitreader_u(&br, 21));
+        REQUIRE (0 == br.flg_err);
+        REQUIRE (0 > ublox_bitreader_array_u(&br, 1, 1, val));
+        REQUIRE (256 == br.pos);
+        REQUIRE (0 == ublox_bitreader_u(&br, 1));
+        REQUIRE (1 == br.flg_err);
+    }
+
+    SECTION("test ublox_bitwriter") {
+        uint8_t buf[40];
+        uint8_t ref[40];
+        uint32_t val[8];
+        int32_t sval[4];
+        ublox_bitwriter_t bw;
+        size_t pos = 0;
+        size_t i;
+
+        memset(ref, 0, sizeof(ref));
+        memset(buf, 0xFF, sizeof(buf));
+        ublox_bitwriter_init(&bw, buf, sizeof(buf));
+        ublox_bitwriter_u(&bw, 12, 1077);
+        ublox_setbitu(ref, pos, 12, 1077); pos += 12;
+        ublox_bitwriter_s(&bw, 7, -5);
+        ublox_setbitu(ref, pos, 7, (uint32_t)-5 & 0x7F); pos += 7;
+        ublox_bitwriter_u(&bw, 0, 1);
+        ublox_bitwriter_s64(&bw, 38, -12345678901LL);
+        ublox_setbitu(ref, pos, 6, (uint32_t)((uint64_t)-12345678901LL >> 32) & 0x3F); pos += 6;
+        ublox_setbitu(ref, pos, 32, (uint32_t)(uint64_t)-12345678901LL); pos += 32;
+        ublox_bitwriter_u64(&bw, 64, 0x8000000000000001ULL);
+        ublox_setbitu(ref, pos, 32, 0x80000000); pos += 32;
+        ublox_setbitu(ref, pos, 32, 0x00000001); pos += 32;
+        for (i = 0; i < 8; i ++) {
+            val[i] = i * 111 + 7;
+            ublox_setbitu(ref, pos, 10, val[i]); pos += 10;
+        }
+        REQUIRE (0 == ublox_bitwriter_array_u(&bw, 10, 8, val));
+        for (i = 0; i < 4; i ++) {
+            sval[i] = (int32_t)(i * 1000) - 1500;
+            ublox_setbitu(ref, pos, 15, (uint32_t)sval[i] & 0x7FFF); pos += 15;
+        }
+        REQUIRE (0 == ublox_bitwriter_array_s(&bw, 15, 4, sval));
+        REQUIRE (pos == bw.pos);
+        REQUIRE (0 == bw.flg_err);
+        REQUIRE ((pos + 7) / 8 == ublox_bitwriter_flush(&bw));
+        REQUIRE (0 == memcmp(ref, buf, (pos + 7) / 8));
+
+        // the last bits
+        ublox_bitwriter_u64(&bw, sizeof(buf) * 8 - pos, 0);
+        REQUIRE (0 == bw.flg_err);
+        REQUIRE (0 > ublox_bitwriter_array_u(&bw, 1, 1, val));
+        ublox_bitwriter_u(&bw, 1, 1);
+        REQUIRE (1 == bw.flg_err);
+        REQUIRE (sizeof(buf) == ublox_bitwriter_flush(&bw));
+        REQUIRE (0 == memcmp(ref, buf, sizeof(buf)));
+    }
+}
+
+TEST_CASE( .name="crc24q", .description="test CRC-24Q.", .skip=0 ) {
+    SECTION("test crc24q") {
+        REQUIRE (0 == ublox_crc24q((const uint8_t *)"", 0));
+        REQUIRE (0xCDE703 == ublox_crc24q((const uint8_t *)"123456789", 9));
+    }
+    SECTION("test crc24q by the bitwise reference") {
+        uint8_t buf[100];
+        uint32_t crc;
+        size_t sz;
+        size_t i;
+        int j;
+
+        for (i = 0; i < sizeof(buf); i ++) {
+            buf[i] = (uint8_t)(i * 37 + 11);
+        }
+        for (sz = 0; sz <= sizeof(buf); sz ++) {
+            crc = 0;
+            for (i = 0; i < sz; i ++) {
+                crc ^= (uint32_t)buf[i] << 16;
+                for (j = 0; j < 8; j ++) {
+                    crc <<= 1;
+                    if (crc & 0x1000000) {
+                        crc ^= UBLOX_CRC24Q_POLY;
+                    }
+                }
+            }
+            REQUIRE (crc == ublox_crc24q(buf, sz));
+        }
+    }
+}
+
+#endif /* CIUT_ENABLED */
@@ -35,6 +35,96 @@ int cstr_strip(const char * orig, char * buf, size_t sz_buf);
 
 ssize_t parse_hex_buf(char * cstr, size_t cslen, uint8_t * buf, size_t szbuf);
 
+uint32_t ublox_getbitu(const uint8_t * buf, size_t pos, size_t len);
+int32_t ublox_getbits(const uint8_t * buf, size_t pos, size_t len);
+void ublox_setbitu(uint8_t * buf, size_t pos, size_t len, uint32_t val);
+
+/**
+ * A bit field of the table for ublox_bitfield_extract(), MSB first. The
+ * field can be split into two parts (the high part and the low part), both
+ * in the 64-bit window starting from the byte of the first bit. Use the
+ * macros UBLOX_BITFIELD_xxx to create the items of the table, the values
+ * are computed at compile time.
+ */
+typedef struct _ublox_bitfield_t {
+    uint64_t mask;   /**< the bits of the field in the window */
+    uint16_t off;    /**< the byte offset of the window */
+    uint8_t sh1;     /**< the right shift of the high part in the window */
+    uint8_t len1;    /**< the number of bits of the high part */
+    uint8_t sh2;     /**< the right shift of the low part in the window */
+    uint8_t len2;    /**< the number of bits of the low part, 0 if the field is not split */
+    uint8_t sign;    /**< 1 if the value is two's complement */
+} ublox_bitfield_t;
+
+#define UBLOX_BITFIELD_LMASK(len) ((~0ULL >> (63 - (len))) >> 1)
+#define UBLOX_BITFIELD_SH(pos1, pos, len) (64 - ((pos) - (pos1) / 8 * 8) - (len))
+#define UBLOX_BITFIELD_X(pos1, len1, pos2, len2, sgn) { \
+        (UBLOX_BITFIELD_LMASK(len1) << UBLOX_BITFIELD_SH(pos1, pos1, len1)) \
+            | (UBLOX_BITFIELD_LMASK(len2) << UBLOX_BITFIELD_SH(pos1, pos2, len2)), \
+        (pos1) / 8, UBLOX_BITFIELD_SH(pos1, pos1, len1), (len1), UBLOX_BITFIELD_SH(pos1, pos2, len2), (len2), (sgn) }
+/** the unsigned field of len bits at pos */
+#define UBLOX_BITFIELD_U(pos, len) UBLOX_BITFIELD_X(pos, len, (pos) + (len), 0, 0)
+/** the signed field of len bits at pos */
+#define UBLOX_BITFIELD_S(pos, len) UBLOX_BITFIELD_X(pos, len, (pos) + (len), 0, 1)
+/** the unsigned field split into two parts, the high part first */
+#define UBLOX_BITFIELD_U2(pos1, len1, pos2, len2) UBLOX_BITFIELD_X(pos1, len1, pos2, len2, 0)
+/** the signed field split into two parts, the high part first */
+#define UBLOX_BITFIELD_S2(pos1, len1, pos2, len2) UBLOX_BITFIELD_X(pos1, len1, pos2, len2, 1)
+
+#define UBLOX_BITFIELD_IMPL_AUTO   0 /**< select the best implementation supported by the CPU */
+#define UBLOX_BITFIELD_IMPL_SCALAR 1
+#define UBLOX_BITFIELD_IMPL_BMI2   2
+int ublox_bitfield_impl_select(int impl);
+const char * ublox_bitfield_impl_name(int impl);
+int ublox_bitfield_check(const ublox_bitfield_t * tbl, size_t num);
+int ublox_bitfield_extract(const uint8_t * buf, size_t sz, const ublox_bitfield_t * tbl, size_t num, uint32_t * val);
+
+/**
+ * The sequential reader of the bit fields, MSB first, such as the messages of
+ * RTCM 3. Each field is taken from a 64-bit window of the buffer without the
+ * loop of the bits. Reading after the end of the buffer returns 0 and sets
+ * flg_err, so the caller checks flg_err once after a group of fields.
+ */
+typedef struct _ublox_bitreader_t {
+    const uint8_t * buf;
+    size_t sz;       /**< the byte size of buf */
+    size_t pos;      /**< the position of the next bit */
+    int flg_err;     /**< 1 if a field is out of the buffer */
+} ublox_bitreader_t;
+
+void ublox_bitreader_init(ublox_bitreader_t * br, const uint8_t * buf, size_t sz);
+uint32_t ublox_bitreader_u(ublox_bitreader_t * br, size_t len);
+int32_t ublox_bitreader_s(ublox_bitreader_t * br, size_t len);
+uint64_t ublox_bitreader_u64(ublox_bitreader_t * br, size_t len);
+int64_t ublox_bitreader_s64(ublox_bitreader_t * br, size_t len);
+int ublox_bitreader_array_u(ublox_bitreader_t * br, size_t len, size_t num, uint32_t * val);
+int ublox_bitreader_array_s(ublox_bitreader_t * br, size_t len, size_t num, int32_t * val);
+
+/**
+ * The sequential writer of the bit fields, MSB first, to the preallocated
+ * buffer. The pending bits of the last byte are kept in a register and the
+ * complete bytes are stored without the loop of the bits. Writing after the
+ * end of the buffer is dropped and sets flg_err.
+ */
+typedef struct _ublox_bitwriter_t {
+    uint8_t * buf;
+    size_t sz;       /**< the byte size of buf */
+    size_t pos;      /**< the number of bits written */
+    uint64_t acc;    /**< the bits of the last byte not stored, pos % 8 bits */
+    int flg_err;     /**< 1 if a field is out of the buffer */
+} ublox_bitwriter_t;
+
+void ublox_bitwriter_init(ublox_bitwriter_t * bw, uint8_t * buf, size_t sz);
+void ublox_bitwriter_u(ublox_bitwriter_t * bw, size_t len, uint32_t val);
+void ublox_bitwriter_s(ublox_bitwriter_t * bw, size_t len, int32_t val);
+void ublox_bitwriter_u64(ublox_bitwriter_t * bw, size_t len, uint64_t val);
+void ublox_bitwriter_s64(ublox_bitwriter_t * bw, size_t len, int64_t val);
+int ublox_bitwriter_array_u(ublox_bitwriter_t * bw, size_t len, size_t num, const uint32_t * val);
+int ublox_bitwriter_array_s(ublox_bitwriter_t * bw, size_t len, size_t num, const int32_t * val);
+size_t ublox_bitwriter_flush(ublox_bitwriter_t * bw);
+
+uint32_t ublox_crc24q(const uint8_t * buf, size_t sz);
+
 #ifndef NUM_ARRAY
 #define NUM_ARRAY(a) (sizeof(a)/sizeof(a[0]))
 #endif
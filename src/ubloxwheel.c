@@ -0,0 +1,289 @@
+/**
+ * \file    ubloxwheel.c
+ * \brief   The hashed timer wheel of the deadlines
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#include "ubloxconn.h"
+#include "ubloxwheel.h"
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#define UBLOX_WHEEL_MASK (UBLOX_WHEEL_SLOTS - 1)
+
+/* append the node to the circular list */
+static void
+ublox_wheel_link(ublox_tmnode_t * head, ublox_tmnode_t * node)
+{
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+/* remove the node from the circular list */
+static void
+ublox_wheel_unlink(ublox_tmnode_t * node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node->prev = NULL;
+}
+
+/**
+ * \brief setup the timer
+ * \param node: the timer
+ * \param data: the owner of the timer
+ */
+void
+ublox_tmnode_init(ublox_tmnode_t * node, void * data)
+{
+    assert (NULL != node);
+    node->next = node->prev = NULL;
+    node->expire = 0;
+    node->data = data;
+}
+
+/**
+ * \brief setup the wheel
+ * \param w: the wheel
+ * \param tick: the time of a slot (ms), the resolution of the timers
+ * \param now: the current time (ms)
+ */
+void
+ublox_wheel_init(ublox_wheel_t * w, uint32_t tick, uint64_t now)
+{
+    size_t i;
+
+    assert (NULL != w);
+    w->tick = (tick > 0)?tick:1;
+    w->cur = now / w->tick;
+    w->num = 0;
+    for (i = 0; i < UBLOX_WHEEL_SLOTS; i ++) {
+        w->slots[i].next = w->slots[i].prev = w->slots + i;
+        w->slots[i].data = NULL;
+    }
+}
+
+/**
+ * \brief start or restart the timer
+ * \param w: the wheel
+ * \param node: the timer
+ * \param expire: the deadline (ms)
+ */
+void
+ublox_wheel_add(ublox_wheel_t * w, ublox_tmnode_t * node, uint64_t expire)
+{
+    uint64_t t;
+
+    assert (NULL != w);
+    assert (NULL != node);
+    if (ublox_tmnode_pending(node)) {
+        ublox_wheel_unlink(node);
+        w->num --;
+    }
+    node->expire = expire;
+    t = expire / w->tick;
+    if (t < w->cur) {
+        // expired already, fired by the next advance
+        t = w->cur;
+    }
+    ublox_wheel_link(w->slots + (t & UBLOX_WHEEL_MASK), node);
+    w->num ++;
+}
+
+/**
+ * \brief stop the timer, nothing to do if it's not in the wheel
+ * \param w: the wheel
+ * \param node: the timer
+ */
+void
+ublox_wheel_del(ublox_wheel_t * w, ublox_tmnode_t * node)
+{
+    assert (NULL != w);
+    assert (NULL != node);
+    if (ublox_tmnode_pending(node)) {
+        ublox_wheel_unlink(node);
+        w->num --;
+    }
+}
+
+/**
+ * \brief call the callback of the timers expired
+ * \param w: the wheel
+ * \param now: the current time (ms)
+ * \param cb: the callback
+ * \param userdata: the user data of the callback
+ *
+ * \return the number of the timers expired
+ *
+ * The slots from the current tick to now are visited once, at most one
+ * revolution. The callback may add or remove any timer.
+ */
+size_t
+ublox_wheel_advance(ublox_wheel_t * w, uint64_t now, ublox_wheel_cb_t cb, void * userdata)
+{
+    ublox_tmnode_t pending;
+    ublox_tmnode_t * head;
+    ublox_tmnode_t * node;
+    uint64_t end;
+    uint64_t n;
+    size_t num = 0;
+
+    assert (NULL != w);
+    end = now / w->tick;
+    if (end < w->cur) {
+        end = w->cur;
+    }
+    n = end - w->cur + 1;
+    if (n > UBLOX_WHEEL_SLOTS) {
+        n = UBLOX_WHEEL_SLOTS;
+    }
+    for (; n > 0; n --, w->cur ++) {
+        head = w->slots + (w->cur & UBLOX_WHEEL_MASK);
+        if (head->next == head) {
+            continue;
+        }
+        // move the slot to a local list, so the callback can add the timers to the slot
+        pending.next = head->next;
+        pending.prev = head->prev;
+        pending.next->prev = pending.prev->next = &pending;
+        head->next = head->prev = head;
+        while (pending.next != &pending) {
+            node = pending.next;
+            ublox_wheel_unlink(node);
+            if (node->expire > now) {
+                // a later round
+                ublox_wheel_link(head, node);
+                continue;
+            }
+            w->num --;
+            num ++;
+            if (NULL != cb) {
+                cb(userdata, node);
+            }
+        }
+    }
+    // the slot of now may have the timers of the rest of this tick
+    w->cur = end;
+    return num;
+}
+
+/**
+ * \brief the time to advance the wheel
+ * \param w: the wheel
+ *
+ * \return the earliest deadline (ms) of the next non-empty slot, 0 if no timer
+ *
+ * If the timers are beyond one revolution, the time of one revolution later
+ * is returned.
+ */
+uint64_t
+ublox_wheel_next(const ublox_wheel_t * w)
+{
+    const ublox_tmnode_t * head;
+    const ublox_tmnode_t * node;
+    uint64_t t;
+    uint64_t ret;
+    size_t i;
+
+    assert (NULL != w);
+    if (w->num < 1) {
+        return 0;
+    }
+    for (i = 0; i < UBLOX_WHEEL_SLOTS; i ++) {
+        t = w->cur + i;
+        head = w->slots + (t & UBLOX_WHEEL_MASK);
+        ret = UINT64_MAX;
+        for (node = head->next; node != head; node = node->next) {
+            if ((node->expire / w->tick <= t) && (node->expire < ret)) {
+                ret = node->expire;
+            }
+        }
+        if (ret != UINT64_MAX) {
+            return ret;
+        }
+    }
+    return (w->cur + UBLOX_WHEEL_SLOTS) * w->tick;
+}
+
+#if defined(CIUT_ENABLED) && (CIUT_ENABLED == 1)
+#include <ciut.h>
+
+/* record the order of the expired timers */
+static void
+ublox_wheel_test_cb(void * userdata, ublox_tmnode_t * node)
+{
+    char * order = (char *)userdata;
+    size_t len = strlen(order);
+
+    order[len] = '0' + (char)(intptr_t)(node->data);
+    order[len + 1] = 0;
+}
+
+TEST_CASE( .name="ublox-wheel", .description="Test the timer wheel." ) {
+    ublox_wheel_t w;
+    ublox_tmnode_t nodes[5];
+    char order[16];
+    size_t i;
+
+    SECTION("test the order of the timers") {
+        ublox_wheel_init(&w, 10, 1000);
+        for (i = 0; i < NUM_ARRAY(nodes); i ++) {
+            ublox_tmnode_init(nodes + i, (void *)(intptr_t)i);
+            REQUIRE(! ublox_tmnode_pending(nodes + i));
+        }
+        REQUIRE(0 == ublox_wheel_next(&w));
+        ublox_wheel_add(&w, nodes + 0, 1055);
+        ublox_wheel_add(&w, nodes + 1, 1020);
+        ublox_wheel_add(&w, nodes + 2, 1025);
+        // one revolution later, the same slot of nodes[1]
+        ublox_wheel_add(&w, nodes + 3, 1020 + 10 * UBLOX_WHEEL_SLOTS);
+        ublox_wheel_add(&w, nodes + 4, 900);
+        REQUIRE(5 == w.num);
+        REQUIRE(ublox_tmnode_pending(nodes + 3));
+        REQUIRE(900 == ublox_wheel_next(&w));
+
+        order[0] = 0;
+        REQUIRE(1 == ublox_wheel_advance(&w, 1000, ublox_wheel_test_cb, order));
+        REQUIRE(0 == strcmp("4", order));
+        REQUIRE(! ublox_tmnode_pending(nodes + 4));
+        REQUIRE(1020 == ublox_wheel_next(&w));
+
+        REQUIRE(1 == ublox_wheel_advance(&w, 1020, ublox_wheel_test_cb, order));
+        REQUIRE(0 == strcmp("41", order));
+        REQUIRE(1025 == ublox_wheel_next(&w));
+        REQUIRE(0 == ublox_wheel_advance(&w, 1024, ublox_wheel_test_cb, order));
+        REQUIRE(1 == ublox_wheel_advance(&w, 1040, ublox_wheel_test_cb, order));
+        REQUIRE(0 == strcmp("412", order));
+
+        // restart and stop
+        ublox_wheel_add(&w, nodes + 0, 1100);
+        REQUIRE(2 == w.num);
+        REQUIRE(1100 == ublox_wheel_next(&w));
+        ublox_wheel_del(&w, nodes + 0);
+        ublox_wheel_del(&w, nodes + 0);
+        REQUIRE(1 == w.num);
+        REQUIRE(! ublox_tmnode_pending(nodes + 0));
+
+        // nodes[3] is in the next round of its slot
+        REQUIRE(1020 + 10 * UBLOX_WHEEL_SLOTS == ublox_wheel_next(&w));
+        REQUIRE(0 == ublox_wheel_advance(&w, 1020 + 10 * UBLOX_WHEEL_SLOTS - 1, ublox_wheel_test_cb, order));
+        REQUIRE(ublox_tmnode_pending(nodes + 3));
+        // nodes[0] is beyond one revolution
+        ublox_wheel_add(&w, nodes + 0, 1000 + 30 * UBLOX_WHEEL_SLOTS);
+        REQUIRE(1 == ublox_wheel_advance(&w, 1020 + 10 * UBLOX_WHEEL_SLOTS, ublox_wheel_test_cb, order));
+        REQUIRE(0 == strcmp("4123", order));
+        REQUIRE((102 + 2 * UBLOX_WHEEL_SLOTS) * 10 == ublox_wheel_next(&w));
+        REQUIRE(1 == ublox_wheel_advance(&w, 1000000, ublox_wheel_test_cb, order));
+        REQUIRE(0 == strcmp("41230", order));
+        REQUIRE(0 == w.num);
+        REQUIRE(0 == ublox_wheel_next(&w));
+    }
+}
+#endif /* CIUT_ENABLED */
@@ -0,0 +1,61 @@
+/**
+ * \file    ubloxwheel.h
+ * \brief   The hashed timer wheel of the deadlines
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#ifndef UBLOX_WHEEL_H
+#define UBLOX_WHEEL_H 1
+
+#include "osporting.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UBLOX_WHEEL_BITS  8 /**< the bits of the slot index */
+#define UBLOX_WHEEL_SLOTS (1 << UBLOX_WHEEL_BITS) /**< the number of slots of the wheel */
+
+/** a timer in the wheel, embedded in the object of the owner */
+typedef struct _ublox_tmnode_t {
+    struct _ublox_tmnode_t * next; /**< NULL if not in the wheel */
+    struct _ublox_tmnode_t * prev;
+    uint64_t expire;      /**< the deadline (ms) */
+    void * data;          /**< the owner of the timer */
+} ublox_tmnode_t;
+
+/**
+ * The timers are hashed to the slots by (expire / tick), a timer beyond one
+ * revolution stays in its slot until its round comes. Adding and removing a
+ * timer are O(1), the wheel is advanced by the expired slots only, so the
+ * event loop can sleep until the next non-empty slot regardless of the number
+ * of the timers. The time is given by the caller in ms, such as uv_now().
+ */
+typedef struct _ublox_wheel_t {
+    ublox_tmnode_t slots[UBLOX_WHEEL_SLOTS]; /**< the heads of the circular lists */
+    uint32_t tick;        /**< the time of a slot (ms) */
+    uint64_t cur;         /**< the current tick, the slots before it are processed */
+    size_t num;           /**< the number of the timers in the wheel */
+} ublox_wheel_t;
+
+/** the callback of the expired timer, the timer can be added again in it */
+typedef void (* ublox_wheel_cb_t)(void * userdata, ublox_tmnode_t * node);
+
+void ublox_tmnode_init(ublox_tmnode_t * node, void * data);
+/** the timer is in the wheel */
+#define ublox_tmnode_pending(node) (NULL != (node)->next)
+
+void ublox_wheel_init(ublox_wheel_t * w, uint32_t tick, uint64_t now);
+void ublox_wheel_add(ublox_wheel_t * w, ublox_tmnode_t * node, uint64_t expire);
+void ublox_wheel_del(ublox_wheel_t * w, ublox_tmnode_t * node);
+size_t ublox_wheel_advance(ublox_wheel_t * w, uint64_t now, ublox_wheel_cb_t cb, void * userdata);
+uint64_t ublox_wheel_next(const ublox_wheel_t * w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UBLOX_WHEEL_H */
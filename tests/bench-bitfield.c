@@ -0,0 +1,152 @@
+/**
+ * \file    bench-bitfield.c
+ * \brief   Benchmark of the bit field extraction of the navigation words
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ubloxutils.h"
+
+#define BENCH_SZ_SUBFRAME 38 /* BeiDou, 300 bits */
+#define BENCH_NUM_SUBFRAME (64 * 1024)
+#define BENCH_ROUNDS 32
+
+/* the subframe 2 of BeiDou D1, most of the fields are split by the parity */
+static const ublox_bitfield_t g_bench_tbl[] = {
+    UBLOX_BITFIELD_S2(42, 10, 60, 6),
+    UBLOX_BITFIELD_S2(66, 16, 90, 2),
+    UBLOX_BITFIELD_S2(92, 20, 120, 12),
+    UBLOX_BITFIELD_U2(132, 10, 150, 22),
+    UBLOX_BITFIELD_S(180, 18),
+    UBLOX_BITFIELD_S2(198, 4, 210, 14),
+    UBLOX_BITFIELD_S2(224, 8, 240, 10),
+    UBLOX_BITFIELD_U2(250, 12, 270, 20),
+    UBLOX_BITFIELD_U(290, 2),
+};
+
+/* the same fields as g_bench_tbl: pos1, len1, pos2, len2 */
+static const size_t g_bench_pos[][4] = {
+    { 42, 10, 60, 6 }, { 66, 16, 90, 2 }, { 92, 20, 120, 12 }, { 132, 10, 150, 22 }, { 180, 18, 198, 0 },
+    { 198, 4, 210, 14 }, { 224, 8, 240, 10 }, { 250, 12, 270, 20 }, { 290, 2, 292, 0 },
+};
+
+static double
+time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the bit-by-bit extraction, as the reference */
+static uint32_t
+bench_getbitu_loop(const uint8_t * buf, size_t pos, size_t len)
+{
+    uint32_t val = 0;
+    size_t i;
+    for (i = pos; i < pos + len; i ++) {
+        val = (val << 1) | ((buf[i / 8] >> (7 - i % 8)) & 1u);
+    }
+    return val;
+}
+
+static uint32_t
+bench_run_loop(const uint8_t * buf)
+{
+    uint32_t sum = 0;
+    size_t i, j;
+    for (i = 0; i < BENCH_NUM_SUBFRAME; i ++, buf += BENCH_SZ_SUBFRAME) {
+        for (j = 0; j < NUM_ARRAY(g_bench_pos); j ++) {
+            sum += (bench_getbitu_loop(buf, g_bench_pos[j][0], g_bench_pos[j][1]) << g_bench_pos[j][3])
+                | bench_getbitu_loop(buf, g_bench_pos[j][2], g_bench_pos[j][3]);
+        }
+    }
+    return sum;
+}
+
+static uint32_t
+bench_run_getbitu(const uint8_t * buf)
+{
+    uint32_t sum = 0;
+    size_t i, j;
+    for (i = 0; i < BENCH_NUM_SUBFRAME; i ++, buf += BENCH_SZ_SUBFRAME) {
+        for (j = 0; j < NUM_ARRAY(g_bench_pos); j ++) {
+            sum += (ublox_getbitu(buf, g_bench_pos[j][0], g_bench_pos[j][1]) << g_bench_pos[j][3])
+                | ublox_getbitu(buf, g_bench_pos[j][2], g_bench_pos[j][3]);
+        }
+    }
+    return sum;
+}
+
+static uint32_t
+bench_run_table(const uint8_t * buf)
+{
+    uint32_t val[NUM_ARRAY(g_bench_tbl)];
+    uint32_t sum = 0;
+    size_t i, j;
+    for (i = 0; i < BENCH_NUM_SUBFRAME; i ++, buf += BENCH_SZ_SUBFRAME) {
+        ublox_bitfield_extract(buf, BENCH_SZ_SUBFRAME, g_bench_tbl, NUM_ARRAY(g_bench_tbl), val);
+        for (j = 0; j < NUM_ARRAY(g_bench_tbl); j ++) {
+            // the signed values are sign extended, use the field bits only
+            sum += val[j] & (uint32_t)UBLOX_BITFIELD_LMASK(g_bench_tbl[j].len1 + g_bench_tbl[j].len2);
+        }
+    }
+    return sum;
+}
+
+static void
+bench_report(const char * title, uint32_t (* run)(const uint8_t *), const uint8_t * buf)
+{
+    uint32_t sum = 0;
+    double t;
+    int i;
+
+    t = time_now();
+    for (i = 0; i < BENCH_ROUNDS; i ++) {
+        sum += run(buf);
+    }
+    t = time_now() - t;
+    printf("%-16s %10.1f Mfields/s  sum=%08x\n", title,
+        (double)BENCH_NUM_SUBFRAME * NUM_ARRAY(g_bench_tbl) * BENCH_ROUNDS / t / 1e6, sum);
+}
+
+int
+main(int argc, char * argv[])
+{
+    uint8_t * buf;
+    size_t i;
+    int impl;
+
+    if (0 != ublox_bitfield_check(g_bench_tbl, NUM_ARRAY(g_bench_tbl))) {
+        fprintf(stderr, "bad table\n");
+        return 1;
+    }
+    buf = (uint8_t *)malloc(BENCH_SZ_SUBFRAME * BENCH_NUM_SUBFRAME);
+    if (NULL == buf) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (i = 0; i < BENCH_SZ_SUBFRAME * BENCH_NUM_SUBFRAME; i ++) {
+        buf[i] = (uint8_t)rand();
+    }
+    bench_report("bit loop", bench_run_loop, buf);
+    bench_report("ublox_getbitu", bench_run_getbitu, buf);
+    for (impl = UBLOX_BITFIELD_IMPL_SCALAR; impl <= UBLOX_BITFIELD_IMPL_BMI2; impl ++) {
+        char title[32];
+        if (0 > ublox_bitfield_impl_select(impl)) {
+            continue;
+        }
+        snprintf(title, sizeof(title), "table %s", ublox_bitfield_impl_name(impl));
+        bench_report(title, bench_run_table, buf);
+    }
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * \file    bench-ubloxsync.c
+ * \brief   Benchmark of the UBX header search
+ * \author  Yunhui Fu (yhfudev@gmail.com)
+ * \version 1.0
+ * \date    2026-10-17
+ * \copyright GPL/BSD
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ubloxconn.h"
+
+#define BENCH_SIZE   (16 * 1024 * 1024)
+#define BENCH_ROUNDS 8
+
+static double
+time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * \brief fill the buffer with UBX packets (payload 1000 bytes)
+ */
+static void
+fill_clean(uint8_t * buf, size_t sz)
+{
+    size_t i;
+    size_t len = 1000;
+    for (i = 0; i < sz; i ++) {
+        buf[i] = (uint8_t)rand();
+        if (buf[i] == 0xB5) {
+            buf[i] = 0x00;
+        }
+    }
+    for (i = 0; i + UBLOX_PKT_LENGTH_MIN + len <= sz; i += UBLOX_PKT_LENGTH_MIN + len) {
+        buf[i] = 0xB5;
+        buf[i + 1] = 0x62;
+        buf[i + 4] = len & 0xFF;
+        buf[i + 5] = (len >> 8) & 0xFF;
+    }
+}
+
+/**
+ * \brief fill the buffer with garbage, about 30% are 0xB5, with few real headers
+ */
+static void
+fill_garbage(uint8_t * buf, size_t sz)
+{
+    size_t i;
+    for (i = 0; i < sz; i ++) {
+        buf[i] = (rand() % 10 < 3)?0xB5:(uint8_t)rand();
+        if (buf[i] == 0x62) {
+            buf[i] = 0x00;
+        }
+    }
+    for (i = 0; i + 1 < sz; i += 64 * 1024) {
+        buf[i] = 0xB5;
+        buf[i + 1] = 0x62;
+    }
+}
+
+/**
+ * \brief scan the whole buffer header by header
+ * \return the number of headers found
+ */
+static size_t
+scan_all(const uint8_t * buf, size_t sz)
+{
+    size_t cnt = 0;
+    size_t off = 0;
+    size_t ret;
+    while (off < sz) {
+        ret = ublox_pkt_find_sync(buf + off, sz - off);
+        off += ret;
+        if (off >= sz) {
+            break;
+        }
+        cnt ++;
+        off ++;
+    }
+    return cnt;
+}
+
+static void
+bench_run(const char * title, const uint8_t * buf, size_t sz)
+{
+    int impl;
+    int i;
+    size_t cnt;
+    double t;
+
+    for (impl = UBLOX_SYNC_IMPL_SCALAR; impl <= UBLOX_SYNC_IMPL_NEON; impl ++) {
+        if (0 > ublox_pkt_sync_impl_select(impl)) {
+            continue;
+        }
+        cnt = 0;
+        t = time_now();
+        for (i = 0; i < BENCH_ROUNDS; i ++) {
+            cnt += scan_all(buf, sz);
+        }
+        t = time_now() - t;
+        printf("%-8s %-7s %10.1f MB/s  headers=%zu\n", title, ublox_pkt_sync_impl_name(impl),
+            (double)sz * BENCH_ROUNDS / t / 1e6, cnt / BENCH_ROUNDS);
+    }
+}
+
+int
+main(int argc, char * argv[])
+{
+    uint8_t * buf;
+
+    buf = (uint8_t *)malloc(BENCH_SIZE);
+    if (NULL == buf) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    srand(1);
+    fill_clean(buf, BENCH_SIZE);
+    bench_run("clean", buf, BENCH_SIZE);
+    fill_garbage(buf, BENCH_SIZE);
+    bench_run("garbage", buf, BENCH_SIZE);
+    free(buf);
+    return 0;
+}